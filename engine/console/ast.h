@@ -380,13 +380,17 @@ struct FloatNode : ExprNode
 
 struct StrConstNode : ExprNode
 {
-   char *str;
+   const char *str;
+   U32 len;
    F64 fVal;
    U32 index;
    bool tag;
    bool doc; // Specifies that this string is a documentation block.
 
-   static StrConstNode *alloc( Compiler::Resources* res, S32 lineNumber, char *str, bool tag, bool doc = false, S32 forceLen = -1);
+   static StrConstNode *alloc( Compiler::Resources* res, S32 lineNumber, const char *str, bool tag, bool doc = false, S32 forceLen = -1);
+   /// References str directly rather than copying it. str[len] must be a nul
+   /// and the storage must outlive compilation (e.g. the tokenizer buffer).
+   static StrConstNode *allocView( Compiler::Resources* res, S32 lineNumber, const char *str, U32 len, bool tag, bool doc = false);
   
    U32 compile(CodeStream &codeStream, U32 ip, TypeReq type);
    TypeReq getPreferredType();
@@ -33,6 +33,7 @@
 #include "console/compiler.h"
 #include "console/consoleInternal.h"
 #include "console/ast.h"
+#include "console/simpleParser.h"
 
 using namespace Compiler;
 
@@ -41,15 +42,29 @@ using namespace Compiler;
 /// TorqueScript AST node allocators.
 ///
 /// These static methods exist to allocate new AST node for the compiler. They
-/// all allocate memory from the res->consoleAllocator for efficiency, and often take
+/// all allocate memory from the res->astArena for efficiency, and often take
 /// arguments relating to the state of the nodes. They are called from gram.y
 /// (really gram.c) as the lexer analyzes the script code.
 
 //------------------------------------------------------------
 
+void *Compiler::Resources::astAlloc(U32 size)
+{
+   void *ptr = astArena.alloc(size);
+   if (ptr == nullptr)
+   {
+      char buf[128];
+      snprintf(buf, sizeof(buf), "script exceeds AST memory limit (%" PRIu64 " bytes)", astArena.getLimit());
+      throw SimpleParser::TokenError(currentASTGen ? currentASTGen->currentToken() : SimpleParser::TOK(), SimpleParser::TT::NONE, buf);
+   }
+   return ptr;
+}
+
+//------------------------------------------------------------
+
 BreakStmtNode *BreakStmtNode::alloc( Compiler::Resources* res, S32 lineNumber )
 {
-   BreakStmtNode *ret = (BreakStmtNode *) res->consoleAlloc(sizeof(BreakStmtNode));
+   BreakStmtNode *ret = (BreakStmtNode *) res->astAlloc(sizeof(BreakStmtNode));
    constructInPlace(ret);
    ret->dbgLineNumber = lineNumber;
    return ret;
@@ -57,7 +72,7 @@ BreakStmtNode *BreakStmtNode::alloc( Compiler::Resources* res, S32 lineNumber )
 
 ContinueStmtNode *ContinueStmtNode::alloc( Compiler::Resources* res, S32 lineNumber )
 {
-   ContinueStmtNode *ret = (ContinueStmtNode *) res->consoleAlloc(sizeof(ContinueStmtNode));
+   ContinueStmtNode *ret = (ContinueStmtNode *) res->astAlloc(sizeof(ContinueStmtNode));
    constructInPlace(ret);
    ret->dbgLineNumber = lineNumber;
    return ret;
@@ -65,7 +80,7 @@ ContinueStmtNode *ContinueStmtNode::alloc( Compiler::Resources* res, S32 lineNum
 
 ReturnStmtNode *ReturnStmtNode::alloc( Compiler::Resources* res, S32 lineNumber, ExprNode *expr)
 {
-   ReturnStmtNode *ret = (ReturnStmtNode *) res->consoleAlloc(sizeof(ReturnStmtNode));
+   ReturnStmtNode *ret = (ReturnStmtNode *) res->astAlloc(sizeof(ReturnStmtNode));
    constructInPlace(ret);
    ret->expr = expr;
    ret->dbgLineNumber = lineNumber;
@@ -75,7 +90,7 @@ ReturnStmtNode *ReturnStmtNode::alloc( Compiler::Resources* res, S32 lineNumber,
 
 IfStmtNode *IfStmtNode::alloc( Compiler::Resources* res, S32 lineNumber, ExprNode *testExpr, StmtNode *ifBlock, StmtNode *elseBlock, bool propagate )
 {
-   IfStmtNode *ret = (IfStmtNode *) res->consoleAlloc(sizeof(IfStmtNode));
+   IfStmtNode *ret = (IfStmtNode *) res->astAlloc(sizeof(IfStmtNode));
    constructInPlace(ret);
    ret->dbgLineNumber = lineNumber;
    
@@ -90,7 +105,7 @@ IfStmtNode *IfStmtNode::alloc( Compiler::Resources* res, S32 lineNumber, ExprNod
 
 LoopStmtNode *LoopStmtNode::alloc( Compiler::Resources* res, S32 lineNumber, ExprNode *initExpr, ExprNode *testExpr, ExprNode *endLoopExpr, StmtNode *loopBlock, bool isDoLoop )
 {
-   LoopStmtNode *ret = (LoopStmtNode *) res->consoleAlloc(sizeof(LoopStmtNode));
+   LoopStmtNode *ret = (LoopStmtNode *) res->astAlloc(sizeof(LoopStmtNode));
    constructInPlace(ret);
    ret->dbgLineNumber = lineNumber;
    ret->testExpr = testExpr;
@@ -110,7 +125,7 @@ LoopStmtNode *LoopStmtNode::alloc( Compiler::Resources* res, S32 lineNumber, Exp
 
 IterStmtNode* IterStmtNode::alloc( Compiler::Resources* res, S32 lineNumber, StringTableEntry varName, ExprNode* containerExpr, StmtNode* body, bool isStringIter )
 {
-   IterStmtNode* ret = ( IterStmtNode* ) res->consoleAlloc( sizeof( IterStmtNode ) );
+   IterStmtNode* ret = ( IterStmtNode* ) res->astAlloc( sizeof( IterStmtNode ) );
    constructInPlace( ret );
    
    ret->dbgLineNumber = lineNumber;
@@ -124,7 +139,7 @@ IterStmtNode* IterStmtNode::alloc( Compiler::Resources* res, S32 lineNumber, Str
 
 FloatBinaryExprNode *FloatBinaryExprNode::alloc( Compiler::Resources* res, S32 lineNumber, const SimpleLexer::TokenType op, ExprNode *left, ExprNode *right )
 {
-   FloatBinaryExprNode *ret = (FloatBinaryExprNode *) res->consoleAlloc(sizeof(FloatBinaryExprNode));
+   FloatBinaryExprNode *ret = (FloatBinaryExprNode *) res->astAlloc(sizeof(FloatBinaryExprNode));
    constructInPlace(ret);
    ret->dbgLineNumber = lineNumber;
    
@@ -137,7 +152,7 @@ FloatBinaryExprNode *FloatBinaryExprNode::alloc( Compiler::Resources* res, S32 l
 
 IntBinaryExprNode *IntBinaryExprNode::alloc( Compiler::Resources* res, S32 lineNumber, const SimpleLexer::TokenType op, ExprNode *left, ExprNode *right )
 {
-   IntBinaryExprNode *ret = (IntBinaryExprNode *) res->consoleAlloc(sizeof(IntBinaryExprNode));
+   IntBinaryExprNode *ret = (IntBinaryExprNode *) res->astAlloc(sizeof(IntBinaryExprNode));
    constructInPlace(ret);
    ret->dbgLineNumber = lineNumber;
    
@@ -152,7 +167,7 @@ IntBinaryExprNode *IntBinaryExprNode::alloc( Compiler::Resources* res, S32 lineN
 
 StreqExprNode *StreqExprNode::alloc( Compiler::Resources* res, S32 lineNumber, ExprNode *left, ExprNode *right, bool eq )
 {
-   StreqExprNode *ret = (StreqExprNode *) res->consoleAlloc(sizeof(StreqExprNode));
+   StreqExprNode *ret = (StreqExprNode *) res->astAlloc(sizeof(StreqExprNode));
    constructInPlace(ret);
    ret->dbgLineNumber = lineNumber;
    ret->left = left;
@@ -164,7 +179,7 @@ StreqExprNode *StreqExprNode::alloc( Compiler::Resources* res, S32 lineNumber, E
 
 StrcatExprNode *StrcatExprNode::alloc( Compiler::Resources* res, S32 lineNumber, ExprNode *left, ExprNode *right, int appendChar )
 {
-   StrcatExprNode *ret = (StrcatExprNode *) res->consoleAlloc(sizeof(StrcatExprNode));
+   StrcatExprNode *ret = (StrcatExprNode *) res->astAlloc(sizeof(StrcatExprNode));
    constructInPlace(ret);
    ret->dbgLineNumber = lineNumber;
    ret->left = left;
@@ -176,7 +191,7 @@ StrcatExprNode *StrcatExprNode::alloc( Compiler::Resources* res, S32 lineNumber,
 
 CommaCatExprNode *CommaCatExprNode::alloc( Compiler::Resources* res, S32 lineNumber, ExprNode *left, ExprNode *right )
 {
-   CommaCatExprNode *ret = (CommaCatExprNode *) res->consoleAlloc(sizeof(CommaCatExprNode));
+   CommaCatExprNode *ret = (CommaCatExprNode *) res->astAlloc(sizeof(CommaCatExprNode));
    constructInPlace(ret);
    ret->dbgLineNumber = lineNumber;
    ret->left = left;
@@ -187,7 +202,7 @@ CommaCatExprNode *CommaCatExprNode::alloc( Compiler::Resources* res, S32 lineNum
 
 IntUnaryExprNode *IntUnaryExprNode::alloc( Compiler::Resources* res, S32 lineNumber, const SimpleLexer::TokenType op, ExprNode *expr )
 {
-   IntUnaryExprNode *ret = (IntUnaryExprNode *) res->consoleAlloc(sizeof(IntUnaryExprNode));
+   IntUnaryExprNode *ret = (IntUnaryExprNode *) res->astAlloc(sizeof(IntUnaryExprNode));
    constructInPlace(ret);
    ret->dbgLineNumber = lineNumber;
    ret->op = op;
@@ -198,7 +213,7 @@ IntUnaryExprNode *IntUnaryExprNode::alloc( Compiler::Resources* res, S32 lineNum
 
 FloatUnaryExprNode *FloatUnaryExprNode::alloc( Compiler::Resources* res, S32 lineNumber, const SimpleLexer::TokenType op, ExprNode *expr )
 {
-   FloatUnaryExprNode *ret = (FloatUnaryExprNode *) res->consoleAlloc(sizeof(FloatUnaryExprNode));
+   FloatUnaryExprNode *ret = (FloatUnaryExprNode *) res->astAlloc(sizeof(FloatUnaryExprNode));
    constructInPlace(ret);
    ret->dbgLineNumber = lineNumber;
    ret->op = op;
@@ -208,7 +223,7 @@ FloatUnaryExprNode *FloatUnaryExprNode::alloc( Compiler::Resources* res, S32 lin
 
 VarNode *VarNode::alloc( Compiler::Resources* res, S32 lineNumber, StringTableEntry varName, ExprNode *arrayIndex, StringTableEntry typeName )
 {
-   VarNode *ret = (VarNode *) res->consoleAlloc(sizeof(VarNode));
+   VarNode *ret = (VarNode *) res->astAlloc(sizeof(VarNode));
    constructInPlace(ret);
    ret->dbgLineNumber = lineNumber;
    ret->varName = varName;
@@ -221,7 +236,7 @@ VarNode *VarNode::alloc( Compiler::Resources* res, S32 lineNumber, StringTableEn
 
 IntNode *IntNode::alloc( Compiler::Resources* res, S32 lineNumber, S32 value )
 {
-   IntNode *ret = (IntNode *) res->consoleAlloc(sizeof(IntNode));
+   IntNode *ret = (IntNode *) res->astAlloc(sizeof(IntNode));
    constructInPlace(ret);
    ret->dbgLineNumber = lineNumber;
    ret->value = value;
@@ -230,7 +245,7 @@ IntNode *IntNode::alloc( Compiler::Resources* res, S32 lineNumber, S32 value )
 
 ConditionalExprNode *ConditionalExprNode::alloc( Compiler::Resources* res, S32 lineNumber, ExprNode *testExpr, ExprNode *trueExpr, ExprNode *falseExpr )
 {
-   ConditionalExprNode *ret = (ConditionalExprNode *) res->consoleAlloc(sizeof(ConditionalExprNode));
+   ConditionalExprNode *ret = (ConditionalExprNode *) res->astAlloc(sizeof(ConditionalExprNode));
    constructInPlace(ret);
    ret->dbgLineNumber = lineNumber;
    ret->testExpr = testExpr;
@@ -242,7 +257,7 @@ ConditionalExprNode *ConditionalExprNode::alloc( Compiler::Resources* res, S32 l
 
 FloatNode *FloatNode::alloc( Compiler::Resources* res, S32 lineNumber, F64 value )
 {
-   FloatNode *ret = (FloatNode *) res->consoleAlloc(sizeof(FloatNode));
+   FloatNode *ret = (FloatNode *) res->astAlloc(sizeof(FloatNode));
    constructInPlace(ret);
    
    ret->dbgLineNumber = lineNumber;
@@ -250,31 +265,34 @@ FloatNode *FloatNode::alloc( Compiler::Resources* res, S32 lineNumber, F64 value
    return ret;
 }
 
-StrConstNode *StrConstNode::alloc( Compiler::Resources* res, S32 lineNumber, char *str, bool tag, bool doc, S32 forceLen)
+StrConstNode *StrConstNode::alloc( Compiler::Resources* res, S32 lineNumber, const char *str, bool tag, bool doc, S32 forceLen)
+{
+   U32 len = forceLen >= 0 ? (U32)forceLen : (U32)strlen(str);
+   char *copy = (char *) res->astAlloc((U32)dAlignSize(len + 1, 8));
+   memcpy(copy, str, len);
+   copy[len] = '\0';
+   
+   return allocView(res, lineNumber, copy, len, tag, doc);
+}
+
+StrConstNode *StrConstNode::allocView( Compiler::Resources* res, S32 lineNumber, const char *str, U32 len, bool tag, bool doc)
 {
-   StrConstNode *ret = (StrConstNode *) res->consoleAlloc(sizeof(StrConstNode));
+   AssertFatal(str[len] == '\0', "StrConstNode::allocView: string must be nul terminated");
+   
+   StrConstNode *ret = (StrConstNode *) res->astAlloc(sizeof(StrConstNode));
    constructInPlace(ret);
    ret->dbgLineNumber = lineNumber;
-   ret->str = (char *) res->consoleAlloc((U32)dAlignSize(forceLen >= 0 ? forceLen+1 : strlen(str) + 1, 8));
+   ret->str = str;
+   ret->len = len;
    ret->tag = tag;
    ret->doc = doc;
    
-   if (forceLen >= 0)
-   {
-      memcpy(ret->str, str, forceLen);
-      ret->str[forceLen] = '\0';
-   }
-   else
-   {
-      strcpy(ret->str, str);
-   }
-   
    return ret;
 }
 
 ConstantNode *ConstantNode::alloc( Compiler::Resources* res, S32 lineNumber, StringTableEntry value )
 {
-   ConstantNode *ret = (ConstantNode *) res->consoleAlloc(sizeof(ConstantNode));
+   ConstantNode *ret = (ConstantNode *) res->astAlloc(sizeof(ConstantNode));
    constructInPlace(ret);
    ret->dbgLineNumber = lineNumber;
    ret->value = value;
@@ -283,7 +301,7 @@ ConstantNode *ConstantNode::alloc( Compiler::Resources* res, S32 lineNumber, Str
 
 AssignExprNode *AssignExprNode::alloc( Compiler::Resources* res, S32 lineNumber, StringTableEntry varName, ExprNode *arrayIndex, ExprNode *expr, StringTableEntry typeName )
 {
-   AssignExprNode *ret = (AssignExprNode *) res->consoleAlloc(sizeof(AssignExprNode));
+   AssignExprNode *ret = (AssignExprNode *) res->astAlloc(sizeof(AssignExprNode));
    constructInPlace(ret);
 
    ret->dbgLineNumber = lineNumber;
@@ -300,7 +318,7 @@ AssignExprNode *AssignExprNode::alloc( Compiler::Resources* res, S32 lineNumber,
 
 AssignOpExprNode *AssignOpExprNode::alloc( Compiler::Resources* res, S32 lineNumber, StringTableEntry varName, ExprNode *arrayIndex, ExprNode *expr, const SimpleLexer::TokenType op )
 {
-   AssignOpExprNode *ret = (AssignOpExprNode *) res->consoleAlloc(sizeof(AssignOpExprNode));
+   AssignOpExprNode *ret = (AssignOpExprNode *) res->astAlloc(sizeof(AssignOpExprNode));
    constructInPlace(ret);
 
    ret->dbgLineNumber = lineNumber;
@@ -317,7 +335,7 @@ AssignOpExprNode *AssignOpExprNode::alloc( Compiler::Resources* res, S32 lineNum
 
 TTagSetStmtNode *TTagSetStmtNode::alloc( Compiler::Resources* res, S32 lineNumber, StringTableEntry tag, ExprNode *valueExpr, ExprNode *stringExpr )
 {
-   TTagSetStmtNode *ret = (TTagSetStmtNode *) res->consoleAlloc(sizeof(TTagSetStmtNode));
+   TTagSetStmtNode *ret = (TTagSetStmtNode *) res->astAlloc(sizeof(TTagSetStmtNode));
    constructInPlace(ret);
    ret->dbgLineNumber = lineNumber;
    ret->tag = tag;
@@ -328,7 +346,7 @@ TTagSetStmtNode *TTagSetStmtNode::alloc( Compiler::Resources* res, S32 lineNumbe
 
 TTagDerefNode *TTagDerefNode::alloc( Compiler::Resources* res, S32 lineNumber, ExprNode *expr )
 {
-   TTagDerefNode *ret = (TTagDerefNode *) res->consoleAlloc(sizeof(TTagDerefNode));
+   TTagDerefNode *ret = (TTagDerefNode *) res->astAlloc(sizeof(TTagDerefNode));
    constructInPlace(ret);
    ret->dbgLineNumber = lineNumber;
    ret->expr = expr;
@@ -337,7 +355,7 @@ TTagDerefNode *TTagDerefNode::alloc( Compiler::Resources* res, S32 lineNumber, E
 
 TTagExprNode *TTagExprNode::alloc( Compiler::Resources* res, S32 lineNumber, StringTableEntry tag )
 {
-   TTagExprNode *ret = (TTagExprNode *) res->consoleAlloc(sizeof(TTagExprNode));
+   TTagExprNode *ret = (TTagExprNode *) res->astAlloc(sizeof(TTagExprNode));
    constructInPlace(ret);
    ret->dbgLineNumber = lineNumber;
    ret->tag = tag;
@@ -346,7 +364,7 @@ TTagExprNode *TTagExprNode::alloc( Compiler::Resources* res, S32 lineNumber, Str
 
 FuncCallExprNode *FuncCallExprNode::alloc( Compiler::Resources* res, S32 lineNumber, StringTableEntry funcName, StringTableEntry nameSpace, ExprNode *args, bool dot )
 {
-   FuncCallExprNode *ret = (FuncCallExprNode *) res->consoleAlloc(sizeof(FuncCallExprNode));
+   FuncCallExprNode *ret = (FuncCallExprNode *) res->astAlloc(sizeof(FuncCallExprNode));
    constructInPlace(ret);
    ret->dbgLineNumber = lineNumber;
    ret->funcName = funcName;
@@ -369,7 +387,7 @@ AssertCallExprNode *AssertCallExprNode::alloc( Compiler::Resources* res, S32 lin
 {
 #ifdef TORQUE_ENABLE_SCRIPTASSERTS
    
-   AssertCallExprNode *ret = (AssertCallExprNode *) res->consoleAlloc(sizeof(FuncCallExprNode));
+   AssertCallExprNode *ret = (AssertCallExprNode *) res->astAlloc(sizeof(FuncCallExprNode));
    constructInPlace(ret);
    ret->dbgLineNumber = lineNumber;
    ret->testExpr = testExpr;
@@ -385,7 +403,7 @@ AssertCallExprNode *AssertCallExprNode::alloc( Compiler::Resources* res, S32 lin
 
 SlotAccessNode *SlotAccessNode::alloc( Compiler::Resources* res, S32 lineNumber, ExprNode *objectExpr, ExprNode *arrayExpr, StringTableEntry slotName )
 {
-   SlotAccessNode *ret = (SlotAccessNode *) res->consoleAlloc(sizeof(SlotAccessNode));
+   SlotAccessNode *ret = (SlotAccessNode *) res->astAlloc(sizeof(SlotAccessNode));
    constructInPlace(ret);
    ret->dbgLineNumber = lineNumber;
    ret->objectExpr = objectExpr;
@@ -397,7 +415,7 @@ SlotAccessNode *SlotAccessNode::alloc( Compiler::Resources* res, S32 lineNumber,
 
 InternalSlotAccessNode *InternalSlotAccessNode::alloc( Compiler::Resources* res, S32 lineNumber, ExprNode *objectExpr, ExprNode *slotExpr, bool recurse )
 {
-   InternalSlotAccessNode *ret = (InternalSlotAccessNode *) res->consoleAlloc(sizeof(InternalSlotAccessNode));
+   InternalSlotAccessNode *ret = (InternalSlotAccessNode *) res->astAlloc(sizeof(InternalSlotAccessNode));
    constructInPlace(ret);
    ret->dbgLineNumber = lineNumber;
    ret->objectExpr = objectExpr;
@@ -408,7 +426,7 @@ InternalSlotAccessNode *InternalSlotAccessNode::alloc( Compiler::Resources* res,
 
 SlotAssignNode *SlotAssignNode::alloc( Compiler::Resources* res, S32 lineNumber, ExprNode *objectExpr, ExprNode *arrayExpr, StringTableEntry slotName, ExprNode *valueExpr, StringTableEntry typeName )
 {
-   SlotAssignNode *ret = (SlotAssignNode *) res->consoleAlloc(sizeof(SlotAssignNode));
+   SlotAssignNode *ret = (SlotAssignNode *) res->astAlloc(sizeof(SlotAssignNode));
    constructInPlace(ret);
    ret->dbgLineNumber = lineNumber;
    ret->objectExpr = objectExpr;
@@ -422,7 +440,7 @@ SlotAssignNode *SlotAssignNode::alloc( Compiler::Resources* res, S32 lineNumber,
 
 SlotAssignOpNode *SlotAssignOpNode::alloc( Compiler::Resources* res, S32 lineNumber, ExprNode *objectExpr, StringTableEntry slotName, ExprNode *arrayExpr, const SimpleLexer::TokenType op, ExprNode *valueExpr )
 {
-   SlotAssignOpNode *ret = (SlotAssignOpNode *) res->consoleAlloc(sizeof(SlotAssignOpNode));
+   SlotAssignOpNode *ret = (SlotAssignOpNode *) res->astAlloc(sizeof(SlotAssignOpNode));
    constructInPlace(ret);
    ret->dbgLineNumber = lineNumber;
    ret->objectExpr = objectExpr;
@@ -437,7 +455,7 @@ SlotAssignOpNode *SlotAssignOpNode::alloc( Compiler::Resources* res, S32 lineNum
 
 ObjectDeclNode *ObjectDeclNode::alloc( Compiler::Resources* res, S32 lineNumber, ExprNode *classNameExpr, ExprNode *objectNameExpr, ExprNode *argList, StringTableEntry parentObject, SlotAssignNode *slotDecls, ObjectDeclNode *subObjects, bool isDatablock, bool classNameInternal, bool isSingleton )
 {
-   ObjectDeclNode *ret = (ObjectDeclNode *) res->consoleAlloc(sizeof(ObjectDeclNode));
+   ObjectDeclNode *ret = (ObjectDeclNode *) res->astAlloc(sizeof(ObjectDeclNode));
    constructInPlace(ret);
    ret->dbgLineNumber = lineNumber;
    ret->classNameExpr = classNameExpr;
@@ -458,7 +476,7 @@ ObjectDeclNode *ObjectDeclNode::alloc( Compiler::Resources* res, S32 lineNumber,
 
 FunctionDeclStmtNode *FunctionDeclStmtNode::alloc( Compiler::Resources* res, S32 lineNumber, StringTableEntry fnName, StringTableEntry nameSpace, VarNode *args, StmtNode *stmts, StringTableEntry retTypeName, bool isSignal )
 {
-   FunctionDeclStmtNode *ret = (FunctionDeclStmtNode *) res->consoleAlloc(sizeof(FunctionDeclStmtNode));
+   FunctionDeclStmtNode *ret = (FunctionDeclStmtNode *) res->astAlloc(sizeof(FunctionDeclStmtNode));
    constructInPlace(ret);
    ret->dbgLineNumber = lineNumber;
    ret->fnName = fnName;
@@ -477,7 +495,7 @@ CatchStmtNode* CatchStmtNode::alloc(Compiler::Resources* res,
                                     ExprNode* testExpr,
                                     StmtNode* catchBlock)
 {
-   CatchStmtNode* ret = (CatchStmtNode *) res->consoleAlloc(sizeof(CatchStmtNode));
+   CatchStmtNode* ret = (CatchStmtNode *) res->astAlloc(sizeof(CatchStmtNode));
    constructInPlace(ret);
    ret->dbgLineNumber = lineNumber;
    ret->testExpr   = testExpr;
@@ -490,7 +508,7 @@ TryStmtNode* TryStmtNode::alloc(Compiler::Resources* res,
                                 StmtNode *tryBlock,
                                 CatchStmtNode* catchBlocks)
 {
-   TryStmtNode* ret = (TryStmtNode *) res->consoleAlloc(sizeof(TryStmtNode));
+   TryStmtNode* ret = (TryStmtNode *) res->astAlloc(sizeof(TryStmtNode));
    constructInPlace(ret);
    ret->dbgLineNumber = lineNumber;
    ret->tryBlock      = tryBlock;
@@ -504,7 +522,7 @@ TryStmtNode* TryStmtNode::alloc(Compiler::Resources* res,
 
 TupleExprNode *TupleExprNode::alloc( Compiler::Resources* res, S32 lineNumber, ExprNode* inItems )
 {
-   TupleExprNode* ret = (TupleExprNode *) res->consoleAlloc(sizeof(TupleExprNode));
+   TupleExprNode* ret = (TupleExprNode *) res->astAlloc(sizeof(TupleExprNode));
    constructInPlace(ret);
    ret->dbgLineNumber = lineNumber;
    ret->items         = inItems;
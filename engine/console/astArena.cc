@@ -0,0 +1,146 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2025-2026 korkscript contributors.
+// See AUTHORS file and git repository for contributor information.
+//
+// SPDX-License-Identifier: MIT
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "console/stlTypes.h"
+#include "console/astArena.h"
+
+namespace Compiler
+{
+
+AstArena::AstArena() :
+   mFirst(nullptr),
+   mCurrent(nullptr),
+   mUsedBytes(0),
+   mPeakBytes(0),
+   mReservedBytes(0),
+   mLastPeakBytes(0),
+   mLimit(0),
+   mLimitExceeded(false),
+   mLastLimitExceeded(false)
+{
+}
+
+AstArena::~AstArena()
+{
+   releaseMemory();
+}
+
+AstArena::Block* AstArena::newBlock(U32 minSize)
+{
+   U32 size = minSize > BlockSize ? minSize : BlockSize;
+   Block* block = (Block*)KorkApi::VMem::allocBytes(sizeof(Block) + size);
+   if (block == nullptr)
+   {
+      return nullptr;
+   }
+
+   block->next = nullptr;
+   block->size = size;
+   block->used = 0;
+   mReservedBytes += sizeof(Block) + size;
+   return block;
+}
+
+void AstArena::freeBlocks(Block* from)
+{
+   while (from)
+   {
+      Block* next = from->next;
+      mReservedBytes -= sizeof(Block) + from->size;
+      KorkApi::VMem::freeBytes(from);
+      from = next;
+   }
+}
+
+bool AstArena::nextBlock(U32 size)
+{
+   // Reuse the following block if it was retained from a previous compile
+   Block* next = mCurrent ? mCurrent->next : mFirst;
+   if (next && next->size >= size)
+   {
+      next->used = 0;
+      mCurrent = next;
+      return true;
+   }
+
+   Block* block = newBlock(size);
+   if (block == nullptr)
+   {
+      return false;
+   }
+
+   // Insert in order so the tree stays in parse order
+   block->next = next;
+   if (mCurrent)
+   {
+      mCurrent->next = block;
+   }
+   else
+   {
+      mFirst = block;
+   }
+   mCurrent = block;
+   return true;
+}
+
+void AstArena::rewind()
+{
+   if (mUsedBytes > mPeakBytes)
+   {
+      mPeakBytes = mUsedBytes;
+   }
+
+   mUsedBytes = 0;
+   mCurrent = nullptr;
+}
+
+void AstArena::reset()
+{
+   rewind();
+
+   if (mPeakBytes > 0 || mLimitExceeded)
+   {
+      mLastPeakBytes = mPeakBytes;
+      mLastLimitExceeded = mLimitExceeded;
+   }
+
+   mPeakBytes = 0;
+   mLimitExceeded = false;
+
+   if (mFirst == nullptr)
+   {
+      return;
+   }
+
+   // Only walks the list if a large compile left more than we want to keep
+   if (mReservedBytes > RetainBytes)
+   {
+      U64 kept = 0;
+      for (Block* block = mFirst; block; block = block->next)
+      {
+         kept += sizeof(Block) + block->size;
+         if (kept >= RetainBytes || block->next == nullptr)
+         {
+            freeBlocks(block->next);
+            block->next = nullptr;
+            break;
+         }
+      }
+   }
+}
+
+void AstArena::releaseMemory()
+{
+   freeBlocks(mFirst);
+   mFirst = nullptr;
+   mCurrent = nullptr;
+   mUsedBytes = 0;
+   mPeakBytes = 0;
+}
+
+}
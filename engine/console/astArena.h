@@ -0,0 +1,100 @@
+#pragma once
+//-----------------------------------------------------------------------------
+// Copyright (c) 2025-2026 korkscript contributors.
+// See AUTHORS file and git repository for contributor information.
+//
+// SPDX-License-Identifier: MIT
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+
+namespace Compiler
+{
+
+/// Bump allocator for AST nodes.
+///
+/// Nodes are laid out contiguously in allocation (i.e. parse) order. reset()
+/// rewinds to the first block so freeing a whole tree is O(1); blocks are kept
+/// for the next compile up to RetainBytes. An optional limit caps the bytes
+/// handed out between resets.
+class AstArena
+{
+public:
+   enum
+   {
+      BlockSize = 256 * 1024,
+      RetainBytes = 4 * BlockSize,
+      Alignment = 8
+   };
+
+protected:
+   struct Block
+   {
+      Block* next;
+      U32 size;
+      U32 used;
+
+      inline U8* data() { return (U8*)(this+1); }
+   };
+
+   Block* mFirst;
+   Block* mCurrent;
+   U64 mUsedBytes;     ///< Bytes handed out since the last reset or rewind
+   U64 mPeakBytes;     ///< Highest mUsedBytes seen at a rewind since the last reset
+   U64 mReservedBytes; ///< Bytes held in blocks
+   U64 mLastPeakBytes; ///< mUsedBytes at the last reset which followed a compile
+   U64 mLimit;         ///< 0 = unlimited
+   bool mLimitExceeded;
+   bool mLastLimitExceeded;
+
+   Block* newBlock(U32 minSize);
+   void freeBlocks(Block* from);
+   bool nextBlock(U32 size);
+
+public:
+   AstArena();
+   ~AstArena();
+
+   /// Returns nullptr if the limit would be exceeded.
+   inline void* alloc(U32 size)
+   {
+      size = (size + (Alignment-1)) & ~(Alignment-1);
+
+      if (mLimit != 0 && mUsedBytes + size > mLimit)
+      {
+         mLimitExceeded = true;
+         return nullptr;
+      }
+
+      if (mCurrent == nullptr || mCurrent->used + size > mCurrent->size)
+      {
+         if (!nextBlock(size))
+         {
+            return nullptr;
+         }
+      }
+
+      void* ptr = mCurrent->data() + mCurrent->used;
+      mCurrent->used += size;
+      mUsedBytes += size;
+      return ptr;
+   }
+
+   /// Releases all nodes, recording usage stats for the finished compile.
+   /// Excess blocks beyond RetainBytes are freed.
+   void reset();
+   /// Releases all nodes without ending the compile, i.e. once a top level
+   /// declaration has been compiled in streaming mode. Blocks are kept.
+   void rewind();
+   /// Frees all blocks.
+   void releaseMemory();
+
+   inline void setLimit(U64 limit) { mLimit = limit; }
+   inline U64 getLimit() const { return mLimit; }
+   inline U64 getUsedBytes() const { return mUsedBytes; }
+   inline U64 getReservedBytes() const { return mReservedBytes; }
+   inline U64 getLastPeakBytes() const { return mLastPeakBytes; }
+   inline bool wasLastLimitExceeded() const { return mLastLimitExceeded; }
+};
+
+}
@@ -809,12 +809,9 @@ TypeReq FloatUnaryExprNode::getPreferredType()
 U32 VarNode::compile(CodeStream &codeStream, U32 ip, TypeReq type)
 {
    // if this has an arrayIndex...
-   // OP_LOADIMMED_IDENT
-   // varName
-   // OP_ADVANCE_STR
    // evaluate arrayIndex TypeReqString
-   // OP_REWIND_STR
    // OP_SETCURVAR_ARRAY
+   // varName
    // OP_LOADVAR (type)
    
    // else
@@ -827,17 +824,14 @@ U32 VarNode::compile(CodeStream &codeStream, U32 ip, TypeReq type)
    
    codeStream.mResources->precompileIdent(varName);
 
-   codeStream.emit(arrayIndex ? OP_LOADIMMED_IDENT : OP_SETCURVAR);
-   codeStream.emitSTE(varName);
-   
    if(arrayIndex)
    {
-      codeStream.emit(OP_ADVANCE_STR);
       ip = arrayIndex->compile(codeStream, ip, TypeReqString);
-      codeStream.emit(OP_REWIND_STR);
-      codeStream.emit(OP_SETCURVAR_ARRAY);
    }
    
+   codeStream.emit(arrayIndex ? OP_SETCURVAR_ARRAY : OP_SETCURVAR);
+   codeStream.emitSTE(varName);
+   
    // Set type
    S32 typeID = varType ? codeStream.mResources->precompileType(varType) : -1;
    
@@ -973,14 +967,18 @@ TypeReq FloatNode::getPreferredType()
 
 U32 StrConstNode::compile(CodeStream &codeStream, U32 ip, TypeReq type)
 {
+   // NOTE: str lives until the compiler allocator is reset, so the table can reference
+   // it unless nodes are released per declaration.
+   const bool view = !codeStream.mResources->streamingCompile;
+   
    // Early out for documentation block.
    if( doc )
    {
-      index = codeStream.mResources->getCurrentStringTable()->add(str, true, tag);
+      index = codeStream.mResources->getCurrentStringTable()->addN(str, len, true, tag, view);
    }
    else if(type == TypeReqString || type == TypeReqTypedString)
    {
-      index = codeStream.mResources->getCurrentStringTable()->add(str, true, tag);
+      index = codeStream.mResources->getCurrentStringTable()->addN(str, len, true, tag, view);
    }
    else if (type != TypeReqNone)
    {
@@ -1070,8 +1068,101 @@ TypeReq ConstantNode::getPreferredType()
 
 //------------------------------------------------------------
 
+/// Returns true if evaluating expr cannot assign to a variable, so it may be
+/// evaluated after reading a variable it is appended to without changing the
+/// result. Calls are excluded since a callee (or eval) may assign to it.
+static bool isAssignFreeExpr(ExprNode* expr)
+{
+   if (expr == nullptr)
+      return true;
+
+   if (dynamic_cast<IntNode*>(expr) || dynamic_cast<FloatNode*>(expr) || dynamic_cast<ConstantNode*>(expr))
+      return true;
+   if (StrConstNode* strNode = dynamic_cast<StrConstNode*>(expr))
+      return !strNode->doc;
+   if (VarNode* varNode = dynamic_cast<VarNode*>(expr))
+      return isAssignFreeExpr(varNode->arrayIndex);
+   if (BinaryExprNode* binNode = dynamic_cast<BinaryExprNode*>(expr))
+      return isAssignFreeExpr(binNode->left) && isAssignFreeExpr(binNode->right);
+   if (IntUnaryExprNode* unaryNode = dynamic_cast<IntUnaryExprNode*>(expr))
+      return isAssignFreeExpr(unaryNode->expr);
+   if (FloatUnaryExprNode* unaryNode = dynamic_cast<FloatUnaryExprNode*>(expr))
+      return isAssignFreeExpr(unaryNode->expr);
+   if (ConditionalExprNode* condNode = dynamic_cast<ConditionalExprNode*>(expr))
+      return isAssignFreeExpr(condNode->testExpr) && isAssignFreeExpr(condNode->trueExpr) && isAssignFreeExpr(condNode->falseExpr);
+   if (SlotAccessNode* slotNode = dynamic_cast<SlotAccessNode*>(expr))
+      return isAssignFreeExpr(slotNode->objectExpr) && isAssignFreeExpr(slotNode->arrayExpr);
+
+   return false;
+}
+
+/// For %var = %var @ a @ b ..., returns the concatenation directly above the
+/// read of %var (i.e. %var @ a), otherwise nullptr.
+static StrcatExprNode* findSelfAppend(StringTableEntry varName, ExprNode* rhsExpr)
+{
+   StrcatExprNode* first = dynamic_cast<StrcatExprNode*>(rhsExpr);
+   if (first == nullptr)
+      return nullptr;
+
+   while (StrcatExprNode* next = dynamic_cast<StrcatExprNode*>(first->left))
+   {
+      if (!isAssignFreeExpr(first->right))
+         return nullptr;
+      first = next;
+   }
+
+   VarNode* varNode = dynamic_cast<VarNode*>(first->left);
+   if (varNode == nullptr || varNode->arrayIndex || varNode->varType ||
+       !isAssignFreeExpr(first->right))
+      return nullptr;
+
+   return (varNode->varName == varName || strcasecmp(varNode->varName, varName) == 0) ? first : nullptr;
+}
+
+/// Compiles node (a concatenation above first) without first's left hand side,
+/// leaving a @ b ... on the string stack.
+static U32 compileAppendedStrings(CodeStream &codeStream, U32 ip, StrcatExprNode* node, StrcatExprNode* first)
+{
+   if (node == first)
+      return first->right->compile(codeStream, ip, TypeReqString);
+
+   ip = compileAppendedStrings(codeStream, ip, static_cast<StrcatExprNode*>(node->left), first);
+   if(!node->appendChar)
+      codeStream.emit(OP_ADVANCE_STR);
+   else
+   {
+      codeStream.emit(OP_ADVANCE_STR_APPENDCHAR);
+      codeStream.emit(node->appendChar);
+   }
+   ip = node->right->compile(codeStream, ip, TypeReqString);
+   codeStream.emit(OP_REWIND_STR);
+   return codeStream.tell();
+}
+
 U32 AssignExprNode::compile(CodeStream &codeStream, U32 ip, TypeReq type)
 {
+   // %var = %var @ ...; as a statement appends in place rather than copying
+   // %var to the string stack and back, which is O(n^2) when building a
+   // string in a loop.
+   //
+   // eval appended strings
+   // OP_APPENDVAR_STR
+   // varName
+   // appendChar
+   if (type == TypeReqNone && !arrayIndex && varInfo->typeId == -1 &&
+       (assignTypeName == nullptr || assignTypeName[0] == '\0'))
+   {
+      if (StrcatExprNode* first = findSelfAppend(varName, rhsExpr))
+      {
+         codeStream.mResources->precompileIdent(varName);
+         ip = compileAppendedStrings(codeStream, ip, static_cast<StrcatExprNode*>(rhsExpr), first);
+         codeStream.emit(OP_APPENDVAR_STR);
+         codeStream.emitSTE(varName);
+         codeStream.emit(first->appendChar);
+         return codeStream.tell();
+      }
+   }
+   
    subType = rhsExpr->getPreferredType();
    
    //
@@ -1110,12 +1201,9 @@ U32 AssignExprNode::compile(CodeStream &codeStream, U32 ip, TypeReq type)
    // if it's an array expr, the formula is:
    // eval expr
    // (push and pop if it's TypeReqString) OP_ADVANCE_STR
-   // OP_LOADIMMED_IDENT
-   // varName
-   // OP_ADVANCE_STR
    // eval array
-   // OP_REWIND_STR
    // OP_SETCURVAR_ARRAY_CREATE
+   // varName
    // OP_TERMINATE_REWIND_STR
    // OP_SAVEVAR
    
@@ -1147,13 +1235,9 @@ U32 AssignExprNode::compile(CodeStream &codeStream, U32 ip, TypeReq type)
          codeStream.emit(OP_ADVANCE_STR);
       }
 
-      codeStream.emit(OP_LOADIMMED_IDENT);
-      codeStream.emitSTE(varName);
-      
-      codeStream.emit(OP_ADVANCE_STR);
       ip = arrayIndex->compile(codeStream, ip, TypeReqString);
-      codeStream.emit(OP_REWIND_STR);
       codeStream.emit(OP_SETCURVAR_ARRAY_CREATE);
+      codeStream.emitSTE(varName);
 
       if (usingStringStack)
       {
@@ -1296,12 +1380,9 @@ U32 AssignOpExprNode::compile(CodeStream &codeStream, U32 ip, TypeReq type)
    // eval expr as float or int
    // if there's an arrayIndex
    
-   // OP_LOADIMMED_IDENT
-   // varName
-   // OP_ADVANCE_STR
    // eval arrayIndex stringwise
-   // OP_REWIND_STR
    // OP_SETCURVAR_ARRAY_CREATE
+   // varName
    
    // else
    // OP_SETCURVAR_CREATE
@@ -1338,13 +1419,9 @@ U32 AssignOpExprNode::compile(CodeStream &codeStream, U32 ip, TypeReq type)
    }
    else
    {
-      codeStream.emit(OP_LOADIMMED_IDENT);
-      codeStream.emitSTE(varName);
-      
-      codeStream.emit(OP_ADVANCE_STR);
       ip = arrayIndex->compile(codeStream, ip, TypeReqString);
-      codeStream.emit(OP_REWIND_STR);
       codeStream.emit(OP_SETCURVAR_ARRAY_CREATE);
+      codeStream.emitSTE(varName);
    }
    
    // NOTE: no mechanism to set type here.
@@ -1566,7 +1643,7 @@ U32 SlotAccessNode::compile(CodeStream &codeStream, U32 ip, TypeReq type)
    
    codeStream.emit(OP_SETCURFIELD);
    
-   codeStream.emitSTE(slotName);
+   codeStream.emitFieldSTE(slotName);
 
    if(arrayExpr)
    {
@@ -1730,7 +1807,7 @@ U32 SlotAssignNode::compile(CodeStream &codeStream, U32 ip, TypeReq type)
    }
    
    codeStream.emit(OP_SETCURFIELD); // sets curField; curFieldArray = 0
-   codeStream.emitSTE(slotName);
+   codeStream.emitFieldSTE(slotName);
 
    if (arrayExpr)
    {
@@ -1881,7 +1958,7 @@ U32 SlotAssignOpNode::compile(CodeStream &codeStream, U32 ip, TypeReq type)
    ip = objectExpr->compile(codeStream, ip, TypeReqString);
    codeStream.emit(OP_SETCUROBJECT);
    codeStream.emit(OP_SETCURFIELD);
-   codeStream.emitSTE(slotName);
+   codeStream.emitFieldSTE(slotName);
    
    if(arrayExpr)
    {
@@ -1931,6 +2008,84 @@ TypeReq SlotAssignOpNode::getReturnLoadType()
 
 //------------------------------------------------------------
 
+static bool isConstantObjectSlot(SlotAssignNode* slot)
+{
+   if (slot->arrayExpr || slot->objectExpr || slot->varType)
+      return false;
+
+   ExprNode* rhs = slot->rhsExpr;
+   StrConstNode* strNode = dynamic_cast<StrConstNode*>(rhs);
+   if (strNode)
+      return !strNode->tag && !strNode->doc;
+
+   return dynamic_cast<IntNode*>(rhs) || dynamic_cast<FloatNode*>(rhs) || dynamic_cast<ConstantNode*>(rhs);
+}
+
+/// Emits OP_SET_OBJECT_FIELDS for slots which are all constant, in place of a
+/// SlotAssignNode per field. Values are stored the same way the equivalent
+/// OP_SAVEFIELD_* would receive them.
+static void compileConstantObjectSlots(CodeStream &codeStream, SlotAssignNode* slotDecls)
+{
+   U32 count = 0;
+   for(SlotAssignNode *slotWalk = slotDecls; slotWalk; slotWalk = (SlotAssignNode *) slotWalk->getNext())
+      count++;
+
+   codeStream.emit(OP_SET_OBJECT_FIELDS);
+   codeStream.emit(count);
+
+   for(SlotAssignNode *slotWalk = slotDecls; slotWalk; slotWalk = (SlotAssignNode *) slotWalk->getNext())
+   {
+      codeStream.mResources->precompileIdent(slotWalk->slotName);
+      codeStream.emitFieldSTE(slotWalk->slotName);
+
+      ExprNode* rhs = slotWalk->rhsExpr;
+      const bool asString = slotWalk->disableTypes;
+
+      if (StrConstNode* strNode = dynamic_cast<StrConstNode*>(rhs))
+      {
+         const bool view = !codeStream.mResources->streamingCompile;
+         codeStream.emit(OBJECT_FIELD_STR);
+         codeStream.emit(codeStream.mResources->getCurrentStringTable()->addN(strNode->str, strNode->len, true, false, view));
+         codeStream.emit(0);
+      }
+      else if (ConstantNode* constNode = dynamic_cast<ConstantNode*>(rhs))
+      {
+         codeStream.mResources->precompileIdent(constNode->value);
+         codeStream.emit(OBJECT_FIELD_IDENT);
+         codeStream.emitSTE(constNode->value);
+      }
+      else if (IntNode* intNode = dynamic_cast<IntNode*>(rhs))
+      {
+         if (asString)
+         {
+            codeStream.emit(OBJECT_FIELD_STR);
+            codeStream.emit(codeStream.mResources->getCurrentStringTable()->addIntString(intNode->value));
+         }
+         else
+         {
+            codeStream.emit(OBJECT_FIELD_UINT);
+            codeStream.emit(intNode->value);
+         }
+         codeStream.emit(0);
+      }
+      else
+      {
+         FloatNode* floatNode = static_cast<FloatNode*>(rhs);
+         if (asString)
+         {
+            codeStream.emit(OBJECT_FIELD_STR);
+            codeStream.emit(codeStream.mResources->getCurrentStringTable()->addFloatString(floatNode->value));
+         }
+         else
+         {
+            codeStream.emit(OBJECT_FIELD_FLT);
+            codeStream.emit(codeStream.mResources->getCurrentFloatTable()->add(floatNode->value));
+         }
+         codeStream.emit(0);
+      }
+   }
+}
+
 U32 ObjectDeclNode::compileSubObject(CodeStream &codeStream, U32 ip, bool root)
 {
    // goes
@@ -1948,6 +2103,10 @@ U32 ObjectDeclNode::compileSubObject(CodeStream &codeStream, U32 ip, bool root)
    // fail point 1
    
    // for each field, eval
+   //   OR if every field is constant:
+   // OP_SET_OBJECT_FIELDS 1
+   // count 1
+   // (fieldName, kind, value) ObjectFieldEntrySize * count
    // OP_ADD_OBJECT (to UINT[0]) 1
    // root? 1
    
@@ -1993,8 +2152,20 @@ U32 ObjectDeclNode::compileSubObject(CodeStream &codeStream, U32 ip, bool root)
    codeStream.emit(isSingleton);
    codeStream.emit(dbgLineNumber);
    const U32 failIp = codeStream.emit(0);
-   for(SlotAssignNode *slotWalk = slotDecls; slotWalk; slotWalk = (SlotAssignNode *) slotWalk->getNext())
-      ip = slotWalk->compile(codeStream, ip, TypeReqNone);
+
+   bool constantSlots = slotDecls != nullptr;
+   for(SlotAssignNode *slotWalk = slotDecls; slotWalk && constantSlots; slotWalk = (SlotAssignNode *) slotWalk->getNext())
+      constantSlots = isConstantObjectSlot(slotWalk);
+
+   if (constantSlots)
+   {
+      compileConstantObjectSlots(codeStream, slotDecls);
+   }
+   else
+   {
+      for(SlotAssignNode *slotWalk = slotDecls; slotWalk; slotWalk = (SlotAssignNode *) slotWalk->getNext())
+         ip = slotWalk->compile(codeStream, ip, TypeReqNone);
+   }
    codeStream.emit(OP_ADD_OBJECT);
    codeStream.emit(root);
    for(ObjectDeclNode *objectWalk = subObjects; objectWalk; objectWalk = (ObjectDeclNode *) objectWalk->getNext())
@@ -38,6 +38,7 @@
 #include "console/telnetDebugger.h"
 
 #include "core/stream.h"
+#include <algorithm>
 
 using namespace Compiler;
 
@@ -54,6 +55,11 @@ CodeBlock::CodeBlock(KorkApi::VmInternal* vm, bool _isExecBlock)
    globalFloats = nullptr;
    functionFloats = nullptr;
    lineBreakPairs = nullptr;
+   lineTable = nullptr;
+   lineTableSize = 0;
+   linePages = nullptr;
+   numLinePages = 0;
+   warnCounts = nullptr;
    breakList = nullptr;
    breakListSize = 0;
    
@@ -61,6 +67,9 @@ CodeBlock::CodeBlock(KorkApi::VmInternal* vm, bool _isExecBlock)
    identStringOffsets = nullptr;
    numFunctionCalls = 0;
    functionCalls = nullptr;
+   numFieldSites = 0;
+   fieldSites = nullptr;
+   ipHits = nullptr;
    numIdentStrings = 0;
    startTypeStrings = 0;
    numTypeStrings = 0;
@@ -69,6 +78,8 @@ CodeBlock::CodeBlock(KorkApi::VmInternal* vm, bool _isExecBlock)
    isExecBlock = _isExecBlock;
    inList = false;
    didFlushFunctions = false;
+   snapshotId = 0;
+   snapshotGen = 0;
    
    refCount = 0;
    code = nullptr;
@@ -99,8 +110,18 @@ CodeBlock::~CodeBlock()
    mVM->DeleteArray(code);
    mVM->DeleteArray(breakList);
    
+   if (lineTable)
+      mVM->DeleteArray(lineTable);
+   if (linePages)
+      mVM->DeleteArray(linePages);
+   if (warnCounts)
+      mVM->DeleteArray(warnCounts);
    if (functionCalls)
       mVM->DeleteArray(functionCalls);
+   if (fieldSites)
+      mVM->DeleteArray(fieldSites);
+   if (ipHits)
+      mVM->DeleteArray(ipHits);
    if (identStrings)
       mVM->DeleteArray(identStrings);
    if (identStringOffsets)
@@ -167,17 +188,6 @@ void CodeBlock::clearBreakpoint(U32 lineNumber)
    }
 }
 
-void CodeBlock::setAllBreaks()
-{
-   if(!lineBreakPairs)
-      return;
-   for(U32 i = 0; i < lineBreakPairCount; i++)
-   {
-      U32 *p = lineBreakPairs + i * 2;
-      code[p[1]] = OP_BREAK;
-   }
-}
-
 bool CodeBlock::setBreakpoint(U32 lineNumber)
 {
    if(!lineBreakPairs)
@@ -261,17 +271,216 @@ void CodeBlock::findBreakLine(U32 ip, U32 &line, U32 &instruction)
    line = p[found].instLine >> 8;
 }
 
+U32 CodeBlock::getLineStartingAt(U32 ip)
+{
+   LinePair *start = (LinePair *) lineBreakPairs;
+   LinePair *end = start + lineBreakPairCount;
+   LinePair *p = std::lower_bound(start, end, ip, [](const LinePair& pair, U32 value) {
+      return pair.ip < value;
+   });
+   return (p != end && p->ip == ip) ? p->instLine >> 8 : 0;
+}
+
+static inline U32 lineTableVarSize(U32 value)
+{
+   U32 size = 1;
+   while (value >= 0x80)
+   {
+      value >>= 7;
+      size++;
+   }
+   return size;
+}
+
+static inline U8* lineTableWriteVar(U8* ptr, U32 value)
+{
+   while (value >= 0x80)
+   {
+      *ptr++ = (U8)(value | 0x80);
+      value >>= 7;
+   }
+   *ptr++ = (U8)value;
+   return ptr;
+}
+
+static inline U32 lineTableReadVar(const U8*& ptr)
+{
+   U32 value = 0;
+   U32 shift = 0;
+   U8 b;
+   do
+   {
+      b = *ptr++;
+      value |= (U32)(b & 0x7F) << shift;
+      shift += 7;
+   } while (b & 0x80);
+   return value;
+}
+
+static inline U32 lineTableZigZag(S32 value)
+{
+   return ((U32)value << 1) ^ (U32)(value >> 31);
+}
+
+static inline S32 lineTableUnZigZag(U32 value)
+{
+   return (S32)(value >> 1) ^ -(S32)(value & 1);
+}
+
+/// Builds lineTable from lineBreakPairs (before calcBreakList packs the opcodes
+/// into them). Each pair is stored as a varint ip delta followed by a zigzag 
+/// varint line delta, with a page index so lookups only decode the pairs
+/// within one page.
+void CodeBlock::buildLineTable()
+{
+   if (lineTable)
+      mVM->DeleteArray(lineTable);
+   if (linePages)
+      mVM->DeleteArray(linePages);
+   lineTable = nullptr;
+   linePages = nullptr;
+   lineTableSize = 0;
+   numLinePages = 0;
+   
+   if (lineBreakPairCount == 0)
+      return;
+   
+   U32 size = 0;
+   U32 prevIp = 0;
+   U32 prevLine = 0;
+   for (U32 i = 0; i < lineBreakPairCount; i++)
+   {
+      const U32 line = lineBreakPairs[i * 2];
+      const U32 ip = lineBreakPairs[i * 2 + 1];
+      size += lineTableVarSize(ip - prevIp) + lineTableVarSize(lineTableZigZag((S32)(line - prevLine)));
+      prevIp = ip;
+      prevLine = line;
+   }
+   
+   lineTableSize = size;
+   lineTable = mVM->NewArray<U8>(size);
+   numLinePages = ((getMax(codeSize, prevIp + 1) - 1) >> LinePageShift) + 1;
+   linePages = mVM->NewArray<LineTablePage>(numLinePages);
+   
+   U8* ptr = lineTable;
+   U32 nextPage = 0;
+   prevIp = 0;
+   prevLine = 0;
+   for (U32 i = 0; i < lineBreakPairCount; i++)
+   {
+      const U32 line = lineBreakPairs[i * 2];
+      const U32 ip = lineBreakPairs[i * 2 + 1];
+      
+      // Pages starting in (prevIp, ip] resume decoding at this pair
+      for (; nextPage < numLinePages && (nextPage << LinePageShift) <= ip; nextPage++)
+      {
+         LineTablePage& page = linePages[nextPage];
+         page.pos = (U32)(ptr - lineTable);
+         page.index = i;
+         page.ip = prevIp;
+         page.line = prevLine;
+      }
+      
+      ptr = lineTableWriteVar(ptr, ip - prevIp);
+      ptr = lineTableWriteVar(ptr, lineTableZigZag((S32)(line - prevLine)));
+      prevIp = ip;
+      prevLine = line;
+   }
+   
+   // Pages after the last pair
+   for (; nextPage < numLinePages; nextPage++)
+   {
+      LineTablePage& page = linePages[nextPage];
+      page.pos = lineTableSize;
+      page.index = lineBreakPairCount;
+      page.ip = prevIp;
+      page.line = prevLine;
+   }
+}
+
+U32 CodeBlock::getLineForIp(U32 ip, U32* outIndex)
+{
+   // Unlike findBreakLine, instructions following the last pair belong to its line
+   if (lineTable == nullptr || ip < lineBreakPairs[1] || (ip >> LinePageShift) >= numLinePages)
+   {
+      return 0;
+   }
+   
+   const LineTablePage& page = linePages[ip >> LinePageShift];
+   const U8* ptr = lineTable + page.pos;
+   const U8* end = lineTable + lineTableSize;
+   U32 curIp = page.ip;
+   U32 curLine = page.line;
+   U32 index = page.index;
+   
+   while (ptr < end)
+   {
+      const U8* next = ptr;
+      const U32 nextIp = curIp + lineTableReadVar(next);
+      if (nextIp > ip)
+         break;
+      
+      curIp = nextIp;
+      curLine += lineTableUnZigZag(lineTableReadVar(next));
+      ptr = next;
+      index++;
+   }
+   
+   if (outIndex)
+      *outIndex = index - 1;
+   return curLine;
+}
+
+const char *CodeBlock::getFileLine(U32 ip, U32 &outLine)
+{
+   outLine = getLineForIp(ip);
+   return name ? name : "<input>";
+}
+
 const char *CodeBlock::getFileLine(U32 ip)
 {
    char* nameBuffer = mVM->mFileLineBuffer;
-   U32 line=0;
-   U32 inst=0;
-   findBreakLine(ip, line, inst);
+   U32 line = 0;
+   const char* file = getFileLine(ip, line);
    
-   snprintf(nameBuffer, KorkApi::VmInternal::FileLineBufferSize, "%s (%d)", name ? name : "<input>", line);
+   snprintf(nameBuffer, KorkApi::VmInternal::FileLineBufferSize, "%s (%d)", file, line);
    return nameBuffer;
 }
 
+bool CodeBlock::shouldWarn(U32 ip, const char *&outFile, U32 &outLine)
+{
+   if (!mVM->isLogEnabled())
+      return false;
+   
+   U32 index = 0;
+   outFile = name ? name : "<input>";
+   outLine = getLineForIp(ip, &index);
+   
+   const U32 limit = mVM->mConfig.warnRepeatLimit;
+   if (limit == U32_MAX || outLine == 0)
+      return true;
+   
+   if (warnCounts == nullptr)
+   {
+      warnCounts = mVM->NewArray<U32>(lineBreakPairCount);
+      memset(warnCounts, 0, sizeof(U32) * lineBreakPairCount);
+   }
+   
+   U32& count = warnCounts[index];
+   if (count < limit)
+   {
+      count++;
+      return true;
+   }
+   else if (count == limit)
+   {
+      count++;
+      mVM->printf(0, "%s (%u): Further warnings from this line will be suppressed.", outFile, outLine);
+   }
+   
+   return false;
+}
+
 void CodeBlock::removeFromCodeList()
 {
    if (!inList)
@@ -357,6 +566,8 @@ void CodeBlock::calcBreakList()
    if(seqCount)
       breakList[size++] = seqCount;
    
+   buildLineTable();
+   
    for(i = 0; i < lineBreakPairCount; i++)
    {
       U32 *p = lineBreakPairs + i * 2;
@@ -395,6 +606,24 @@ void CodeBlock::flushNSEntries()
    didFlushFunctions = true;
 }
 
+void CodeBlock::allocFieldSites()
+{
+   if (fieldSites)
+      mVM->DeleteArray(fieldSites);
+   
+   if (numFieldSites == 0)
+   {
+      numFieldSites = 1;
+   }
+   
+   fieldSites = mVM->NewArray<FieldSiteCache>(numFieldSites);
+   for (U32 i=0; i<numFieldSites; i++)
+   {
+      fieldSites[i].klass = nullptr;
+      fieldSites[i].fieldIndex = -1;
+   }
+}
+
 bool CodeBlock::read(StringTableEntry fileName, StringTableEntry inModPath, Stream &st, U32 readVersion)
 {
    if (readVersion == 0)
@@ -578,6 +807,14 @@ bool CodeBlock::read(StringTableEntry fileName, StringTableEntry inModPath, Stre
    functionCalls = mVM->NewArray<void*>(numFunctionCalls);
    memset(functionCalls, '\0', sizeof(void*) * numFunctionCalls);
    
+   // Older versions have no field site indices in the code
+   numFieldSites = 0;
+   if (readVersion > 78)
+   {
+      st.read(&numFieldSites);
+   }
+   allocFieldSites();
+   
    if(lineBreakPairCount)
       calcBreakList();
    
@@ -707,63 +944,127 @@ bool CodeBlock::write(Stream &st)
    st.write(numFunctionCalls);
    st.write(startTypeStrings);
    st.write(numTypeStrings);
+   st.write(numFieldSites);
    
    return true;
 }
 
-bool CodeBlock::compileToStream(Stream &st, StringTableEntry fileName, const char *inScript)
+// Parses the source of lex and compiles it into codeStream, setting outIp to the end
+// of the compiled code. String literals reference the lexer buffer, so lex must
+// outlive the string tables.
+//
+// If the lexer is streaming each top level declaration is compiled as soon as it is
+// parsed, after which its AST nodes and source text are released, so memory is bounded
+// by the largest declaration rather than the size of the script.
+static bool parseAndCompileSource(KorkApi::VmInternal* vm, SimpleLexer::Tokenizer<KorkApi::VMStringTable>& lex, CodeStream& codeStream, U32& outIp)
 {
-   mVM->mCompilerResources->syntaxError = false;
+   Compiler::Resources* res = vm->mCompilerResources;
+   SimpleParser::ASTGen<KorkApi::VMStringTable> astGen(&lex, res);
    
-   mVM->mCompilerResources->consoleAllocReset();
-   
-   mVM->mCompilerResources->STEtoCode = &Compiler::compileSTEtoCode;
-   
-   StmtNode* rootNode = nullptr;
+   // Need to do this here as ast node gen stores stuff in tables
+   res->resetTables();
+   outIp = 0;
    
-   SimpleLexer::Tokenizer<KorkApi::VMStringTable> lex(KorkApi::VMStringTable(mVM), inScript, fileName, mVM->mCompilerResources->allowStringInterpolation);
-   SimpleParser::ASTGen<KorkApi::VMStringTable> astGen(&lex, mVM->mCompilerResources);
+   if (!lex.isStreaming())
+   {
+      StmtNode* rootNode = nullptr;
+      
+      try
+      {
+         if (!astGen.processTokens())
+         {
+            vm->printf(0, "Invalid token (%s) at %i:%i", lex.toString(astGen.mErrorToken).c_str(), astGen.mErrorToken.pos.line, astGen.mErrorToken.pos.col);
+         }
+         else
+         {
+            rootNode = astGen.parseProgram();
+         }
+      }
+      catch (SimpleParser::TokenError& e)
+      {
+         vm->printf(0, "Error parsing (\"%s\"; token is %s) at %i:%i", e.what(), lex.toString(e.token()).c_str(), e.token().pos.line, e.token().pos.col);
+      }
+      
+      if (!rootNode)
+      {
+         return false;
+      }
+      
+      outIp = compileBlock(rootNode, codeStream, 0);
+      return true;
+   }
    
-   // Reset all our value tables...
-   mVM->mCompilerResources->resetTables();
+   bool compiledAny = false;
+   bool ok = true;
+   res->streamingCompile = true;
    
    try
    {
-      if (!astGen.processTokens())
-      {
-         mVM->printf(0, "Invalid token (%s) at %i:%i", lex.toString(astGen.mErrorToken).c_str(), astGen.mErrorToken.pos.line, astGen.mErrorToken.pos.col);
-      }
-      else
+      StmtNode* decl = nullptr;
+      
+      res->pushLocalVarContext();
+      while (astGen.parseNextDecl(decl))
       {
-         rootNode = astGen.parseProgram();
+         if (decl)
+         {
+            outIp = compileBlock(decl, codeStream, outIp);
+            compiledAny = true;
+         }
+         
+         res->astArena.rewind();
+         astGen.releaseConsumedTokens();
       }
+      res->popLocalVarContext();
    }
    catch (SimpleParser::TokenError& e)
    {
-      mVM->printf(0, "Error parsing (\"%s\"; token is %s) at %i:%i", e.what(), lex.toString(e.token()).c_str(), e.token().pos.line, e.token().pos.col);
+      vm->printf(0, "Error parsing (\"%s\"; token is %s) at %i:%i", e.what(), lex.toString(e.token()).c_str(), e.token().pos.line, e.token().pos.col);
+      ok = false;
    }
    
-   if(!rootNode)
+   res->streamingCompile = false;
+   return ok && compiledAny;
+}
+
+bool CodeBlock::compileToStream(Stream &st, StringTableEntry fileName, const char *inScript)
+{
+   return compileSourceToStream(st, fileName, inScript, nullptr, nullptr);
+}
+
+bool CodeBlock::compileToStream(Stream &st, StringTableEntry fileName, KorkApi::SourceReadFn readFn, void* readUserPtr)
+{
+   return compileSourceToStream(st, fileName, nullptr, readFn, readUserPtr);
+}
+
+bool CodeBlock::compileSourceToStream(Stream &st, StringTableEntry fileName, const char *inScript, KorkApi::SourceReadFn readFn, void* readUserPtr)
+{
+   mVM->mCompilerResources->syntaxError = false;
+   
+   mVM->mCompilerResources->consoleAllocReset();
+   
+   mVM->mCompilerResources->STEtoCode = &Compiler::compileSTEtoCode;
+   
+   SimpleLexer::Tokenizer<KorkApi::VMStringTable> lex(KorkApi::VMStringTable(mVM), inScript ? inScript : "", fileName, mVM->mCompilerResources->allowStringInterpolation);
+   if (readFn)
    {
-      mVM->mCompilerResources->consoleAllocReset();
-      return false;
+      lex.setStreamSource(readFn, readUserPtr);
    }
    
    CodeStream codeStream(mVM->mCompilerResources);
    codeStream.setFilename(fileName);
-   U32 lastIp;
-   if(rootNode)
-   {
-      lastIp = compileBlock(rootNode, codeStream, 0) + 1;
-   }
-   else
+   U32 lastIp = 0;
+   
+   if (!parseAndCompileSource(mVM, lex, codeStream, lastIp))
    {
-      codeSize = 1;
-      lastIp = 0;
+      mVM->mCompilerResources->consoleAllocReset();
+      return false;
    }
    
+   lastIp++;
+   
    codeStream.emit(OP_RETURN);
-   codeStream.emitCodeStream(&codeSize, &code, &lineBreakPairs, &numFunctionCalls, &functionCalls);
+   codeStream.emitCodeStream(&codeSize, &code, &lineBreakPairs, &numFunctionCalls, &functionCalls, &numFieldSites);
+   allocFieldSites();
    
    lineBreakPairCount = codeStream.getNumLineBreaks();
    
@@ -823,13 +1124,40 @@ bool CodeBlock::compileToStream(Stream &st, StringTableEntry fileName, const cha
    st.write(numFunctionCalls);
    st.write(startTypeStrings);
    st.write(numTypeStrings);
+   st.write(numFieldSites);
    
    mVM->mCompilerResources->consoleAllocReset();
    
    return true;
 }
 
- KorkApi::ConsoleValue CodeBlock::compileExec(StringTableEntry fileName, StringTableEntry inModPath, const char *inString, bool noCalls, bool isNativeFrame, int setFrame)
+KorkApi::ConsoleValue CodeBlock::compileExec(StringTableEntry fileName, StringTableEntry inModPath, const char *inString, bool noCalls, bool isNativeFrame, int setFrame)
+{
+   return compileSourceExec(fileName, inModPath, inString, nullptr, nullptr, noCalls, isNativeFrame, setFrame);
+}
+
+KorkApi::ConsoleValue CodeBlock::compileExec(StringTableEntry fileName, StringTableEntry inModPath, KorkApi::SourceReadFn readFn, void* readUserPtr, bool noCalls, bool isNativeFrame, int setFrame)
+{
+   return compileSourceExec(fileName, inModPath, nullptr, readFn, readUserPtr, noCalls, isNativeFrame, setFrame);
+}
+
+bool CodeBlock::compile(StringTableEntry fileName, StringTableEntry inModPath, const char *inString)
+{
+   return compileSource(fileName, inModPath, inString, nullptr, nullptr);
+}
+
+KorkApi::ConsoleValue CodeBlock::compileSourceExec(StringTableEntry fileName, StringTableEntry inModPath, const char *inString, KorkApi::SourceReadFn readFn, void* readUserPtr, bool noCalls, bool isNativeFrame, int setFrame)
+{
+   if (!compileSource(fileName, inModPath, inString, readFn, readUserPtr))
+   {
+      mVM->Delete(this);
+      return KorkApi::ConsoleValue();
+   }
+   
+   return exec(0, fileName, nullptr, 0, 0, noCalls, isNativeFrame, nullptr, setFrame);
+}
+
+bool CodeBlock::compileSource(StringTableEntry fileName, StringTableEntry inModPath, const char *inString, KorkApi::SourceReadFn readFn, void* readUserPtr)
 {
    mVM->mCompilerResources->STEtoCode = &Compiler::compileSTEtoCode;
    mVM->mCompilerResources->consoleAllocReset();
@@ -863,39 +1191,21 @@ bool CodeBlock::compileToStream(Stream &st, StringTableEntry fileName, const cha
       addToCodeList();
    }
    
-   StmtNode* rootNode = nullptr;
-   
-   SimpleLexer::Tokenizer<KorkApi::VMStringTable> lex(KorkApi::VMStringTable(mVM), inString, fileName ? fileName : "", mVM->mCompilerResources->allowStringInterpolation);
-   SimpleParser::ASTGen<KorkApi::VMStringTable> astGen(&lex, mVM->mCompilerResources);
-    
-    // Need to do this here as ast node gen stores stuff in tables
-    mVM->mCompilerResources->resetTables();
-   
-   try
+   SimpleLexer::Tokenizer<KorkApi::VMStringTable> lex(KorkApi::VMStringTable(mVM), inString ? inString : "", fileName ? fileName : "", mVM->mCompilerResources->allowStringInterpolation);
+   if (readFn)
    {
-      if (!astGen.processTokens())
-      {
-         mVM->printf(0, "Invalid token (%s) at %i:%i", lex.toString(astGen.mErrorToken).c_str(), astGen.mErrorToken.pos.line, astGen.mErrorToken.pos.col);
-      }
-      else
-      {
-         rootNode = astGen.parseProgram();
-      }
-   }
-   catch (SimpleParser::TokenError& e)
-   {
-      mVM->printf(0, "Error parsing (\"%s\"; token is %s) at %i:%i", e.what(), lex.toString(e.token()).c_str(), e.token().pos.line, e.token().pos.col);
-   }
-   
-   if(!rootNode)
-   {
-      mVM->Delete(this);
-      return KorkApi::ConsoleValue();
+      lex.setStreamSource(readFn, readUserPtr);
    }
    
    CodeStream codeStream(mVM->mCompilerResources);
    codeStream.setFilename(fileName);
-   U32 lastIp = compileBlock(rootNode, codeStream, 0);
+   U32 lastIp = 0;
+   
+   if (!parseAndCompileSource(mVM, lex, codeStream, lastIp))
+   {
+      mVM->mCompilerResources->consoleAllocReset();
+      return false;
+   }
    
    lineBreakPairCount = codeStream.getNumLineBreaks();
    
@@ -927,7 +1237,8 @@ bool CodeBlock::compileToStream(Stream &st, StringTableEntry fileName, const cha
    mainTable.build(&identStrings, &identStringOffsets, &numIdentStrings);
    
    codeStream.emit(OP_RETURN);
-   codeStream.emitCodeStream(&codeSize, &code, &lineBreakPairs, &numFunctionCalls, &functionCalls);
+   codeStream.emitCodeStream(&codeSize, &code, &lineBreakPairs, &numFunctionCalls, &functionCalls, &numFieldSites);
+   allocFieldSites();
    
    mVM->mCompilerResources->consoleAllocReset();
    
@@ -942,10 +1253,10 @@ bool CodeBlock::compileToStream(Stream &st, StringTableEntry fileName, const cha
    if (!linkTypes())
    {
       mVM->printf(0, "Invalid types in script");
-      return KorkApi::ConsoleValue();
+      return false;
    }
    
-   return exec(0, fileName, nullptr, 0, 0, noCalls, isNativeFrame, nullptr, setFrame);
+   return true;
 }
 
 //-------------------------------------------------------------------------
@@ -966,7 +1277,7 @@ void CodeBlock::decRefCount()
 
 //-------------------------------------------------------------------------
 
-void CodeBlock::dumpInstructions( U32 startIp, bool upToReturn, bool downcaseStrings, bool includeLines )
+void CodeBlock::dumpInstructions( U32 startIp, bool upToReturn, bool downcaseStrings, bool includeLines, bool includeHits )
 {
    U32 ip = startIp;
    U32 endFuncIp = 0;
@@ -989,6 +1300,8 @@ void CodeBlock::dumpInstructions( U32 startIp, bool upToReturn, bool downcaseStr
    };
 
    U32 lastLine = 0;
+   U64 lastHits = ~(U64)0;
+   includeHits = includeHits && ipHits != nullptr;
    
    while( ip < codeSize )
    {
@@ -1009,6 +1322,13 @@ void CodeBlock::dumpInstructions( U32 startIp, bool upToReturn, bool downcaseStr
             lastLine = breakLine;
          }
       }
+
+      // Counts only change where control flow does, so mark each change
+      if (includeHits && ipHits[ip] != lastHits)
+      {
+         lastHits = ipHits[ip];
+         mVM->printf(0, "# Hits %llu", (unsigned long long)lastHits);
+      }
       
       switch( code[ ip ++ ] )
       {
@@ -1082,6 +1402,36 @@ void CodeBlock::dumpInstructions( U32 startIp, bool upToReturn, bool downcaseStr
             mVM->printf(0, "%i: OP_FINISH_OBJECT", ip - 1 );
             break;
          }
+
+         case OP_SET_OBJECT_FIELDS:
+         {
+            U32 count = code[ip];
+            mVM->printf(0, "%i: OP_SET_OBJECT_FIELDS count=%i", ip - 1, count );
+
+            U32 entryIp = ip + 1;
+            for (U32 i=0; i<count; i++, entryIp += ObjectFieldEntrySize)
+            {
+               StringTableEntry field = codeToSte(nullptr, code, entryIp);
+               switch (code[entryIp+2])
+               {
+                  case OBJECT_FIELD_STR:
+                     mVM->printf(0, "   field=%s str=%s", field, (inFunction ? functionStrings : globalStrings) + code[entryIp+3] );
+                     break;
+                  case OBJECT_FIELD_IDENT:
+                     mVM->printf(0, "   field=%s ident=%s", field, codeToSte(nullptr, code, entryIp+3) );
+                     break;
+                  case OBJECT_FIELD_UINT:
+                     mVM->printf(0, "   field=%s uint=%u", field, code[entryIp+3] );
+                     break;
+                  default:
+                     mVM->printf(0, "   field=%s flt=%f", field, (inFunction ? functionFloats : globalFloats)[code[entryIp+3]] );
+                     break;
+               }
+            }
+
+            ip = entryIp;
+            break;
+         }
          
          case OP_JMPIFFNOT:
          {
@@ -1322,15 +1672,34 @@ void CodeBlock::dumpInstructions( U32 startIp, bool upToReturn, bool downcaseStr
             break;
          }
          
+         case OP_APPENDVAR_STR:
+         {
+            StringTableEntry var = codeToSte(nullptr, code, ip);
+            U32 ch = code[ip+2];
+            
+            if (ch)
+               mVM->printf(0, "%i: OP_APPENDVAR_STR var=%s char=%c", ip - 1, var, ch );
+            else
+               mVM->printf(0, "%i: OP_APPENDVAR_STR var=%s", ip - 1, var );
+            ip += 3;
+            break;
+         }
+         
          case OP_SETCURVAR_ARRAY:
          {
-            mVM->printf(0, "%i: OP_SETCURVAR_ARRAY", ip - 1 );
+            StringTableEntry var = codeToSte(nullptr, code, ip);
+            
+            mVM->printf(0, "%i: OP_SETCURVAR_ARRAY var=%s", ip - 1, var );
+            ip += 2;
             break;
          }
          
          case OP_SETCURVAR_ARRAY_CREATE:
          {
-            mVM->printf(0, "%i: OP_SETCURVAR_ARRAY_CREATE", ip - 1 );
+            StringTableEntry var = codeToSte(nullptr, code, ip);
+            
+            mVM->printf(0, "%i: OP_SETCURVAR_ARRAY_CREATE var=%s", ip - 1, var );
+            ip += 2;
             break;
          }
          
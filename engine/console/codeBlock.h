@@ -37,6 +37,7 @@ namespace KorkApi
 {
 class Vm;
 class VmInternal;
+struct ClassInfo;
 }
 
 class Stream;
@@ -44,8 +45,24 @@ class Namespace;
 class CodeStream;
 
 struct ConsoleFrame;
+struct CallStats;
 struct ExprEvalState;
 
+/// Static field resolved by an OP_SETCURFIELD site for the last class seen there
+struct FieldSiteCache
+{
+   KorkApi::ClassInfo* klass;
+   S32 fieldIndex; ///< -1 if the field is not a static field of klass
+};
+
+/// Line table decoder state at the start of a page of instructions (see CodeBlock::LinePageShift)
+struct LineTablePage
+{
+   U32 pos;   ///< Offset in lineTable of the first pair with ip >= the page start
+   U32 index; ///< Index of that pair
+   U32 ip;    ///< ip of the pair before it (0 if none)
+   U32 line;  ///< line of the pair before it (0 if none)
+};
 
 /// Core TorqueScript code management class.
 ///
@@ -58,6 +75,11 @@ private:
    
 public:
    
+   enum
+   {
+      LinePageShift = 6 ///< Instructions per line table page (as a power of 2)
+   };
+   
    CodeBlock(KorkApi::VmInternal* vm, bool isExecBlock);
    ~CodeBlock();
    
@@ -83,6 +105,11 @@ public:
    U32 refCount;
    U32 lineBreakPairCount;
    U32 *lineBreakPairs;
+   U8 *lineTable;          ///< Delta encoded copy of lineBreakPairs (see buildLineTable)
+   U32 lineTableSize;
+   LineTablePage *linePages;
+   U32 numLinePages;
+   U32 *warnCounts;        ///< Warnings logged per line break pair, allocated on first warning
    U32 breakListSize;
    U32 *breakList;
    CodeBlock *nextFile;
@@ -94,6 +121,11 @@ public:
    
    U32 numFunctionCalls;
    void** functionCalls;
+   
+   U32 numFieldSites;
+   FieldSiteCache* fieldSites;
+
+   U64* ipHits; ///< Executions per instruction ip (see OpcodeStats)
 
    U32 startTypeStrings;
    U32 numTypeStrings;
@@ -103,13 +135,18 @@ public:
    bool inList;
    bool didFlushFunctions;
    
+   // Fiber snapshot tracking (see ConsoleSerializer)
+   U32 snapshotId;
+   U32 snapshotGen;
+   
    void addToCodeList();
    void removeFromCodeList();
    void calcBreakList();
+   void buildLineTable();
    void clearAllBreaks();
-   void setAllBreaks();
    
-   void dumpInstructions( U32 startIp = 0, bool upToReturn = false, bool downcaseStrings = false, bool includeLines = false );
+   /// @param includeHits Annotates instructions with ipHits counts if present.
+   void dumpInstructions( U32 startIp = 0, bool upToReturn = false, bool downcaseStrings = false, bool includeLines = false, bool includeHits = false );
    
    /// Returns the first breakable line or 0 if none was found.
    /// @param lineNumber The one based line number.
@@ -123,14 +160,33 @@ public:
    bool setBreakpoint(U32 lineNumber);
    
    void findBreakLine(U32 ip, U32 &line, U32 &instruction);
+   /// Returns the line if ip is the first instruction of a breakable line, otherwise 0.
+   U32 getLineStartingAt(U32 ip);
+   /// Returns the line containing ip, or 0 if there is none. Only decodes pairs
+   /// within ip's page of the line table.
+   /// @param outIndex Set to the index of the line break pair, if ip has a line.
+   U32 getLineForIp(U32 ip, U32* outIndex = nullptr);
    void getFunctionArgs(char buffer[1024], U32 offset);
+   /// Returns the file name and sets outLine for ip without formatting anything.
+   const char *getFileLine(U32 ip, U32 &outLine);
    const char *getFileLine(U32 ip);
+   /// Counts a runtime warning logged for the line containing ip, filling in its
+   /// file and line. Returns false once the line has logged more than
+   /// Config::warnRepeatLimit warnings, or if nothing is consuming the log.
+   bool shouldWarn(U32 ip, const char *&outFile, U32 &outLine);
    const char *getFileLineInt(U32 ip);
    
    void* getNSEntry(U32 index);
    void setNSEntry(U32 index, void* entry);
    void flushNSEntries();
    
+   /// Returns the cache for a field site index (nullptr for 0 or out of range)
+   inline FieldSiteCache* getFieldSite(U32 index)
+   {
+      return (index != 0 && index < numFieldSites) ? &fieldSites[index] : nullptr;
+   }
+   void allocFieldSites();
+   
    bool read(StringTableEntry fileName, StringTableEntry modPath, Stream &st, U32 readVersion);
    bool linkTypes();
    StringTableEntry getTypeName(U32 typeID);
@@ -138,6 +194,9 @@ public:
    bool write(Stream &st);
    
    bool compileToStream(Stream& s, StringTableEntry fileName, const char *script);
+   /// Streaming variant; the source is read in chunks via readFn and each top
+   /// level declaration is compiled as soon as it has been parsed.
+   bool compileToStream(Stream& s, StringTableEntry fileName, KorkApi::SourceReadFn readFn, void* readUserPtr);
    
    void incRefCount();
    void decRefCount();
@@ -161,6 +220,27 @@ public:
                            const char *script,
                            bool noCalls, bool isNativeFrame=true, int setFrame = -1 );
    
+   /// Streaming variant of compileExec; see compileToStream.
+   KorkApi::ConsoleValue compileExec(StringTableEntry fileName, StringTableEntry inModPath,
+                                     KorkApi::SourceReadFn readFn, void* readUserPtr,
+                                     bool noCalls, bool isNativeFrame=true, int setFrame = -1);
+   
+   /// Compiles a block of script into this CodeBlock without executing it; the
+   /// code can then be run any number of times via exec(0, ...). Unlike
+   /// compileExec the CodeBlock is not deleted on failure.
+   ///
+   /// @return false if the script failed to compile.
+   bool compile(StringTableEntry fileName, StringTableEntry inModPath, const char *script);
+   
+protected:
+   bool compileSource(StringTableEntry fileName, StringTableEntry inModPath, const char* script, KorkApi::SourceReadFn readFn, void* readUserPtr);
+   bool compileSourceToStream(Stream& s, StringTableEntry fileName, const char* script, KorkApi::SourceReadFn readFn, void* readUserPtr);
+   KorkApi::ConsoleValue compileSourceExec(StringTableEntry fileName, StringTableEntry inModPath,
+                                           const char* script, KorkApi::SourceReadFn readFn, void* readUserPtr,
+                                           bool noCalls, bool isNativeFrame, int setFrame);
+   
+public:
+   
    ConsoleFrame& setupExecFrame(ExprEvalState& eval,
                                 U32*        code,
                                 U32             ip,
@@ -186,14 +266,15 @@ public:
    /// -1 a new frame is created. If the index is out of range the
    /// top stack frame is used.
    /// @param packageName The code package name or null.
+   /// @param callStats Stats of the function being called, timed if call stats are enabled.
     KorkApi::ConsoleValue exec(U32 offset, const char *fnName, Namespace *ns, U32 argc,
                     KorkApi::ConsoleValue *argv, bool noCalls, bool isNativeFrame, StringTableEntry packageName,
-                    S32 setFrame = -1, bool startSuspended=false);
+                    S32 setFrame = -1, bool startSuspended=false, CallStats* callStats=nullptr);
    
    /// Variant of exec which JUST sets up the frame (for script->script calls)
    ConsoleFrame* beginExec(ExprEvalState& state, U32 offset, const char *fnName, Namespace *ns, U32 argc,
                    KorkApi::ConsoleValue *argv, bool noCalls, bool isNativeFrame, StringTableEntry packageName,
-                   S32 setFrame = -1);
+                   S32 setFrame = -1, CallStats* callStats=nullptr);
 };
 
 #endif
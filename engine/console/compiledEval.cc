@@ -35,6 +35,7 @@
 #include "console/consoleNamespace.h"
 
 #include "core/findMatch.h"
+#include "core/memStream.h"
 #include "console/consoleInternal.h"
 #include "console/consoleNamespace.h"
 #include "console/compiler.h"
@@ -42,12 +43,61 @@
 #include "console/stringStack.h"
 
 #include "console/telnetDebugger.h"
+#include "console/scriptProfiler.h"
+#include "console/opcodeStats.h"
+#include <chrono>
 
 
 #include "console/ast.h"
 
 using namespace Compiler;
 
+// Direct access to fields with KorkApi::NumericStorage (see VmInternal::getNumericFieldPtr)
+
+static inline F64 loadNumericField(const void* ptr, U8 storage)
+{
+   switch (storage)
+   {
+      case KorkApi::NumericStorageS32: return *(const S32*)ptr;
+      case KorkApi::NumericStorageU32: return *(const U32*)ptr;
+      case KorkApi::NumericStorageF32: return *(const F32*)ptr;
+      default:                         return *(const F64*)ptr;
+   }
+}
+
+static inline S64 loadNumericFieldInt(const void* ptr, U8 storage)
+{
+   switch (storage)
+   {
+      case KorkApi::NumericStorageS32: return *(const S32*)ptr;
+      case KorkApi::NumericStorageU32: return *(const U32*)ptr;
+      case KorkApi::NumericStorageF32: return (S64)*(const F32*)ptr;
+      default:                         return (S64)*(const F64*)ptr;
+   }
+}
+
+static inline void storeNumericField(void* ptr, U8 storage, F64 value)
+{
+   switch (storage)
+   {
+      case KorkApi::NumericStorageS32: *(S32*)ptr = (S32)(S64)value; break;
+      case KorkApi::NumericStorageU32: *(U32*)ptr = (U32)(S64)value; break;
+      case KorkApi::NumericStorageF32: *(F32*)ptr = (F32)value; break;
+      default:                         *(F64*)ptr = value; break;
+   }
+}
+
+static inline void storeNumericFieldInt(void* ptr, U8 storage, U32 value)
+{
+   switch (storage)
+   {
+      case KorkApi::NumericStorageS32: *(S32*)ptr = (S32)value; break;
+      case KorkApi::NumericStorageU32: *(U32*)ptr = value; break;
+      case KorkApi::NumericStorageF32: *(F32*)ptr = (F32)value; break;
+      default:                         *(F64*)ptr = (F64)value; break;
+   }
+}
+
 struct LocalRefTrack
 {
    KorkApi::VmInternal* vm;
@@ -188,6 +238,7 @@ struct ConsoleFrame
    LocalRefTrack curIterObject; // current object for _ITER
    StringTableEntry prevField;
    StringTableEntry curField;
+   FieldSiteCache* curFieldSite; // site which set curField (if any)
 
    // Buffers (640 bytes)
    char curFieldArray[FieldArraySize];
@@ -229,6 +280,7 @@ public:
       , curIterObject(vm)
       , prevField(nullptr)
       , curField(nullptr)
+      , curFieldSite(nullptr)
       , curFNDocBlock(nullptr)
       , curNSDocBlock(nullptr)
       , callArgc(0)
@@ -246,6 +298,9 @@ public:
    inline void copyFrom(ConsoleFrame* other, bool includeScope);
    inline void setCurVarName(StringTableEntry name);
    inline void setCurVarNameCreate(StringTableEntry name);
+   inline void setCurVarArray(StringTableEntry name, const char* key);
+   inline void setCurVarArrayCreate(StringTableEntry name, const char* key);
+   inline S32 getCurFieldIndex();
 
    inline S32 getIntVariable();
    inline F64 getFloatVariable();
@@ -254,7 +309,8 @@ public:
    inline KorkApi::ConsoleValue getConsoleVariable();
    inline void setUnsignedVariable(U32 val);
    inline void setNumberVariable(F64 val);
-   inline void setStringVariable(const char *val);
+   inline void setStringVariable(const char *val, U32 len);
+   inline void appendStringVariable(const char *val, U32 len, char appendChar);
    inline void setConsoleValue(KorkApi::ConsoleValue value);
    inline void setConsoleValues(U32 argc, KorkApi::ConsoleValue* values);
    inline void setCopyVariable();
@@ -302,6 +358,29 @@ inline void ConsoleFrame::copyFrom(ConsoleFrame* other, bool includeScope)
    }
 }
 
+inline S32 ConsoleFrame::getCurFieldIndex()
+{
+   KorkApi::VMObject* obj = curObject;
+   if (obj == nullptr)
+   {
+      return -1;
+   }
+   
+   if (curFieldSite == nullptr)
+   {
+      return evalState->vmInternal->findClassField(obj->klass, curField);
+   }
+   
+   // Sites always refer to the same field name, so only the class can vary
+   if (curFieldSite->klass != obj->klass)
+   {
+      curFieldSite->klass = obj->klass;
+      curFieldSite->fieldIndex = evalState->vmInternal->findClassField(obj->klass, curField);
+   }
+   
+   return curFieldSite->fieldIndex;
+}
+
 inline void ConsoleFrame::setCurVarName(StringTableEntry name)
 {
    if(name[0] == '$')
@@ -334,6 +413,38 @@ inline void ConsoleFrame::setCurVarNameCreate(StringTableEntry name)
    }
 }
 
+inline void ConsoleFrame::setCurVarArray(StringTableEntry name, const char* key)
+{
+   if(name[0] == '$')
+   {
+      currentVar.var = evalState->vmInternal->mGlobalVars.lookupArray(name, key);
+      currentVar.dictionary = &evalState->vmInternal->mGlobalVars;
+   }
+   else
+   {
+      currentVar.var = dictionary.lookupArray(name, key);
+      currentVar.dictionary = &dictionary;
+   }
+   if(!currentVar.var && evalState->vmInternal->mConfig.warnUndefinedScriptVariables)
+   {
+      evalState->vmInternal->printf(1, "Variable referenced before assignment: %s%s", name, key);
+   }
+}
+
+inline void ConsoleFrame::setCurVarArrayCreate(StringTableEntry name, const char* key)
+{
+   if(name[0] == '$')
+   {
+      currentVar.var = evalState->vmInternal->mGlobalVars.addArray(name, key);
+      currentVar.dictionary = &evalState->vmInternal->mGlobalVars;
+   }
+   else
+   {
+      currentVar.var = dictionary.addArray(name, key);
+      currentVar.dictionary = &dictionary;
+   }
+}
+
 //------------------------------------------------------------
 
 inline S32 ConsoleFrame::getIntVariable()
@@ -371,10 +482,16 @@ inline void ConsoleFrame::setNumberVariable(F64 val)
    currentVar.dictionary->setEntryNumberValue(currentVar.var, val);
 }
 
-inline void ConsoleFrame::setStringVariable(const char *val)
+inline void ConsoleFrame::setStringVariable(const char *val, U32 len)
+{
+   AssertFatal(currentVar.var != nullptr, "Invalid evaluator state - trying to set null variable!");
+   currentVar.dictionary->setEntryStringValue(currentVar.var, val, len);
+}
+
+inline void ConsoleFrame::appendStringVariable(const char *val, U32 len, char appendChar)
 {
    AssertFatal(currentVar.var != nullptr, "Invalid evaluator state - trying to set null variable!");
-   currentVar.dictionary->setEntryStringValue(currentVar.var, val);
+   currentVar.dictionary->appendEntryString(currentVar.var, val, len, appendChar);
 }
 
 inline void ConsoleFrame::setConsoleValue(KorkApi::ConsoleValue value)
@@ -402,7 +519,7 @@ inline void ConsoleFrame::setCopyVariable()
             currentVar.dictionary->setEntryNumberValue(currentVar.var, copyVar.dictionary->getEntryNumberValue(copyVar.var));
          break;
          default:
-            currentVar.dictionary->setEntryStringValue(currentVar.var, copyVar.dictionary->getEntryStringValue(copyVar.var));
+            currentVar.dictionary->setEntryStringValue(currentVar.var, copyVar.dictionary->getEntryStringValue(copyVar.var), copyVar.var->mConsoleValue.len);
          break;
       }
    }
@@ -595,7 +712,7 @@ ConsoleFrame& CodeBlock::setupExecFrame(
    return *newFrame;
 }
 
-KorkApi::ConsoleValue CodeBlock::exec(U32 ip, const char *functionName, Namespace *thisNamespace, U32 argc,  KorkApi::ConsoleValue* argv, bool noCalls, bool isNativeFrame, StringTableEntry packageName, S32 setFrame, bool startSuspended)
+KorkApi::ConsoleValue CodeBlock::exec(U32 ip, const char *functionName, Namespace *thisNamespace, U32 argc,  KorkApi::ConsoleValue* argv, bool noCalls, bool isNativeFrame, StringTableEntry packageName, S32 setFrame, bool startSuspended, CallStats* callStats)
 {
    ExprEvalState& evalState = *mVM->mCurrentFiberState;
    evalState.mSTR.clearFunctionOffset();
@@ -616,7 +733,8 @@ KorkApi::ConsoleValue CodeBlock::exec(U32 ip, const char *functionName, Namespac
                                         noCalls,
                                         isNativeFrame,
                                         packageName,
-                                        setFrame);
+                                        setFrame,
+                                        callStats);
    
    evalState.mSTR.setStringValue(""); // this should be cleared before exec (otherwise ops can get garbage values)
    
@@ -630,12 +748,13 @@ KorkApi::ConsoleValue CodeBlock::exec(U32 ip, const char *functionName, Namespac
    if (frame)
    {
       evalState.mState = KorkApi::FiberRunResult::SUSPENDED;
+      evalState.pauseCallTimers();
    }
    
    return KorkApi::ConsoleValue();
 }
 
-ConsoleFrame* CodeBlock::beginExec(ExprEvalState& evalState, U32 ip, const char *functionName, Namespace *thisNamespace, U32 argc,  KorkApi::ConsoleValue* argv, bool noCalls,  bool isNativeFrame, StringTableEntry packageName, S32 setFrame)
+ConsoleFrame* CodeBlock::beginExec(ExprEvalState& evalState, U32 ip, const char *functionName, Namespace *thisNamespace, U32 argc,  KorkApi::ConsoleValue* argv, bool noCalls,  bool isNativeFrame, StringTableEntry packageName, S32 setFrame, CallStats* callStats)
 {
    evalState.mSTR.clearFunctionOffset();
    evalState.mState = KorkApi::FiberRunResult::RUNNING;
@@ -654,12 +773,14 @@ ConsoleFrame* CodeBlock::beginExec(ExprEvalState& evalState, U32 ip, const char
    frame.stackStart = evalState.mSTR.mStartStackSize;
    frame.noCalls = noCalls;
    
+   if (callStats && mVM->mCallStatsEnabled)
+   {
+      evalState.beginCallTimer(callStats, (S32)evalState.vmFrames.size()-1);
+   }
+   
    // TODO: this needs to push frame info too
    // Grab the state of the telenet debugger here once
    // so that the push and pop frames are always balanced.
-   const bool telDebuggerOn = mVM->mTelDebugger && mVM->mTelDebugger->isConnected();
-   if ( telDebuggerOn && !frame.isReference )
-      mVM->mTelDebugger->pushStackFrame();
    
    // NOTE: should be handled in pushFrame
    //incRefCount();
@@ -720,6 +841,9 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
    U32 callArgc = 0;
    KorkApi::ConsoleValue* callArgv = nullptr;
    const char**           callArgvS = nullptr;
+   // Location of a runtime warning (see CodeBlock::shouldWarn)
+   const char* warnFile = nullptr;
+   U32 warnLine = 0;
    
    AssertFatal(!vmFrames.empty(), "no frames");
    
@@ -751,9 +875,10 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
          frame.pushStringStackCount--;
       }
       
-      if ((frame.lastCallType == Namespace::Entry::VoidCallbackType) && (code[ip] != OP_STR_TO_NONE))
+      if ((frame.lastCallType == Namespace::Entry::VoidCallbackType) && (code[ip] != OP_STR_TO_NONE) &&
+          frame.codeBlock->shouldWarn(ip-4, warnFile, warnLine))
       {
-         vmInternal->printf(0, "%s: Call to %s in %s uses result of void function call.", frame.codeBlock->getFileLine(ip-4), tmpFnName, frame.scopeName);
+         vmInternal->printf(0, "%s (%u): Call to %s in %s uses result of void function call.", warnFile, warnLine, tmpFnName, frame.scopeName);
       }
       
       if(code[ip] == OP_STR_TO_UINT)
@@ -790,7 +915,31 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
       printf("LINE %s\n", frame.codeBlock->getFileLine(ip));
 #endif
       
-      const U32 instruction = code[ip++];
+      if (vmInternal->mProfiler && vmInternal->mProfiler->tick())
+      {
+         vmInternal->mProfiler->sample(this, ip);
+      }
+
+#ifdef KS_OPCODE_STATS
+      if (vmInternal->mOpcodeStats && vmInternal->mOpcodeStats->isEnabled())
+      {
+         vmInternal->mOpcodeStats->record(frame.codeBlock, ip, code[ip]);
+      }
+#endif
+      
+      // Debugger stepping; explicit breakpoints are handled by OP_BREAK
+      if (evalState.mStepBreakDepth != 0 && evalState.vmFrames.size() <= evalState.mStepBreakDepth && code[ip] != OP_BREAK)
+      {
+         U32 stepLine = frame.codeBlock->getLineStartingAt(ip);
+         if (stepLine != 0 && vmInternal->mTelDebugger)
+         {
+            evalState.vmFrames.back()->codeBlock = frame.codeBlock;
+            evalState.vmFrames.back()->ip = ip;
+            vmInternal->mTelDebugger->executionStopped(frame.codeBlock, stepLine);
+         }
+      }
+      
+      U32 instruction = code[ip++];
       
    breakContinue:
       switch(instruction)
@@ -958,7 +1107,8 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
                // Deal with failure!
                if(!object)
                {
-                  vmInternal->printf(0, "%s: Unable to instantiate non-conobject class %s.", frame.codeBlock->getFileLine(ip-1), callArgvS[1]);
+                  if (frame.codeBlock->shouldWarn(ip-1, warnFile, warnLine))
+                     vmInternal->printf(0, "%s (%u): Unable to instantiate non-conobject class %s.", warnFile, warnLine, callArgvS[1]);
                   ip = frame.failJump;
                   break;
                }
@@ -969,7 +1119,8 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
                // Deal with the case of a non-SimObject.
                if(!frame.currentNewObject.isValid())
                {
-                  vmInternal->printf(0, "%s: Unable to instantiate non-SimObject class %s.", frame.codeBlock->getFileLine(ip-1), callArgvS[1]);
+                  if (frame.codeBlock->shouldWarn(ip-1, warnFile, warnLine))
+                     vmInternal->printf(0, "%s (%u): Unable to instantiate non-SimObject class %s.", warnFile, warnLine, callArgvS[1]);
                   delete object;
                   ip = frame.failJump;
                   break;
@@ -985,9 +1136,9 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
                      
                      vmInternal->assignFieldsFromTo(parent, frame.currentNewObject);
                   }
-                  else
+                  else if (frame.codeBlock->shouldWarn(ip-1, warnFile, warnLine))
                   {
-                     vmInternal->printf(0, "%s: Unable to find parent object %s for %s.", frame.codeBlock->getFileLine(ip-1), tmpVar, callArgvS[1]);
+                     vmInternal->printf(0, "%s (%u): Unable to find parent object %s for %s.", warnFile, warnLine, tmpVar, callArgvS[1]);
                   }
                }
 
@@ -1024,9 +1175,12 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
             if(!frame.currentNewObject->klass->iCreate.AddObjectFn(vmPublic, frame.currentNewObject, placeAtRoot, groupAddId))
             {
                // This error is usually caused by failing to call Parent::initPersistFields in the class' initPersistFields().
-               vmInternal->printf(0, "%s: Register object failed for object %s of class %s.", frame.codeBlock->getFileLine(ip-2),
-                                  frame.currentNewObject->klass->iCreate.GetNameFn(frame.currentNewObject),
-                                  frame.currentNewObject->klass->name);
+               if (frame.codeBlock->shouldWarn(ip-2, warnFile, warnLine))
+               {
+                  vmInternal->printf(0, "%s (%u): Register object failed for object %s of class %s.", warnFile, warnLine,
+                                     frame.currentNewObject->klass->iCreate.GetNameFn(frame.currentNewObject),
+                                     frame.currentNewObject->klass->name);
+               }
 
                // NOTE: AddObject may have "unregistered" the object, but since we refcount our objects this is still safe.
                frame.currentNewObject->klass->iCreate.DestroyClassFn(frame.currentNewObject->klass->userPtr, vmPublic, frame.currentNewObject->userPtr);
@@ -1061,6 +1215,86 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
             evalState.clearCreatedObject(frame._OBJ, frame.currentNewObject, &frame.failJump);
             break;
          }
+
+         case OP_SET_OBJECT_FIELDS:
+         {
+            // count, then count entries of (field STE + site, kind, value)
+            const U32 count = code[ip];
+            U32 entryIp = ip + 1;
+            ip = entryIp + (count * Compiler::ObjectFieldEntrySize);
+
+            frame.curObject = frame.currentNewObject;
+            if (!frame.curObject)
+            {
+               break;
+            }
+
+            KorkApi::VMObject* obj = frame.curObject;
+            const U32 BatchSize = 32;
+            StringTableEntry names[BatchSize];
+            KorkApi::ConsoleValue values[BatchSize];
+
+            for (U32 batchStart = 0; batchStart < count; batchStart += BatchSize)
+            {
+               const U32 batchCount = getMin(count - batchStart, BatchSize);
+               const U32 batchIp = entryIp;
+
+               for (U32 i=0; i<batchCount; i++, entryIp += Compiler::ObjectFieldEntrySize)
+               {
+                  names[i] = Compiler::CodeToSTE(nullptr, identStrings, code, entryIp);
+                  switch (code[entryIp+2])
+                  {
+                     case Compiler::OBJECT_FIELD_STR:
+                        values[i] = KorkApi::ConsoleValue::makeString(frame.curStringTable + code[entryIp+3]);
+                        break;
+                     case Compiler::OBJECT_FIELD_IDENT:
+                        values[i] = KorkApi::ConsoleValue::makeString(Compiler::CodeToSTE(nullptr, identStrings, code, entryIp+3));
+                        break;
+                     case Compiler::OBJECT_FIELD_UINT:
+                        values[i] = KorkApi::ConsoleValue::makeUnsigned(code[entryIp+3]);
+                        break;
+                     default:
+                        values[i] = KorkApi::ConsoleValue::makeNumber(frame.curFloatTable[code[entryIp+3]]);
+                        break;
+                  }
+               }
+
+               if (obj->klass->iCreate.SetFieldsFn &&
+                   obj->klass->iCreate.SetFieldsFn(vmPublic, obj, batchCount, names, values))
+               {
+                  continue;
+               }
+
+               // Same as OP_SETCURFIELD followed by the matching OP_SAVEFIELD_*
+               U32 fieldIp = batchIp;
+               for (U32 i=0; i<batchCount; i++, fieldIp += Compiler::ObjectFieldEntrySize)
+               {
+                  frame.curField = names[i];
+                  frame.curFieldSite = frame.codeBlock->getFieldSite(code[fieldIp+1]);
+                  frame.curFieldArray[0] = 0;
+
+                  S32 fieldIndex = frame.getCurFieldIndex();
+                  const U16 typeId = values[i].typeId;
+
+                  if (typeId != KorkApi::ConsoleValue::TypeInternalString)
+                  {
+                     U8 storage = 0;
+                     void* fieldPtr = vmInternal->getNumericFieldPtr(obj, fieldIndex, frame.curFieldArray, true, storage);
+                     if (fieldPtr)
+                     {
+                        if (typeId == KorkApi::ConsoleValue::TypeInternalUnsigned)
+                           storeNumericFieldInt(fieldPtr, storage, (U32)values[i].getInt());
+                        else
+                           storeNumericField(fieldPtr, storage, values[i].getFloat());
+                        continue;
+                     }
+                  }
+
+                  vmInternal->setObjectFieldTupleByIndex(obj, fieldIndex, frame.curField, KorkApi::ConsoleValue::makeString(frame.curFieldArray), 1, &values[i]);
+               }
+            }
+            break;
+         }
             
          case OP_JMPIFFNOT:
             if(evalState.floatStack[frame._FLT--])
@@ -1315,28 +1549,32 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
             break;
             
          case OP_SETCURVAR_ARRAY:
-            tmpVar = vmInternal->internString(evalState.mSTR.getStringValue(), false);
+            // Index is on the string stack
+            tmpVar = Compiler::CodeToSTE(nullptr, identStrings, code, ip);
+            ip += 2;
             
             // See OP_SETCURVAR
             frame.prevField = nullptr;
             frame.prevObject = nullptr;
             frame.curObject = nullptr;
             
-            frame.setCurVarName(tmpVar);
+            frame.setCurVarArray(tmpVar, evalState.mSTR.getStringValue());
             
             // See OP_SETCURVAR for why we do this.
             frame.nsDocBlockClassLocation = 0;
             break;
             
          case OP_SETCURVAR_ARRAY_CREATE:
-            tmpVar = vmInternal->internString(evalState.mSTR.getStringValue(), false);
+            // Index is on the string stack
+            tmpVar = Compiler::CodeToSTE(nullptr, identStrings, code, ip);
+            ip += 2;
             
             // See OP_SETCURVAR
             frame.prevField = nullptr;
             frame.prevObject = nullptr;
             frame.curObject = nullptr;
             
-            frame.setCurVarNameCreate(tmpVar);
+            frame.setCurVarArrayCreate(tmpVar, evalState.mSTR.getStringValue());
             
             // See OP_SETCURVAR for why we do this.
             frame.nsDocBlockClassLocation = 0;
@@ -1354,7 +1592,10 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
             
          case OP_LOADVAR_STR:
             tmpVal = frame.getConsoleVariable();
-            evalState.mSTR.setStringValue(vmInternal->valueAsString(tmpVal));
+            if (tmpVal.hasLen())
+               evalState.mSTR.setStringValueLen((const char*)tmpVal.evaluatePtr(vmInternal->mAllocBase), tmpVal.len);
+            else
+               evalState.mSTR.setStringValue(vmInternal->valueAsString(tmpVal));
             break;
             
          case OP_LOADVAR_VAR:
@@ -1371,7 +1612,7 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
             break;
             
          case OP_SAVEVAR_STR:
-            frame.setStringVariable(evalState.mSTR.getStringValue());
+            frame.setStringVariable(evalState.mSTR.getStringValue(), evalState.mSTR.getStringValueLen());
             break;
             
          case OP_SAVEVAR_VAR:
@@ -1379,6 +1620,27 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
             frame.setCopyVariable();
             break;
             
+         case OP_APPENDVAR_STR:
+         {
+            tmpVar = Compiler::CodeToSTE(nullptr, identStrings, code, ip);
+            const char appendChar = (char)code[ip+2];
+            ip += 3;
+            
+            // See OP_SETCURVAR
+            frame.prevField = nullptr;
+            frame.prevObject = nullptr;
+            frame.curObject = nullptr;
+            frame.nsDocBlockClassLocation = 0;
+            
+            // Lookup first so undefined variables warn as they would when read
+            frame.setCurVarName(tmpVar);
+            if (!frame.currentVar.var)
+               frame.setCurVarNameCreate(tmpVar);
+            
+            frame.appendStringVariable(evalState.mSTR.getStringValue(), evalState.mSTR.getStringValueLen(), appendChar);
+            break;
+         }
+            
          case OP_SETCUROBJECT:
             // Save the previous object for parsing vector fields.
             frame.prevObject = frame.curObject;
@@ -1431,6 +1693,7 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
             frame.prevField = frame.curField;
             strcpy( frame.prevFieldArray, frame.curFieldArray );
             frame.curField = Compiler::CodeToSTE(nullptr, identStrings, code, ip);
+            frame.curFieldSite = frame.codeBlock->getFieldSite(code[ip+1]);
             frame.curFieldArray[0] = 0;
             ip += 2;
             break;
@@ -1455,8 +1718,18 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
          case OP_LOADFIELD_UINT:
             if (frame.curObject)
             {
-               KorkApi::ConsoleValue retValue = vmInternal->getObjectField(frame.curObject, frame.curField, KorkApi::ConsoleValue::makeString(frame.curFieldArray), KorkApi::ConsoleValue::TypeInternalUnsigned, KorkApi::ConsoleValue::ZoneExternal);
-               evalState.intStack[frame._UINT+1] = vmInternal->valueAsInt(retValue);
+               S32 fieldIndex = frame.getCurFieldIndex();
+               U8 storage = 0;
+               void* fieldPtr = vmInternal->getNumericFieldPtr(frame.curObject, fieldIndex, frame.curFieldArray, false, storage);
+               if (fieldPtr)
+               {
+                  evalState.intStack[frame._UINT+1] = loadNumericFieldInt(fieldPtr, storage);
+               }
+               else
+               {
+                  KorkApi::ConsoleValue retValue = vmInternal->getObjectFieldByIndex(frame.curObject, fieldIndex, frame.curField, KorkApi::ConsoleValue::makeString(frame.curFieldArray), KorkApi::ConsoleValue::TypeInternalUnsigned, KorkApi::ConsoleValue::ZoneExternal);
+                  evalState.intStack[frame._UINT+1] = vmInternal->valueAsInt(retValue);
+               }
             }
             else
             {
@@ -1472,8 +1745,18 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
          case OP_LOADFIELD_FLT:
             if (frame.curObject)
             {
-               KorkApi::ConsoleValue retValue =  vmInternal->getObjectField(frame.curObject, frame.curField, KorkApi::ConsoleValue::makeString(frame.curFieldArray), KorkApi::ConsoleValue::TypeInternalNumber, KorkApi::ConsoleValue::ZoneExternal);
-               evalState.floatStack[frame._FLT+1] = vmInternal->valueAsFloat(retValue);
+               S32 fieldIndex = frame.getCurFieldIndex();
+               U8 storage = 0;
+               void* fieldPtr = vmInternal->getNumericFieldPtr(frame.curObject, fieldIndex, frame.curFieldArray, false, storage);
+               if (fieldPtr)
+               {
+                  evalState.floatStack[frame._FLT+1] = loadNumericField(fieldPtr, storage);
+               }
+               else
+               {
+                  KorkApi::ConsoleValue retValue =  vmInternal->getObjectFieldByIndex(frame.curObject, fieldIndex, frame.curField, KorkApi::ConsoleValue::makeString(frame.curFieldArray), KorkApi::ConsoleValue::TypeInternalNumber, KorkApi::ConsoleValue::ZoneExternal);
+                  evalState.floatStack[frame._FLT+1] = vmInternal->valueAsFloat(retValue);
+               }
             }
             else
             {
@@ -1488,7 +1771,7 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
          case OP_LOADFIELD_STR:
             if (frame.curObject)
             {
-               KorkApi::ConsoleValue retValue =  vmInternal->getObjectField(frame.curObject, frame.curField, KorkApi::ConsoleValue::makeString(frame.curFieldArray), KorkApi::ConsoleValue::TypeInternalString, KorkApi::ConsoleValue::ZoneExternal);
+               KorkApi::ConsoleValue retValue =  vmInternal->getObjectFieldByIndex(frame.curObject, frame.getCurFieldIndex(), frame.curField, KorkApi::ConsoleValue::makeString(frame.curFieldArray), KorkApi::ConsoleValue::TypeInternalString, KorkApi::ConsoleValue::ZoneExternal);
                evalState.mSTR.setStringValue(vmInternal->valueAsString(retValue));
             }
             else
@@ -1504,8 +1787,18 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
             evalState.mSTR.setUnsignedValue((U32)evalState.intStack[frame._UINT]);
             if (frame.curObject)
             {
-               KorkApi::ConsoleValue cv = evalState.mSTR.getConsoleValue();
-               vmInternal->setObjectField(frame.curObject, frame.curField, KorkApi::ConsoleValue::makeString(frame.curFieldArray), cv);
+               S32 fieldIndex = frame.getCurFieldIndex();
+               U8 storage = 0;
+               void* fieldPtr = vmInternal->getNumericFieldPtr(frame.curObject, fieldIndex, frame.curFieldArray, true, storage);
+               if (fieldPtr)
+               {
+                  storeNumericFieldInt(fieldPtr, storage, (U32)evalState.intStack[frame._UINT]);
+               }
+               else
+               {
+                  KorkApi::ConsoleValue cv = evalState.mSTR.getConsoleValue();
+                  vmInternal->setObjectFieldTupleByIndex(frame.curObject, fieldIndex, frame.curField, KorkApi::ConsoleValue::makeString(frame.curFieldArray), 1, &cv);
+               }
             }
             else
             {
@@ -1520,8 +1813,18 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
             evalState.mSTR.setNumberValue(evalState.floatStack[frame._FLT]);
             if (frame.curObject)
             {
-               KorkApi::ConsoleValue cv = evalState.mSTR.getConsoleValue();
-               vmInternal->setObjectField(frame.curObject, frame.curField, KorkApi::ConsoleValue::makeString(frame.curFieldArray), cv);
+               S32 fieldIndex = frame.getCurFieldIndex();
+               U8 storage = 0;
+               void* fieldPtr = vmInternal->getNumericFieldPtr(frame.curObject, fieldIndex, frame.curFieldArray, true, storage);
+               if (fieldPtr)
+               {
+                  storeNumericField(fieldPtr, storage, evalState.floatStack[frame._FLT]);
+               }
+               else
+               {
+                  KorkApi::ConsoleValue cv = evalState.mSTR.getConsoleValue();
+                  vmInternal->setObjectFieldTupleByIndex(frame.curObject, fieldIndex, frame.curField, KorkApi::ConsoleValue::makeString(frame.curFieldArray), 1, &cv);
+               }
             }
             else
             {
@@ -1536,7 +1839,7 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
             if (frame.curObject)
             {
                KorkApi::ConsoleValue cv = vmInternal->valueAsCVString(evalState.mSTR.getConsoleValue());
-               vmInternal->setObjectField(frame.curObject, frame.curField, KorkApi::ConsoleValue::makeString(frame.curFieldArray), cv);
+               vmInternal->setObjectFieldTupleByIndex(frame.curObject, frame.getCurFieldIndex(), frame.curField, KorkApi::ConsoleValue::makeString(frame.curFieldArray), 1, &cv);
             }
             else
             {
@@ -1758,7 +2061,8 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
                if(!frame.thisObject)
                {
                   frame.thisObject = 0;
-                  vmInternal->printf(0,"%s: Unable to find object: '%s' attempting to call function '%s'", frame.codeBlock->getFileLine(ip-6), objName, tmpFnName);
+                  if (frame.codeBlock->shouldWarn(ip-6, warnFile, warnLine))
+                     vmInternal->printf(0,"%s (%u): Unable to find object: '%s' attempting to call function '%s'", warnFile, warnLine, objName, tmpFnName);
                   evalState.mSTR.popFrame();
                   frame.pushStringStackCount--;
                   evalState.mSTR.setStringValue("");
@@ -1790,9 +2094,9 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
             
             if(!tmpNsEntry || frame.noCalls)
             {
-               if(!frame.noCalls)
+               if(!frame.noCalls && frame.codeBlock->shouldWarn(ip-4, warnFile, warnLine))
                {
-                  vmInternal->printf(0,"%s: Unknown command %s.", frame.codeBlock->getFileLine(ip-4), tmpFnName);
+                  vmInternal->printf(0,"%s (%u): Unknown command %s.", warnFile, warnLine, tmpFnName);
                   if(frame.lastCallType == FuncCallExprNode::MethodCall)
                   {
                      const char* objName = frame.thisObject.obj->klass->iCreate.GetNameFn(frame.thisObject.obj);
@@ -1829,7 +2133,9 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
                                                                            callArgv,
                                                                            false,
                                                                            false,
-                                                                           tmpNsEntry->mPackage);
+                                                                           tmpNsEntry->mPackage,
+                                                                           -1,
+                                                                           &tmpNsEntry->mCallStats);
                   
                   // NOTE: "frame" is now invalidated
                   if (newFrame)
@@ -1852,8 +2158,11 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
                if((tmpNsEntry->mMinArgs && effectiveArgc < tmpNsEntry->mMinArgs) || (tmpNsEntry->mMaxArgs && effectiveArgc > tmpNsEntry->mMaxArgs))
                {
                   const char* nsName = tmpNs? tmpNs->mName: "";
-                  vmInternal->printf(0, "%s: %s::%s - wrong number of arguments.", frame.codeBlock->getFileLine(ip-4), nsName, tmpFnName);
-                  vmInternal->printf(0, "%s: usage: %s", frame.codeBlock->getFileLine(ip-4), tmpNsEntry->getUsage());
+                  if (frame.codeBlock->shouldWarn(ip-4, warnFile, warnLine))
+                  {
+                     vmInternal->printf(0, "%s (%u): %s::%s - wrong number of arguments.", warnFile, warnLine, nsName, tmpFnName);
+                     vmInternal->printf(0, "%s (%u): usage: %s", warnFile, warnLine, tmpNsEntry->getUsage());
+                  }
                   evalState.mSTR.popFrame();
                   frame.pushStringStackCount--;
                   evalState.mSTR.setStringValue("");
@@ -1867,6 +2176,10 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
                      evalState.mSTR.convertArgv(vmInternal, callArgc, &callArgvS);
                   }
                   
+                  // NOTE: timer ends when any of the cases below jumps to execFinished
+                  NativeCallTimerScope callTimer(evalState, &tmpNsEntry->mCallStats, vmInternal->mCallStatsEnabled);
+                  NativeResultScope resultScope(evalState, evalState.mSTR.mNumFrames);
+                  
                   // Handle calling
                   // NOTE regarding yielding:
                   //   Yielded value should match the type of the function in this case.
@@ -1881,7 +2194,7 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
                         else if (tmpNsEntry->validateArgCount(callArgc - 2, &evalState))
                         {
                            frame.inNativeFunction = true;
-                           frame.thisObject->klass->iSignals.TriggerSignal(tmpNsEntry->mUserPtr, frame.thisObject.obj, tmpFnName, callArgc - 2, callArgv + 2);
+                           frame.thisObject->klass->iSignals.TriggerSignal(tmpNsEntry->mUserPtr, frame.thisObject.obj, tmpNsEntry->mSignalSlot, tmpFnName, callArgc - 2, callArgv + 2);
                         }
                         mLastFiberValue = KorkApi::ConsoleValue();
                         loopFrameSetup = true;
@@ -1900,6 +2213,13 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
                         else
                         {
                            mLastFiberValue = KorkApi::ConsoleValue::makeString(ret); // NOTE: none of these should yield
+                           
+                           // Use the zoned result if the function returned a buffer from makeStringResult
+                           if (evalState.mStringResultValue.hasLen() &&
+                               evalState.mStringResultValue.evaluatePtr(vmInternal->mAllocBase) == ret)
+                           {
+                              mLastFiberValue = evalState.mStringResultValue;
+                           }
                         }
                         
                         loopFrameSetup = true;
@@ -2020,8 +2340,7 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
             {
                const char *message = frame.curStringTable + code[ip];
 
-               U32 breakLine, inst;
-               frame.codeBlock->findBreakLine( ip - 1, breakLine, inst );
+               U32 breakLine = frame.codeBlock->getLineForIp( ip - 1 );
 
                if ( PlatformAssert::processAssert( PlatformAssert::Fatal,
                                                    frame.codeBlock->name ? frame.codeBlock->name : "eval",
@@ -2051,6 +2370,7 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
             U32 breakLine;
             U32 inst = 0;
             frame.codeBlock->findBreakLine(ip-1, breakLine, inst);
+            instruction = inst;
             if(!breakLine)
                goto breakContinue;
             vmInternal->mTelDebugger->executionStopped(frame.codeBlock, breakLine);
@@ -2272,6 +2592,7 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
             frame.prevField = frame.curField;
             strcpy( frame.prevFieldArray, frame.curFieldArray );
             frame.curField = vmInternal->mEmptyString;
+            frame.curFieldSite = nullptr;
             frame.curFieldArray[0] = 0;
             break;
             
@@ -2285,7 +2606,7 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
          {
             // This is like OP_CALLFUNC
             evalState.mSTR.getArgcArgv(nullptr, &callArgc, &callArgv);
-            vmInternal->setObjectFieldTuple(frame.curObject, frame.curField, KorkApi::ConsoleValue::makeString(frame.curFieldArray), callArgc-1, callArgv+1);
+            vmInternal->setObjectFieldTupleByIndex(frame.curObject, frame.getCurFieldIndex(), frame.curField, KorkApi::ConsoleValue::makeString(frame.curFieldArray), callArgc-1, callArgv+1);
             
             evalState.mSTR.popFrame();
             evalState.mSTR.setStringValue(""); // clear stack in case original value is garbage
@@ -2327,7 +2648,7 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
             
          case OP_LOADFIELD_VAR:
             // field -> var
-            tmpVal = vmInternal->getObjectField(frame.curObject, frame.curField, KorkApi::ConsoleValue::makeString(frame.curFieldArray), KorkApi::ConsoleValue::TypeInternalUnsigned, KorkApi::ConsoleValue::ZoneFunc);
+            tmpVal = vmInternal->getObjectFieldByIndex(frame.curObject, frame.getCurFieldIndex(), frame.curField, KorkApi::ConsoleValue::makeString(frame.curFieldArray), KorkApi::ConsoleValue::TypeInternalUnsigned, KorkApi::ConsoleValue::ZoneFunc);
             frame.setConsoleValue(tmpVal);
             break;
          case OP_SAVEFIELD_VAR:
@@ -2336,7 +2657,7 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
             if (frame.curObject)
             {
                KorkApi::ConsoleValue cv = frame.getConsoleVariable();
-               vmInternal->setObjectField(frame.curObject, frame.curField, KorkApi::ConsoleValue::makeString(frame.curFieldArray), cv);
+               vmInternal->setObjectFieldTupleByIndex(frame.curObject, frame.getCurFieldIndex(), frame.curField, KorkApi::ConsoleValue::makeString(frame.curFieldArray), 1, &cv);
             }
             else
             {
@@ -2358,7 +2679,7 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
             break;
          case OP_LOADFIELD_TYPED:
             // field -> typed
-            tmpVal = vmInternal->getObjectField(frame.curObject, frame.curField, KorkApi::ConsoleValue::makeString(frame.curFieldArray), KorkApi::TypeDirectCopy, KorkApi::ConsoleValue::ZoneFunc);
+            tmpVal = vmInternal->getObjectFieldByIndex(frame.curObject, frame.getCurFieldIndex(), frame.curField, KorkApi::ConsoleValue::makeString(frame.curFieldArray), KorkApi::TypeDirectCopy, KorkApi::ConsoleValue::ZoneFunc);
             evalState.mSTR.setConsoleValue(vmInternal, tmpVal);
             break;
          case OP_SAVEVAR_TYPED:
@@ -2374,7 +2695,7 @@ KorkApi::FiberRunResult ExprEvalState::runVM()
             {
    
                KorkApi::ConsoleValue cv = evalState.mSTR.getConsoleValue();
-               vmInternal->setObjectField(frame.curObject, frame.curField, KorkApi::ConsoleValue::makeString(frame.curFieldArray), cv);
+               vmInternal->setObjectFieldTupleByIndex(frame.curObject, frame.getCurFieldIndex(), frame.curField, KorkApi::ConsoleValue::makeString(frame.curFieldArray), 1, &cv);
             }
             else
             {
@@ -2512,6 +2833,7 @@ execFinished:
    if (mState == KorkApi::FiberRunResult::SUSPENDED)
    {
       frame.ip = ip;
+      pauseCallTimers();
       result.state = mState;
       result.value = mLastFiberValue;
       return result;
@@ -2706,6 +3028,11 @@ bool ExprEvalState::clearStringStack(ConsoleFrame& frame, bool clearValue)
 
 void ExprEvalState::popFrame()
 {
+   if (!mCallTimers.empty())
+   {
+      endFrameCallTimers((S32)vmFrames.size()-1);
+   }
+   
    ConsoleFrame *last = vmFrames.back();
    vmFrames.pop_back();
    
@@ -2747,10 +3074,6 @@ void ExprEvalState::popFrame()
       }
    }
    
-   const bool telDebuggerOn = vmInternal->mTelDebugger && vmInternal->mTelDebugger->isConnected();
-   if ( telDebuggerOn && !last->isReference )
-      vmInternal->mTelDebugger->popStackFrame();
-   
    if (last->codeBlock)
    {
       last->codeBlock->decRefCount();
@@ -2871,6 +3194,78 @@ ConsoleBasicFrame ExprEvalState::getBasicFrameInfo(U32 idx)
    return outF;
 }
 
+U64 ExprEvalState::getCallTimerNow()
+{
+   return (U64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+U32 ExprEvalState::beginCallTimer(CallStats* stats, S32 frameIndex)
+{
+   stats->calls++;
+   
+   CallTimer timer;
+   timer.stats = stats;
+   timer.start = getCallTimerNow();
+   timer.childTime = 0;
+   timer.frameIndex = frameIndex;
+   mCallTimers.push_back(timer);
+   return (U32)mCallTimers.size()-1;
+}
+
+void ExprEvalState::endCallTimers(U32 timerIndex)
+{
+   U64 now = getCallTimerNow();
+   while (mCallTimers.size() > timerIndex)
+   {
+      CallTimer timer = mCallTimers.back();
+      mCallTimers.pop_back();
+      
+      U64 elapsed = now - timer.start;
+      timer.stats->inclusiveTime += elapsed;
+      timer.stats->exclusiveTime += elapsed > timer.childTime ? elapsed - timer.childTime : 0;
+      
+      if (!mCallTimers.empty())
+      {
+         mCallTimers.back().childTime += elapsed;
+      }
+   }
+}
+
+void ExprEvalState::endFrameCallTimers(S32 frameIndex)
+{
+   U32 timerIndex = mCallTimers.size();
+   while (timerIndex > 0 && mCallTimers[timerIndex-1].frameIndex >= frameIndex)
+   {
+      timerIndex--;
+   }
+   endCallTimers(timerIndex);
+}
+
+void ExprEvalState::pauseCallTimers()
+{
+   if (!mCallTimersPaused && !mCallTimers.empty())
+   {
+      mCallTimersPaused = true;
+      mCallTimersPausedAt = getCallTimerNow();
+   }
+}
+
+void ExprEvalState::resumeCallTimers()
+{
+   if (!mCallTimersPaused)
+   {
+      return;
+   }
+   
+   // Time spent suspended doesn't count towards any active calls
+   U64 delta = getCallTimerNow() - mCallTimersPausedAt;
+   for (CallTimer& timer : mCallTimers)
+   {
+      timer.start += delta;
+   }
+   mCallTimersPaused = false;
+}
+
 void ExprEvalState::suspend()
 {
    if (mState == KorkApi::FiberRunResult::RUNNING)
@@ -2886,6 +3281,8 @@ KorkApi::FiberRunResult ExprEvalState::resume(KorkApi::ConsoleValue value)
    {
       mState = KorkApi::FiberRunResult::RUNNING;
       mLastFiberValue = value;
+      mStringResultValue = KorkApi::ConsoleValue();
+      resumeCallTimers();
       KorkApi::FiberRunResult result = runVM();
       return result;
    }
@@ -2899,6 +3296,10 @@ ConsoleSerializer::ConsoleSerializer(KorkApi::VmInternal* target, void* userPtr,
    mUserPtr = userPtr;
    mAllowId = allowId;
    mStream = s;
+   mReadVersion = CSOB_VERSION;
+   mWriteDelta = false;
+   mOutStream = nullptr;
+   mScratch = nullptr;
 }
 
 ConsoleSerializer::~ConsoleSerializer()
@@ -2990,12 +3391,19 @@ ExprEvalState* ConsoleSerializer::loadEvalState()
    bool ownsDict = false;
    
    if (!mStream->read(&version) ||
-       version != CEOB_VERSION)
+       version != (mReadVersion >= 3 ? CEOB_VERSION : 1))
    {
       return nullptr;
    }
 
-   if (!mStream->read(&theRemap.oldIndex))
+   if (!readCount(theRemap.oldIndex))
+   {
+      return nullptr;
+   }
+   
+   U32 numIterRecords = MaxIterStackSize;
+   if (mReadVersion >= 3 &&
+       (!readCount(numIterRecords) || numIterRecords > MaxIterStackSize))
    {
       return nullptr;
    }
@@ -3010,7 +3418,7 @@ ExprEvalState* ConsoleSerializer::loadEvalState()
    mFiberRemap.push_back(theRemap);
 
    // Stacks
-   for (U32 i=0; i<MaxIterStackSize; i++)
+   for (U32 i=0; i<numIterRecords; i++)
    {
       readIterStackRecord(state->iterStack[i]);
    }
@@ -3054,11 +3462,11 @@ ExprEvalState* ConsoleSerializer::loadEvalState()
    
    // Dictionary
    S32 dictionaryId = addReferencedDictionary(state->globalVars.mHashTable);
-   mStream->read(&dictionaryId);
+   readIndex(dictionaryId);
 
    // Frames
    U32 numFrames = 0;
-   mStream->read(&numFrames);
+   readCount(numFrames);
    for (U32 i=0; i<numFrames; i++)
    {
       IFFBlock frameBlock;
@@ -3105,10 +3513,18 @@ bool ConsoleSerializer::saveEvalState(ExprEvalState* state)
    U32 startWrite = mStream->getPosition();
    U32 oldIndex = state->mAllocNumber-1;
    mStream->write(CEOB_VERSION);
-   mStream->write(oldIndex);
+   writeCount(oldIndex);
+   
+   // Only iterators below the deepest frame pointer are live
+   U32 numIterRecords = 0;
+   for (ConsoleFrame* frame : state->vmFrames)
+   {
+      numIterRecords = getMax(numIterRecords, (U32)frame->_ITER);
+   }
+   writeCount(numIterRecords);
 
    // Stacks
-   for (U32 i=0; i<MaxIterStackSize; i++)
+   for (U32 i=0; i<numIterRecords; i++)
    {
       writeIterStackRecord(state->iterStack[i]);
    }
@@ -3130,8 +3546,8 @@ bool ConsoleSerializer::saveEvalState(ExprEvalState* state)
    writeStringStack(state->mSTR);
 
    // Names
-   mStream->writeString(state->mCurrentFile);
-   mStream->writeString(state->mCurrentRoot);
+   writeSTString(state->mCurrentFile);
+   writeSTString(state->mCurrentRoot);
 
    // State
    mStream->write((U8)state->mState);
@@ -3156,10 +3572,10 @@ bool ConsoleSerializer::saveEvalState(ExprEvalState* state)
    
    // Dictionary
    S32 dictionaryId = addReferencedDictionary(ownsDict ? state->globalVars.mHashTable : nullptr); // fiber must own globals for them to be written
-   mStream->write(dictionaryId);
+   writeIndex(dictionaryId);
 
    // Frames
-   mStream->write((U32)state->vmFrames.size());
+   writeCount((U32)state->vmFrames.size());
    for (ConsoleFrame* frame : state->vmFrames)
    {
       IFFBlock frameBlock;
@@ -3195,6 +3611,9 @@ bool ConsoleSerializer::readConsoleValue(KorkApi::ConsoleValue& value, KorkApi::
       return false;
    }
    
+   // Lengths aren't stored
+   value.len = KorkApi::ConsoleValue::UnknownLen;
+   
    // Load external data
    if (dataRef && value.getZone() == KorkApi::ConsoleValue::ZoneVmHeap)
    {
@@ -3223,7 +3642,7 @@ bool ConsoleSerializer::writeConsoleValue(KorkApi::ConsoleValue& value, KorkApi:
 bool ConsoleSerializer::readHeapData(KorkApi::ConsoleHeapAllocRef& ref)
 {
    U32 size = 0;
-   if (!mStream->read(&size))
+   if (!readCount(size))
    {
       return false;
    }
@@ -3245,11 +3664,11 @@ bool ConsoleSerializer::writeHeapData(KorkApi::ConsoleHeapAllocRef ref)
 {
    if (!ref)
    {
-      return mStream->write((U32)0);
+      return writeCount(0);
    }
    else
    {
-      return mStream->write((U32)ref->size) &&
+      return writeCount((U32)ref->size) &&
              mStream->write((U32)ref->size, ref->ptr());
    }
 }
@@ -3273,13 +3692,20 @@ bool ConsoleSerializer::writeIterStackRecord(IterStackRecord& ref)
 bool ConsoleSerializer::readVarRef(ConsoleVarRef& ref)
 {
    S32 dictId = -1;
-   if (!mStream->read(&dictId))
+   if (!readIndex(dictId))
    {
       return false;
    }
    
    StringTableEntry steName = readSTString(mStream);
    
+   char key[256];
+   key[0] = '\0';
+   if (mReadVersion >= 4)
+   {
+      mStream->readString(key);
+   }
+   
    Dictionary::HashTableData* data = getReferencedDictionary(dictId);
    if (!data || data->owner == nullptr)
    {
@@ -3289,7 +3715,7 @@ bool ConsoleSerializer::readVarRef(ConsoleVarRef& ref)
    else
    {
       ref.dictionary = data->owner;
-      ref.var = ref.dictionary->lookup(steName);
+      ref.var = ref.dictionary->lookupArray(steName, key);
    }
    
    return mStream->getStatus() == Stream::Ok;
@@ -3298,11 +3724,35 @@ bool ConsoleSerializer::readVarRef(ConsoleVarRef& ref)
 bool ConsoleSerializer::writeVarRef(ConsoleVarRef& ref)
 {
    S32 dictId = addReferencedDictionary(ref.dictionary ? ref.dictionary->mHashTable : nullptr);
-   mStream->write(dictId);
-   mStream->writeString(ref.var ? ref.var->name : "");
+   writeIndex(dictId);
+   writeSTString(ref.var ? ref.var->name : "");
+   
+   if (ref.var && ref.var->isArrayElement())
+   {
+      writeArrayKey(ref.var);
+   }
+   else
+   {
+      mStream->writeString("");
+   }
+   
    return mStream->getStatus() == Stream::Ok;
 }
 
+void ConsoleSerializer::writeArrayKey(Dictionary::Entry* entry)
+{
+   if (entry->mArrayKey)
+   {
+      mStream->writeString(entry->mArrayKey);
+   }
+   else
+   {
+      char key[16];
+      snprintf(key, sizeof(key), "%u", entry->mArrayIndex);
+      mStream->writeString(key);
+   }
+}
+
 KorkApi::VMObject* ConsoleSerializer::loadObject()
 {
    U8 refType = 0;
@@ -3338,7 +3788,7 @@ void ConsoleSerializer::writeObject(KorkApi::VMObject* obj)
       {
          objFlags |= BIT(1);
          mStream->write(objFlags);
-         mStream->writeString(objName);
+         writeSTString(objName);
          return;
       }
       else if (mAllowId)
@@ -3370,14 +3820,23 @@ bool ConsoleSerializer::readStringStack(StringStack& stack)
    stack.reset();
    
    U32 bufferSize = 0;
-   if (!mStream->read(&bufferSize))
+   if (!readCount(bufferSize))
+   {
+      return false;
+   }
+   
+   // NOTE: from version 3 only the live part of the buffer is stored
+   U32 liveSize = bufferSize;
+   if (mReadVersion >= 3 &&
+       (!readCount(liveSize) || liveSize > bufferSize))
    {
       return false;
    }
    
    stack.mBuffer.resize(bufferSize);
+   memset(stack.mBuffer.data() + liveSize, 0, bufferSize - liveSize);
    
-   return mStream->read(bufferSize, stack.mBuffer.data()) &&
+   return mStream->read(liveSize, stack.mBuffer.data()) &&
      mStream->read(sizeof(stack.mFrameOffsets), stack.mFrameOffsets) &&
      mStream->read(sizeof(stack.mStartOffsets), stack.mStartOffsets) &&
      mStream->read(sizeof(stack.mStartTypes), stack.mStartTypes) &&
@@ -3394,8 +3853,13 @@ bool ConsoleSerializer::readStringStack(StringStack& stack)
 
 bool ConsoleSerializer::writeStringStack(StringStack& stack)
 {
-   return mStream->write((U32)stack.mBuffer.size()) &&
-     mStream->write((U32)stack.mBuffer.size(), stack.mBuffer.data()) &&
+   // Nothing above the current value or function buffer is in use
+   U32 bufferSize = (U32)stack.mBuffer.size();
+   U32 liveSize = getMin(bufferSize, stack.mStart + getMax(stack.mLen + 1, stack.mFunctionOffset));
+   
+   return writeCount(bufferSize) &&
+     writeCount(liveSize) &&
+     mStream->write(liveSize, stack.mBuffer.data()) &&
      mStream->write(sizeof(stack.mFrameOffsets), stack.mFrameOffsets) &&
      mStream->write(sizeof(stack.mStartOffsets), stack.mStartOffsets) &&
      mStream->write(sizeof(stack.mStartTypes), stack.mStartTypes) &&
@@ -3418,8 +3882,8 @@ ConsoleFrame* ConsoleSerializer::loadFrame(ExprEvalState* state)
    S32 dictionaryId = -1;
    bool ownsDict = false;
 
-   mStream->read(&blockId);
-   mStream->read(&dictionaryId);
+   readIndex(blockId);
+   readIndex(dictionaryId);
    mStream->read(&ownsDict);
 
    CodeBlock* block = getReferencedCodeblock(blockId);
@@ -3458,11 +3922,11 @@ ConsoleFrame* ConsoleSerializer::loadFrame(ExprEvalState* state)
    mStream->read(&frame->_STARTOBJ);
 
    // Offsets
-   mStream->read(&frame->failJump);
-   mStream->read(&frame->stackStart);
-   mStream->read(&frame->callArgc);
-   mStream->read(&frame->ip);
-   mStream->read(&frame->lastCallType);
+   readCount(frame->failJump);
+   readCount(frame->stackStart);
+   readCount(frame->callArgc);
+   readCount(frame->ip);
+   readCount(frame->lastCallType);
 
    // Dictionary state
    frame->scopeName = readSTString(mStream);
@@ -3482,14 +3946,22 @@ ConsoleFrame* ConsoleSerializer::loadFrame(ExprEvalState* state)
    readVarRef(frame->copyVar);
    
    // Docblock
-   mStream->read(&frame->nsDocBlockClassOffset);
-   mStream->read(&frame->nsDocBlockOffset);
+   readCount(frame->nsDocBlockClassOffset);
+   readCount(frame->nsDocBlockOffset);
    mStream->read(&frame->nsDocBlockClassNameLength);
    mStream->read(&frame->nsDocBlockClassLocation);
 
    // Buffers
-   mStream->read(ConsoleFrame::FieldArraySize, frame->curFieldArray);
-   mStream->read(ConsoleFrame::FieldArraySize, frame->prevFieldArray);
+   if (mReadVersion >= 3)
+   {
+      mStream->readString(frame->curFieldArray);
+      mStream->readString(frame->prevFieldArray);
+   }
+   else
+   {
+      mStream->read(ConsoleFrame::FieldArraySize, frame->curFieldArray);
+      mStream->read(ConsoleFrame::FieldArraySize, frame->prevFieldArray);
+   }
 
    // Restore everything remaining
 
@@ -3523,8 +3995,8 @@ bool ConsoleSerializer::writeFrame(ConsoleFrame& frame)
       return false;
    }
    
-   mStream->write(blockId);
-   mStream->write(dictionaryId);
+   writeIndex(blockId);
+   writeIndex(dictionaryId);
    mStream->write(ownsDict);
 
    bool inFunction = frame.curFloatTable != frame.codeBlock->globalFloats;
@@ -3547,16 +4019,16 @@ bool ConsoleSerializer::writeFrame(ConsoleFrame& frame)
    mStream->write(frame._STARTOBJ);
 
    // Offsets
-   mStream->write(frame.failJump);
-   mStream->write(frame.stackStart);
-   mStream->write(frame.callArgc);
-   mStream->write(frame.ip);
-   mStream->write(frame.lastCallType);
+   writeCount(frame.failJump);
+   writeCount(frame.stackStart);
+   writeCount(frame.callArgc);
+   writeCount(frame.ip);
+   writeCount(frame.lastCallType);
 
    // Dictionary state
-   mStream->writeString(frame.scopeName);
-   mStream->writeString(frame.scopePackage);
-   mStream->writeString(frame.scopeNamespace ? frame.scopeNamespace->mName : "");
+   writeSTString(frame.scopeName);
+   writeSTString(frame.scopePackage);
+   writeSTString(frame.scopeNamespace ? frame.scopeNamespace->mName : "");
 
    // References
    writeObjectRef(frame.currentNewObject);
@@ -3570,14 +4042,14 @@ bool ConsoleSerializer::writeFrame(ConsoleFrame& frame)
    writeVarRef(frame.copyVar);
 
    // Docblock
-   mStream->write(frame.nsDocBlockClassOffset);
-   mStream->write(frame.nsDocBlockOffset);
+   writeCount(frame.nsDocBlockClassOffset);
+   writeCount(frame.nsDocBlockOffset);
    mStream->write(frame.nsDocBlockClassNameLength);
    mStream->write(frame.nsDocBlockClassLocation);
 
    // Buffers
-   mStream->write(ConsoleFrame::FieldArraySize, frame.curFieldArray);
-   mStream->write(ConsoleFrame::FieldArraySize, frame.prevFieldArray);
+   mStream->writeString(frame.curFieldArray);
+   mStream->writeString(frame.prevFieldArray);
    
    return true;
 }
@@ -3600,17 +4072,13 @@ void ConsoleSerializer::fixupConsoleValues()
    // Dictionary variables
    for (Dictionary::HashTableData* ht : mDictionaryTables)
    {
-      for (U32 i=0; i<ht->size; i++)
-      {
-         for (Dictionary::Entry* entry = ht->data[i]; entry; entry = entry->nextEntry)
+      Dictionary::forEachEntry(ht, [&](Dictionary::Entry* entry) {
+         KorkApi::ConsoleValue& v = entry->mConsoleValue;
+         if (v.getZone() >= KorkApi::ConsoleValue::ZoneFiberStart)
          {
-            KorkApi::ConsoleValue& v = entry->mConsoleValue;
-            if (v.getZone() >= KorkApi::ConsoleValue::ZoneFiberStart)
-            {
-               remapCV(v);
-            }
+            remapCV(v);
          }
-      }
+      });
    }
    
    // Fiber values
@@ -3633,6 +4101,8 @@ void ConsoleSerializer::fixupConsoleValues()
 
 void ConsoleSerializer::reset(bool ownObjects)
 {
+   releaseBaseObjects();
+   
    if (ownObjects && mTarget)
    {
       for (ExprEvalState* state : mFibers)
@@ -3655,162 +4125,338 @@ void ConsoleSerializer::reset(bool ownObjects)
    }
    
    mCodeBlocks.clear();
+   mCodeBlockIds.clear();
    mDictionaryTables.clear();
+   mDictionaryIds.clear();
    mFibers.clear();
    mFiberRemap.clear();
+   mWriteStrings.clear();
+   mReadStrings.clear();
 }
 
-bool ConsoleSerializer::read(KorkApi::Vector<ExprEvalState*> &fibers)
+void ConsoleSerializer::releaseBaseObjects()
 {
-   IFFBlock block;
-   if (!mStream->read(sizeof(IFFBlock), &block))
+   for (CodeBlock* block : mBaseCodeBlocks)
    {
-      reset(true);
-      return false;
+      block->decRefCount();
    }
    
-   if (block.ident != CSOB_MAGIC || block.getRawSize() < 12)
+   for (Dictionary::HashTableData* ht : mBaseDictionaryTables)
    {
-      reset(true);
-      return false;
+      // Tables carried over into the current snapshot are still in use
+      if (ht->owner != nullptr ||
+          std::find(mDictionaryTables.begin(), mDictionaryTables.end(), ht) != mDictionaryTables.end())
+      {
+         continue;
+      }
+      
+      Dictionary tempDict(mTarget, ht);
+      ht->owner = &tempDict;
    }
    
-   U32 version = 0;
+   mBaseCodeBlocks.clear();
+   mBaseCodeBlockIds.clear();
+   mBaseDictionaryTables.clear();
+   mBaseDictionaryIds.clear();
+}
+
+bool ConsoleSerializer::canReferencePrevious(U32 snapshotGen) const
+{
+   return mWriteDelta &&
+          mTarget->mSnapshotGeneration != 0 &&
+          snapshotGen == mTarget->mSnapshotGeneration;
+}
+
+void ConsoleSerializer::markSnapshotWritten()
+{
+   U32 gen = ++mTarget->mSnapshotGeneration;
+   
+   for (Dictionary::HashTableData* ht : mDictionaryTables)
+   {
+      ht->snapshotGen = gen;
+      Dictionary::clearDirty(ht);
+   }
+   
+   for (CodeBlock* block : mCodeBlocks)
+   {
+      block->snapshotGen = gen;
+   }
+}
+
+bool ConsoleSerializer::readSnapshot(bool loadFiberList)
+{
+   U32 startPos = mStream->getPosition();
+   
+   IFFBlock block;
+   if (!mStream->read(sizeof(IFFBlock), &block))
+   {
+      return false;
+   }
+   
+   if (block.ident != CSOB_MAGIC)
+   {
+      return false;
+   }
+   
+   U32 version = 0;
+   U32 flags = 0;
    U32 objectOffset = 0;
    U32 mainOffset = 0;
    mStream->read(&version);
-   mStream->read(&objectOffset);
-   mStream->read(&mainOffset);
    
-   if (version != CSOB_VERSION)
+   if (version < 1 || version > CSOB_VERSION)
    {
-      reset(true);
       return false;
    }
    
-   mStream->setPosition(objectOffset);
+   if (version > 1)
+   {
+      mStream->read(&flags);
+   }
    
-   if (!loadRelatedObjects())
+   // NOTE: from version 3 the main block size is not known when writing
+   if (version < 3)
+   {
+      if (block.getRawSize() < 12)
+      {
+         return false;
+      }
+      
+      mStream->read(&objectOffset);
+      mStream->read(&mainOffset);
+   }
+   
+   // Deltas need the previous snapshot
+   if ((flags & CSOB_FLAG_DELTA) != 0 &&
+       mBaseDictionaryTables.empty() &&
+       mBaseCodeBlocks.empty())
    {
-      reset(true);
       return false;
    }
    
-   mStream->setPosition(mainOffset);
+   mReadVersion = version;
+   mReadStrings.clear();
    
-   if (!loadFibers())
+   if (version < 3)
+   {
+      mStream->setPosition(startPos + objectOffset);
+   }
+   
+   if (!loadRelatedObjects())
    {
-      reset(true);
       return false;
    }
    
+   if (!loadFiberList)
+   {
+      return true;
+   }
+   
+   if (version < 3)
+   {
+      mStream->setPosition(startPos + mainOffset);
+   }
+   
+   return loadFibers();
+}
+
+bool ConsoleSerializer::read(KorkApi::Vector<ExprEvalState*> &fibers)
+{
+   return readChain(1, &mStream, fibers);
+}
+
+bool ConsoleSerializer::readChain(U32 numStreams, Stream** streams, KorkApi::Vector<ExprEvalState*> &fibers)
+{
+   // NOTE: only the final snapshot in the chain creates fibers; prior
+   // snapshots just provide the dictionaries and codeblocks it refers to.
+   for (U32 i=0; i<numStreams; i++)
+   {
+      const bool isLast = i == numStreams-1;
+      mStream = streams[i];
+      
+      if (!readSnapshot(isLast))
+      {
+         reset(true);
+         return false;
+      }
+      
+      if (!isLast)
+      {
+         releaseBaseObjects();
+         mBaseCodeBlocks = mCodeBlocks;
+         mBaseCodeBlockIds = mCodeBlockIds;
+         mBaseDictionaryTables = mDictionaryTables;
+         mBaseDictionaryIds = mDictionaryIds;
+         mCodeBlocks.clear();
+         mCodeBlockIds.clear();
+         mDictionaryTables.clear();
+         mDictionaryIds.clear();
+      }
+   }
+   
    fibers = mFibers;
    
    return true;
 }
 
-bool ConsoleSerializer::write(KorkApi::Vector<ExprEvalState*> &fibers)
+bool ConsoleSerializer::write(KorkApi::Vector<ExprEvalState*> &fibers, bool delta)
 {
    // This is:
-   // CSOB
+   // CSOB (size 0)
    //   version
-   //   <offsets>
-   //   <fiber list>
+   //   flags
    //   <object list>
+   //   <fiber list>
+   //
+   // Each block is assembled in a scratch stream and then appended to the 
+   // output, so the output only needs to support sequential writes.
+   
+   GrowableMemStream scratch;
+   Stream* outStream = mStream;
+   mOutStream = outStream;
+   mScratch = &scratch;
+   mWriteDelta = delta;
+   mFibers = fibers;
    
-   U32 startPos = mStream->getPosition();
+   auto fail = [this, outStream]() {
+      mStream = outStream;
+      mScratch = nullptr;
+      reset(false);
+      return false;
+   };
 
    IFFBlock block;
    block.ident = CSOB_MAGIC;
-   if (!mStream->write(sizeof(IFFBlock), &block))
+   if (!mStream->write(sizeof(IFFBlock), &block) ||
+       !mStream->write(CSOB_VERSION) ||
+       !mStream->write(delta ? CSOB_FLAG_DELTA : (U32)0))
    {
-      reset(false);
-      return false;
+      return fail();
    }
-
-   mStream->write(CSOB_VERSION);
-   U32 objectOffset = mStream->getPosition(); mStream->write((U32)0);
-   U32 mainOffset = mStream->getPosition(); mStream->write((mStream->getPosition() - startPos) + 4);
-
-   mFibers = fibers;
+   
+   // Fibers need to be visited first to determine which objects are referenced
+   mOutStream = nullptr;
    if (!saveFibers())
    {
-      reset(false);
-      return false;
+      return fail();
    }
-
-   U32 startObjects = mStream->getPosition() - startPos;
-   mStream->setPosition(objectOffset);
-   mStream->write(startObjects);
-   mStream->setPosition(startObjects);
+   mOutStream = outStream;
+   mWriteStrings.clear();
    
-   if (!saveRelatedObjects())
+   if (!saveRelatedObjects() ||
+       !saveFibers())
    {
-      reset(false);
-      return false;
-   }
-   
-   block.updateSize(*mStream, startPos);
-   if (!block.writePad(*mStream))
-   {
-      reset(false);
-      return false;
+      return fail();
    }
    
+   mScratch = nullptr;
+   markSnapshotWritten();
    reset(false);
    return true;
 }
 
-Dictionary::HashTableData* ConsoleSerializer::loadHashTable()
+bool ConsoleSerializer::loadHashTableEntries(Dictionary& dict, U32 entryCount)
 {
-   Dictionary tempDict(mTarget);
-   tempDict.reset();
-
-   U32 entryCount = 0;
-   if (!mStream->read(&entryCount))
-   {
-      return nullptr;
-   }
-   
    for (U32 i = 0; i < entryCount; ++i)
    {
-      bool isConst = false;
-      if (!mStream->read(&isConst))
+      U8 flags = 0;
+      if (!mStream->read(&flags))
       {
-         return nullptr;
+         return false;
       }
       
       StringTableEntry name = readSTString(mStream);
       if (name == nullptr)
       {
-         return nullptr;
+         return false;
+      }
+      
+      Dictionary::Entry* entry = nullptr;
+      if (flags & ENTRY_FLAG_ELEMENT)
+      {
+         char key[256];
+         mStream->readString(key);
+         entry = dict.addArray(name, key);
+      }
+      else
+      {
+         entry = dict.add(name);
       }
       
-      Dictionary::Entry* entry = tempDict.add(name);
       if (!entry)
       {
-         return nullptr;
+         return false;
       }
       
       U32 valueSize = 0;
-      mStream->read(&valueSize);
+      readCount(valueSize);
       
       // Set heap value
+      dict.clearEntry(entry);
       if (valueSize != 0)
       {
          entry->mHeapAlloc = mTarget->createHeapRef(valueSize);
          if (!mStream->read(valueSize, entry->mHeapAlloc->ptr()))
          {
-            return nullptr;
+            return false;
          }
       }
       
       if (!readConsoleValue(entry->mConsoleValue, entry->mHeapAlloc))
       {
-         return nullptr;
+         return false;
       }
       
-      entry->mIsConstant = isConst;
+      entry->mIsConstant = (flags & ENTRY_FLAG_CONSTANT) != 0;
+   }
+   
+   return true;
+}
+
+bool ConsoleSerializer::writeHashTableEntry(Dictionary::Entry* entry)
+{
+   U8 flags = (entry->mIsConstant ? ENTRY_FLAG_CONSTANT : 0) |
+              (entry->isArrayElement() ? ENTRY_FLAG_ELEMENT : 0);
+   mStream->write(flags);
+   writeSTString(entry->name);
+   
+   if (entry->isArrayElement())
+   {
+      writeArrayKey(entry);
+   }
+   
+   if (mStream->getStatus() != Stream::Ok)
+   {
+      return false;
+   }
+   
+   if (entry->mHeapAlloc)
+   {
+      writeCount((U32)entry->mHeapAlloc->size);
+      mStream->write(entry->mHeapAlloc->size, entry->mHeapAlloc->ptr());
+   }
+   else
+   {
+      writeCount(0);
+   }
+   
+   return writeConsoleValue(entry->mConsoleValue, entry->mHeapAlloc);
+}
+
+Dictionary::HashTableData* ConsoleSerializer::loadHashTable()
+{
+   Dictionary tempDict(mTarget);
+   tempDict.reset();
+
+   U32 entryCount = 0;
+   if (!readCount(entryCount))
+   {
+      return nullptr;
+   }
+   
+   if (!loadHashTableEntries(tempDict, entryCount))
+   {
+      return nullptr;
    }
    
    Dictionary::HashTableData* ht = tempDict.mHashTable;
@@ -3821,9 +4467,9 @@ Dictionary::HashTableData* ConsoleSerializer::loadHashTable()
 
 bool ConsoleSerializer::writeHashTable(const Dictionary::HashTableData* ht)
 {
-   U32 entryCount = (U32)ht->count;
+   U32 entryCount = (U32)(ht->count + ht->elementCount);
 
-   if (!mStream->write(entryCount))
+   if (!writeCount(entryCount))
       return false;
 
    if (ht->size <= 0 ||
@@ -3832,56 +4478,99 @@ bool ConsoleSerializer::writeHashTable(const Dictionary::HashTableData* ht)
       return true;
    }
    
-   for (S32 i = 0; i < ht->size; ++i)
+   bool ok = true;
+   Dictionary::forEachEntry(ht, [&](Dictionary::Entry* entry) {
+      ok = ok && writeHashTableEntry(entry);
+   });
+
+   return ok;
+}
+
+bool ConsoleSerializer::applyHashTableDelta(Dictionary::HashTableData* ht)
+{
+   U32 entryCount = 0;
+   if (!readCount(entryCount))
    {
-      for (Dictionary::Entry* entry = ht->data[i]; entry; entry = entry->nextEntry)
+      return false;
+   }
+   
+   // NOTE: table is unowned at this point so tempDict won't free it
+   Dictionary tempDict(mTarget, ht);
+   return loadHashTableEntries(tempDict, entryCount);
+}
+
+bool ConsoleSerializer::writeHashTableDelta(const Dictionary::HashTableData* ht)
+{
+   U32 entryCount = 0;
+   Dictionary::forEachEntry(ht, [&](Dictionary::Entry* entry) {
+      if (entry->mDirty)
       {
-         mStream->write((bool)entry->mIsConstant);
-         mStream->writeString(entry->name);
-         
-         if (mStream->getStatus() != Stream::Ok)
-         {
-            return false;
-         }
-         
-         if (entry->mHeapAlloc)
-         {
-            mStream->write((U32)entry->mHeapAlloc->size);
-            mStream->write(entry->mHeapAlloc->size, entry->mHeapAlloc->ptr());
-         }
-         else
-         {
-            mStream->write((U32)0);
-         }
-         
-         if (!writeConsoleValue(entry->mConsoleValue, entry->mHeapAlloc))
+         entryCount++;
+      }
+   });
+   
+   if (!writeCount(entryCount))
+      return false;
+   
+   bool ok = true;
+   if (entryCount > 0)
+   {
+      Dictionary::forEachEntry(ht, [&](Dictionary::Entry* entry) {
+         if (entry->mDirty)
          {
-            return false;
+            ok = ok && writeHashTableEntry(entry);
          }
-      }
+      });
    }
-
-   return true;
+   
+   return ok;
 }
 
 bool ConsoleSerializer::loadRelatedObjects()
 {
+   auto findBaseTable = [this](U32 snapshotId) -> Dictionary::HashTableData* {
+      for (U32 i=0; i<mBaseDictionaryIds.size(); i++)
+      {
+         if (mBaseDictionaryIds[i] == snapshotId)
+            return mBaseDictionaryTables[i];
+      }
+      return nullptr;
+   };
+   
+   auto findBaseBlock = [this](U32 snapshotId) -> CodeBlock* {
+      for (U32 i=0; i<mBaseCodeBlockIds.size(); i++)
+      {
+         if (mBaseCodeBlockIds[i] == snapshotId)
+            return mBaseCodeBlocks[i];
+      }
+      return nullptr;
+   };
+   
+   // Smallest valid DICT/DSOB payload (an empty table)
+   const U32 minBlockSize = mReadVersion >= 3 ? 2 : 4;
+   
    IFFBlock scanBlock;
    while (mStream->read(sizeof(IFFBlock), &scanBlock))
    {
       U32 startBlockPos = mStream->getPosition();
+      U32 snapshotId = 0;
 
       switch (scanBlock.ident)
       {
       case DICT_MAGIC:
          // Serialized dictionary
          {
-            if (scanBlock.getRawSize() < 4)
+            if (scanBlock.getRawSize() < minBlockSize)
             {
                scanBlock.seekNext(*mStream, 0);
                continue;
             }
             
+            if (mReadVersion > 1)
+            {
+               readCount(snapshotId);
+            }
+            
             Dictionary::HashTableData* ht = loadHashTable();
             
             if (ht == nullptr)
@@ -3890,18 +4579,47 @@ bool ConsoleSerializer::loadRelatedObjects()
             }
             
             mDictionaryTables.push_back(ht);
+            mDictionaryIds.push_back(snapshotId);
+            scanBlock.seekNext(*mStream, mStream->getPosition() - startBlockPos);
+         }
+         break;
+      case DREF_MAGIC:
+      case DDLT_MAGIC:
+         // Dictionary from previous snapshot
+         {
+            readCount(snapshotId);
+            
+            Dictionary::HashTableData* ht = findBaseTable(snapshotId);
+            if (ht == nullptr)
+            {
+               return false;
+            }
+            
+            if (scanBlock.ident == DDLT_MAGIC &&
+                !applyHashTableDelta(ht))
+            {
+               return false;
+            }
+            
+            mDictionaryTables.push_back(ht);
+            mDictionaryIds.push_back(snapshotId);
             scanBlock.seekNext(*mStream, mStream->getPosition() - startBlockPos);
          }
          break;
       case DSOB_MAGIC:
          // Serialized codeblock
          {
-            if (scanBlock.getRawSize() < 4)
+            if (scanBlock.getRawSize() < minBlockSize)
             {
                scanBlock.seekNext(*mStream, 0);
                continue;
             }
             
+            if (mReadVersion > 1)
+            {
+               readCount(snapshotId);
+            }
+            
             StringTableEntry steFilename = readSTString(mStream);
             StringTableEntry steModPath = readSTString(mStream);
             CodeBlock* block = mTarget->New<CodeBlock>(mTarget, true);
@@ -3914,6 +4632,24 @@ bool ConsoleSerializer::loadRelatedObjects()
             }
             block->incRefCount();
             mCodeBlocks.push_back(block);
+            mCodeBlockIds.push_back(snapshotId);
+            scanBlock.seekNext(*mStream, mStream->getPosition() - startBlockPos);
+         }
+         break;
+      case DSRF_MAGIC:
+         // Codeblock from previous snapshot
+         {
+            readCount(snapshotId);
+            
+            CodeBlock* block = findBaseBlock(snapshotId);
+            if (block == nullptr)
+            {
+               return false;
+            }
+            
+            block->incRefCount();
+            mCodeBlocks.push_back(block);
+            mCodeBlockIds.push_back(snapshotId);
             scanBlock.seekNext(*mStream, mStream->getPosition() - startBlockPos);
          }
          break;
@@ -3934,45 +4670,93 @@ bool ConsoleSerializer::loadRelatedObjects()
 bool ConsoleSerializer::saveRelatedObjects()
 {
    IFFBlock writeBlock;
-   writeBlock.ident = DICT_MAGIC;
    
    for (Dictionary::HashTableData* data : mDictionaryTables)
    {
+      if (data->snapshotId == 0)
+      {
+         data->snapshotId = ++mTarget->mSnapshotIdCounter;
+      }
+      
+      // Tables in the previous snapshot only need their changes written
+      if (canReferencePrevious(data->snapshotGen) && !data->structureChanged)
+      {
+         writeBlock.ident = data->dirty ? DDLT_MAGIC : DREF_MAGIC;
+      }
+      else
+      {
+         writeBlock.ident = DICT_MAGIC;
+      }
+      
+      beginBlock();
       U32 startPos = mStream->getPosition();
       if (!mStream->write(sizeof(IFFBlock), &writeBlock))
       {
          return false;
       }
       
-      writeHashTable(data);
+      writeCount(data->snapshotId);
+      
+      if (writeBlock.ident == DICT_MAGIC)
+      {
+         writeHashTable(data);
+      }
+      else if (writeBlock.ident == DDLT_MAGIC)
+      {
+         writeHashTableDelta(data);
+      }
+      
       writeBlock.updateSize(*mStream, startPos);
       writeBlock.writePad(*mStream);
+      
+      if (!flushBlock())
+      {
+         return false;
+      }
    }
    
-   writeBlock.ident = DSOB_MAGIC;
    for (CodeBlock* block : mCodeBlocks)
    {
+      if (block->snapshotId == 0)
+      {
+         block->snapshotId = ++mTarget->mSnapshotIdCounter;
+      }
+      
+      writeBlock.ident = canReferencePrevious(block->snapshotGen) ? DSRF_MAGIC : DSOB_MAGIC;
+      
+      beginBlock();
       U32 startPos = mStream->getPosition();
       if (!mStream->write(sizeof(IFFBlock), &writeBlock))
       {
          return false;
       }
       
-      mStream->writeString(block->name);
-      mStream->writeString(block->modPath);
-      if (!block->write(*mStream))
+      writeCount(block->snapshotId);
+      
+      if (writeBlock.ident == DSOB_MAGIC)
       {
-         return false;
+         writeSTString(block->name);
+         writeSTString(block->modPath);
+         if (!block->write(*mStream))
+         {
+            return false;
+         }
       }
       
       writeBlock.updateSize(*mStream, startPos);
       writeBlock.writePad(*mStream);
+      
+      if (!flushBlock())
+      {
+         return false;
+      }
    }
    
    // End of list
+   beginBlock();
    writeBlock.ident = EOLB_MAGIC;
    writeBlock.setSize(0);
-   return mStream->write(sizeof(IFFBlock), &writeBlock);
+   return mStream->write(sizeof(IFFBlock), &writeBlock) && flushBlock();
 }
 
 bool ConsoleSerializer::loadFibers()
@@ -4023,6 +4807,7 @@ bool ConsoleSerializer::saveFibers()
    writeBlock.ident = CEOB_MAGIC;
    for (ExprEvalState* state : mFibers)
    {
+      beginBlock();
       U32 startPos = mStream->getPosition();
       if (!mStream->write(sizeof(IFFBlock), &writeBlock))
       {
@@ -4035,18 +4820,161 @@ bool ConsoleSerializer::saveFibers()
       }
       
       writeBlock.updateSize(*mStream, startPos);
+      writeBlock.writePad(*mStream);
+      
+      if (!flushBlock())
+      {
+         return false;
+      }
    }
    
+   beginBlock();
    writeBlock.ident = EOLB_MAGIC;
    writeBlock.setSize(0);
-   return mStream->write(sizeof(IFFBlock), &writeBlock);
+   return mStream->write(sizeof(IFFBlock), &writeBlock) && flushBlock();
 }
 
 const char* ConsoleSerializer::readSTString(Stream* s, bool casesens)
 {
    char buf[256];
-   s->readString(buf);
-   return mTarget->internString(buf, casesens);
+   
+   if (mReadVersion < 3)
+   {
+      s->readString(buf);
+      return mTarget->internString(buf, casesens);
+   }
+   
+   // 0 = new string follows, otherwise index+1 of a previous string
+   U32 index = 0;
+   if (!readVarU32(index))
+   {
+      return nullptr;
+   }
+   
+   if (index == 0)
+   {
+      s->readString(buf);
+      StringTableEntry ste = mTarget->internString(buf, casesens);
+      mReadStrings.push_back(ste);
+      return ste;
+   }
+   
+   return index <= mReadStrings.size() ? mReadStrings[index-1] : nullptr;
+}
+
+bool ConsoleSerializer::writeSTString(const char* str)
+{
+   if (str == nullptr)
+   {
+      str = "";
+   }
+   
+   auto itr = mWriteStrings.find(str);
+   if (itr != mWriteStrings.end())
+   {
+      return writeVarU32(itr->second + 1);
+   }
+   
+   U32 index = (U32)mWriteStrings.size();
+   mWriteStrings[str] = index;
+   writeVarU32(0);
+   mStream->writeString(str);
+   return mStream->getStatus() == Stream::Ok;
+}
+
+bool ConsoleSerializer::readVarU32(U32& value)
+{
+   value = 0;
+   for (U32 shift=0; shift<35; shift += 7)
+   {
+      U8 byte = 0;
+      if (!mStream->read(&byte))
+      {
+         return false;
+      }
+      
+      value |= (U32)(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0)
+      {
+         return true;
+      }
+   }
+   
+   return false;
+}
+
+bool ConsoleSerializer::writeVarU32(U32 value)
+{
+   U8 buf[5];
+   U32 len = 0;
+   
+   do
+   {
+      U8 byte = value & 0x7F;
+      value >>= 7;
+      buf[len++] = byte | (value != 0 ? 0x80 : 0);
+   } while (value != 0);
+   
+   return mStream->write(len, buf);
+}
+
+bool ConsoleSerializer::readCount(U32& value)
+{
+   return mReadVersion >= 3 ? readVarU32(value) : mStream->read(&value);
+}
+
+bool ConsoleSerializer::writeCount(U32 value)
+{
+   return writeVarU32(value);
+}
+
+bool ConsoleSerializer::readIndex(S32& value)
+{
+   if (mReadVersion < 3)
+   {
+      return mStream->read(&value);
+   }
+   
+   U32 encoded = 0;
+   if (!readVarU32(encoded))
+   {
+      return false;
+   }
+   
+   value = (S32)encoded - 1;
+   return true;
+}
+
+bool ConsoleSerializer::writeIndex(S32 value)
+{
+   return writeVarU32((U32)(value + 1));
+}
+
+void ConsoleSerializer::beginBlock()
+{
+   if (mScratch)
+   {
+      mScratch->clear();
+      mStream = mScratch;
+   }
+}
+
+bool ConsoleSerializer::flushBlock()
+{
+   if (mScratch == nullptr)
+   {
+      return true;
+   }
+   
+   mStream = mOutStream;
+   
+   // Discovery pass writes nothing
+   if (mOutStream == nullptr)
+   {
+      return true;
+   }
+   
+   return mOutStream->write(mScratch->getStreamSize(), mScratch->getBuffer());
 }
 
 bool KorkApi::VmInternal::getCurrentFiberFileLine(StringTableEntry* outFile, U32* outLine)
@@ -4059,12 +4987,9 @@ bool KorkApi::VmInternal::getCurrentFiberFileLine(StringTableEntry* outFile, U32
    ConsoleFrame* frame = mCurrentFiberState->vmFrames.back();
    CodeBlock* block = frame->codeBlock;
    
-   U32 line = 0;
-   U32 inst = 0;
-   block->findBreakLine(frame->ip, line, inst);
-   
    *outFile = block->name;
-   *outLine = line;
+   *outLine = block->getLineForIp(frame->ip);
+   return true;
 }
 
 KorkApi::FiberFrameInfo KorkApi::Vm::getCurrentFiberFrameInfo(S32 frameId)
@@ -4100,11 +5025,19 @@ KorkApi::FiberFrameInfo KorkApi::Vm::getCurrentFiberFrameInfo(S32 frameId)
 
 void KorkApi::Vm::enumGlobals(const char* expr, void* userPtr, EnumFuncCallback callback)
 {
+   VmAllocTLS::Scope memScope(mInternal);
    mInternal->mGlobalVars.exportVariables(expr, userPtr, callback);
 }
 
+void KorkApi::Vm::deleteGlobals(const char* expr)
+{
+   VmAllocTLS::Scope memScope(mInternal);
+   mInternal->mGlobalVars.deleteVariables(expr);
+}
+
 bool KorkApi::Vm::enumLocals(void* userPtr, EnumFuncCallback callback, S32 frame)
 {
+   VmAllocTLS::Scope memScope(mInternal);
    U32 frameIdx = frame < 0 ? (U32)(mInternal->mCurrentFiberState->vmFrames.size()-1) : (U32)frame;
    if (frameIdx >= mInternal->mCurrentFiberState->vmFrames.size())
    {
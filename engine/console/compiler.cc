@@ -206,43 +206,106 @@ using namespace Compiler;
 //-------------------------------------------------------------------------
 
 
+static inline U32 compilerStringHash(const char *str, U32 len)
+{
+   U32 hash = 2166136261U;
+   for (U32 i=0; i<len; i++)
+   {
+      hash = (hash ^ (U8)dTolower(str[i])) * 16777619U;
+   }
+   return hash;
+}
+
 U32 CompilerStringTable::add(const char *str, bool caseSens, bool tag)
 {
-   // Is it already in?
+   return addN(str, (U32)strlen(str), caseSens, tag, false);
+}
+
+U32 CompilerStringTable::addN(const char *str, U32 strLen, bool caseSens, bool tag, bool view)
+{
+   if (count >= numBuckets)
+   {
+      rehash(numBuckets == 0 ? 64 : numBuckets * 2);
+   }
+
+   // Is it already in? Chains are kept in insertion order so the first
+   // matching entry wins, same as a walk of the full list.
+   U32 hash = compilerStringHash(str, strLen);
    Entry **walk;
-   for(walk = &list; *walk; walk = &((*walk)->next))
+   for(walk = &buckets[hash & (numBuckets-1)]; *walk; walk = &((*walk)->hashNext))
    {
-      if((*walk)->tag != tag)
+      Entry *e = *walk;
+      if(e->tag != tag || e->hash != hash || e->strLen != strLen)
          continue;
 
       if(caseSens)
       {
-         if(!strcmp((*walk)->string, str))
-            return (*walk)->start;
+         if(!memcmp(e->string, str, strLen))
+            return e->start;
       }
       else
       {
-         if(!strcasecmp((*walk)->string, str))
-            return (*walk)->start;
+         if(!strncasecmp(e->string, str, strLen))
+            return e->start;
       }
    }
 
    // Write it out.
    Entry *newStr = (Entry *) res->consoleAlloc(sizeof(Entry));
    *walk = newStr;
+   *listTail = newStr;
+   listTail = &newStr->next;
    newStr->next = nullptr;
+   newStr->hashNext = nullptr;
+   newStr->hash = hash;
    newStr->start = totalLen;
-   U32 len = strlen(str) + 1;
+   newStr->strLen = strLen;
+   U32 len = strLen + 1;
    if(tag && len < 7) // alloc space for the numeric tag 1 for tag, 5 for # and 1 for nul
       len = 7;
    totalLen += len;
-   newStr->string = (char *) res->consoleAlloc(dAlignSize(len, 8));
    newStr->len = len;
    newStr->tag = tag;
-   memcpy(newStr->string, str, len);
+   count++;
+
+   // Tags are padded out so always need their own storage
+   if (view && len == strLen + 1)
+   {
+      newStr->string = str;
+   }
+   else
+   {
+      char *string = (char *) res->consoleAlloc(dAlignSize(len, 8));
+      memcpy(string, str, strLen);
+      memset(string + strLen, '\0', len - strLen);
+      newStr->string = string;
+   }
+
    return newStr->start;
 }
 
+void CompilerStringTable::rehash(U32 newNumBuckets)
+{
+   buckets = (Entry **) res->consoleAlloc(sizeof(Entry*) * newNumBuckets);
+   memset(buckets, 0, sizeof(Entry*) * newNumBuckets);
+   numBuckets = newNumBuckets;
+
+   // Re-link in list order to keep each chain in insertion order
+   Entry ***tails = (Entry ***) res->consoleAlloc(sizeof(Entry**) * newNumBuckets);
+   for (U32 i=0; i<newNumBuckets; i++)
+   {
+      tails[i] = &buckets[i];
+   }
+
+   for(Entry *walk = list; walk; walk = walk->next)
+   {
+      U32 idx = walk->hash & (newNumBuckets-1);
+      walk->hashNext = nullptr;
+      *tails[idx] = walk;
+      tails[idx] = &walk->hashNext;
+   }
+}
+
 U32 CompilerStringTable::addIntString(U32 value)
 {
    snprintf(buf, sizeof(buf), "%d", value);
@@ -258,6 +321,10 @@ U32 CompilerStringTable::addFloatString(F64 value)
 void CompilerStringTable::reset()
 {
    list = nullptr;
+   listTail = &list;
+   buckets = nullptr;
+   numBuckets = 0;
+   count = 0;
    totalLen = 0;
 }
 
@@ -265,7 +332,10 @@ char *CompilerStringTable::build()
 {
    char *ret = KorkApi::VMem::NewArray<char>(totalLen);
    for(Entry *walk = list; walk; walk = walk->next)
-      strcpy(ret + walk->start, walk->string);
+   {
+      memcpy(ret + walk->start, walk->string, walk->strLen);
+      memset(ret + walk->start + walk->strLen, '\0', walk->len - walk->strLen);
+   }
    return ret;
 }
 
@@ -273,7 +343,11 @@ void CompilerStringTable::write(Stream &st)
 {
    st.write(totalLen);
    for(Entry *walk = list; walk; walk = walk->next)
-      st.write(walk->len, walk->string);
+   {
+      st.write(walk->strLen, walk->string);
+      for (U32 i=walk->strLen; i<walk->len; i++)
+         st.write(U8(0));
+   }
 }
 
 //------------------------------------------------------------
@@ -538,7 +612,7 @@ void CodeStream::fixLoop(U32 loopBlockStart, U32 breakPoint, U32 continuePoint)
 
 //-------------------------------------------------------------------------
   
-void CodeStream::emitCodeStream(U32 *size, U32 **stream, U32 **lineBreaks, U32* numFuncCalls, void*** funcCallsPtr)
+void CodeStream::emitCodeStream(U32 *size, U32 **stream, U32 **lineBreaks, U32* numFuncCalls, void*** funcCallsPtr, U32* numFieldSites)
 {
    // Alloc stream
    U32 numLineBreaks = getNumLineBreaks();
@@ -566,6 +640,9 @@ void CodeStream::emitCodeStream(U32 *size, U32 **stream, U32 **lineBreaks, U32*
    *funcCallsPtr = KorkApi::VMem::NewArray<void*>(mNumFuncCalls);
    memset(*funcCallsPtr, '\0', sizeof(void*) * mNumFuncCalls);
    
+   // Field sites (0 is also reserved)
+   *numFieldSites = mNumFieldSites + 1;
+   
    // Apply patches on top
    for (U32 i=0; i<mPatchList.size(); i++)
    {
@@ -583,6 +660,8 @@ void CodeStream::reset()
    mFixLoopStack.clear();
    mFixList.clear();
    mBreakLines.clear();
+   mNumFuncCalls = 0;
+   mNumFieldSites = 0;
    
    // Pop down to one code block
    CodeData *itr = mCode ? mCode->next : nullptr;
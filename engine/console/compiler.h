@@ -43,6 +43,7 @@ class Stream;
 #include "console/codeBlock.h"
 
 #include "core/dataChunker.h"
+#include "console/astArena.h"
 #include "embed/compilerOpcodes.h"
 
 struct StmtNode;
@@ -107,31 +108,48 @@ namespace Compiler
    {
       struct Entry
       {
-         char *string;
+         const char *string;
          U32 start;
          U32 len;
+         U32 strLen;
+         U32 hash; ///< case-folded so case insensitive lookups share a chain
          bool tag;
          Entry *next;
+         Entry *hashNext;
       };
       U32 totalLen;
       Resources* res;
       Entry *list;
+      Entry **listTail;
+      Entry **buckets;
+      U32 numBuckets;
+      U32 count;
 
       CompilerStringTable(Resources* _res) : res(_res)
       {
          totalLen = 0;
          list = nullptr;
+         listTail = &list;
+         buckets = nullptr;
+         numBuckets = 0;
+         count = 0;
          memset(buf, 0, sizeof(buf));
       }
 
       char buf[256];
 
       U32 add(const char *str, bool caseSens = true, bool tag = false);
+      /// Adds str[0..len), which must be followed by a nul. If view is set the
+      /// table references str directly, so it must outlive build() / write().
+      U32 addN(const char *str, U32 len, bool caseSens = true, bool tag = false, bool view = false);
       U32 addIntString(U32 value);
       U32 addFloatString(F64 value);
       void reset();
       char *build();
       void write(Stream &st);
+
+   protected:
+      void rehash(U32 newNumBuckets);
    };
 
    //------------------------------------------------------------
@@ -204,6 +222,7 @@ namespace Compiler
       CompilerStringTable *currentStringTable, globalStringTable, functionStringTable;
       CompilerFloatTable  *currentFloatTable,  globalFloatTable,  functionFloatTable;
       KorkApi::VMChunker   consoleAllocator;
+      AstArena             astArena;
       CompilerIdentTable   identTable;
       CompilerIdentTable   typeTable;
 
@@ -221,6 +240,7 @@ namespace Compiler
       bool allowTypes;
       bool allowSignals;
       bool allowStringInterpolation;
+      bool streamingCompile; ///< AST nodes are released after each top level declaration
 
       void (*STEtoCode)(Resources* res, StringTableEntry ste, U32 ip, U32 *ptr);
 
@@ -247,7 +267,10 @@ namespace Compiler
       void resetTables();
 
       void *consoleAlloc(U32 size) { return consoleAllocator.alloc(size);  }
-      void consoleAllocReset()     { consoleAllocator.freeBlocks(); }
+      void consoleAllocReset()     { consoleAllocator.freeBlocks(); astArena.reset(); }
+
+      /// Allocates AST node memory. Throws a parse error if the arena limit is hit.
+      void *astAlloc(U32 size);
 
       void pushLocalVarContext(); 
       void popLocalVarContext();
@@ -266,6 +289,7 @@ namespace Compiler
          allowTuples = false;
          allowTypes = false;
          allowSignals = false;
+         streamingCompile = false;
          currentASTGen = nullptr;
          emptyString = nullptr;
          logFn = nullptr;
@@ -348,13 +372,14 @@ protected:
    U32 mCurrentReturnType;
    
    U32 mNumFuncCalls;
+   U32 mNumFieldSites;
    
 public:
    Compiler::Resources* mResources;
    
 public:
 
-   CodeStream(Compiler::Resources* res) : mCode(0), mCodeHead(nullptr), mCodePos(0), mFilename(nullptr), mResources(res)
+   CodeStream(Compiler::Resources* res) : mCode(0), mCodeHead(nullptr), mCodePos(0), mFilename(nullptr), mNumFuncCalls(0), mNumFieldSites(0), mResources(res)
    {
    }
    
@@ -405,6 +430,21 @@ public:
       return mCodePos-2;
    }
    
+   /// Emits a field name followed by a new field site index (see CodeBlock::getFieldSite)
+   inline U32 emitFieldSTE(const char *code)
+   {
+      U32* ptr = (U32*)allocCode(8);
+      ptr[0] = 0;
+      ptr[1] = 0;
+      mResources->STEtoCode(mResources, code, mCodePos, (U32*)ptr);
+      ptr[1] = ++mNumFieldSites;
+#ifdef DEBUG_CODESTREAM
+      printf("code[%u] = %s (site %u)\n", mCodePos, code, ptr[1]);
+#endif
+      mCodePos += 2;
+      return mCodePos-2;
+   }
+   
    inline U32 tell()
    {
       return mCodePos;
@@ -464,7 +504,7 @@ public:
       return mBreakLines.size() / 2;
    }
    
-   void emitCodeStream(U32 *size, U32 **stream, U32 **lineBreaks, U32* numFuncCalls, void*** funcCallsPtr);
+   void emitCodeStream(U32 *size, U32 **stream, U32 **lineBreaks, U32* numFuncCalls, void*** funcCallsPtr, U32* numFieldSites);
    
    void reset();
 
@@ -37,40 +37,166 @@
 #include "console/consoleInternal.h"
 #include "console/compiler.h"
 #include "core/escape.h"
+#include <set>
 
 //#define DEBUG_SPEW
 
 
 #define ST_INIT_SIZE 15
 
+//---------------------------------------------------------------
+//
+// Name index
+//
+//---------------------------------------------------------------
+
+struct Dictionary::NameIndex
+{
+   struct Item
+   {
+      const char* name;
+      void* ptr;     ///< Entry* or ArrayData*
+      bool isArray;
+   };
+   
+   /// Same order as exportVariables; a plain variable sorts before an array of the same name.
+   struct ItemLess
+   {
+      bool operator()(const Item& a, const Item& b) const
+      {
+         S32 cmp = strcasecmp(a.name, b.name);
+         return cmp != 0 ? cmp < 0 : (a.isArray < b.isArray);
+      }
+   };
+   
+   typedef std::set<Item, ItemLess, KorkApi::TlsVmAllocator<Item> > ItemSet;
+   ItemSet items;
+};
+
+void Dictionary::enableNameIndex()
+{
+   if (mHashTable->nameIndex)
+      return;
+   
+   mHashTable->nameIndex = mVm->New<NameIndex>();
+   
+   for (S32 i = 0; i < mHashTable->size; i++)
+   {
+      for (Entry* walk = mHashTable->data[i]; walk; walk = walk->nextEntry)
+         indexInsert(walk->name, walk, false);
+   }
+   
+   for (S32 i = 0; i < mHashTable->arraySize; i++)
+   {
+      for (ArrayData* array = mHashTable->arrays[i]; array; array = array->nextArray)
+         indexInsert(array->name, array, true);
+   }
+}
+
+void Dictionary::indexInsert(const char* name, void* ptr, bool isArray)
+{
+   KorkApi::VmAllocTLS::Scope memScope(mVm);
+   NameIndex::Item item = { name, ptr, isArray };
+   mHashTable->nameIndex->items.insert(item);
+}
+
+void Dictionary::indexErase(const char* name, void* ptr, bool isArray)
+{
+   KorkApi::VmAllocTLS::Scope memScope(mVm);
+   NameIndex::Item item = { name, ptr, isArray };
+   mHashTable->nameIndex->items.erase(item);
+}
+
+template<typename F> void Dictionary::visitIndexedPrefix(const char* prefix, U32 prefixLen, F fn)
+{
+   char buffer[1024];
+   char nameBuffer[1024];
+   
+   if (prefixLen >= sizeof(buffer))
+      prefixLen = sizeof(buffer) - 1;
+   memcpy(buffer, prefix, prefixLen);
+   buffer[prefixLen] = '\0';
+   
+   NameIndex::ItemSet& items = mHashTable->nameIndex->items;
+   
+   // Variables and arrays whose names start with prefix are one range of the index
+   NameIndex::Item first = { buffer, nullptr, false };
+   for (auto itr = items.lower_bound(first); itr != items.end(); ++itr)
+   {
+      if (strncasecmp(itr->name, buffer, prefixLen) != 0)
+         break;
+      
+      if (itr->isArray)
+         forEachElement((ArrayData*)itr->ptr, fn);
+      else
+         fn((Entry*)itr->ptr);
+   }
+   
+   // Arrays named by part of prefix may have elements whose key completes it
+   for (S32 len = (S32)prefixLen - 1; len > 0 && mHashTable->arrayCount != 0; len--)
+   {
+      char save = buffer[len];
+      buffer[len] = '\0';
+      NameIndex::Item arrayItem = { buffer, nullptr, true };
+      auto itr = items.find(arrayItem);
+      buffer[len] = save;
+      
+      if (itr == items.end())
+         continue;
+      
+      forEachElement((ArrayData*)itr->ptr, [&](Entry* e) {
+         if (strncasecmp(getEntryName(e, nameBuffer, sizeof(nameBuffer)), buffer, prefixLen) == 0)
+            fn(e);
+      });
+   }
+}
+
 //---------------------------------------------------------------
 //
 // Dictionary functions
 //
 //---------------------------------------------------------------
 
-bool varCompare(const Dictionary::Entry* a, const Dictionary::Entry* b)
+struct ExportEntry
+{
+   const char* name;
+   Dictionary::Entry* entry;
+};
+
+bool varCompare(const ExportEntry& a, const ExportEntry& b)
 {
-    return strcasecmp(a->name, b->name) < 0;
+    return strcasecmp(a.name, b.name) < 0;
 }
 
 void Dictionary::exportVariables(const char *varString, void* userPtr, KorkApi::EnumFuncCallback callback)
 {
    const char *searchStr = varString;
-   KorkApi::Vector<Entry *> sortList;
+   KorkApi::Vector<ExportEntry> sortList;
+   KorkApi::Deque<KorkApi::String> elementNames;
+   char nameBuffer[1024];
    
-   for(S32 i = 0; i < mHashTable->size; i++)
-   {
-      Entry *walk = mHashTable->data[i];
-      while(walk)
+   auto addMatch = [&](Entry* walk) {
+      const char* name = getEntryName(walk, nameBuffer, sizeof(nameBuffer));
+      if (varString == nullptr || FindMatch::isMatch((char *) searchStr, (char *) name))
       {
-         if (varString == nullptr || FindMatch::isMatch((char *) searchStr, (char *) walk->name))
+         if (walk->isArrayElement())
          {
-            sortList.push_back(walk);
+            elementNames.push_back(KorkApi::String(name));
+            name = elementNames.back().c_str();
          }
          
-         walk = walk->nextEntry;
+         ExportEntry item = { name, walk };
+         sortList.push_back(item);
       }
+   };
+   
+   if (mHashTable->nameIndex)
+   {
+      visitIndexedPrefix(searchStr ? searchStr : "", searchStr ? (U32)strcspn(searchStr, "*?") : 0, addMatch);
+   }
+   else
+   {
+      forEachEntry(mHashTable, addMatch);
    }
    
    if(!sortList.size())
@@ -78,9 +204,9 @@ void Dictionary::exportVariables(const char *varString, void* userPtr, KorkApi::
    
    std::sort(sortList.begin(), sortList.end(), varCompare);
    
-   for(Entry* s : sortList)
+   for(const ExportEntry& s : sortList)
    {
-      callback(mVm->mVM, userPtr, s->name, s->mConsoleValue);
+      callback(mVm->mVM, userPtr, s.name, s.entry->mConsoleValue);
    }
 }
 
@@ -88,6 +214,20 @@ void Dictionary::deleteVariables(const char *varString)
 {
    const char *searchStr = varString;
    
+   if (mHashTable->nameIndex)
+   {
+      KorkApi::Vector<Entry*> matched;
+      char nameBuffer[1024];
+      visitIndexedPrefix(searchStr, (U32)strcspn(searchStr, "*?"), [&](Entry* walk) {
+         if (FindMatch::isMatch((char *) searchStr, (char *) getEntryName(walk, nameBuffer, sizeof(nameBuffer))))
+            matched.push_back(walk);
+      });
+      
+      for (Entry* ent : matched)
+         remove(ent);
+      return;
+   }
+   
    for(S32 i = 0; i < mHashTable->size; i++)
    {
       Entry *walk = mHashTable->data[i];
@@ -99,6 +239,23 @@ void Dictionary::deleteVariables(const char *varString)
             remove(matchedEntry); // assumes remove() is a stable remove (will not reorder entries on remove)
       }
    }
+   
+   if (mHashTable->elementCount == 0)
+      return;
+   
+   // Removing the last element frees its array, so collect matches first
+   KorkApi::Vector<Entry*> matched;
+   char nameBuffer[1024];
+   forEachEntry(mHashTable, [&](Entry* walk) {
+      if (walk->isArrayElement() &&
+          FindMatch::isMatch((char *) searchStr, (char *) getEntryName(walk, nameBuffer, sizeof(nameBuffer))))
+      {
+         matched.push_back(walk);
+      }
+   });
+   
+   for (Entry* ent : matched)
+      remove(ent);
 }
 
 U32 HashPointer(StringTableEntry ptr)
@@ -106,7 +263,7 @@ U32 HashPointer(StringTableEntry ptr)
    return (U32)(((dsize_t)ptr) >> 2);
 }
 
-Dictionary::Entry *Dictionary::lookup(StringTableEntry name)
+Dictionary::Entry *Dictionary::lookupPlain(StringTableEntry name)
 {
    Entry *walk = mHashTable->data[HashPointer(name) % mHashTable->size];
    while(walk)
@@ -120,17 +277,22 @@ Dictionary::Entry *Dictionary::lookup(StringTableEntry name)
    return nullptr;
 }
 
-Dictionary::Entry *Dictionary::add(StringTableEntry name)
+Dictionary::Entry *Dictionary::lookup(StringTableEntry name)
 {
-   Entry *walk = mHashTable->data[HashPointer(name) % mHashTable->size];
-   while(walk)
+   Entry *ret = lookupPlain(name);
+   if (ret == nullptr && mHashTable->elementCount != 0)
    {
-      if(walk->name == name)
-         return walk;
-      else
-         walk = walk->nextEntry;
+      ret = lookupAlias(name, nullptr);
    }
-   Entry *ret;
+   return ret;
+}
+
+Dictionary::Entry *Dictionary::add(StringTableEntry name)
+{
+   Entry *ret = lookup(name);
+   if (ret)
+      return ret;
+   
    mHashTable->count++;
    
    if(mHashTable->count > mHashTable->size * 2)
@@ -166,22 +328,430 @@ Dictionary::Entry *Dictionary::add(StringTableEntry name)
    U32 idx = HashPointer(name) % mHashTable->size;
    ret->nextEntry = mHashTable->data[idx];
    mHashTable->data[idx] = ret;
+   if (mHashTable->nameIndex)
+      indexInsert(name, ret, false);
+   markDirty(ret);
    return ret;
 }
 
 // deleteVariables() assumes remove() is a stable remove (will not reorder entries on remove)
 void Dictionary::remove(Dictionary::Entry *ent)
 {
+   if (ent->isArrayElement())
+   {
+      removeElement(ent);
+      return;
+   }
+   
    Entry **walk = &mHashTable->data[HashPointer(ent->name) % mHashTable->size];
    while(*walk != ent)
       walk = &((*walk)->nextEntry);
    
    *walk = (ent->nextEntry);
+   if (mHashTable->nameIndex)
+      indexErase(ent->name, ent, false);
    clearEntry(ent);
    mVm->Delete(ent);
    mHashTable->count--;
+   mHashTable->structureChanged = true;
 }
 
+//---------------------------------------------------------------
+
+enum
+{
+   ARRAY_TABLE_INIT_SIZE = 7,
+   ARRAY_KEYED_INIT_SIZE = 15,
+   ARRAY_DENSE_INIT_SIZE = 16,
+   ARRAY_DENSE_MIN_LIMIT = 64,      ///< Indices below this may always be dense
+   ARRAY_DENSE_MAX_DIGITS = 9,
+   ARRAY_NAME_LEN_SLOTS = 64        ///< Last slot counts all longer names
+};
+
+static inline U32 getArrayNameLenSlot(U32 len)
+{
+   return len < ARRAY_NAME_LEN_SLOTS-1 ? len : ARRAY_NAME_LEN_SLOTS-1;
+}
+
+/// Returns true if key is a canonical non-negative integer, i.e. "0" or "12" but not "012" or "+1".
+static bool getArrayDenseIndex(const char* key, U32& index)
+{
+   if (key[0] < '0' || key[0] > '9' || (key[0] == '0' && key[1] != '\0'))
+      return false;
+   
+   U32 value = 0;
+   U32 digits = 0;
+   for (const char* c = key; *c; c++, digits++)
+   {
+      if (*c < '0' || *c > '9' || digits == ARRAY_DENSE_MAX_DIGITS)
+         return false;
+      value = (value * 10) + (*c - '0');
+   }
+   
+   index = value;
+   return true;
+}
+
+static U32 hashArrayKey(const char* key)
+{
+   U32 hash = 2166136261U;
+   for (const char* c = key; *c; c++)
+   {
+      hash = (hash ^ (U8)dTolower(*c)) * 16777619U;
+   }
+   return hash;
+}
+
+Dictionary::ArrayData* Dictionary::findArray(StringTableEntry name)
+{
+   if (mHashTable->arrays == nullptr)
+      return nullptr;
+   
+   for (ArrayData* walk = mHashTable->arrays[HashPointer(name) % mHashTable->arraySize]; walk; walk = walk->nextArray)
+   {
+      if (walk->name == name)
+         return walk;
+   }
+   
+   return nullptr;
+}
+
+Dictionary::ArrayData* Dictionary::createArray(StringTableEntry name)
+{
+   HashTableData* ht = mHashTable;
+   
+   if (ht->arrays == nullptr)
+   {
+      ht->arraySize = ARRAY_TABLE_INIT_SIZE;
+      ht->arrays = mVm->NewArray<ArrayData*>(ht->arraySize);
+      for (S32 i = 0; i < ht->arraySize; i++)
+         ht->arrays[i] = nullptr;
+      ht->arrayNameLens = mVm->NewArray<U32>(ARRAY_NAME_LEN_SLOTS);
+      for (U32 i = 0; i < ARRAY_NAME_LEN_SLOTS; i++)
+         ht->arrayNameLens[i] = 0;
+   }
+   else if (ht->arrayCount + 1 > ht->arraySize * 2)
+   {
+      S32 newSize = ht->arraySize * 4 - 1;
+      ArrayData** newArrays = mVm->NewArray<ArrayData*>(newSize);
+      for (S32 i = 0; i < newSize; i++)
+         newArrays[i] = nullptr;
+      
+      for (S32 i = 0; i < ht->arraySize; i++)
+      {
+         ArrayData* walk = ht->arrays[i];
+         while (walk)
+         {
+            ArrayData* next = walk->nextArray;
+            U32 idx = HashPointer(walk->name) % newSize;
+            walk->nextArray = newArrays[idx];
+            newArrays[idx] = walk;
+            walk = next;
+         }
+      }
+      
+      mVm->DeleteArray(ht->arrays);
+      ht->arrays = newArrays;
+      ht->arraySize = newSize;
+   }
+   
+   ArrayData* array = mVm->New<ArrayData>();
+   array->name = name;
+   array->dense = nullptr;
+   array->keyed = nullptr;
+   array->denseSize = 0;
+   array->keyedSize = 0;
+   array->keyedCount = 0;
+   array->count = 0;
+   
+   U32 idx = HashPointer(name) % ht->arraySize;
+   array->nextArray = ht->arrays[idx];
+   ht->arrays[idx] = array;
+   ht->arrayCount++;
+   ht->arrayNameLens[getArrayNameLenSlot((U32)strlen(name))]++;
+   if (ht->nameIndex)
+      indexInsert(name, array, true);
+   return array;
+}
+
+void Dictionary::freeArray(ArrayData* array)
+{
+   for (U32 i = 0; i < array->denseSize; i++)
+   {
+      if (array->dense[i])
+      {
+         clearEntry(array->dense[i]);
+         mVm->Delete(array->dense[i]);
+      }
+   }
+   
+   for (U32 i = 0; i < array->keyedSize; i++)
+   {
+      Entry* walk = array->keyed[i];
+      while (walk)
+      {
+         Entry* next = walk->nextEntry;
+         clearEntry(walk);
+         mVm->DeleteArray(walk->mArrayKey);
+         mVm->Delete(walk);
+         walk = next;
+      }
+   }
+   
+   mHashTable->elementCount -= array->count;
+   
+   if (array->dense)
+      mVm->DeleteArray(array->dense);
+   if (array->keyed)
+      mVm->DeleteArray(array->keyed);
+   mVm->Delete(array);
+}
+
+Dictionary::Entry* Dictionary::findElement(ArrayData* array, const char* key)
+{
+   U32 index = 0;
+   if (getArrayDenseIndex(key, index) && index < array->denseSize && array->dense[index])
+   {
+      return array->dense[index];
+   }
+   
+   if (array->keyedCount == 0)
+   {
+      return nullptr;
+   }
+   
+   U32 hash = hashArrayKey(key);
+   for (Entry* walk = array->keyed[hash % array->keyedSize]; walk; walk = walk->nextEntry)
+   {
+      if (walk->mArrayIndex == hash && strcasecmp(walk->mArrayKey, key) == 0)
+         return walk;
+   }
+   
+   return nullptr;
+}
+
+Dictionary::Entry* Dictionary::createElement(ArrayData* array, const char* key)
+{
+   Entry* ret = mVm->New<Entry>(array->name);
+   ret->mArray = array;
+   
+   U32 index = 0;
+   if (getArrayDenseIndex(key, index))
+   {
+      // Only grow for reasonably packed indices, sparse ones go in the keyed table
+      U32 limit = array->denseSize * 2;
+      if (limit < ARRAY_DENSE_MIN_LIMIT)
+         limit = ARRAY_DENSE_MIN_LIMIT;
+      
+      if (index >= array->denseSize && index < limit)
+      {
+         U32 newSize = array->denseSize ? array->denseSize * 2 : ARRAY_DENSE_INIT_SIZE;
+         while (newSize <= index)
+            newSize *= 2;
+         
+         Entry** newDense = mVm->NewArray<Entry*>(newSize);
+         for (U32 i = 0; i < array->denseSize; i++)
+            newDense[i] = array->dense[i];
+         for (U32 i = array->denseSize; i < newSize; i++)
+            newDense[i] = nullptr;
+         
+         if (array->dense)
+            mVm->DeleteArray(array->dense);
+         array->dense = newDense;
+         array->denseSize = newSize;
+      }
+      
+      if (index < array->denseSize)
+      {
+         ret->mArrayIndex = index;
+         array->dense[index] = ret;
+         array->count++;
+         mHashTable->elementCount++;
+         markDirty(ret);
+         return ret;
+      }
+   }
+   
+   if (array->keyed == nullptr)
+   {
+      array->keyedSize = ARRAY_KEYED_INIT_SIZE;
+      array->keyed = mVm->NewArray<Entry*>(array->keyedSize);
+      for (U32 i = 0; i < array->keyedSize; i++)
+         array->keyed[i] = nullptr;
+   }
+   else if (array->keyedCount + 1 > array->keyedSize * 2)
+   {
+      U32 newSize = array->keyedSize * 4 - 1;
+      Entry** newKeyed = mVm->NewArray<Entry*>(newSize);
+      for (U32 i = 0; i < newSize; i++)
+         newKeyed[i] = nullptr;
+      
+      for (U32 i = 0; i < array->keyedSize; i++)
+      {
+         Entry* walk = array->keyed[i];
+         while (walk)
+         {
+            Entry* next = walk->nextEntry;
+            U32 idx = walk->mArrayIndex % newSize;
+            walk->nextEntry = newKeyed[idx];
+            newKeyed[idx] = walk;
+            walk = next;
+         }
+      }
+      
+      mVm->DeleteArray(array->keyed);
+      array->keyed = newKeyed;
+      array->keyedSize = newSize;
+   }
+   
+   U32 keyLen = (U32)strlen(key);
+   ret->mArrayKey = mVm->NewArray<char>(keyLen + 1);
+   memcpy(ret->mArrayKey, key, keyLen + 1);
+   ret->mArrayIndex = hashArrayKey(key);
+   
+   U32 idx = ret->mArrayIndex % array->keyedSize;
+   ret->nextEntry = array->keyed[idx];
+   array->keyed[idx] = ret;
+   array->keyedCount++;
+   array->count++;
+   mHashTable->elementCount++;
+   markDirty(ret);
+   return ret;
+}
+
+void Dictionary::removeElement(Entry* ent)
+{
+   ArrayData* array = ent->mArray;
+   
+   if (ent->mArrayKey == nullptr)
+   {
+      array->dense[ent->mArrayIndex] = nullptr;
+   }
+   else
+   {
+      Entry **walk = &array->keyed[ent->mArrayIndex % array->keyedSize];
+      while(*walk != ent)
+         walk = &((*walk)->nextEntry);
+      *walk = ent->nextEntry;
+      array->keyedCount--;
+      mVm->DeleteArray(ent->mArrayKey);
+   }
+   
+   clearEntry(ent);
+   mVm->Delete(ent);
+   array->count--;
+   mHashTable->elementCount--;
+   mHashTable->structureChanged = true;
+   
+   if (array->count == 0)
+   {
+      ArrayData **walk = &mHashTable->arrays[HashPointer(array->name) % mHashTable->arraySize];
+      while(*walk != array)
+         walk = &((*walk)->nextArray);
+      *walk = array->nextArray;
+      mHashTable->arrayCount--;
+      mHashTable->arrayNameLens[getArrayNameLenSlot((U32)strlen(array->name))]--;
+      if (mHashTable->nameIndex)
+         indexErase(array->name, array, true);
+      freeArray(array);
+   }
+}
+
+Dictionary::Entry* Dictionary::lookupAlias(const char* name, ArrayData* skip)
+{
+   // Any array whose name prefixes name may hold it as an element. Only
+   // prefix lengths which some array name has need to be looked up.
+   U32 nameLen = (U32)strlen(name);
+   for (U32 len = 1; len < nameLen; len++)
+   {
+      U32 slot = getArrayNameLenSlot(len);
+      if (mHashTable->arrayNameLens[slot] == 0)
+      {
+         if (slot == ARRAY_NAME_LEN_SLOTS-1)
+            break;
+         continue;
+      }
+      
+      StringTableEntry prefix = mVm->lookupStringN(name, len, false);
+      ArrayData* array = prefix ? findArray(prefix) : nullptr;
+      if (array == nullptr || array == skip)
+         continue;
+      
+      Entry* ret = findElement(array, name + len);
+      if (ret)
+         return ret;
+   }
+   
+   return nullptr;
+}
+
+Dictionary::Entry* Dictionary::lookupArray(StringTableEntry name, const char* key)
+{
+   if (key[0] == '\0')
+   {
+      return lookup(name);
+   }
+   
+   ArrayData* array = findArray(name);
+   if (array)
+   {
+      Entry* ret = findElement(array, key);
+      if (ret)
+         return ret;
+   }
+   
+   // Not in the array, but could still exist under its composite name
+   char buffer[1024];
+   S32 len = snprintf(buffer, sizeof(buffer), "%s%s", name, key);
+   if (len < 0 || len >= (S32)sizeof(buffer))
+   {
+      return nullptr;
+   }
+   
+   StringTableEntry composite = mVm->lookupString(buffer, false);
+   Entry* ret = composite ? lookupPlain(composite) : nullptr;
+   if (ret == nullptr && mHashTable->arrayCount > (array ? 1 : 0))
+   {
+      ret = lookupAlias(buffer, array);
+   }
+   
+   return ret;
+}
+
+Dictionary::Entry* Dictionary::addArray(StringTableEntry name, const char* key)
+{
+   if (key[0] == '\0')
+   {
+      return add(name);
+   }
+   
+   Entry* ret = lookupArray(name, key);
+   if (ret)
+      return ret;
+   
+   ArrayData* array = findArray(name);
+   if (array == nullptr)
+      array = createArray(name);
+   
+   return createElement(array, key);
+}
+
+const char* Dictionary::getEntryName(Entry* e, char* buffer, U32 bufferSize)
+{
+   if (!e->isArrayElement())
+   {
+      return e->name;
+   }
+   
+   if (e->mArrayKey)
+      snprintf(buffer, bufferSize, "%s%s", e->name, e->mArrayKey);
+   else
+      snprintf(buffer, bufferSize, "%s%u", e->name, e->mArrayIndex);
+   return buffer;
+}
+
+//---------------------------------------------------------------
+
 Dictionary::Dictionary()
 :  mHashTable( nullptr )
 {
@@ -207,6 +777,16 @@ void Dictionary::setState(KorkApi::VmInternal *state, Dictionary::HashTableData*
       mHashTable->owner = this;
       mHashTable->count = 0;
       mHashTable->size = ST_INIT_SIZE;
+      mHashTable->snapshotId = 0;
+      mHashTable->snapshotGen = 0;
+      mHashTable->dirty = false;
+      mHashTable->structureChanged = false;
+      mHashTable->arrays = nullptr;
+      mHashTable->arrayNameLens = nullptr;
+      mHashTable->arraySize = 0;
+      mHashTable->arrayCount = 0;
+      mHashTable->elementCount = 0;
+      mHashTable->nameIndex = nullptr;
       mHashTable->data = mVm->NewArray<Entry*>(mHashTable->size);
       
       for(S32 i = 0; i < mHashTable->size; i++)
@@ -219,6 +799,11 @@ Dictionary::~Dictionary()
    if ( mHashTable->owner == this )
    {
       reset();
+      if (mHashTable->nameIndex)
+      {
+         KorkApi::VmAllocTLS::Scope memScope(mVm);
+         mVm->Delete(mHashTable->nameIndex);
+      }
       mVm->DeleteArray(mHashTable->data);
       mVm->Delete(mHashTable);
    }
@@ -241,27 +826,89 @@ void Dictionary::reset()
       }
       mHashTable->data[i] = nullptr;
    }
+   
+   for(i = 0; i < mHashTable->arraySize; i++)
+   {
+      ArrayData* array = mHashTable->arrays[i];
+      while(array)
+      {
+         ArrayData* next = array->nextArray;
+         freeArray(array);
+         array = next;
+      }
+   }
+   
+   if (mHashTable->arrays)
+   {
+      mVm->DeleteArray(mHashTable->arrays);
+      mVm->DeleteArray(mHashTable->arrayNameLens);
+      mHashTable->arrays = nullptr;
+      mHashTable->arrayNameLens = nullptr;
+   }
+   
+   if (mHashTable->nameIndex)
+   {
+      KorkApi::VmAllocTLS::Scope memScope(mVm);
+      mHashTable->nameIndex->items.clear();
+   }
+   
    mHashTable->size = ST_INIT_SIZE;
    mHashTable->count = 0;
+   mHashTable->arraySize = 0;
+   mHashTable->arrayCount = 0;
+   mHashTable->elementCount = 0;
+   mHashTable->structureChanged = true;
+}
+
+void Dictionary::clearDirty(HashTableData* ht)
+{
+   if (ht->dirty)
+   {
+      forEachEntry(ht, [](Entry* walk) {
+         walk->mDirty = false;
+      });
+   }
+   
+   ht->dirty = false;
+   ht->structureChanged = false;
 }
 
 
 const char *Dictionary::tabComplete(const char *prevText, S32 baseLen, bool fForward)
 {
-   S32 i;
-   
    const char *bestMatch = nullptr;
-   for(i = 0; i < mHashTable->size; i++)
-   {
-      Entry *walk = mHashTable->data[i];
-      while(walk)
+   
+   // Element names only exist while completing, so intern the one we return
+   char bestElement[1024];
+   char nameBuffer[1024];
+   
+   auto checkMatch = [&](Entry* walk) {
+      const char* name = getEntryName(walk, nameBuffer, sizeof(nameBuffer));
+      if (mVm->mNSState.canTabComplete(prevText, bestMatch, name, baseLen, fForward))
       {
-         if (mVm->mNSState.canTabComplete(prevText, bestMatch, walk->name, baseLen, fForward))
+         if (walk->isArrayElement())
+         {
+            strcpy(bestElement, name);
+            bestMatch = bestElement;
+         }
+         else
+         {
             bestMatch = walk->name;
-         walk = walk->nextEntry;
+         }
       }
+   };
+   
+   if (mHashTable->nameIndex)
+   {
+      U32 prefixLen = (U32)strlen(prevText);
+      visitIndexedPrefix(prevText, baseLen < (S32)prefixLen ? (U32)baseLen : prefixLen, checkMatch);
    }
-   return bestMatch;
+   else
+   {
+      forEachEntry(mHashTable, checkMatch);
+   }
+   
+   return bestMatch == bestElement ? mVm->internString(bestElement, false) : bestMatch;
 }
 
 
@@ -275,6 +922,10 @@ Dictionary::Entry::Entry(StringTableEntry in_name)
    mIsConstant = false;
    mIsRegistered = false;
    mEnforcedType = 0;
+   mDirty = false;
+   mArray = nullptr;
+   mArrayKey = nullptr;
+   mArrayIndex = 0;
 
    mConsoleValue = KorkApi::ConsoleValue();
    mHeapAlloc = nullptr;
@@ -347,12 +998,73 @@ void Dictionary::clearEntry(Entry* e)
    }
 }
 
-void Dictionary::setEntryStringValue(Dictionary::Entry* e, const char * value)
+void Dictionary::setEntryStringValue(Dictionary::Entry* e, const char * value, U32 len)
 {
-   KorkApi::TypeStorageInterface inputStorage = KorkApi::CreateRegisterStorageFromArg(mVm, KorkApi::ConsoleValue::makeString(value));
+   KorkApi::TypeStorageInterface inputStorage = KorkApi::CreateRegisterStorageFromArg(mVm, KorkApi::ConsoleValue::makeStringLen(value, value ? len : KorkApi::ConsoleValue::UnknownLen));
    return setEntryTypeValue(e, KorkApi::ConsoleValue::TypeInternalString, &inputStorage);
 }
 
+void Dictionary::appendEntryString(Dictionary::Entry* e, const char *value, U32 valueLen, char appendChar)
+{
+   KorkApi::ConsoleValue& cv = e->mConsoleValue;
+   const bool heapString = e->mHeapAlloc &&
+                           !e->mIsConstant &&
+                           !e->mIsRegistered &&
+                           e->mEnforcedType == 0 &&
+                           cv.typeId == KorkApi::ConsoleValue::TypeInternalString &&
+                           cv.getZone() == KorkApi::ConsoleValue::ZoneVmHeap &&
+                           cv.cvalue == (U64)e->mHeapAlloc->ptr();
+   
+   if (valueLen == KorkApi::ConsoleValue::UnknownLen)
+      valueLen = (U32)strlen(value);
+   const U32 extraLen = valueLen + (appendChar ? 1 : 0);
+   
+   if (!heapString)
+   {
+      // Assign the concatenation normally; the next append will be in place
+      const char* current = getEntryStringValue(e);
+      if (current == nullptr)
+         current = "";
+      const U32 currentLen = cv.hasLen() ? cv.len : (U32)strlen(current);
+      
+      char* buffer = mVm->NewArray<char>(currentLen + extraLen + 1);
+      memcpy(buffer, current, currentLen);
+      if (appendChar)
+         buffer[currentLen] = appendChar;
+      memcpy(buffer + currentLen + (appendChar ? 1 : 0), value, valueLen + 1);
+      setEntryStringValue(e, buffer, currentLen + extraLen);
+      mVm->DeleteArray(buffer);
+      return;
+   }
+   
+   markDirty(e);
+   
+   char* ptr = (char*)e->mHeapAlloc->ptr();
+   U32 len = cv.len;
+   if (len == KorkApi::ConsoleValue::UnknownLen || len >= e->mHeapAlloc->size || ptr[len] != '\0')
+      len = (U32)strlen(ptr);
+   
+   const U32 needed = len + extraLen + 1;
+   if (needed > e->mHeapAlloc->size)
+   {
+      U32 newSize = getMax(needed, e->mHeapAlloc->size * 2);
+      newSize = getMax(newSize, (U32)64);
+      
+      KorkApi::ConsoleHeapAllocRef newAlloc = mVm->createHeapRef(newSize);
+      memcpy(newAlloc->ptr(), ptr, len);
+      mVm->releaseHeapRef(e->mHeapAlloc);
+      
+      e->mHeapAlloc = newAlloc;
+      ptr = (char*)newAlloc->ptr();
+      cv.cvalue = (U64)ptr;
+   }
+   
+   if (appendChar)
+      ptr[len++] = appendChar;
+   memcpy(ptr + len, value, valueLen + 1);
+   cv.len = len + valueLen;
+}
+
 void Dictionary::setEntryTypeValue(Dictionary::Entry* e, U32 inputTypeId, KorkApi::TypeStorageInterface* inputStorage)
 {
    if (e->mIsConstant)
@@ -361,6 +1073,7 @@ void Dictionary::setEntryTypeValue(Dictionary::Entry* e, U32 inputTypeId, KorkAp
       return;
    }
    
+   markDirty(e);
    
    ConsoleVarRef cv;
    cv.dictionary = this;
@@ -404,6 +1117,10 @@ void Dictionary::setEntryTypeValue(Dictionary::Entry* e, U32 inputTypeId, KorkAp
       {
          outputStorage.data.storageRegister->typeId = outputTypeId;
          e->mConsoleValue = *outputStorage.data.storageRegister;
+         
+         // Registered storage may be changed natively
+         if (e->mIsRegistered)
+            e->mConsoleValue.len = KorkApi::ConsoleValue::UnknownLen;
       }
    }
 }
@@ -423,6 +1140,8 @@ void Dictionary::setEntryValues(Entry* e, U32 argc, KorkApi::ConsoleValue* value
       return;
    }
    
+   markDirty(e);
+   
    ConsoleVarRef cv;
    cv.dictionary = this;
    cv.var = e;
@@ -484,6 +1203,8 @@ void Dictionary::setEntryType(Entry* e, U16 typeId)
 void Dictionary::resizeHeap(Entry* e, U32 newSize, bool force)
 {
    bool shouldRealloc = (e->mHeapAlloc == nullptr) || (force && (newSize != e->mHeapAlloc->size)) || (newSize > e->mHeapAlloc->size);
+   markDirty(e);
+   
    if (shouldRealloc && e->mHeapAlloc)
    {
       mVm->releaseHeapRef(e->mHeapAlloc);
@@ -539,6 +1260,7 @@ Dictionary::Entry* Dictionary::addVariable(  const char *name,
    ent->mUsage = usage;
    ent->mIsRegistered = true;
    ent->mEnforcedType = type;
+   markDirty(ent);
    
    return ent;
 }
@@ -567,9 +1289,11 @@ ExprEvalState::ExprEvalState(KorkApi::VmInternal* vm): mSTR(&vm->mAllocBase, &vm
    vmInternal = vm;
    traceOn = false;
    traceBuffer[0] = '\0';
+   mCallTimersPausedAt = 0;
+   mCallTimersPaused = false;
    lastThrow = 0;
    nextThrow = 0;
-   mStackPopBreakIndex = -1;
+   mStepBreakDepth = vm->mPendingStepBreakDepth;
    
    memset(iterStack, 0, sizeof(iterStack));
    memset(floatStack, 0, sizeof(floatStack));
@@ -586,6 +1310,9 @@ ExprEvalState::ExprEvalState(KorkApi::VmInternal* vm): mSTR(&vm->mAllocBase, &vm
    mState = KorkApi::FiberRunResult::INACTIVE;
    mUserPtr = nullptr;
    mLastFiberValue = KorkApi::ConsoleValue();
+   mLastFiberHeapData = nullptr;
+   mNativeResultFrame = 0;
+   mStringResultValue = KorkApi::ConsoleValue();
 }
 
 ExprEvalState::~ExprEvalState()
@@ -598,6 +1325,8 @@ void ExprEvalState::reset()
    while(vmFrames.size())
       popFrame();
    mSTR.reset();
+   mCallTimers.clear();
+   mCallTimersPaused = false;
 }
 
 namespace KorkApi
@@ -738,6 +1467,7 @@ TypeStorageInterface CreateConsoleVarTypeStorage(KorkApi::VmInternal* vmInternal
       s.data.argc = 1;
       s.data.storageRegister = vmInternal->getTempValuePtr();
       *s.data.storageRegister = *ref.var->getCVPtr();
+      s.data.storageRegister->len = KorkApi::ConsoleValue::UnknownLen; // contents will change
       s.data.storageAddress = ConsoleValue::makeRaw(
          (U64)ptr,
          typeId,
@@ -764,6 +1494,7 @@ TypeStorageInterface CreateExprStringStackStorage(KorkApi::VmInternal* vmInterna
    
    s.data.storageRegister = vmInternal->getTempValuePtr();
    *s.data.storageRegister = stack.getConsoleValue();
+   s.data.storageRegister->len = KorkApi::ConsoleValue::UnknownLen; // contents will change
    s.data.storageAddress  = ConsoleValue::makeRaw(stack.mStart,
       typeId,
       (KorkApi::ConsoleValue::Zone)(KorkApi::ConsoleValue::ZoneFiberStart + stack.mFuncId)
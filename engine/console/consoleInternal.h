@@ -35,6 +35,7 @@
 #endif
 #ifndef _STREAM_H_
 #include "core/stream.h"
+#include <unordered_map>
 #endif
 
 #include "console/consoleValue.h"
@@ -83,6 +84,8 @@ class Dictionary
 {
 public:
    
+   struct ArrayData;
+   
    struct Entry
    {
       friend class Dictionary;
@@ -90,7 +93,7 @@ public:
       friend struct ConsoleFrame;
       friend class ConsoleSerializer;
       
-      StringTableEntry name;
+      StringTableEntry name; ///< Name of the array for array elements
       Entry *nextEntry;
       
       /// Usage doc string.
@@ -116,6 +119,16 @@ public:
       bool mIsRegistered;
       
       U16 mEnforcedType;
+      
+      /// Whether the value changed since the last fiber snapshot.
+      bool mDirty;
+      
+      /// Array this is an element of, or nullptr for plain variables.
+      ArrayData* mArray;
+      /// Key for elements in ArrayData::keyed, nullptr for dense elements.
+      char* mArrayKey;
+      /// Index for dense elements, key hash for keyed elements.
+      U32 mArrayIndex;
 
    public:
       
@@ -123,19 +136,75 @@ public:
       ~Entry();
       
       inline KorkApi::ConsoleValue* getCVPtr() { return &mConsoleValue; }
+      inline bool isArrayElement() const { return mArray != nullptr; }
+   };
+   
+   /// Element storage for a variable used as an array, i.e. %arr[%i].
+   ///
+   /// Elements behave exactly like the composite variable they used to be
+   /// interned as (%arr[5] and %arr5 are the same variable), but are stored
+   /// by key so no StringTableEntry is created per element. Canonical
+   /// non-negative integer keys go in a dense vector, anything else in a
+   /// case insensitive hash of the key string.
+   struct ArrayData
+   {
+      StringTableEntry name;
+      ArrayData* nextArray;
+      Entry** dense;
+      Entry** keyed;
+      U32 denseSize;
+      U32 keyedSize;
+      U32 keyedCount;
+      U32 count;
    };
    
+   /// Ordered index of variable and array names, see enableNameIndex.
+   struct NameIndex;
+   
    struct HashTableData
    {
       S32 size;
       S32 count;
       Entry **data;
       Dictionary* owner;
+      
+      // Arrays (nullptr until the first element is added)
+      ArrayData** arrays;
+      U32* arrayNameLens; ///< Number of arrays per name length, allocated with arrays
+      S32 arraySize;
+      S32 arrayCount;
+      S32 elementCount;
+      
+      NameIndex* nameIndex; ///< nullptr unless enabled
+      
+      // Snapshot tracking (see ConsoleSerializer)
+      U32 snapshotId;         ///< Stable id used to match tables between snapshots (0 = never written)
+      U32 snapshotGen;        ///< Generation of the last snapshot this table was written to
+      bool dirty;             ///< Entry values changed since the last snapshot
+      bool structureChanged;  ///< Entries were removed since the last snapshot
    };
    
    HashTableData* mHashTable;
    KorkApi::VmInternal* mVm;
    
+protected:
+   
+   Entry* lookupPlain(StringTableEntry name);
+   ArrayData* findArray(StringTableEntry name);
+   ArrayData* createArray(StringTableEntry name);
+   void freeArray(ArrayData* array);
+   Entry* findElement(ArrayData* array, const char* key);
+   Entry* createElement(ArrayData* array, const char* key);
+   void removeElement(Entry* ent);
+   Entry* lookupAlias(const char* name, ArrayData* skip);
+   
+   void indexInsert(const char* name, void* ptr, bool isArray);
+   void indexErase(const char* name, void* ptr, bool isArray);
+   /// Calls fn(Entry*) for every variable starting with prefix using the name index.
+   template<typename F> void visitIndexedPrefix(const char* prefix, U32 prefixLen, F fn);
+   
+public:
+   
    Dictionary();
    Dictionary(KorkApi::VmInternal *state, Dictionary::HashTableData* ref=nullptr);
    ~Dictionary();
@@ -150,7 +219,11 @@ public:
 
    void setEntryUnsignedValue(Entry* e, U64 val);
    void setEntryNumberValue(Entry* e, F32 val);
-   void setEntryStringValue(Entry* e, const char *value);
+   void setEntryStringValue(Entry* e, const char *value, U32 len = KorkApi::ConsoleValue::UnknownLen);
+   /// Same as assigning e's string value @ appendChar @ value, but appends
+   /// in place, growing the heap storage geometrically. appendChar is
+   /// skipped if 0.
+   void appendEntryString(Entry* e, const char *value, U32 valueLen, char appendChar);
    void setEntryTypeValue(Entry* e, U32 typeId, KorkApi::TypeStorageInterface * storage);
    void setEntryValue(Entry* e, KorkApi::ConsoleValue value);
    void setEntryValues(Entry* e, U32 argc, KorkApi::ConsoleValue* values);
@@ -159,7 +232,16 @@ public:
    Entry *lookup(StringTableEntry name);
    Entry* getVariable(StringTableEntry name);
    Entry *add(StringTableEntry name);
+   /// Looks up name[key], i.e. the variable which was previously named name+key.
+   Entry *lookupArray(StringTableEntry name, const char* key);
+   Entry *addArray(StringTableEntry name, const char* key);
+   /// Returns the script visible name of e, using buffer for array elements.
+   const char* getEntryName(Entry* e, char* buffer, U32 bufferSize);
    void setState(KorkApi::VmInternal *state, Dictionary::HashTableData* ref=nullptr);
+   /// Keeps an ordered index of names so wildcard exports, deletes and tab
+   /// completion only visit variables matching the literal prefix of the
+   /// pattern (e.g. "$Pref::" for "$Pref::*"). Used for the global table.
+   void enableNameIndex();
    void remove(Entry *);
    void reset();
    
@@ -172,11 +254,60 @@ public:
    void remapVariables(U32 oldFiberIndex, U32 newFiberIndex);
    
    void resizeHeap(Entry* e, U32 newSize, bool force);
+   
+   inline void markDirty(Entry* e)
+   {
+      e->mDirty = true;
+      mHashTable->dirty = true;
+   }
+   
+   /// Clears snapshot dirty state on the table and all its entries.
+   static void clearDirty(HashTableData* ht);
    void getHeapPtrSize(Entry* e, U32* size, void** ptr);
    
    U32 getCount() const
    {
-      return mHashTable->count;
+      return mHashTable->count + mHashTable->elementCount;
+   }
+   
+   /// Calls fn(Entry*) for every element of array.
+   template<typename F> static void forEachElement(const ArrayData* array, F fn)
+   {
+      for (U32 j = 0; j < array->denseSize; j++)
+      {
+         if (array->dense[j])
+         {
+            fn(array->dense[j]);
+         }
+      }
+      
+      for (U32 j = 0; j < array->keyedSize; j++)
+      {
+         for (Entry* walk = array->keyed[j]; walk; walk = walk->nextEntry)
+         {
+            fn(walk);
+         }
+      }
+   }
+   
+   /// Calls fn(Entry*) for every variable in ht including array elements.
+   template<typename F> static void forEachEntry(const HashTableData* ht, F fn)
+   {
+      for (S32 i = 0; i < ht->size; i++)
+      {
+         for (Entry* walk = ht->data[i]; walk; walk = walk->nextEntry)
+         {
+            fn(walk);
+         }
+      }
+      
+      for (S32 i = 0; i < ht->arraySize; i++)
+      {
+         for (ArrayData* array = ht->arrays[i]; array; array = array->nextArray)
+         {
+            forEachElement(array, fn);
+         }
+      }
    }
    
    bool isOwner() const
@@ -220,6 +351,16 @@ struct IterStackRecord
 struct ConsoleFrame;
 struct LocalRefTrack;
 
+/// Per function call counters, kept in Namespace::Entry.
+struct CallStats
+{
+   U64 calls;
+   U64 inclusiveTime; ///< ns including callees
+   U64 exclusiveTime; ///< ns excluding callees
+   
+   void reset() { calls = 0; inclusiveTime = 0; exclusiveTime = 0; }
+};
+
 struct ConsoleBasicFrame
 {
    CodeBlock* code;
@@ -250,6 +391,14 @@ public:
       U16 frameDepth;
    };
    
+   struct CallTimer
+   {
+      CallStats* stats;
+      U64 start;
+      U64 childTime;  ///< Inclusive time of nested timed calls
+      S32 frameIndex; ///< Script function frame, or frame which made the native call
+   };
+   
    U32 mAllocNumber : 24;
    U32 mGeneration : 7;
    
@@ -273,7 +422,9 @@ public:
    U32 lastThrow;
    U32 nextThrow;
 
-   U32 mStackPopBreakIndex; // for telnet debugger
+   /// Telnet debugger stepping; breaks at the next line executed with at most
+   /// this many frames. 0 if not stepping.
+   U32 mStepBreakDepth;
    
    StringStack mSTR;
    
@@ -287,9 +438,22 @@ public:
    KorkApi::FiberRunResult::State mState;
    KorkApi::ConsoleValue mLastFiberValue; ///< Value yielded from function or returned to fiber
    KorkApi::ConsoleHeapAllocRef mLastFiberHeapData; // mainly for serialization
+   
+   /// @name Native string results
+   /// @{
+   
+   U32 mNativeResultFrame;                   ///< String stack frame of the native function being called (0 = none)
+   KorkApi::ConsoleValue mStringResultValue; ///< Last result passed to makeStringResult
+   
+   /// @}
 
    char traceBuffer[TraceBufferSize];
    
+   /// Active timed calls (only used when VmInternal::mCallStatsEnabled is set)
+   KorkApi::Vector<CallTimer> mCallTimers;
+   U64 mCallTimersPausedAt;
+   bool mCallTimersPaused;
+   
    ExprEvalState(KorkApi::VmInternal* vm);
    ~ExprEvalState();
    
@@ -355,14 +519,80 @@ public:
    
    /// @}
    
+   /// @name Call stats
+   /// @{
+   
+   static U64 getCallTimerNow();
+   U32 beginCallTimer(CallStats* stats, S32 frameIndex);
+   void endCallTimers(U32 timerIndex);
+   void endFrameCallTimers(S32 frameIndex);
+   void pauseCallTimers();
+   void resumeCallTimers();
+   
+   /// @}
+   
    /// Run integrity checks for debugging.
    void validate();
 };
 
+/// Times a native call for the duration of the scope (if call stats are enabled).
+struct NativeCallTimerScope
+{
+   ExprEvalState* mState;
+   S32 mTimerIndex;
+   
+   NativeCallTimerScope(ExprEvalState& state, CallStats* stats, bool enabled) : mState(&state), mTimerIndex(-1)
+   {
+      if (enabled)
+         mTimerIndex = (S32)state.beginCallTimer(stats, (S32)state.vmFrames.size()-1);
+   }
+   
+   ~NativeCallTimerScope()
+   {
+      if (mTimerIndex >= 0)
+         mState->endCallTimers((U32)mTimerIndex);
+   }
+};
+
+/// Marks a string stack frame as belonging to a native call for the duration
+/// of the scope, so string results can be placed in its return space. Frame 0
+/// means the call has no frame of its own (i.e. it was made from native code).
+struct NativeResultScope
+{
+   ExprEvalState* mState;
+   U32 mPrevFrame;
+   KorkApi::ConsoleValue mPrevResultValue;
+   
+   NativeResultScope(ExprEvalState& state, U32 frame) : mState(&state), mPrevFrame(state.mNativeResultFrame), mPrevResultValue(state.mStringResultValue)
+   {
+      state.mNativeResultFrame = frame;
+      state.mStringResultValue = KorkApi::ConsoleValue();
+   }
+   
+   ~NativeResultScope()
+   {
+      mState->mNativeResultFrame = mPrevFrame;
+      mState->mStringResultValue = mPrevResultValue;
+   }
+};
+
 struct ConsoleVarRef;
+class GrowableMemStream;
 
 /// Class which serializes console execution state. Accepts a list of
 /// fibers to serialize; any referenced values will get re-mapped.
+///
+/// Snapshots can also be written as deltas against the previous snapshot 
+/// written by the VM. In this case dictionaries and codeblocks which were 
+/// present in the previous snapshot are written as references (DREF, DSRF), 
+/// or in the case of dictionaries as a list of changed entries (DDLT). Fiber 
+/// and frame records are always written in full. Deltas are restored by 
+/// reading the base snapshot followed by each delta in order.
+///
+/// From version 3 the object list is written before the fiber list so 
+/// snapshots can be read and written sequentially (e.g. through a 
+/// ChunkWriteStream). Counts, ids and offsets are stored as varints, 
+/// and names are written once per snapshot then referred to by index.
 struct ConsoleSerializer
 {
    struct Remap
@@ -372,18 +602,28 @@ struct ConsoleSerializer
    };
 
    // Main block
-   static const U32 CSOB_VERSION = 1;
+   static const U32 CSOB_VERSION = 4;
    static const U32 CSOB_MAGIC = makeFourCCTag('C','S','O','B');
+   static const U32 CSOB_FLAG_DELTA = BIT(0);
    // Fiber
-   static const U32 CEOB_VERSION = 1;
+   static const U32 CEOB_VERSION = 2;
    static const U32 CEOB_MAGIC = makeFourCCTag('C','E','O','B');
    // Frame
    static const U32 CFFB_MAGIC = makeFourCCTag('C','F','F','B');
    // Dictionary
    static const U32 DICT_VERSION = 1;
    static const U32 DICT_MAGIC = makeFourCCTag('D','I','C','T');
+   // Dictionary entry flags
+   static const U8 ENTRY_FLAG_CONSTANT = BIT(0);
+   static const U8 ENTRY_FLAG_ELEMENT = BIT(1); ///< Array element, key follows the array name (version 4+)
+   // Dictionary unchanged from previous snapshot
+   static const U32 DREF_MAGIC = makeFourCCTag('D','R','E','F');
+   // Dictionary changes from previous snapshot
+   static const U32 DDLT_MAGIC = makeFourCCTag('D','D','L','T');
    // DSO copy
    static const U32 DSOB_MAGIC = makeFourCCTag('D','S','O','B');
+   // DSO unchanged from previous snapshot
+   static const U32 DSRF_MAGIC = makeFourCCTag('D','S','R','F');
    // End of list
    static const U32 EOLB_MAGIC = makeFourCCTag('E','O','L','B');
    
@@ -395,6 +635,29 @@ struct ConsoleSerializer
    KorkApi::Vector<ExprEvalState*> mFibers;
    KorkApi::Vector<Remap> mFiberRemap;
    bool mAllowId;
+   
+   // Snapshot ids for mCodeBlocks & mDictionaryTables when reading
+   KorkApi::Vector<U32> mCodeBlockIds;
+   KorkApi::Vector<U32> mDictionaryIds;
+   
+   // Objects from the previous snapshot in a delta chain
+   KorkApi::Vector<CodeBlock*> mBaseCodeBlocks;
+   KorkApi::Vector<U32> mBaseCodeBlockIds;
+   KorkApi::Vector<Dictionary::HashTableData*> mBaseDictionaryTables;
+   KorkApi::Vector<U32> mBaseDictionaryIds;
+   
+   U32 mReadVersion;
+   bool mWriteDelta;
+   
+   // Block output; blocks are assembled in mScratch then copied to mOutStream
+   Stream* mOutStream;
+   GrowableMemStream* mScratch;
+   
+   // Names written to or read from the current snapshot
+   typedef std::unordered_map<const char*, U32, std::hash<const char*>, std::equal_to<const char*>, 
+                              KorkApi::TlsVmAllocator<std::pair<const char* const, U32> > > StringIndexMap;
+   StringIndexMap mWriteStrings;
+   KorkApi::Vector<StringTableEntry> mReadStrings;
 
    ConsoleSerializer(KorkApi::VmInternal* target, void* userPtr, bool allowId, Stream* s);
    ~ConsoleSerializer();
@@ -421,6 +684,7 @@ struct ConsoleSerializer
 
    bool readVarRef(ConsoleVarRef& ref);
    bool writeVarRef(ConsoleVarRef& ref);
+   void writeArrayKey(Dictionary::Entry* entry);
    
    bool readConsoleValue(KorkApi::ConsoleValue& value, KorkApi::ConsoleHeapAllocRef ref);
    bool writeConsoleValue(KorkApi::ConsoleValue& value, KorkApi::ConsoleHeapAllocRef ref);
@@ -441,6 +705,21 @@ struct ConsoleSerializer
    bool saveFibers();
    
    const char *readSTString(Stream* s, bool casesens=false);
+   bool writeSTString(const char* str);
+   
+   bool readVarU32(U32& value);
+   bool writeVarU32(U32 value);
+   
+   /// Counts, sizes and offsets (varint from version 3)
+   bool readCount(U32& value);
+   bool writeCount(U32 value);
+   
+   /// Object list indexes which may be -1 (varint from version 3)
+   bool readIndex(S32& value);
+   bool writeIndex(S32 value);
+   
+   void beginBlock();
+   bool flushBlock();
    
    void fixupConsoleValues();
 
@@ -451,8 +730,20 @@ struct ConsoleSerializer
    Dictionary::HashTableData* loadHashTable();
    bool writeHashTable(const Dictionary::HashTableData* ht);
    
+   bool loadHashTableEntries(Dictionary& dict, U32 entryCount);
+   bool writeHashTableEntry(Dictionary::Entry* entry);
+   bool applyHashTableDelta(Dictionary::HashTableData* ht);
+   bool writeHashTableDelta(const Dictionary::HashTableData* ht);
+   
+   bool canReferencePrevious(U32 snapshotGen) const;
+   void markSnapshotWritten();
+   void releaseBaseObjects();
+   
+   bool readSnapshot(bool loadFiberList);
+   
    bool read(KorkApi::Vector<ExprEvalState*> &fibers);
-   bool write(KorkApi::Vector<ExprEvalState*> &fibers);
+   bool readChain(U32 numStreams, Stream** streams, KorkApi::Vector<ExprEvalState*> &fibers);
+   bool write(KorkApi::Vector<ExprEvalState*> &fibers, bool delta=false);
 };
 
 struct ConsoleVarRef
@@ -222,6 +222,8 @@ Namespace::Entry::Entry()
    mCode = nullptr;
    mUserPtr = nullptr;
    mType = InvalidFunctionType;
+   mSignalSlot = -1;
+   mCallStats.reset();
 }
 
 void Namespace::Entry::clear()
@@ -232,6 +234,7 @@ void Namespace::Entry::clear()
       mCode = nullptr;
    }
    mUserPtr = nullptr;
+   mSignalSlot = -1;
 }
 
 Namespace::Namespace()
@@ -558,6 +561,7 @@ void Namespace::addSignal(StringTableEntry name, void* userPtr, const char* usag
    ent->mMaxArgs = maxArgs;
    ent->mUserPtr = userPtr;
    ent->mType = Entry::SignalType;
+   ent->mSignalSlot = mVmInternal->getSignalSlot(name, true);
 }
 
 void Namespace::markGroup(const char* name, const char* usage)
@@ -613,7 +617,7 @@ KorkApi::ConsoleValue Namespace::Entry::execute(S32 argc, KorkApi::ConsoleValue*
       if (!validateArgCount(argc - 2, state))
          return KorkApi::ConsoleValue();
 
-      resolvedThis->klass->iSignals.TriggerSignal(mUserPtr, resolvedThis, mFunctionName, argc - 2, argv + 2);
+      resolvedThis->klass->iSignals.TriggerSignal(mUserPtr, resolvedThis, mSignalSlot, mFunctionName, argc - 2, argv + 2);
       return KorkApi::ConsoleValue();
    }
 
@@ -622,7 +626,7 @@ KorkApi::ConsoleValue Namespace::Entry::execute(S32 argc, KorkApi::ConsoleValue*
       if(mFunctionOffset)
       {
          const char* strV = mNamespace->mVmInternal->valueAsString(argv[0]);
-         return mCode->exec(mFunctionOffset, state->vmInternal->internString(strV, false), mNamespace, argc, argv, false, true, mPackage, -1, startSuspended);
+         return mCode->exec(mFunctionOffset, state->vmInternal->internString(strV, false), mNamespace, argc, argv, false, true, mPackage, -1, startSuspended, &mCallStats);
       }
       else
       {
@@ -633,6 +637,8 @@ KorkApi::ConsoleValue Namespace::Entry::execute(S32 argc, KorkApi::ConsoleValue*
    if(!validateArgCount(argc, state))
       return KorkApi::ConsoleValue();
 
+   NativeCallTimerScope callTimer(*state, &mCallStats, state->vmInternal->mCallStatsEnabled);
+   NativeResultScope resultScope(*state, 0);
    const char* localArgv[StringStack::MaxArgs];
 
    if (mType != ValueCallbackType)
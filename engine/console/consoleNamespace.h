@@ -80,6 +80,8 @@ class Namespace
       KorkApi::String mDynamicUsage;
       StringTableEntry mPackage;
       void* mUserPtr;
+      S32 mSignalSlot; ///< Slot of signal (see VmInternal::getSignalSlot), -1 otherwise
+      CallStats mCallStats; ///< See Vm::setCallStatsEnabled
 
       CodeBlock *mCode;
       U32 mFunctionOffset;
@@ -41,12 +41,18 @@ struct ConsoleValue
       ZoneFiberStart = ZoneFunc
    };
    
+   enum : U32
+   {
+      UnknownLen = 0xFFFFFFFF
+   };
+   
    // ---- Storage ----
    U64 cvalue;
    U16 typeId;
    U16 zoneId;
+   U32 len; ///< Byte length of string values if known, else UnknownLen
    
-   ConsoleValue() : cvalue(0), typeId(TypeInternalString), zoneId(0)
+   ConsoleValue() : cvalue(0), typeId(TypeInternalString), zoneId(0), len(UnknownLen)
    {
    }
    
@@ -72,6 +78,10 @@ struct ConsoleValue
    {
       ConsoleValue v; v.setString(p, zone); return v;
    }
+   static ConsoleValue makeStringLen(const char* p, U32 strLen, Zone zone=ZoneExternal)
+   {
+      ConsoleValue v; v.setString(p, zone); v.len = strLen; return v;
+   }
    static ConsoleValue makeDynString(char* p, Zone zone=ZoneExternal)
    {
       ConsoleValue v; v.setDynString(p, zone); return v;
@@ -89,6 +99,7 @@ struct ConsoleValue
    {
       typeId = TypeInternalUnsigned;
       setZone(ZoneExternal); // zone irrelevant for immediates
+      len = UnknownLen;
       *((U64*)&cvalue) = i;
    }
    
@@ -96,6 +107,7 @@ struct ConsoleValue
    {
       typeId = TypeInternalNumber;
       setZone(ZoneExternal); // zone irrelevant for immediates
+      len = UnknownLen;
       *((F64*)&cvalue) = d;
    }
    
@@ -104,6 +116,7 @@ struct ConsoleValue
       typeId = TypeInternalString;
       setZone(zone);
       cvalue = (UINTPTR)p;
+      len = UnknownLen;
    }
    
    inline void setDynString(char* p, Zone zone=ZoneExternal)
@@ -111,6 +124,7 @@ struct ConsoleValue
       typeId = TypeInternalString;
       setZone(zone);
       cvalue = (UINTPTR)p;
+      len = UnknownLen;
    }
    
    inline void setTyped(U64 p, U16 customTypeId, Zone zone=ZoneExternal)
@@ -118,6 +132,13 @@ struct ConsoleValue
       typeId = customTypeId;
       setZone(zone);
       cvalue = (U64)p;
+      len = UnknownLen;
+   }
+   
+   /// True if this is a string value with a known length.
+   inline bool hasLen() const
+   {
+      return typeId == TypeInternalString && len != UnknownLen;
    }
    
    inline U64 getInt(U64 def = 0) const
@@ -150,6 +171,7 @@ struct ConsoleValue
    void* advancePtr(size_t bytes)
    {
       cvalue += bytes;
+      len = (len == UnknownLen || len < bytes) ? (U32)UnknownLen : (U32)(len - bytes);
       U64 val = cvalue;
       return *((char**)&val);
    }
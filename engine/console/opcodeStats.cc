@@ -0,0 +1,288 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2025-2026 korkscript contributors.
+// See AUTHORS file and git repository for contributor information.
+//
+// SPDX-License-Identifier: MIT
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "embed/api.h"
+#include "embed/internalApi.h"
+#include "console/consoleInternal.h"
+#include "console/consoleNamespace.h"
+#include "console/compiler.h"
+#include "console/codeBlock.h"
+#include "console/opcodeStats.h"
+#include <algorithm>
+
+static const char* sOpcodeNames[] =
+{
+   "OP_FUNC_DECL",
+   "OP_CREATE_OBJECT",
+   "OP_ADD_OBJECT",
+   "OP_END_OBJECT",
+   "OP_FINISH_OBJECT",
+   "OP_JMPIFFNOT",
+   "OP_JMPIFNOT",
+   "OP_JMPIFF",
+   "OP_JMPIF",
+   "OP_JMPIFNOT_NP",
+   "OP_JMPIF_NP",
+   "OP_JMP",
+   "OP_RETURN",
+   "OP_RETURN_VOID",
+   "OP_RETURN_FLT",
+   "OP_RETURN_UINT",
+   "OP_CMPEQ",
+   "OP_CMPGR",
+   "OP_CMPGE",
+   "OP_CMPLT",
+   "OP_CMPLE",
+   "OP_CMPNE",
+   "OP_XOR",
+   "OP_MOD",
+   "OP_BITAND",
+   "OP_BITOR",
+   "OP_NOT",
+   "OP_NOTF",
+   "OP_ONESCOMPLEMENT",
+   "OP_SHR",
+   "OP_SHL",
+   "OP_AND",
+   "OP_OR",
+   "OP_ADD",
+   "OP_SUB",
+   "OP_MUL",
+   "OP_DIV",
+   "OP_NEG",
+   "OP_SETCURVAR",
+   "OP_SETCURVAR_CREATE",
+   "OP_SETCURVAR_ARRAY",
+   "OP_SETCURVAR_ARRAY_CREATE",
+   "OP_LOADVAR_UINT",
+   "OP_LOADVAR_FLT",
+   "OP_LOADVAR_STR",
+   "OP_LOADVAR_VAR",
+   "OP_SAVEVAR_UINT",
+   "OP_SAVEVAR_FLT",
+   "OP_SAVEVAR_STR",
+   "OP_SAVEVAR_VAR",
+   "OP_SETCUROBJECT",
+   "OP_SETCUROBJECT_NEW",
+   "OP_SETCUROBJECT_INTERNAL",
+   "OP_SETCURFIELD",
+   "OP_SETCURFIELD_ARRAY",
+   "OP_SETCURFIELD_TYPE",
+   "OP_LOADFIELD_UINT",
+   "OP_LOADFIELD_FLT",
+   "OP_LOADFIELD_STR",
+   "OP_SAVEFIELD_UINT",
+   "OP_SAVEFIELD_FLT",
+   "OP_SAVEFIELD_STR",
+   "OP_STR_TO_UINT",
+   "OP_STR_TO_FLT",
+   "OP_STR_TO_NONE",
+   "OP_FLT_TO_UINT",
+   "OP_FLT_TO_STR",
+   "OP_FLT_TO_NONE",
+   "OP_UINT_TO_FLT",
+   "OP_UINT_TO_STR",
+   "OP_UINT_TO_NONE",
+   "OP_COPYVAR_TO_NONE",
+   "OP_LOADIMMED_UINT",
+   "OP_LOADIMMED_FLT",
+   "OP_TAG_TO_STR",
+   "OP_LOADIMMED_STR",
+   "OP_DOCBLOCK_STR",
+   "OP_LOADIMMED_IDENT",
+   "OP_CALLFUNC_RESOLVE",
+   "OP_CALLFUNC",
+   "OP_ADVANCE_STR",
+   "OP_ADVANCE_STR_APPENDCHAR",
+   "OP_ADVANCE_STR_COMMA",
+   "OP_ADVANCE_STR_NUL",
+   "OP_REWIND_STR",
+   "OP_TERMINATE_REWIND_STR",
+   "OP_COMPARE_STR",
+   "OP_PUSH",
+   "OP_PUSH_UINT",
+   "OP_PUSH_FLT",
+   "OP_PUSH_VAR",
+   "OP_PUSH_FRAME",
+   "OP_ASSERT",
+   "OP_BREAK",
+   "OP_ITER_BEGIN",
+   "OP_ITER_BEGIN_STR",
+   "OP_ITER",
+   "OP_ITER_END",
+   "OP_PUSH_TRY",
+   "OP_PUSH_TRY_STACK",
+   "OP_POP_TRY",
+   "OP_THROW",
+   "OP_DUP_UINT",
+   "OP_PUSH_TYPED",
+   "OP_LOADVAR_TYPED",
+   "OP_LOADVAR_TYPED_REF",
+   "OP_LOADFIELD_TYPED",
+   "OP_SAVEVAR_TYPED",
+   "OP_SAVEFIELD_TYPED",
+   "OP_STR_TO_TYPED",
+   "OP_FLT_TO_TYPED",
+   "OP_UINT_TO_TYPED",
+   "OP_TYPED_TO_STR",
+   "OP_TYPED_TO_FLT",
+   "OP_TYPED_TO_UINT",
+   "OP_TYPED_TO_NONE",
+   "OP_TYPED_OP",
+   "OP_TYPED_OP_REVERSE",
+   "OP_TYPED_UNARY_OP",
+   "OP_SETCURFIELD_NONE",
+   "OP_SETVAR_FROM_COPY",
+   "OP_LOADFIELD_VAR",
+   "OP_SAVEFIELD_VAR",
+   "OP_SETCURVAR_TYPE",
+   "OP_SET_DYNAMIC_TYPE_FROM_VAR",
+   "OP_SET_DYNAMIC_TYPE_FROM_FIELD",
+   "OP_SET_DYNAMIC_TYPE_FROM_ID",
+   "OP_SET_DYNAMIC_TYPE_TO_NULL",
+   "OP_SAVEVAR_MULTIPLE",
+   "OP_SAVEVAR_MULTIPLE_TYPED",
+   "OP_SAVEFIELD_MULTIPLE",
+   "OP_SIGNAL_DECL",
+   "OP_SET_OBJECT_FIELDS",
+   "OP_APPENDVAR_STR",
+   "OP_INVALID",
+};
+
+static_assert(sizeof(sOpcodeNames) / sizeof(sOpcodeNames[0]) == OpcodeStats::NumOpcodes, "Opcode name table out of sync with CompiledInstructions");
+static_assert(OpcodeStats::NumOpcodes <= 1024, "Triple keys pack opcodes into 10 bits");
+
+OpcodeStats::OpcodeStats(KorkApi::VmInternal* vm) :
+   mVMInternal(vm),
+   mEnabled(false),
+   mTotal(0)
+{
+   mPrev[0] = mPrev[1] = NoOpcode;
+   memset(mOpCounts, 0, sizeof(mOpCounts));
+   mPairCounts.resize(NumOpcodes * NumOpcodes, 0);
+}
+
+OpcodeStats::~OpcodeStats()
+{
+   reset();
+}
+
+const char* OpcodeStats::getOpcodeName(U32 opcode)
+{
+   return opcode < NumOpcodes ? sOpcodeNames[opcode] : "OP_UNKNOWN";
+}
+
+U64* OpcodeStats::allocHits(CodeBlock* code)
+{
+   code->ipHits = mVMInternal->NewArray<U64>(code->codeSize);
+   memset(code->ipHits, 0, sizeof(U64) * code->codeSize);
+
+   code->incRefCount();
+   mBlocks.push_back(code);
+   return code->ipHits;
+}
+
+void OpcodeStats::reset()
+{
+   mTotal = 0;
+   mPrev[0] = mPrev[1] = NoOpcode;
+   memset(mOpCounts, 0, sizeof(mOpCounts));
+   std::fill(mPairCounts.begin(), mPairCounts.end(), 0);
+   mTripleCounts.clear();
+
+   for (CodeBlock* code : mBlocks)
+   {
+      mVMInternal->DeleteArray(code->ipHits);
+      code->ipHits = nullptr;
+      code->decRefCount();
+   }
+   mBlocks.clear();
+}
+
+void OpcodeStats::dump(U32 maxRows, KorkApi::ProfilerOutputFn outputFn, void* userPtr)
+{
+   struct Row
+   {
+      U32 key;
+      U64 count;
+   };
+
+   char buffer[256];
+   const F64 total = mTotal > 0 ? (F64)mTotal : 1.0;
+   KorkApi::Vector<Row> rows;
+
+   auto sortRows = [&rows, maxRows]() {
+      std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) {
+         return a.count != b.count ? a.count > b.count : a.key < b.key;
+      });
+      if (maxRows != 0 && rows.size() > maxRows)
+      {
+         rows.resize(maxRows);
+      }
+   };
+
+   snprintf(buffer, sizeof(buffer), "Executed instructions: %llu", (unsigned long long)mTotal);
+   outputFn(userPtr, buffer);
+
+   rows.clear();
+   for (U32 i=0; i<NumOpcodes; i++)
+   {
+      if (mOpCounts[i] != 0)
+      {
+         Row row = { i, mOpCounts[i] };
+         rows.push_back(row);
+      }
+   }
+   sortRows();
+
+   outputFn(userPtr, "     count   pct%  opcode");
+   for (const Row& row : rows)
+   {
+      snprintf(buffer, sizeof(buffer), "%10llu %5.1f%%  %s",
+               (unsigned long long)row.count, (row.count * 100.0) / total,
+               getOpcodeName(row.key));
+      outputFn(userPtr, buffer);
+   }
+
+   rows.clear();
+   for (U32 i=0; i<mPairCounts.size(); i++)
+   {
+      if (mPairCounts[i] != 0)
+      {
+         Row row = { i, mPairCounts[i] };
+         rows.push_back(row);
+      }
+   }
+   sortRows();
+
+   outputFn(userPtr, "     count   pct%  pair");
+   for (const Row& row : rows)
+   {
+      snprintf(buffer, sizeof(buffer), "%10llu %5.1f%%  %s %s",
+               (unsigned long long)row.count, (row.count * 100.0) / total,
+               getOpcodeName(row.key / NumOpcodes), getOpcodeName(row.key % NumOpcodes));
+      outputFn(userPtr, buffer);
+   }
+
+   rows.clear();
+   for (auto& itr : mTripleCounts)
+   {
+      Row row = { itr.first, itr.second };
+      rows.push_back(row);
+   }
+   sortRows();
+
+   outputFn(userPtr, "     count   pct%  triple");
+   for (const Row& row : rows)
+   {
+      snprintf(buffer, sizeof(buffer), "%10llu %5.1f%%  %s %s %s",
+               (unsigned long long)row.count, (row.count * 100.0) / total,
+               getOpcodeName(row.key >> 20), getOpcodeName((row.key >> 10) & 0x3FF), getOpcodeName(row.key & 0x3FF));
+      outputFn(userPtr, buffer);
+   }
+}
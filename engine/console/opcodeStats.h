@@ -0,0 +1,93 @@
+#pragma once
+//-----------------------------------------------------------------------------
+// Copyright (c) 2025-2026 korkscript contributors.
+// See AUTHORS file and git repository for contributor information.
+//
+// SPDX-License-Identifier: MIT
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "console/stlTypes.h"
+#include "embed/api.h"
+#include "embed/compilerOpcodes.h"
+#include <unordered_map>
+
+// NOTE: record needs console/codeBlock.h to be included first
+
+/// Executed instruction counters.
+///
+/// Counts each executed opcode, each pair & triple of consecutively executed
+/// opcodes and hits per instruction in each CodeBlock. The interpreter only
+/// records into this when built with KS_OPCODE_STATS, so normal builds pay
+/// nothing for it.
+///
+/// Code blocks which have hit counts are referenced until the next reset
+/// so their counts can still be dumped after they finish executing.
+class OpcodeStats
+{
+public:
+   enum
+   {
+      NumOpcodes = Compiler::OP_INVALID + 1,
+      NoOpcode = NumOpcodes
+   };
+
+protected:
+   typedef std::unordered_map<U32, U64, std::hash<U32>, std::equal_to<U32>,
+                              KorkApi::TlsVmAllocator<std::pair<const U32, U64> > > TripleMap;
+
+   KorkApi::VmInternal* mVMInternal;
+   bool mEnabled;
+   U32 mPrev[2]; ///< Last two executed opcodes, most recent first
+   U64 mTotal;
+   U64 mOpCounts[NumOpcodes];
+   KorkApi::Vector<U64> mPairCounts; ///< [first * NumOpcodes + second]
+   TripleMap mTripleCounts;          ///< Keyed by first << 20 | second << 10 | third
+   KorkApi::Vector<CodeBlock*> mBlocks;
+
+   U64* allocHits(CodeBlock* code);
+
+public:
+   OpcodeStats(KorkApi::VmInternal* vm);
+   ~OpcodeStats();
+
+   static const char* getOpcodeName(U32 opcode);
+
+   inline void setEnabled(bool enabled) { mEnabled = enabled; mPrev[0] = mPrev[1] = NoOpcode; }
+   inline bool isEnabled() const { return mEnabled; }
+   inline U64 getTotal() const { return mTotal; }
+   inline U64 getOpcodeCount(U32 opcode) const { return opcode < NumOpcodes ? mOpCounts[opcode] : 0; }
+
+   /// Called before executing the instruction at ip
+   inline void record(CodeBlock* code, U32 ip, U32 opcode)
+   {
+      if (opcode >= NumOpcodes)
+      {
+         opcode = Compiler::OP_INVALID;
+      }
+
+      mTotal++;
+      mOpCounts[opcode]++;
+
+      if (mPrev[0] != NoOpcode)
+      {
+         mPairCounts[(mPrev[0] * NumOpcodes) + opcode]++;
+         if (mPrev[1] != NoOpcode)
+         {
+            mTripleCounts[(mPrev[1] << 20) | (mPrev[0] << 10) | opcode]++;
+         }
+      }
+
+      mPrev[1] = mPrev[0];
+      mPrev[0] = opcode;
+
+      U64* hits = code->ipHits ? code->ipHits : allocHits(code);
+      hits[ip]++;
+   }
+
+   /// Clears all counts and releases referenced code blocks
+   void reset();
+
+   /// Prints the total followed by the most executed opcodes, pairs and triples (up to maxRows of each)
+   void dump(U32 maxRows, KorkApi::ProfilerOutputFn outputFn, void* userPtr);
+};
@@ -0,0 +1,284 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2025-2026 korkscript contributors.
+// See AUTHORS file and git repository for contributor information.
+//
+// SPDX-License-Identifier: MIT
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "embed/api.h"
+#include "embed/internalApi.h"
+#include "console/consoleInternal.h"
+#include "console/consoleNamespace.h"
+#include "console/compiler.h"
+#include "console/codeBlock.h"
+#include "console/scriptProfiler.h"
+#include <algorithm>
+
+static inline U32 profilerHashPtr(U32 hash, const void* ptr)
+{
+   uintptr_t v = (uintptr_t)ptr;
+   hash = (hash ^ (U32)v) * 16777619U;
+   if (sizeof(v) > 4)
+   {
+      hash = (hash ^ (U32)((U64)v >> 32)) * 16777619U;
+   }
+   return hash;
+}
+
+ScriptProfiler::ScriptProfiler(KorkApi::VmInternal* vm) :
+   mVMInternal(vm),
+   mInterval(0),
+   mCountdown(0),
+   mActive(false),
+   mSampleRequested(false),
+   mNumSamples(0),
+   mNumDropped(0)
+{
+}
+
+ScriptProfiler::~ScriptProfiler()
+{
+}
+
+void ScriptProfiler::start(U32 interval)
+{
+   mInterval = interval;
+   mCountdown = interval;
+   mActive = true;
+}
+
+void ScriptProfiler::stop()
+{
+   mActive = false;
+   mInterval = 0;
+   mSampleRequested.store(false, std::memory_order_relaxed);
+}
+
+void ScriptProfiler::reset()
+{
+   mNumSamples = 0;
+   mNumDropped = 0;
+   mFrames.clear();
+   mStacks.clear();
+   mStackFrames.clear();
+   mFrameHeads.clear();
+   mStackHeads.clear();
+}
+
+U32 ScriptProfiler::internFrame(CodeBlock* code, U32 ip, StringTableEntry function, StringTableEntry nameSpace)
+{
+   U32 line = code->getLineForIp(ip);
+
+   StringTableEntry file = code->name;
+
+   U32 hash = 2166136261U;
+   hash = profilerHashPtr(hash, file);
+   hash = profilerHashPtr(hash, function);
+   hash = profilerHashPtr(hash, nameSpace);
+   hash = (hash ^ line) * 16777619U;
+
+   U32& head = mFrameHeads[hash];
+   for (U32 idx = head; idx != 0; idx = mFrames[idx-1].next)
+   {
+      const Frame& frame = mFrames[idx-1];
+      if (frame.file == file &&
+          frame.function == function &&
+          frame.nameSpace == nameSpace &&
+          frame.line == line)
+      {
+         return idx-1;
+      }
+   }
+
+   Frame frame;
+   frame.file = file;
+   frame.function = function;
+   frame.nameSpace = nameSpace;
+   frame.line = line;
+   frame.next = head;
+   mFrames.push_back(frame);
+   head = (U32)mFrames.size();
+   return head-1;
+}
+
+void ScriptProfiler::sample(ExprEvalState* state, U32 ip)
+{
+   const U32 numFrames = state->vmFrames.size();
+   const U32 firstFrame = numFrames > MaxStackDepth ? numFrames - MaxStackDepth : 0;
+
+   mScratch.clear();
+   U32 hash = 2166136261U;
+
+   for (U32 i=firstFrame; i<numFrames; i++)
+   {
+      ConsoleBasicFrame info = state->getBasicFrameInfo(i);
+      if (info.code == nullptr)
+      {
+         continue;
+      }
+
+      // Outer frames are stored with the ip after their call instruction
+      U32 frameIp = (i == numFrames-1) ? ip : (info.ip > 0 ? info.ip - 1 : 0);
+      U32 frameId = internFrame(info.code, frameIp, info.scopeName, info.scopeNamespace ? info.scopeNamespace->mName : nullptr);
+
+      mScratch.push_back(frameId);
+      hash = (hash ^ frameId) * 16777619U;
+   }
+
+   if (mScratch.empty())
+   {
+      return;
+   }
+
+   mNumSamples++;
+
+   U32& head = mStackHeads[hash];
+   for (U32 idx = head; idx != 0; idx = mStacks[idx-1].next)
+   {
+      Stack& stack = mStacks[idx-1];
+      if (stack.depth == mScratch.size() &&
+          memcmp(&mStackFrames[stack.start], mScratch.data(), sizeof(U32) * stack.depth) == 0)
+      {
+         stack.count++;
+         return;
+      }
+   }
+
+   if (mStacks.size() >= MaxUniqueStacks)
+   {
+      mNumDropped++;
+      return;
+   }
+
+   Stack stack;
+   stack.start = (U32)mStackFrames.size();
+   stack.depth = (U32)mScratch.size();
+   stack.count = 1;
+   stack.next = head;
+   mStackFrames.insert(mStackFrames.end(), mScratch.begin(), mScratch.end());
+   mStacks.push_back(stack);
+   head = (U32)mStacks.size();
+}
+
+void ScriptProfiler::formatFrame(const Frame& frame, char* buffer, U32 bufferSize, bool withLine)
+{
+   const char* function = frame.function ? frame.function : "<main>";
+   const char* file = (frame.file && frame.file[0]) ? frame.file : "<input>";
+
+   if (frame.nameSpace && frame.function)
+   {
+      if (withLine)
+         snprintf(buffer, bufferSize, "%s::%s (%s:%u)", frame.nameSpace, function, file, frame.line);
+      else
+         snprintf(buffer, bufferSize, "%s::%s (%s)", frame.nameSpace, function, file);
+   }
+   else
+   {
+      if (withLine)
+         snprintf(buffer, bufferSize, "%s (%s:%u)", function, file, frame.line);
+      else
+         snprintf(buffer, bufferSize, "%s (%s)", function, file);
+   }
+}
+
+void ScriptProfiler::dump(KorkApi::ProfilerOutputFormat format, KorkApi::ProfilerOutputFn outputFn, void* userPtr)
+{
+   char buffer[1024];
+
+   if (format == KorkApi::ProfilerOutputCollapsed)
+   {
+      // One line per unique stack: "root;...;leaf count"
+      KorkApi::String line;
+      for (const Stack& stack : mStacks)
+      {
+         line.clear();
+         for (U32 i=0; i<stack.depth; i++)
+         {
+            formatFrame(mFrames[mStackFrames[stack.start + i]], buffer, sizeof(buffer), true);
+            if (i > 0)
+               line += ';';
+            line += buffer;
+         }
+         snprintf(buffer, sizeof(buffer), " %u", stack.count);
+         line += buffer;
+         outputFn(userPtr, line.c_str());
+      }
+      return;
+   }
+
+   // Flat report; frames are merged per function regardless of line
+   struct FunctionInfo
+   {
+      U32 frame;
+      U32 flat;
+      U32 cum;
+      U32 lastStack;
+   };
+
+   KorkApi::Vector<U32> order(mFrames.size());
+   for (U32 i=0; i<order.size(); i++)
+   {
+      order[i] = i;
+   }
+
+   auto funcLess = [this](U32 a, U32 b) {
+      const Frame& fa = mFrames[a];
+      const Frame& fb = mFrames[b];
+      if (fa.file != fb.file) return std::less<const char*>()(fa.file, fb.file);
+      if (fa.nameSpace != fb.nameSpace) return std::less<const char*>()(fa.nameSpace, fb.nameSpace);
+      return std::less<const char*>()(fa.function, fb.function);
+   };
+   std::sort(order.begin(), order.end(), funcLess);
+
+   KorkApi::Vector<U32> frameToFunc(mFrames.size());
+   KorkApi::Vector<FunctionInfo> funcs;
+   for (U32 i=0; i<order.size(); i++)
+   {
+      if (i == 0 || funcLess(order[i-1], order[i]))
+      {
+         FunctionInfo info = { order[i], 0, 0, 0 };
+         funcs.push_back(info);
+      }
+      frameToFunc[order[i]] = (U32)funcs.size()-1;
+   }
+
+   for (U32 s=0; s<mStacks.size(); s++)
+   {
+      const Stack& stack = mStacks[s];
+      for (U32 i=0; i<stack.depth; i++)
+      {
+         FunctionInfo& info = funcs[frameToFunc[mStackFrames[stack.start + i]]];
+
+         // Recursive functions only count once per stack
+         if (info.lastStack != s+1)
+         {
+            info.cum += stack.count;
+            info.lastStack = s+1;
+         }
+      }
+
+      funcs[frameToFunc[mStackFrames[stack.start + stack.depth - 1]]].flat += stack.count;
+   }
+
+   std::sort(funcs.begin(), funcs.end(), [](const FunctionInfo& a, const FunctionInfo& b) {
+      return a.flat != b.flat ? a.flat > b.flat : a.cum > b.cum;
+   });
+
+   const F64 total = mNumSamples > 0 ? (F64)mNumSamples : 1.0;
+
+   snprintf(buffer, sizeof(buffer), "Total samples: %u (%u dropped)", mNumSamples, mNumDropped);
+   outputFn(userPtr, buffer);
+   outputFn(userPtr, "      flat  flat%       cum   cum%  function");
+
+   for (const FunctionInfo& info : funcs)
+   {
+      char label[512];
+      formatFrame(mFrames[info.frame], label, sizeof(label), false);
+      snprintf(buffer, sizeof(buffer), "%10u %5.1f%% %10u %5.1f%%  %s",
+               info.flat, (info.flat * 100.0) / total,
+               info.cum, (info.cum * 100.0) / total,
+               label);
+      outputFn(userPtr, buffer);
+   }
+}
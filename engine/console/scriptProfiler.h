@@ -0,0 +1,114 @@
+#pragma once
+//-----------------------------------------------------------------------------
+// Copyright (c) 2025-2026 korkscript contributors.
+// See AUTHORS file and git repository for contributor information.
+//
+// SPDX-License-Identifier: MIT
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "console/stlTypes.h"
+#include "embed/api.h"
+#include <atomic>
+#include <unordered_map>
+
+class ExprEvalState;
+class CodeBlock;
+
+namespace KorkApi
+{
+struct VmInternal;
+}
+
+/// Sampling profiler for script code.
+///
+/// Samples are taken either every N executed instructions or when a sample
+/// is requested (e.g. from a timer thread). Each sample walks the current
+/// fiber's frames and is aggregated by unique call stack, so memory use is
+/// bounded by the number of distinct stacks rather than the number of samples.
+class ScriptProfiler
+{
+public:
+   enum
+   {
+      MaxStackDepth = 64,     ///< Outermost frames beyond this are dropped
+      MaxUniqueStacks = 65536 ///< Further new stacks are counted as dropped
+   };
+
+   struct Frame
+   {
+      StringTableEntry file;
+      StringTableEntry function;
+      StringTableEntry nameSpace;
+      U32 line;
+      U32 next; ///< Next frame with the same hash (index+1)
+   };
+
+   struct Stack
+   {
+      U32 start; ///< First frame id in mStackFrames (root first)
+      U32 depth;
+      U32 count; ///< Number of samples
+      U32 next;  ///< Next stack with the same hash (index+1)
+   };
+
+protected:
+   typedef std::unordered_map<U32, U32, std::hash<U32>, std::equal_to<U32>,
+                              KorkApi::TlsVmAllocator<std::pair<const U32, U32> > > HashHeadMap;
+
+   KorkApi::VmInternal* mVMInternal;
+   U32 mInterval;
+   U32 mCountdown;
+   bool mActive;
+   std::atomic<bool> mSampleRequested;
+
+   U32 mNumSamples;
+   U32 mNumDropped;
+
+   KorkApi::Vector<Frame> mFrames;
+   KorkApi::Vector<Stack> mStacks;
+   KorkApi::Vector<U32> mStackFrames;
+   HashHeadMap mFrameHeads;
+   HashHeadMap mStackHeads;
+   KorkApi::Vector<U32> mScratch;
+
+   U32 internFrame(CodeBlock* code, U32 ip, StringTableEntry function, StringTableEntry nameSpace);
+   void formatFrame(const Frame& frame, char* buffer, U32 bufferSize, bool withLine);
+
+public:
+   ScriptProfiler(KorkApi::VmInternal* vm);
+   ~ScriptProfiler();
+
+   void start(U32 interval);
+   void stop();
+   void reset();
+
+   inline bool isActive() const { return mActive; }
+   inline U32 getNumSamples() const { return mNumSamples; }
+   inline U32 getNumDropped() const { return mNumDropped; }
+
+   /// May be called from any thread
+   inline void requestSample()
+   {
+      if (mActive)
+         mSampleRequested.store(true, std::memory_order_relaxed);
+   }
+
+   /// Called before each instruction; returns true if a sample should be taken.
+   /// NOTE: mInterval is 0 and no sample is pending while stopped.
+   inline bool tick()
+   {
+      if (mInterval != 0 && --mCountdown == 0)
+      {
+         mCountdown = mInterval;
+         return true;
+      }
+      return mSampleRequested.load(std::memory_order_relaxed) &&
+             mSampleRequested.exchange(false, std::memory_order_relaxed);
+   }
+
+   /// Records the frames of state. ip is the current ip of the top frame.
+   void sample(ExprEvalState* state, U32 ip);
+
+   void dump(KorkApi::ProfilerOutputFormat format, KorkApi::ProfilerOutputFn outputFn, void* userPtr);
+};
@@ -11,6 +11,7 @@
 #include <string_view>
 #include <vector>
 #include <cctype>
+#include <cstring>
 #include <cinttypes>
 
 // NOTE: needs Vector and String type set in SimpleLexer namespace
@@ -18,6 +19,10 @@
 namespace SimpleLexer
 {
 
+/// Streaming source callback; should fill data with up to size bytes,
+/// returning the amount read (0 at the end of the source).
+typedef U32 (*SourceReadFn)(void* userPtr, void* data, U32 size);
+
 struct SrcPos
 {
    S32 line;
@@ -164,11 +169,191 @@ struct Token
    {
       return static_cast<char>(ivalue);
    }
+   
+   /// True if stringValue refers to the tokenizer source buffer
+   inline bool hasSourceString() const
+   {
+      return kind == TokenType::STRATOM || kind == TokenType::STREND ||
+             kind == TokenType::TAGATOM || kind == TokenType::DOCBLOCK;
+   }
+};
+
+// Character classes used by the tokenizer. These are fixed ASCII classes
+// so the lexer does not depend on the current C locale.
+enum CharClassFlags : U8
+{
+   CC_SPACE   = BIT(0), // ' ', \t, \v, \f
+   CC_NEWLINE = BIT(1), // \r, \n
+   CC_LETTER  = BIT(2), // [A-Za-z_]
+   CC_DIGIT   = BIT(3), // [0-9]
+   CC_HEX     = BIT(4), // [0-9A-Fa-f]
+   CC_COLON   = BIT(5), // ':' (allowed inside variable names)
+   CC_SINGLE  = BIT(6), // single-char operator tokens
+
+   CC_IDTAIL  = CC_LETTER | CC_DIGIT,
+   CC_VARMID  = CC_LETTER | CC_DIGIT | CC_COLON
+};
+
+struct CharClassTable
+{
+   U8 flags[256];
+};
+
+constexpr CharClassTable buildCharClassTable()
+{
+   CharClassTable table = {};
+
+   table.flags[(U8)' ']  = CC_SPACE;
+   table.flags[(U8)'\t'] = CC_SPACE;
+   table.flags[(U8)'\v'] = CC_SPACE;
+   table.flags[(U8)'\f'] = CC_SPACE;
+   table.flags[(U8)'\r'] = CC_NEWLINE;
+   table.flags[(U8)'\n'] = CC_NEWLINE;
+
+   for (U32 c='a'; c<='z'; c++)
+   {
+      table.flags[c] |= CC_LETTER;
+      table.flags[c - 'a' + 'A'] |= CC_LETTER;
+   }
+   table.flags[(U8)'_'] |= CC_LETTER;
+
+   for (U32 c='0'; c<='9'; c++)
+   {
+      table.flags[c] |= CC_DIGIT | CC_HEX;
+   }
+   for (U32 c='a'; c<='f'; c++)
+   {
+      table.flags[c] |= CC_HEX;
+      table.flags[c - 'a' + 'A'] |= CC_HEX;
+   }
+
+   table.flags[(U8)':'] |= CC_COLON;
+
+   const char* singles = "?[]()+-*/<>|.!:;{},&%^~=";
+   for (const char* s = singles; *s; s++)
+   {
+      table.flags[(U8)*s] |= CC_SINGLE;
+   }
+
+   return table;
+}
+
+inline constexpr CharClassTable gCharClasses = buildCharClassTable();
+
+inline bool charIs(char c, U8 flags)
+{
+   return (gCharClasses.flags[(U8)c] & flags) != 0;
+}
+
+// Reserved words are looked up with a perfect hash over
+// (length, first char, last char); see keywordHash.
+struct KeywordInfo
+{
+   const char* val;
+   U8 len;
+   TokenType kind;
+};
+
+inline constexpr KeywordInfo gKeywords[] = {
+   {"in",        2, TokenType::rwIN},
+   {"or",        2, TokenType::rwCASEOR},
+   {"break",     5, TokenType::rwBREAK},
+   {"return",    6, TokenType::rwRETURN},
+   {"else",      4, TokenType::rwELSE},
+   {"assert",    6, TokenType::rwASSERT},
+   {"while",     5, TokenType::rwWHILE},
+   {"do",        2, TokenType::rwDO},
+   {"if",        2, TokenType::rwIF},
+   {"try",       3, TokenType::rwTRY},
+   {"catch",     5, TokenType::rwCATCH},
+   {"foreach$",  8, TokenType::rwFOREACHSTR},
+   {"foreach",   7, TokenType::rwFOREACH},
+   {"for",       3, TokenType::rwFOR},
+   {"continue",  8, TokenType::rwCONTINUE},
+   {"function",  8, TokenType::rwDEFINE},
+   {"signal",    6, TokenType::rwSIGNAL},
+   {"new",       3, TokenType::rwDECLARE},
+   {"singleton", 9, TokenType::rwDECLARESINGLETON},
+   {"datablock", 9, TokenType::rwDATABLOCK},
+   {"case",      4, TokenType::rwCASE},
+   {"switch$",   7, TokenType::rwSWITCHSTR},
+   {"switch",    6, TokenType::rwSWITCH},
+   {"default",   7, TokenType::rwDEFAULT},
+   {"package",   7, TokenType::rwPACKAGE},
+   {"namespace", 9, TokenType::rwNAMESPACE},
+   {"true",      4, TokenType::INTCONST},
+   {"false",     5, TokenType::INTCONST}
+};
+
+enum
+{
+   KeywordHashSize = 64,
+   KeywordMaxLen = 9
 };
 
+constexpr U32 keywordHash(U32 len, char first, char last)
+{
+   return (len * 9 + (U8)first * 28 + (U8)last) & (KeywordHashSize-1);
+}
+
+struct KeywordHashTable
+{
+   S8 slots[KeywordHashSize]; // index into gKeywords, or -1
+   bool perfect;
+};
+
+constexpr KeywordHashTable buildKeywordHashTable()
+{
+   KeywordHashTable table = {};
+   table.perfect = true;
+
+   for (U32 i=0; i<KeywordHashSize; i++)
+   {
+      table.slots[i] = -1;
+   }
+
+   for (U32 i=0; i<sizeof(gKeywords) / sizeof(gKeywords[0]); i++)
+   {
+      const KeywordInfo& kw = gKeywords[i];
+      U32 h = keywordHash(kw.len, kw.val[0], kw.val[kw.len-1]);
+      if (table.slots[h] >= 0)
+      {
+         table.perfect = false;
+      }
+      table.slots[h] = (S8)i;
+   }
+
+   return table;
+}
+
+inline constexpr KeywordHashTable gKeywordHash = buildKeywordHashTable();
+static_assert(gKeywordHash.perfect, "keywordHash has collisions; pick new multipliers");
+
+inline const KeywordInfo* findKeyword(const char* str, U32 len)
+{
+   if (len < 2 || len > KeywordMaxLen)
+   {
+      return nullptr;
+   }
+
+   S8 idx = gKeywordHash.slots[keywordHash(len, str[0], str[len-1])];
+   if (idx < 0 || gKeywords[idx].len != len ||
+       memcmp(gKeywords[idx].val, str, len) != 0)
+   {
+      return nullptr;
+   }
+
+   return &gKeywords[idx];
+}
+
 template<class I> class Tokenizer
 {
 public:
+   enum
+   {
+      ReadChunkSize = 64 * 1024
+   };
+   
    explicit Tokenizer(I it, std::string_view src, String filename, bool enableInterpolation)
    : mStringIntern(it), mFilename(std::move(filename))
    {
@@ -178,10 +363,55 @@ public:
       mSource.resize(src.size()+1);
       memcpy(&mSource[0], &src[0], src.size());
       mSource[src.size()] = '\0';
+      mReadFn = nullptr;
+      mReadUserPtr = nullptr;
+      mStreamDone = true;
       mInterpState = {};
       mInterpState.doInterp = enableInterpolation;
    }
    
+   /// Switches to streaming mode, replacing any source with that read on
+   /// demand via readFn.
+   ///
+   /// Before each token the rest of the current line is buffered (no token
+   /// other than block comments and docblocks spans a line), and consumed
+   /// source can be dropped with discardBefore().
+   void setStreamSource(SourceReadFn readFn, void* readUserPtr)
+   {
+      mPos = {};
+      mPos.line = 1;
+      mBytePos = 0;
+      mSource.resize(1);
+      mSource[0] = '\0';
+      mReadFn = readFn;
+      mReadUserPtr = readUserPtr;
+      mStreamDone = false;
+   }
+   
+   inline bool isStreaming() const { return mReadFn != nullptr; }
+   inline U32 bytePos() const { return (U32)mBytePos; }
+   
+   /// Drops buffered source before offset, returning the number of bytes
+   /// removed (which should be subtracted from any live token offsets).
+   /// Nothing is removed until at least a chunk has been consumed so the
+   /// copy of the remaining buffer is amortized.
+   U32 discardBefore(U32 offset)
+   {
+      if (offset > mBytePos)
+      {
+         offset = (U32)mBytePos;
+      }
+      
+      if (offset < ReadChunkSize)
+      {
+         return 0;
+      }
+      
+      mSource.erase(mSource.begin(), mSource.begin() + offset);
+      mBytePos -= offset;
+      return offset;
+   }
+   
    inline const String& filename() const { return mFilename; }
    inline int line()  const { return mPos.line; }
    inline int col()   const { return mPos.col;  }
@@ -360,6 +590,8 @@ public:
    {
       for (;;)
       {
+         ensureLine();
+         
          // Interpolated strings - handle pending @
          if (havePendingConcat())
          {
@@ -381,21 +613,9 @@ public:
          if (!noSkipSpaces)
          {
             // Handle newlines / whitespace
-            if (peek() == '\r')
+            if (charIs(peek(), CC_SPACE | CC_NEWLINE))
             {
-               advance();
-               continue;
-            }
-            
-            if (peek() == '\n')
-            {
-               advanceNewline();
-               continue;
-            }
-            
-            if (isSpace(peek()))
-            {
-               skipSpaces();
+               skipWhitespace();
                continue;
             }
             
@@ -478,18 +698,26 @@ public:
             return scanString(peek() == '\'' ? TokenType::TAGATOM : TokenType::STRATOM, peek());
          }
          
-         // Multi-char operators (longest first)
-         t = scanMultiOps();
-         if (!t.isNone())
+         const char c = peek();
+         
+         // Multi-char operators (longest first); these all start with a single-char operator or '$'
+         if (charIs(c, CC_SINGLE) || c == '$')
          {
-            return t;
+            t = scanMultiOps();
+            if (!t.isNone())
+            {
+               return t;
+            }
          }
          
          // Special words mapping to pseudo-characters: NL, TAB, SPC, @
-         t = scanMagicAtoms();
-         if (!t.isNone())
+         if (c == 'N' || c == 'T' || c == 'S' || c == '@')
          {
-            return t;
+            t = scanMagicAtoms();
+            if (!t.isNone())
+            {
+               return t;
+            }
          }
          
          // Hex literal: 0xNNN
@@ -499,8 +727,8 @@ public:
          }
          
          // Float / Integer
-         if (std::isdigit((unsigned char)peek()) ||
-             (peek()=='.' && std::isdigit((unsigned char)peek(1))) )
+         if (isDigit(peek()) ||
+             (peek()=='.' && isDigit(peek(1))) )
          {
             Token t = scanNumber();
             if (t.kind != TokenType::NONE)
@@ -517,7 +745,7 @@ public:
          
          // ILID: [$%][0-9]+[A-Za-z_]... (illegal)
          if (beither2('$', '%') &&
-             std::isdigit((unsigned char)peek(1)))
+             isDigit(peek(1)))
          {
             return illegal("variables must begin with letters");
          }
@@ -529,8 +757,7 @@ public:
          }
          
          // Single-char tokens
-         static const String singles = "?[]()+-*/<>|.!:;{},&%^~=.";
-         if (singles.find(peek()) != String::npos)
+         if (charIs(peek(), CC_SINGLE))
          {
             char ch = (char)peek();
             Token t = makeChar(ch);
@@ -550,11 +777,66 @@ private:
    S64 mBytePos;
    SrcPos mPos;
    InterpolationState mInterpState;
+   SourceReadFn mReadFn;
+   void* mReadUserPtr;
+   Vector<char> mReadBuffer;
+   bool mStreamDone;
    
 public:
    I mStringIntern;
 private:
    
+   // --- streaming
+   
+   // Appends the next chunk of source, returning false at the end
+   bool fill()
+   {
+      if (mStreamDone)
+      {
+         return false;
+      }
+      
+      if (mReadBuffer.empty())
+      {
+         mReadBuffer.resize(ReadChunkSize);
+      }
+      
+      const U32 got = mReadFn(mReadUserPtr, &mReadBuffer[0], ReadChunkSize);
+      if (got == 0)
+      {
+         mStreamDone = true;
+         return false;
+      }
+      
+      // Insert before the terminating nul
+      mSource.insert(mSource.end() - 1, mReadBuffer.begin(), mReadBuffer.begin() + got);
+      return true;
+   }
+   
+   // Makes sure the rest of the current line is buffered
+   inline void ensureLine()
+   {
+      if (mStreamDone)
+      {
+         return;
+      }
+      
+      S64 from = mBytePos;
+      for (;;)
+      {
+         const S64 end = sourceEnd();
+         if (from < end && memchr(&mSource[from], '\n', end - from) != nullptr)
+         {
+            return;
+         }
+         from = end;
+         if (!fill())
+         {
+            return;
+         }
+      }
+   }
+   
    // --- utilities
    bool eof(S64 off = 0) const
    {
@@ -595,69 +877,164 @@ private:
       ++mBytePos; ++mPos.line; mPos.col = 1;
    }
    
+   // Consumes n bytes known not to contain a newline
+   inline void advanceSameLine(S64 n)
+   {
+      mBytePos += n;
+      mPos.col += (S32)n;
+   }
+   
+   // Consumes up to end, updating line info for any newlines in the span
+   void advanceTo(S64 end)
+   {
+      const char* start = &mSource[mBytePos];
+      const char* last = nullptr;
+      const char* p = start;
+      const char* stop = start + (end - mBytePos);
+      
+      while ((p = (const char*)memchr(p, '\n', stop - p)) != nullptr)
+      {
+         ++mPos.line;
+         last = p++;
+      }
+      
+      if (last)
+      {
+         mPos.col = 1 + (S32)(stop - last - 1);
+      }
+      else
+      {
+         mPos.col += (S32)(end - mBytePos);
+      }
+      
+      mBytePos = end;
+   }
+   
+   // NOTE: the buffer always ends in '\0' which has no class,
+   // so the run loops below stop at the end of the source.
+   inline S64 runLength(S64 from, U8 flags) const
+   {
+      const char* p = &mSource[from];
+      const char* start = p;
+      while (charIs(*p, flags))
+      {
+         ++p;
+      }
+      return p - start;
+   }
+   
+   inline S64 sourceEnd() const
+   {
+      return (S64)mSource.size() - 1;
+   }
+   
    static bool isSpace(char c)
    {
-      return c==' ' || c=='\t' || c=='\v' || c=='\f';
+      return charIs(c, CC_SPACE);
    }
    
    static bool isLetter(char c)
    {
-      return std::isalpha((unsigned char)c) || c=='_';
+      return charIs(c, CC_LETTER);
+   }
+   
+   static bool isDigit(char c)
+   {
+      return charIs(c, CC_DIGIT);
    }
    
    static bool isIdTail(char c)
    {
-      return std::isalnum((unsigned char)c) || c=='_';
+      return charIs(c, CC_IDTAIL);
    }
    
    static bool isVarMid(char c)
    {
-      return std::isalnum((unsigned char)c) || c=='_' || c==':';
+      return charIs(c, CC_VARMID);
    }
    
    static bool isHex(char c)
    {
-      return std::isdigit((unsigned char)c) ||
-      (c>='a'&&c<='f') || (c>='A'&&c<='F');
+      return charIs(c, CC_HEX);
    }
    
-   void skipSpaces()
+   void skipWhitespace()
    {
-      while (isSpace(peek()))
+      const char* p = &mSource[mBytePos];
+      for (;;)
       {
-         advance();
+         const char c = *p;
+         if (c == '\n')
+         {
+            ++mPos.line;
+            mPos.col = 1;
+         }
+         else if (charIs(c, CC_SPACE | CC_NEWLINE))
+         {
+            ++mPos.col;
+         }
+         else
+         {
+            break;
+         }
+         ++p;
       }
+      mBytePos = p - &mSource[0];
    }
    
    void skipLine()
    {
-      while (!eof() && peek()!='\n')
+      // leave newline to outer loop
+      const S64 end = sourceEnd();
+      if (mBytePos >= end)
       {
-         advance(); /* leave newline to outer loop */
+         return;
       }
+      
+      const char* start = &mSource[mBytePos];
+      const char* nl = (const char*)memchr(start, '\n', end - mBytePos);
+      advanceSameLine(nl ? (nl - start) : (end - mBytePos));
    }
    
    bool skipBlockComment()
    {
       // consume /*
-      advance(); advance();
-      char prev = 0;
-      while (!eof())
+      advanceSameLine(2);
+      
+      S64 search = mBytePos;
+      
+      for (;;)
       {
-         char c = peek();
-         if (c == '\n')
+         S64 end = sourceEnd();
+         const char* star = search < end ? (const char*)memchr(&mSource[search], '*', end - search) : nullptr;
+         if (star == nullptr)
          {
-            advanceNewline();
+            // Comment continues past the buffered source
+            search = end;
+            if (fill())
+            {
+               continue;
+            }
+            break;
          }
-         else
+         
+         search = (star - &mSource[0]) + 1;
+         if (search >= end && fill())
          {
-            advance();
+            end = sourceEnd();
          }
-         if (prev=='*' && c=='/')
+         
+         if (search < end && mSource[search] == '/')
          {
+            advanceTo(search + 1);
             return true;
          }
-         prev = c;
+      }
+      
+      const S64 end = sourceEnd();
+      if (mBytePos < end)
+      {
+         advanceTo(end);
       }
       return false;
    }
@@ -735,6 +1112,7 @@ private:
          if (!eof() && peek() == '\n')
          {
             advanceNewline();
+            ensureLine();
          }
       }
       
@@ -855,10 +1233,6 @@ private:
       bool sawDot = false;
       bool sawExp = false;
       
-      auto isDigit = [](char c) {
-         return std::isdigit((unsigned char)c)!=0;
-      };
-      
       if (peek()=='.')
       {
          sawDot = true;
@@ -1187,11 +1561,8 @@ private:
       bool addedStar = false;
       SrcPos starPos;
       
-      advance(); // first letter/underscore already checked
-      while (isIdTail(peek()))
-      {
-         advance();
-      }
+      // first letter/underscore already checked
+      advanceSameLine(1 + runLength(mBytePos + 1, CC_IDTAIL));
       
       // Handle $
       if (peek() == '$')
@@ -1201,58 +1572,17 @@ private:
          addedStar = true;
       }
       
-      struct CheckTable
+      const KeywordInfo* kw = findKeyword(startStr, (U32)(mBytePos - t.stringValue.offset));
+      if (kw)
       {
-         const char* val;
-         TokenType kind;
-      };
-      
-      static CheckTable chkTable[] = {
-         {"in",         TokenType::rwIN},
-         {"or",         TokenType::rwCASEOR},
-         {"break",      TokenType::rwBREAK},
-         {"return",     TokenType::rwRETURN},
-         {"else",       TokenType::rwELSE},
-         {"assert",     TokenType::rwASSERT},
-         {"while",      TokenType::rwWHILE},
-         {"do",         TokenType::rwDO},
-         {"if",         TokenType::rwIF},
-         {"try",         TokenType::rwTRY},
-         {"catch",         TokenType::rwCATCH},
-         {"foreach$",   TokenType::rwFOREACHSTR},
-         {"foreach",    TokenType::rwFOREACH},
-         {"for",        TokenType::rwFOR},
-         {"continue",   TokenType::rwCONTINUE},
-         {"function",   TokenType::rwDEFINE},
-         {"signal",     TokenType::rwSIGNAL},
-         {"new",        TokenType::rwDECLARE},
-         {"singleton",  TokenType::rwDECLARESINGLETON},
-         {"datablock",  TokenType::rwDATABLOCK},
-         {"case",       TokenType::rwCASE},
-         {"switch$",    TokenType::rwSWITCHSTR},
-         {"switch",     TokenType::rwSWITCH},
-         {"default",    TokenType::rwDEFAULT},
-         {"package",    TokenType::rwPACKAGE},
-         {"namespace",  TokenType::rwNAMESPACE},
-         {"true",       TokenType::INTCONST},
-         {"false",      TokenType::INTCONST}
-      };
-      
-      for (U32 i=0; i<sizeof(chkTable) / sizeof(chkTable[0]); i++)
-      {
-         //printf("CHK %s %c%c%c%c%c%c%c=%i\n", chkTable[i].val, startStr[0], startStr[1], startStr[2], startStr[3], startStr[4], startStr[5], startStr[6], strlen(chkTable[i].val));
-         if (strncmp(startStr, chkTable[i].val, std::max<S64>(mBytePos - t.stringValue.offset, strlen(chkTable[i].val))) == 0)
+         t.kind = kw->kind;
+         if (t.kind == TokenType::INTCONST)
          {
-            t.kind = chkTable[i].kind;
-            if (t.kind == TokenType::INTCONST)
-            {
-               t.ivalue = (startStr[0] == 't') ? 1 : 0;
-            }
-            else
-            {
-               t.ivalue = 0;
-            }
-            break;
+            t.ivalue = (startStr[0] == 't') ? 1 : 0;
+         }
+         else
+         {
+            t.ivalue = 0;
          }
       }
       
@@ -1290,15 +1620,22 @@ private:
       SrcPos lastGoodSrc = mPos;
       
       // Consume while in VARMID, but remember last position where we ended on IDTAIL.
-      while (isVarMid(peek()))
+      for (;;)
       {
-         char c = peek();
-         advance();
-         if (isIdTail(c))
+         S64 run = runLength(mBytePos, CC_IDTAIL);
+         if (run > 0)
          {
+            advanceSameLine(run);
             lastGood = mBytePos; // we can legally end here
             lastGoodSrc = mPos;
          }
+         
+         run = runLength(mBytePos, CC_COLON);
+         if (run == 0)
+         {
+            break;
+         }
+         advanceSameLine(run);
       }
       
       // Rewind to the last valid end to drop any trailing ':'s
@@ -47,7 +47,7 @@ template<class I> class ASTGen
 public:
    
    ASTGen(SimpleLexer::Tokenizer<I>* tok, Compiler::Resources* res)
-   : mTokenizer(tok), mTokenPos(0), mResources(res)
+   : mTokenizer(tok), mTokenPos(0), mLexDone(false), mResources(res)
    {
       res->currentASTGen = this;
       mErrorToken = TOK();
@@ -69,6 +69,8 @@ public:
          mTokens.push_back(t);
       }
       
+      mLexDone = true;
+      
       if (t.isIllegal() || t.isNone())
       {
          mErrorToken = t;
@@ -110,25 +112,132 @@ public:
       return list;
    }
    
+   /// Streaming alternative to processTokens + parseProgram. Tokens are lexed
+   /// on demand; parses the next top level declaration into outDecl (which may
+   /// be nullptr) and returns false at the end of the input.
+   bool parseNextDecl(StmtNode*& outDecl)
+   {
+      outDecl = nullptr;
+      if (atEnd())
+      {
+         return false;
+      }
+      outDecl = parseDecl();
+      return true;
+   }
+   
+   /// Streaming: drops consumed tokens (bar the last, for errors) and any
+   /// source no longer referenced by the remaining tokens.
+   void releaseConsumedTokens()
+   {
+      if (mTokenPos > 1)
+      {
+         const U64 drop = mTokenPos - 1;
+         mTokens.erase(mTokens.begin(), mTokens.begin() + drop);
+         mTokenPos -= drop;
+      }
+      
+      U32 keepFrom = mTokenizer->bytePos();
+      for (const TOK& t : mTokens)
+      {
+         if (t.hasSourceString() && t.stringValue.offset < keepFrom)
+         {
+            keepFrom = t.stringValue.offset;
+         }
+      }
+      
+      const U32 shift = mTokenizer->discardBefore(keepFrom);
+      if (shift != 0)
+      {
+         for (TOK& t : mTokens)
+         {
+            if (t.hasSourceString())
+            {
+               t.stringValue.offset -= shift;
+            }
+         }
+      }
+   }
+   
 public:
    TOK mErrorToken;
    
+   /// Last consumed token; used for errors raised outside the parser (e.g. allocation)
+   const TOK& currentToken()
+   {
+      return mTokenPos > 0 ? LA((size_t)-1) : LA();
+   }
+   
 private:
    
    SimpleLexer::Tokenizer<I>* mTokenizer;
-   Vector<TOK> mTokens;
+   Deque<TOK> mTokens; // NOTE: deque so LA() references survive lexing more tokens
    U64 mTokenPos;
+   bool mLexDone;
    Compiler::Resources* mResources;
    
    // Token helpers
    
-   const TOK& LA(size_t k=0) const
+   // Lexes tokens on demand when not already done by processTokens
+   void lexTokens(U64 count)
+   {
+      while (mTokens.size() < count)
+      {
+         TOK t = mTokenizer->next();
+         if (t.isEnd())
+         {
+            mLexDone = true;
+            return;
+         }
+         else if (t.isIllegal() || t.isNone())
+         {
+            mLexDone = true;
+            mErrorToken = t;
+            throw TokenError(t, TT::NONE, "invalid token");
+         }
+         mTokens.push_back(t);
+      }
+   }
+   
+   const TOK& LA(size_t k=0)
    {
       static TOK eof; // default END
-      return (mTokenPos+k < mTokens.size()) ? mTokens[mTokenPos+k] : eof;
+      const U64 idx = mTokenPos+k;
+      if (idx >= mTokens.size() && !mLexDone && k != (size_t)-1)
+      {
+         lexTokens(idx+1);
+      }
+      return (idx < mTokens.size()) ? mTokens[idx] : eof;
+   }
+   
+   TOK consume()
+   {
+      TOK t = LA();
+      ++mTokenPos;
+      return t;
+   }
+   
+   // Source strings are referenced in place unless the source is streamed,
+   // in which case the buffer may move or be discarded before compilation.
+   const char* sourceString(const TOK& t)
+   {
+      char* str = mTokenizer->bufferAtOffset(t.stringValue.offset);
+      if (!mTokenizer->isStreaming())
+      {
+         return str;
+      }
+      
+      char* copy = (char*)mResources->astAlloc((U32)dAlignSize(t.stringValue.len + 1, 8));
+      memcpy(copy, str, t.stringValue.len + 1);
+      return copy;
+   }
+   
+   StrConstNode* allocStrConst(const TOK& t, bool tag, bool doc = false)
+   {
+      return StrConstNode::allocView(mResources, t.pos.line, sourceString(t), t.stringValue.len, tag, doc);
    }
    
-   bool atEnd() const
+   bool atEnd()
    {
       return LA().kind == TT::END;
    }
@@ -145,7 +254,7 @@ private:
       return false;
    }
 
-   U32 LAChar(size_t k = 0) const
+   U32 LAChar(size_t k = 0)
    {
       TOK laTok = LA(k);
       return (laTok.kind == TT::opCHAR) ? laTok.ivalue : 0;
@@ -157,7 +266,7 @@ private:
       {
          throw TokenError(LA(), t, what);
       }
-      return mTokens[mTokenPos++];
+      return consume();
    }
    
    TOK expectEither(TT a, TT b, const char* what)
@@ -166,7 +275,7 @@ private:
       {
          throw TokenError(LA(), a, what);
       }
-      return mTokens[mTokenPos++];
+      return consume();
    }
    
    TOK expectChar(char c, const char* what)
@@ -175,7 +284,7 @@ private:
       {
          throw TokenError(LA(), TT::opCHAR, what);
       }
-      return mTokens[mTokenPos++];
+      return consume();
    }
    
    void errorHere(const TOK& tok, String msg)
@@ -644,7 +753,7 @@ private:
    // Checks if the current token the start of a slot assignment.
    //
    // slot_assign starts with: IDENT ...  |  rwDATABLOCK
-   bool beginsSlotAssign() const
+   bool beginsSlotAssign()
    {
       using K = TT;
       const TOK& t = LA();
@@ -772,7 +881,7 @@ private:
       return parseSlotAssignList(object);
    }
    
-   inline bool beginsObjectDecl() const
+   inline bool beginsObjectDecl()
    {
       using K = TT;
       TT k = LA().kind;
@@ -947,7 +1056,7 @@ private:
       {
          if (!mResources->allowSignals)
          {
-            errorHere(mTokens[mTokenPos - 1], "signals not enabled");
+            errorHere(LA((size_t)-1), "signals not enabled");
             return nullptr;
          }
          isSignal = true;
@@ -1087,15 +1196,15 @@ private:
          }
             
          case TT::rwBREAK: {
-            TOK tok = mTokens[mTokenPos++]; expectChar(';', "; expected");
+            TOK tok = consume(); expectChar(';', "; expected");
             return BreakStmtNode::alloc(mResources, (S32)tok.pos.line);
          }
          case TT::rwCONTINUE: {
-            TOK tok = mTokens[mTokenPos++]; expectChar(';', "; expected");
+            TOK tok = consume(); expectChar(';', "; expected");
             return ContinueStmtNode::alloc(mResources, (S32)tok.pos.line);
          }
          case TT::rwRETURN: {
-            TOK tok = mTokens[mTokenPos++];
+            TOK tok = consume();
             if (!matchChar(';'))
             {
                ExprNode*  e = parseExprNode();
@@ -1108,8 +1217,8 @@ private:
             return parseAssertStmt();
             
          case TT::DOCBLOCK: { // also valid inside blocks
-            TOK tok = mTokens[mTokenPos++];
-            return StrConstNode::alloc(mResources, tok.pos.line, mTokenizer->bufferAtOffset(tok.stringValue.offset), false, true, tok.stringValue.len);
+            TOK tok = consume();
+            return allocStrConst(tok, false, true);
          }
 
          // NOTE: in effect this allows:
@@ -1253,7 +1362,7 @@ private:
       if (matchChar(','))
       {
          expect(TT::STRATOM, "assert requires message string");
-         msg = mTokenizer->bufferAtOffset(LA(-1).stringValue.offset);
+         msg = sourceString(LA(-1));
       }
       
       expectChar(')', "')' expected after assert(...)");
@@ -1360,12 +1469,12 @@ private:
    ExprNode* parseExpression(int rbp)
    {
       // prefix / primary
-      TOK t = mTokens[mTokenPos++];
+      TOK t = consume();
       
       // Skip begin string
       if (t.kind == TT::STRBEG)
       {
-         t = mTokens[mTokenPos++];
+         t = consume();
       }
       
       ExprNode* left = nud(t);
@@ -1378,7 +1487,7 @@ private:
          if (bp <= rbp)
             break;
          
-         TOK op = mTokens[mTokenPos++];
+         TOK op = consume();
          left = led(op, left, bp);
       }
       
@@ -1394,7 +1503,7 @@ private:
            if (bp <= rbp)
                break;
 
-           TOK op = mTokens[mTokenPos++];
+           TOK op = consume();
            left = led(op, left, bp);
        }
        return left;
@@ -1613,10 +1722,11 @@ private:
             // Literals
          case TT::INTCONST:   return IntNode::alloc(mResources, t.pos.line, (S32)t.ivalue);
          case TT::FLTCONST:   return FloatNode::alloc(mResources, t.pos.line, t.value);
+         // String literals are decoded in place by the tokenizer, so nodes just reference its buffer (see sourceString)
          case TT::STREND:
-         case TT::STRATOM:    return StrConstNode::alloc(mResources, t.pos.line, mTokenizer->bufferAtOffset(t.stringValue.offset), false);
-         case TT::TAGATOM:    return StrConstNode::alloc(mResources, t.pos.line, mTokenizer->bufferAtOffset(t.stringValue.offset), true);
-         case TT::DOCBLOCK:   return StrConstNode::alloc(mResources, t.pos.line, mTokenizer->bufferAtOffset(t.stringValue.offset), false, true, t.stringValue.len);
+         case TT::STRATOM:    return allocStrConst(t, false);
+         case TT::TAGATOM:    return allocStrConst(t, true);
+         case TT::DOCBLOCK:   return allocStrConst(t, false, true);
             
          case TT::opPLUSPLUS:
          case TT::opMINUSMINUS:
@@ -13,6 +13,7 @@
 #include <memory>
 #include <type_traits>
 #include <vector>
+#include <deque>
 #include <string>
 #include "core/dataChunker.h"
 
@@ -102,6 +103,8 @@ struct TlsVmAllocator
 using String = std::basic_string<char, std::char_traits<char>, TlsVmAllocator<char>>;
 template<class T>
 using Vector = std::vector<T, TlsVmAllocator<T>>;
+template<class T>
+using Deque = std::deque<T, TlsVmAllocator<T>>;
 using VMChunker = DataChunker<TlsVmAllocator<char>>;
 
 }
@@ -113,6 +116,8 @@ namespace SimpleParser
 	using String = KorkApi::String;
    template<class T>
 	using Vector = KorkApi::Vector<T>;
+   template<class T>
+	using Deque = KorkApi::Deque<T>;
 };
 
 namespace SimpleLexer
@@ -153,7 +153,14 @@ void StringStack::setConsoleValue(KorkApi::VmInternal* vmInternal, KorkApi::Cons
       {
          if (v.typeId == KorkApi::ConsoleValue::TypeInternalString)
          {
-            setStringValue((const char*)valueBase);
+            if (valueBase && v.len != KorkApi::ConsoleValue::UnknownLen)
+            {
+               setStringValueLen((const char*)valueBase, v.len);
+            }
+            else
+            {
+               setStringValue((const char*)valueBase);
+            }
          }
          else if (valueBase)
          {
@@ -178,7 +185,7 @@ void StringStack::setConsoleValue(KorkApi::VmInternal* vmInternal, KorkApi::Cons
       }
       else if (v.typeId == KorkApi::ConsoleValue::TypeInternalString)
       {
-         mLen = (U32)strlen((const char*)valueBase);
+         mLen = v.len != KorkApi::ConsoleValue::UnknownLen ? v.len : (U32)strlen((const char*)valueBase);
       }
       mType = v.typeId;
    }
@@ -162,6 +162,19 @@ struct StringStack
       return ret;
    }
 
+   /// Return a buffer in the return space of frame (1 based), which is where the
+   /// top of the stack will be once the frame is popped. Returns false if size
+   /// doesn't fit.
+   bool getFrameReturnBuffer(U32 frame, U16 valueType, U32 size, KorkApi::ConsoleValue& outValue)
+   {
+      if (frame == 0 || frame > mNumFrames || size > ReturnBufferSpace)
+      {
+         return false;
+      }
+      outValue.setTyped((U64)(mStartOffsets[mFrameOffsets[frame-1]]), valueType, (KorkApi::ConsoleValue::Zone)((U32)KorkApi::ConsoleValue::ZoneFunc + mFuncId));
+      return true;
+   }
+
    /// Return a buffer we can use for arguments.
    ///
    /// This updates the function offset.
@@ -199,6 +212,20 @@ struct StringStack
       }
    }
    
+   /// Set a string value of known length on the top of the stack.
+   void setStringValueLen(const char *s, U32 len)
+   {
+      mLen = len;
+      mType = KorkApi::ConsoleValue::TypeInternalString;
+      
+      if ((mBuffer.data() + mStart) != s)
+      {
+         validateBufferSize(mStart + mLen + 2);
+         memmove(mBuffer.data() + mStart, s, mLen);
+      }
+      mBuffer[mStart + mLen] = '\0';
+   }
+   
    void copyStoredValueToStack(KorkApi::VmInternal* vmInternal, KorkApi::ConsoleValue v, void* ptr);
 
    /// Set a string value on the top of the stack.
@@ -252,13 +279,25 @@ struct StringStack
       return mBuffer.data() + mStart;
    }
 
+   /// Get the length of the string on the top of the stack, or
+   /// ConsoleValue::UnknownLen if it isn't a string.
+   inline U32 getStringValueLen() const
+   {
+      return mType == KorkApi::ConsoleValue::TypeInternalString ? mLen : (U32)KorkApi::ConsoleValue::UnknownLen;
+   }
+
    inline KorkApi::ConsoleValue getConsoleValue()
    {
       if (mType == KorkApi::ConsoleValue::TypeInternalString || 
          mType >= KorkApi::ConsoleValue::TypeBeginCustom)
       {
          // Strings and types are put on stack
-         return KorkApi::ConsoleValue::makeRaw(&mBuffer[mStart] - &mBuffer[0], mType, (KorkApi::ConsoleValue::Zone)(KorkApi::ConsoleValue::ZoneFunc + mFuncId));
+         KorkApi::ConsoleValue ret = KorkApi::ConsoleValue::makeRaw(&mBuffer[mStart] - &mBuffer[0], mType, (KorkApi::ConsoleValue::Zone)(KorkApi::ConsoleValue::ZoneFunc + mFuncId));
+         if (mType == KorkApi::ConsoleValue::TypeInternalString)
+         {
+            ret.len = mLen;
+         }
+         return ret;
       }
       else
       {
@@ -281,9 +320,14 @@ struct StringStack
       else
       {
          UINTPTR startData = mStartOffsets[offset];
-         return KorkApi::ConsoleValue::makeTyped((void*)startData,
+         KorkApi::ConsoleValue ret = KorkApi::ConsoleValue::makeTyped((void*)startData,
                                                        mStartTypes[offset],
                                                        (KorkApi::ConsoleValue::Zone)(KorkApi::ConsoleValue::ZoneFunc + mFuncId));
+         if (typeId == KorkApi::ConsoleValue::TypeInternalString)
+         {
+            ret.len = mStartLengths[offset];
+         }
+         return ret;
       }
    }
 
@@ -338,25 +382,47 @@ struct StringStack
    /// Pop the start stack.
    void rewind()
    {
+      U32 oldLen = mLen;
       if (mType != KorkApi::ConsoleValue::TypeInternalString) // termimate regardless if incorrect type
       {
          mBuffer[mStart] = 0;
+         oldLen = 0;
       }
 
+      U32 oldStart = mStart;
       mStart = mStartOffsets[--mStartStackSize];
       mType = mStartTypes[mStartStackSize];
       mValue = mStartValues[mStartStackSize];
-      mLen = getHeadLength();
+      mLen = getJoinedLength(oldStart, oldLen);
    }
 
    // Terminate the current string, and pop the start stack.
    void rewindTerminate()
    {
       mBuffer[mStart] = 0;
+      U32 oldStart = mStart;
       mStart = mStartOffsets[--mStartStackSize];
       mType = mStartTypes[mStartStackSize];
       mValue = mStartValues[mStartStackSize];
-      mLen = getHeadLength();
+      mLen = getJoinedLength(oldStart, 0);
+   }
+
+   /// Length of the head once the value at oldStart (oldLen bytes) has been
+   /// popped into it. Strings are joined unless advanceChar(0) separated them.
+   U32 getJoinedLength(U32 oldStart, U32 oldLen) const
+   {
+      if (mType != KorkApi::ConsoleValue::TypeInternalString)
+      {
+         return getHeadLength();
+      }
+      
+      const U32 prevLen = mStartLengths[mStartStackSize];
+      const U32 gap = oldStart - mStart;
+      if (gap > prevLen && mBuffer[oldStart-1] == '\0')
+      {
+         return prevLen;
+      }
+      return gap + oldLen;
    }
 
    U32 getHeadLength() const
@@ -382,12 +448,18 @@ struct StringStack
       // Figure out the 1st and 2nd item offsets.
       U32 oldStart = mStart;
       U8 oldType = mType;
+      U32 oldLen = mLen;
       mStart = mStartOffsets[--mStartStackSize];
       mType = mStartTypes[mStartStackSize];
       mValue = mStartValues[mStartStackSize];
 
-      // Compare current and previous strings.
-      U32 ret = mType == oldType ? !strcasecmp(mBuffer.data() + mStart, mBuffer.data() + oldStart) : 0;
+      // Compare current and previous strings; strings of different lengths can't match.
+      U32 ret = 0;
+      if (mType == oldType &&
+          (mType != KorkApi::ConsoleValue::TypeInternalString || mStartLengths[mStartStackSize] == oldLen))
+      {
+         ret = !strcasecmp(mBuffer.data() + mStart, mBuffer.data() + oldStart);
+      }
 
       // Put an empty string on the top of the stack.
       mLen = 0;
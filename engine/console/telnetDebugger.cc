@@ -26,6 +26,7 @@
 #include "console/consoleInternal.h"
 #include "console/consoleNamespace.h"
 #include "console/compiler.h"
+#include "console/codeBlock.h"
 #include "console/telnetDebugger.h"
 
 
@@ -103,18 +104,18 @@ static void debuggerConsumer(U32 level, const char *line, void* userPtr)
 
 TelnetDebugger::TelnetDebugger(KorkApi::VmInternal* vm)
 {
+   mVMInternal = vm;
    mVMInternal->mConfig.extraConsumers[1].cbFunc = debuggerConsumer;
    mVMInternal->mConfig.extraConsumers[1].cbUser = this;
-   mVMInternal = vm;
    mCurrentWatchFiber = nullptr;
    
    mAcceptPort = -1;
    
    mState = NotConnected;
    mCurPos = 0;
+   mDebugSocket = 0;
    
    mBreakpoints = nullptr;
-   mBreakOnNextStatement = false;
    mProgramPaused = false;
    mWaitForClient = false;
 
@@ -317,6 +318,10 @@ void TelnetDebugger::checkDebugRecv()
          return;
       }
       
+      // Nothing more to read for now
+      if (numBytes == 0)
+         return;
+      
       mCurPos += numBytes;
    }
 }
@@ -326,12 +331,15 @@ void TelnetDebugger::executionStopped(CodeBlock *code, U32 lineNumber)
    if (mProgramPaused)
       return;
 
+   ExprEvalState* state = mVMInternal->mCurrentFiberState;
+   const bool stepDone = state->mStepBreakDepth != 0 && state->vmFrames.size() <= state->mStepBreakDepth;
+   
    // Need to switch to whatever fiber we are on
    setWatchFiberFromVm();
    
-   if (mBreakOnNextStatement)
+   if (stepDone)
    {
-      setBreakOnNextStatement( false );
+      clearStepBreaks();
       breakProcess();
       return;
    }
@@ -343,13 +351,7 @@ void TelnetDebugger::executionStopped(CodeBlock *code, U32 lineNumber)
    Breakpoint *brk = *bp;
    mProgramPaused = true;
 
-   char buf[256];
-   snprintf(buf, 256, "$Debug::result = %s;", brk->testExpression.c_str());
-   mVMInternal->mVM->evalCode(buf, "", "");
-
-   KorkApi::ConsoleValue cv = mVMInternal->mVM->getGlobalVariable("$Debug::result");
-
-   if (mVMInternal->valueAsBool(cv))
+   if (testBreakpointCondition(brk))
    {
       brk->curCount++;
       if(brk->curCount >= brk->passCount)
@@ -368,29 +370,37 @@ bool TelnetDebugger::isWatchedFiber()
    return mCurrentWatchFiber == mVMInternal->mCurrentFiberState;
 }
 
-void TelnetDebugger::pushStackFrame()
+void TelnetDebugger::setStepBreak(U32 maxDepth)
 {
-   if(mState == NotConnected || !isWatchedFiber())
-      return;
+   clearStepBreaks();
    
-   if(mBreakOnNextStatement && 
-      mCurrentWatchFiber->mStackPopBreakIndex > -1 &&
-      mCurrentWatchFiber->vmFrames.size() > mCurrentWatchFiber->mStackPopBreakIndex)
+   // With no fiber being watched yet, stop in whichever runs first
+   if (mCurrentWatchFiber)
    {
-      setBreakOnNextStatement( false );
+      mCurrentWatchFiber->mStepBreakDepth = maxDepth;
+   }
+   else
+   {
+      setStepBreakAll(maxDepth);
    }
 }
 
-void TelnetDebugger::popStackFrame()
+void TelnetDebugger::setStepBreakAll(U32 maxDepth)
 {
-   if(mState == NotConnected || !isWatchedFiber())
-      return;
+   mVMInternal->mFiberStates.forEach([maxDepth](ExprEvalState* state){
+      state->mStepBreakDepth = maxDepth;
+   });
    
-   if(mCurrentWatchFiber->mStackPopBreakIndex > -1 && 
-      mCurrentWatchFiber->vmFrames.size()-1 <= mCurrentWatchFiber->mStackPopBreakIndex)
-   {
-      setBreakOnNextStatement( true );
-   }
+   // Fibers created before the step completes start with it too
+   mVMInternal->mPendingStepBreakDepth = maxDepth;
+}
+
+void TelnetDebugger::clearStepBreaks()
+{
+   mVMInternal->mFiberStates.forEach([](ExprEvalState* state){
+      state->mStepBreakDepth = 0;
+   });
+   mVMInternal->mPendingStepBreakDepth = 0;
 }
 
 void TelnetDebugger::breakProcess()
@@ -456,10 +466,7 @@ void TelnetDebugger::sendBreak()
             function = "<none>";
          strcat( scope, function );
          
-         U32 line=0, inst;
-         U32 ip = frameInfo.ip;
-         if (code)
-            code->findBreakLine(ip, line, inst);
+         U32 line = code ? code->getLineForIp(frameInfo.ip) : 0;
          snprintf(buffer, MaxCommandSize, " %s %d %s", file, line, scope);
          send(buffer);
       }
@@ -671,10 +678,6 @@ void TelnetDebugger::addAllBreakpoints(CodeBlock *code)
       
       cur = cur->next;
    }
-   
-   // Enable all breaks if a break next was set.
-   if (mBreakOnNextStatement)
-      code->setAllBreaks();
 }
 
 void TelnetDebugger::addBreakpoint(const char *fileName, S32 line, bool clear, S32 passCount, const char *evalString)
@@ -686,7 +689,7 @@ void TelnetDebugger::addBreakpoint(const char *fileName, S32 line, bool clear, S
    {
       // trying to add the same breakpoint...
       Breakpoint *brk = *bp;
-      brk->testExpression = evalString;
+      setBreakpointCondition(brk, evalString);
       brk->passCount = passCount;
       brk->clearOnHit = clear;
       brk->curCount = 0;
@@ -740,12 +743,71 @@ void TelnetDebugger::addBreakpoint(const char *fileName, S32 line, bool clear, S
       brk->passCount = passCount;
       brk->clearOnHit = clear;
       brk->curCount = 0;
-      brk->testExpression = evalString;
+      brk->condition = nullptr;
+      setBreakpointCondition(brk, evalString);
       brk->next = mBreakpoints;
       mBreakpoints = brk;
    }
 }
 
+void TelnetDebugger::setBreakpointCondition(Breakpoint *brk, const char *evalString)
+{
+   brk->testExpression = evalString;
+   brk->conditionValid = true;
+   
+   if (brk->condition)
+   {
+      brk->condition->decRefCount();
+      brk->condition = nullptr;
+   }
+   
+   // Clients send "true" for unconditional breakpoints
+   if (!strcmp(evalString, "true") || !strcmp(evalString, "1"))
+      return;
+   
+   // Compile once here rather than on every hit
+   const char* format = "return %s;";
+   dsize_t len = strlen( format ) + strlen( evalString );
+   char* buffer = mVMInternal->NewArray<char>(len);
+   snprintf( buffer, len, format, evalString );
+   
+   CodeBlock* block = mVMInternal->New<CodeBlock>(mVMInternal, true);
+   if (block->compile(nullptr, nullptr, buffer))
+   {
+      block->incRefCount();
+      brk->condition = block;
+   }
+   else
+   {
+      mVMInternal->Delete(block);
+      brk->conditionValid = false;
+      
+      char msg[MaxCommandSize];
+      snprintf(msg, MaxCommandSize, "DBGERR Invalid breakpoint condition: %s\r\n", evalString);
+      send(msg);
+   }
+   
+   mVMInternal->DeleteArray(buffer);
+}
+
+bool TelnetDebugger::testBreakpointCondition(Breakpoint *brk)
+{
+   if (!brk->conditionValid)
+      return false;
+   if (!brk->condition)
+      return true;
+   
+   KorkApi::ConsoleValue res = brk->condition->exec(0, nullptr, nullptr, 0, nullptr, false, true, nullptr);
+   return mVMInternal->valueAsBool(res);
+}
+
+void TelnetDebugger::freeBreakpoint(Breakpoint *brk)
+{
+   if (brk->condition)
+      brk->condition->decRefCount();
+   mVMInternal->Delete(brk);
+}
+
 void TelnetDebugger::removeBreakpointsFromCode(CodeBlock *code)
 {
    Breakpoint **walk = &mBreakpoints;
@@ -755,7 +817,7 @@ void TelnetDebugger::removeBreakpointsFromCode(CodeBlock *code)
       if(cur->code == code)
       {
          *walk = cur->next;
-         delete walk;
+         freeBreakpoint(cur);
       }
       else
          walk = &cur->next;
@@ -772,7 +834,7 @@ void TelnetDebugger::removeBreakpoint(const char *fileName, S32 line)
       *bp = brk->next;
       if ( brk->code )
          brk->code->clearBreakpoint(brk->lineNumber);
-      delete brk;
+      freeBreakpoint(brk);
    }
 }
 
@@ -786,7 +848,7 @@ void TelnetDebugger::removeAllBreakpoints()
       {
          walk->code->clearBreakpoint(walk->lineNumber);
       }
-      delete walk;
+      freeBreakpoint(walk);
       walk = temp;
    }
    mBreakpoints = nullptr;
@@ -799,58 +861,38 @@ void TelnetDebugger::debugContinue()
       return;
    }
    
-   setBreakOnNextStatement( false );
-   if (mCurrentWatchFiber)
-   {
-      mCurrentWatchFiber->mStackPopBreakIndex = -1;
-   }
+   clearStepBreaks();
    mProgramPaused = false;
    send("RUNNING\r\n");
 }
 
-void TelnetDebugger::setBreakOnNextStatement( bool enabled )
-{
-   if ( enabled )
-   {
-      // Apply breaks on all the code blocks.
-      for(CodeBlock *walk = mVMInternal->mCodeBlockList; walk; walk = walk->nextFile)
-         walk->setAllBreaks();
-      mBreakOnNextStatement = true;
-   }
-   else if ( !enabled )
-   {
-      // Clear all the breaks on the codeblocks
-      // then go reapply the breakpoints.
-      for(CodeBlock *walk = mVMInternal->mCodeBlockList; walk; walk = walk->nextFile)
-         walk->clearAllBreaks();
-      for(Breakpoint *w = mBreakpoints; w; w = w->next)
-      {
-         if ( w->code )
-            w->code->setBreakpoint(w->lineNumber);
-      }
-      mBreakOnNextStatement = false;
-   }
-}
-
 void TelnetDebugger::debugBreakNext()
 {
    if (mState != Connected)
       return;
    
+   // Not tied to the watched fiber; stop in whichever runs next
    if ( !mProgramPaused )
-      setBreakOnNextStatement( true );
+   {
+      setStepBreakAll( U32_MAX );
+   }
 }
 
 void TelnetDebugger::debugStepIn()
 {
    // Note that step in is allowed during
    // the initialize state, so that we can
-   // break on the first script line executed.
+   // break on the first script line executed,
+   // whichever fiber that ends up being.
    
-   setBreakOnNextStatement( true );
-   if (mCurrentWatchFiber)
+   if (mState == Initialize)
    {
-      mCurrentWatchFiber->mStackPopBreakIndex = -1;
+      clearStepBreaks();
+      setStepBreakAll( U32_MAX );
+   }
+   else
+   {
+      setStepBreak( U32_MAX );
    }
    mProgramPaused = false;
    
@@ -869,11 +911,8 @@ void TelnetDebugger::debugStepOver()
    if (mState != Connected)
       return;
    
-   setBreakOnNextStatement( true );
-   if (mCurrentWatchFiber)
-   {
-      mCurrentWatchFiber->mStackPopBreakIndex = mCurrentWatchFiber->vmFrames.size();
-   }
+   // Next line in this frame or a caller
+   setStepBreak( mCurrentWatchFiber ? mCurrentWatchFiber->vmFrames.size() : U32_MAX );
    mProgramPaused = false;
    send("RUNNING\r\n");
 }
@@ -883,13 +922,9 @@ void TelnetDebugger::debugStepOut()
    if (mState != Connected)
       return;
    
-   setBreakOnNextStatement( false );
-   if (mCurrentWatchFiber)
-   {
-      mCurrentWatchFiber->mStackPopBreakIndex = mCurrentWatchFiber->vmFrames.size() - 1;
-      if ( mCurrentWatchFiber->mStackPopBreakIndex == 0 )
-         mCurrentWatchFiber->mStackPopBreakIndex = -1;
-   }
+   // Next line in a caller; just runs if there isn't one
+   U32 depth = mCurrentWatchFiber ? mCurrentWatchFiber->vmFrames.size() : 0;
+   setStepBreak( depth > 0 ? depth - 1 : 0 );
    mProgramPaused = false;
    send("RUNNING\r\n");
 }
@@ -1003,7 +1038,6 @@ void TelnetDebugger::onFiberChanged()
    else
    {
       char buffer[MaxCommandSize];
-      mCurrentWatchFiber->mStackPopBreakIndex = -1; // reset this
       U32 fiberId = mVMInternal->mFiberStates.getHandleValue(mCurrentWatchFiber);
       snprintf(buffer, MaxCommandSize, "FIBER %u", fiberId);
       send(buffer);
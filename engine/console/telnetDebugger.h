@@ -82,15 +82,19 @@ public:
       S32 passCount;
       S32 curCount;
       KorkApi::String testExpression;
+      CodeBlock *condition; ///< Compiled testExpression; nullptr if it always passes
+      bool conditionValid;  ///< false if testExpression failed to compile
       bool clearOnHit;
       Breakpoint *next;
    };
    Breakpoint *mBreakpoints;
 
    Breakpoint **findBreakpoint(StringTableEntry fileName, S32 lineNumber);
+   void setBreakpointCondition(Breakpoint *brk, const char *evalString);
+   bool testBreakpointCondition(Breakpoint *brk);
+   void freeBreakpoint(Breakpoint *brk);
 
    bool mProgramPaused;
-   bool mBreakOnNextStatement;
    ExprEvalState* mCurrentWatchFiber;
 
    bool isWatchedFiber();
@@ -114,7 +118,13 @@ public:
    void checkDebugRecv();
    void processLineBuffer(S32);
    void sendBreak();
-   void setBreakOnNextStatement( bool enabled );
+   
+   /// Stepping is checked per fiber by the interpreter rather than by
+   /// patching OP_BREAK into every line; see ExprEvalState::mStepBreakDepth.
+   void setStepBreak(U32 maxDepth);
+   /// Steps in every fiber, including ones created before the step completes.
+   void setStepBreakAll(U32 maxDepth);
+   void clearStepBreaks();
 
    void setWatchFiberFromVm();
    void enumerateFibers();
@@ -125,8 +135,6 @@ public:
    bool isConnected() const { return mState == Connected; }
 
    void process();
-   void popStackFrame();
-   void pushStackFrame();
    void addAllBreakpoints(CodeBlock *code);
 
    void clearCodeBlockPointers(CodeBlock *code);
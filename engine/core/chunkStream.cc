@@ -0,0 +1,319 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2025-2026 korkscript contributors.
+// See AUTHORS file and git repository for contributor information.
+//
+// SPDX-License-Identifier: MIT
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "platform/platformEndian.h"
+#include "core/chunkStream.h"
+#include "core/lzCompress.h"
+
+static const U32 CHUNK_STREAM_MAGIC = makeFourCCTag('C','H','N','K');
+static const U32 CHUNK_COMPRESSED_FLAG = BIT(31);
+
+//-----------------------------------------------------------------------------
+
+ChunkWriteStream::ChunkWriteStream(WriteFn fn, void* userPtr, bool compress, U32 chunkSize) :
+   mWriteFn(fn),
+   mUserPtr(userPtr),
+   mCompress(compress),
+   mFinished(false),
+   mChunkSize(chunkSize == 0 ? DefaultChunkSize : chunkSize),
+   mPosition(0)
+{
+   mBuffer.reserve(mChunkSize);
+
+   U32 magic = convertHostToLEndian(CHUNK_STREAM_MAGIC);
+   setStatus(mWriteFn(mUserPtr, &magic, sizeof(magic)) ? Ok : IOError);
+}
+
+ChunkWriteStream::~ChunkWriteStream()
+{
+   setStatus(Closed);
+}
+
+bool ChunkWriteStream::emitChunk()
+{
+   if (mBuffer.empty())
+   {
+      return true;
+   }
+
+   U32 rawSize = (U32)mBuffer.size();
+   U32 storedSize = rawSize;
+   const U8* data = mBuffer.data();
+
+   if (mCompress)
+   {
+      mCompressBuffer.resize(lzCompressBound(rawSize));
+      U32 compressedSize = lzCompressBlock(mBuffer.data(), rawSize, mCompressBuffer.data(), (U32)mCompressBuffer.size());
+
+      // Only keep the compressed data if it actually helped
+      if (compressedSize != 0 && compressedSize < rawSize)
+      {
+         storedSize = compressedSize | CHUNK_COMPRESSED_FLAG;
+         data = mCompressBuffer.data();
+      }
+   }
+
+   U32 header[2];
+   header[0] = convertHostToLEndian(rawSize);
+   header[1] = convertHostToLEndian(storedSize);
+
+   if (!mWriteFn(mUserPtr, header, sizeof(header)) ||
+       !mWriteFn(mUserPtr, data, storedSize & ~CHUNK_COMPRESSED_FLAG))
+   {
+      setStatus(IOError);
+      return false;
+   }
+
+   mBuffer.clear();
+   return true;
+}
+
+bool ChunkWriteStream::finish()
+{
+   if (mFinished)
+   {
+      return getStatus() == Ok;
+   }
+
+   mFinished = true;
+   if (getStatus() != Ok || !emitChunk())
+   {
+      return false;
+   }
+
+   U32 header[2] = {0, 0};
+   if (!mWriteFn(mUserPtr, header, sizeof(header)))
+   {
+      setStatus(IOError);
+      return false;
+   }
+
+   return true;
+}
+
+bool ChunkWriteStream::_read(const U32, void*)
+{
+   AssertFatal(false, "ChunkWriteStream::_read: not supported");
+   setStatus(IllegalCall);
+   return false;
+}
+
+bool ChunkWriteStream::_write(const U32 in_numBytes, const void* in_pBuffer)
+{
+   if (mFinished || getStatus() != Ok)
+   {
+      return false;
+   }
+
+   const U8* src = (const U8*)in_pBuffer;
+   U32 remaining = in_numBytes;
+
+   while (remaining > 0)
+   {
+      U32 space = mChunkSize - (U32)mBuffer.size();
+      U32 toCopy = remaining < space ? remaining : space;
+
+      mBuffer.insert(mBuffer.end(), src, src + toCopy);
+      src += toCopy;
+      remaining -= toCopy;
+
+      if (mBuffer.size() == mChunkSize && !emitChunk())
+      {
+         return false;
+      }
+   }
+
+   mPosition += in_numBytes;
+   return true;
+}
+
+bool ChunkWriteStream::hasCapability(const Capability in_cap) const
+{
+   return getStatus() != Closed && in_cap == StreamWrite;
+}
+
+U32 ChunkWriteStream::getPosition() const
+{
+   return mPosition;
+}
+
+bool ChunkWriteStream::setPosition(const U32 in_newPosition)
+{
+   // Data may already have been emitted, so seeking is not possible
+   return in_newPosition == mPosition;
+}
+
+U32 ChunkWriteStream::getStreamSize()
+{
+   return mPosition;
+}
+
+//-----------------------------------------------------------------------------
+
+ChunkReadStream::ChunkReadStream(ReadFn fn, void* userPtr) :
+   mReadFn(fn),
+   mUserPtr(userPtr),
+   mStarted(false),
+   mFinished(false),
+   mPosition(0),
+   mChunkPos(0)
+{
+   setStatus(Ok);
+}
+
+ChunkReadStream::~ChunkReadStream()
+{
+   setStatus(Closed);
+}
+
+bool ChunkReadStream::readExact(void* data, U32 size)
+{
+   U8* dst = (U8*)data;
+   while (size > 0)
+   {
+      U32 numRead = mReadFn(mUserPtr, dst, size);
+      if (numRead == 0)
+      {
+         return false;
+      }
+      dst += numRead;
+      size -= numRead;
+   }
+   return true;
+}
+
+bool ChunkReadStream::nextChunk()
+{
+   if (mFinished)
+   {
+      return false;
+   }
+
+   if (!mStarted)
+   {
+      U32 magic = 0;
+      mStarted = true;
+      if (!readExact(&magic, sizeof(magic)) ||
+          convertLEndianToHost(magic) != CHUNK_STREAM_MAGIC)
+      {
+         mFinished = true;
+         setStatus(IOError);
+         return false;
+      }
+   }
+
+   U32 header[2];
+   if (!readExact(header, sizeof(header)))
+   {
+      mFinished = true;
+      setStatus(IOError);
+      return false;
+   }
+
+   U32 rawSize = convertLEndianToHost(header[0]);
+   U32 storedSize = convertLEndianToHost(header[1]);
+   bool compressed = (storedSize & CHUNK_COMPRESSED_FLAG) != 0;
+   storedSize &= ~CHUNK_COMPRESSED_FLAG;
+
+   if (rawSize == 0)
+   {
+      mFinished = true;
+      return false;
+   }
+
+   mBuffer.resize(rawSize);
+   mChunkPos = 0;
+
+   if (compressed)
+   {
+      mCompressBuffer.resize(storedSize);
+      if (!readExact(mCompressBuffer.data(), storedSize) ||
+          !lzDecompressBlock(mCompressBuffer.data(), storedSize, mBuffer.data(), rawSize))
+      {
+         mFinished = true;
+         setStatus(IOError);
+         return false;
+      }
+   }
+   else if (storedSize != rawSize ||
+            !readExact(mBuffer.data(), rawSize))
+   {
+      mFinished = true;
+      setStatus(IOError);
+      return false;
+   }
+
+   return true;
+}
+
+bool ChunkReadStream::_read(const U32 in_numBytes, void* out_pBuffer)
+{
+   U8* dst = (U8*)out_pBuffer;
+   U32 remaining = in_numBytes;
+
+   while (remaining > 0)
+   {
+      if (mChunkPos >= mBuffer.size() && !nextChunk())
+      {
+         if (getStatus() == Ok)
+         {
+            setStatus(EOS);
+         }
+         return false;
+      }
+
+      U32 avail = (U32)mBuffer.size() - mChunkPos;
+      U32 toCopy = remaining < avail ? remaining : avail;
+
+      if (dst)
+      {
+         memcpy(dst, mBuffer.data() + mChunkPos, toCopy);
+         dst += toCopy;
+      }
+
+      mChunkPos += toCopy;
+      mPosition += toCopy;
+      remaining -= toCopy;
+   }
+
+   return true;
+}
+
+bool ChunkReadStream::_write(const U32, const void*)
+{
+   AssertFatal(false, "ChunkReadStream::_write: not supported");
+   setStatus(IllegalCall);
+   return false;
+}
+
+bool ChunkReadStream::hasCapability(const Capability in_cap) const
+{
+   return getStatus() != Closed && in_cap == StreamRead;
+}
+
+U32 ChunkReadStream::getPosition() const
+{
+   return mPosition;
+}
+
+bool ChunkReadStream::setPosition(const U32 in_newPosition)
+{
+   if (in_newPosition < mPosition)
+   {
+      return false;
+   }
+
+   // Skip forward
+   return _read(in_newPosition - mPosition, nullptr);
+}
+
+U32 ChunkReadStream::getStreamSize()
+{
+   // Size is unknown until the stream has been read
+   return mPosition;
+}
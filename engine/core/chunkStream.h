@@ -0,0 +1,98 @@
+#pragma once
+//-----------------------------------------------------------------------------
+// Copyright (c) 2025-2026 korkscript contributors.
+// See AUTHORS file and git repository for contributor information.
+//
+// SPDX-License-Identifier: MIT
+//-----------------------------------------------------------------------------
+
+#include "core/stream.h"
+#include "console/stlTypes.h"
+
+// Chunked streams let large payloads be written to (or read from) a callback
+// in bounded pieces rather than requiring the whole payload in memory.
+//
+// Format is:
+//   U32 magic ("CHNK")
+//   chunks...
+//     U32 rawSize           (0 = end of stream)
+//     U32 storedSize        (BIT(31) set if chunk is lz compressed)
+//     U8 data[storedSize]
+
+class ChunkWriteStream : public Stream
+{
+   typedef Stream Parent;
+
+public:
+   typedef bool (*WriteFn)(void* userPtr, const void* data, U32 size);
+
+   enum
+   {
+      DefaultChunkSize = 64 * 1024
+   };
+
+protected:
+   WriteFn mWriteFn;
+   void* mUserPtr;
+   bool mCompress;
+   bool mFinished;
+   U32 mChunkSize;
+   U32 mPosition;
+   KorkApi::Vector<U8> mBuffer;
+   KorkApi::Vector<U8> mCompressBuffer;
+
+   bool emitChunk();
+
+public:
+   ChunkWriteStream(WriteFn fn, void* userPtr, bool compress, U32 chunkSize = DefaultChunkSize);
+   ~ChunkWriteStream();
+
+   /// Writes out any buffered data followed by the end of stream marker.
+   bool finish();
+
+protected:
+   bool _read(const U32 in_numBytes,  void* out_pBuffer);
+   bool _write(const U32 in_numBytes, const void* in_pBuffer);
+public:
+   bool hasCapability(const Capability) const;
+   U32  getPosition() const;
+   bool setPosition(const U32 in_newPosition);
+   U32  getStreamSize();
+};
+
+class ChunkReadStream : public Stream
+{
+   typedef Stream Parent;
+
+public:
+   /// Should fill data with up to size bytes, returning the amount read.
+   typedef U32 (*ReadFn)(void* userPtr, void* data, U32 size);
+
+protected:
+   ReadFn mReadFn;
+   void* mUserPtr;
+   bool mStarted;
+   bool mFinished;
+   U32 mPosition;
+   U32 mChunkPos;
+   KorkApi::Vector<U8> mBuffer;
+   KorkApi::Vector<U8> mCompressBuffer;
+
+   bool readExact(void* data, U32 size);
+   bool nextChunk();
+
+public:
+   ChunkReadStream(ReadFn fn, void* userPtr);
+   ~ChunkReadStream();
+
+protected:
+   bool _read(const U32 in_numBytes,  void* out_pBuffer);
+   bool _write(const U32 in_numBytes, const void* in_pBuffer);
+public:
+   bool hasCapability(const Capability) const;
+   U32  getPosition() const;
+
+   /// NOTE: only forward seeks are supported
+   bool setPosition(const U32 in_newPosition);
+   U32  getStreamSize();
+};
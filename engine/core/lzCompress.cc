@@ -0,0 +1,208 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2025-2026 korkscript contributors.
+// See AUTHORS file and git repository for contributor information.
+//
+// SPDX-License-Identifier: MIT
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "core/lzCompress.h"
+
+enum
+{
+   LZMinMatch = 4,
+   LZHashBits = 12,
+   LZHashSize = 1 << LZHashBits,
+   LZMaxOffset = 0xFFFF,
+   LZInvalidPos = 0xFFFFFFFF
+};
+
+static inline U32 lzRead32(const U8* p)
+{
+   U32 v;
+   memcpy(&v, p, sizeof(v));
+   return v;
+}
+
+static inline U32 lzHash(U32 seq)
+{
+   return (seq * 2654435761U) >> (32 - LZHashBits);
+}
+
+U32 lzCompressBound(U32 srcSize)
+{
+   return srcSize + (srcSize / 255) + 16;
+}
+
+U32 lzCompressBlock(const U8* src, U32 srcSize, U8* dst, U32 dstCapacity)
+{
+   U32 table[LZHashSize];
+   for (U32 i=0; i<LZHashSize; i++)
+   {
+      table[i] = LZInvalidPos;
+   }
+
+   U32 op = 0;
+   U32 ip = 0;
+   U32 anchor = 0;
+
+   // Emits literals [anchor, ip) followed by an optional match
+   auto emitSequence = [&](U32 litEnd, U32 offset, U32 matchLen) -> bool {
+      U32 litLen = litEnd - anchor;
+      U32 mlCode = matchLen > 0 ? matchLen - LZMinMatch : 0;
+
+      // Worst case size of this sequence
+      U32 needed = 1 + (litLen / 255) + 1 + litLen + 2 + (mlCode / 255) + 1;
+      if (op + needed > dstCapacity)
+      {
+         return false;
+      }
+
+      U8* token = dst + op++;
+      *token = (U8)((litLen >= 15 ? 15 : litLen) << 4);
+
+      if (litLen >= 15)
+      {
+         U32 rem = litLen - 15;
+         for (; rem >= 255; rem -= 255)
+            dst[op++] = 255;
+         dst[op++] = (U8)rem;
+      }
+
+      memcpy(dst + op, src + anchor, litLen);
+      op += litLen;
+
+      if (matchLen == 0)
+      {
+         return true;
+      }
+
+      dst[op++] = (U8)(offset & 0xFF);
+      dst[op++] = (U8)(offset >> 8);
+
+      *token |= (U8)(mlCode >= 15 ? 15 : mlCode);
+      if (mlCode >= 15)
+      {
+         U32 rem = mlCode - 15;
+         for (; rem >= 255; rem -= 255)
+            dst[op++] = 255;
+         dst[op++] = (U8)rem;
+      }
+
+      return true;
+   };
+
+   while (ip + LZMinMatch <= srcSize)
+   {
+      U32 seq = lzRead32(src + ip);
+      U32 h = lzHash(seq);
+      U32 ref = table[h];
+      table[h] = ip;
+
+      if (ref == LZInvalidPos ||
+          (ip - ref) > LZMaxOffset ||
+          lzRead32(src + ref) != seq)
+      {
+         ip++;
+         continue;
+      }
+
+      U32 matchLen = LZMinMatch;
+      while (ip + matchLen < srcSize && src[ref + matchLen] == src[ip + matchLen])
+      {
+         matchLen++;
+      }
+
+      if (!emitSequence(ip, ip - ref, matchLen))
+      {
+         return 0;
+      }
+
+      ip += matchLen;
+      anchor = ip;
+   }
+
+   // Trailing literals (always present, may be empty)
+   if (!emitSequence(srcSize, 0, 0))
+   {
+      return 0;
+   }
+
+   return op;
+}
+
+bool lzDecompressBlock(const U8* src, U32 srcSize, U8* dst, U32 dstSize)
+{
+   U32 sp = 0;
+   U32 dp = 0;
+
+   while (sp < srcSize)
+   {
+      U8 token = src[sp++];
+
+      U32 litLen = token >> 4;
+      if (litLen == 15)
+      {
+         U8 b = 0;
+         do
+         {
+            if (sp >= srcSize)
+               return false;
+            b = src[sp++];
+            litLen += b;
+         } while (b == 255);
+      }
+
+      if (sp + litLen > srcSize || dp + litLen > dstSize)
+      {
+         return false;
+      }
+
+      memcpy(dst + dp, src + sp, litLen);
+      sp += litLen;
+      dp += litLen;
+
+      // Final sequence has no match
+      if (sp == srcSize)
+      {
+         break;
+      }
+
+      if (sp + 2 > srcSize)
+      {
+         return false;
+      }
+
+      U32 offset = src[sp] | (src[sp+1] << 8);
+      sp += 2;
+
+      U32 matchLen = (token & 0xF);
+      if (matchLen == 15)
+      {
+         U8 b = 0;
+         do
+         {
+            if (sp >= srcSize)
+               return false;
+            b = src[sp++];
+            matchLen += b;
+         } while (b == 255);
+      }
+      matchLen += LZMinMatch;
+
+      if (offset == 0 || offset > dp || dp + matchLen > dstSize)
+      {
+         return false;
+      }
+
+      // NOTE: match may overlap output so copy bytewise
+      const U8* match = dst + dp - offset;
+      for (U32 i=0; i<matchLen; i++)
+      {
+         dst[dp + i] = match[i];
+      }
+      dp += matchLen;
+   }
+
+   return dp == dstSize;
+}
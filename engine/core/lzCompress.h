@@ -0,0 +1,23 @@
+#pragma once
+//-----------------------------------------------------------------------------
+// Copyright (c) 2025-2026 korkscript contributors.
+// See AUTHORS file and git repository for contributor information.
+//
+// SPDX-License-Identifier: MIT
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+
+// Simple LZ77 block compressor using LZ4 style sequences (token, literals,
+// 16bit offset, match length). Blocks are self contained; the caller is
+// responsible for storing the compressed and uncompressed sizes.
+
+/// Returns the maximum size compressBlock can output for srcSize bytes.
+U32 lzCompressBound(U32 srcSize);
+
+/// Compresses src into dst. Returns the compressed size or 0 if the
+/// output would not fit in dstCapacity.
+U32 lzCompressBlock(const U8* src, U32 srcSize, U8* dst, U32 dstCapacity);
+
+/// Decompresses src into dst. dstSize must be the exact uncompressed size.
+bool lzDecompressBlock(const U8* src, U32 srcSize, U8* dst, U32 dstSize);
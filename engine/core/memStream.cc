@@ -172,3 +172,91 @@ bool MemStream::_write(const U32 in_numBytes, const void *in_pBuffer)
    return success;
 }
 
+//-----------------------------------------------------------------------------
+
+GrowableMemStream::GrowableMemStream(const U32 in_initialSize)
+ : m_currentPosition(0)
+{
+   m_buffer.reserve(in_initialSize);
+   setStatus(Ok);
+}
+
+GrowableMemStream::~GrowableMemStream()
+{
+   setStatus(Closed);
+}
+
+void GrowableMemStream::clear()
+{
+   m_buffer.clear();
+   m_currentPosition = 0;
+   setStatus(Ok);
+}
+
+U32 GrowableMemStream::getStreamSize()
+{
+   return (U32)m_buffer.size();
+}
+
+bool GrowableMemStream::hasCapability(const Capability in_cap) const
+{
+   if (getStatus() == Closed)
+      return false;
+
+   U32 totalCaps = U32(Stream::StreamPosition) | U32(Stream::StreamRead) | U32(Stream::StreamWrite);
+   return (U32(in_cap) & totalCaps) != 0;
+}
+
+U32 GrowableMemStream::getPosition() const
+{
+   return m_currentPosition;
+}
+
+bool GrowableMemStream::setPosition(const U32 in_newPosition)
+{
+   if (in_newPosition > m_buffer.size())
+   {
+      setStatus(UnknownError);
+      return false;
+   }
+
+   m_currentPosition = in_newPosition;
+   setStatus(m_currentPosition == m_buffer.size() ? EOS : Ok);
+   return true;
+}
+
+bool GrowableMemStream::_read(const U32 in_numBytes, void *out_pBuffer)
+{
+   if (in_numBytes == 0)
+      return true;
+
+   bool success     = true;
+   U32  actualBytes = in_numBytes;
+   if ((m_currentPosition + in_numBytes) > m_buffer.size()) {
+      success = false;
+      actualBytes = (U32)m_buffer.size() - m_currentPosition;
+   }
+
+   memcpy(out_pBuffer, m_buffer.data() + m_currentPosition, actualBytes);
+   m_currentPosition += actualBytes;
+
+   setStatus(success ? Ok : EOS);
+   return success;
+}
+
+bool GrowableMemStream::_write(const U32 in_numBytes, const void *in_pBuffer)
+{
+   if (in_numBytes == 0)
+      return true;
+
+   if ((m_currentPosition + in_numBytes) > m_buffer.size())
+   {
+      m_buffer.resize(m_currentPosition + in_numBytes);
+   }
+
+   memcpy(m_buffer.data() + m_currentPosition, in_pBuffer, in_numBytes);
+   m_currentPosition += in_numBytes;
+
+   setStatus(Ok);
+   return true;
+}
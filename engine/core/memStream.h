@@ -27,6 +27,7 @@
 #ifndef _STREAM_H_
 #include "core/stream.h"
 #endif
+#include "console/stlTypes.h"
 
 class MemStream : public Stream {
    typedef Stream Parent;
@@ -65,4 +66,32 @@ class MemStream : public Stream {
    U32  getStreamSize();
 };
 
+/// Read/write memory stream which grows its buffer as data is written.
+class GrowableMemStream : public Stream {
+   typedef Stream Parent;
+
+  protected:
+   KorkApi::Vector<U8> m_buffer;
+   U32 m_currentPosition;
+
+  public:
+   GrowableMemStream(const U32 in_initialSize = 0);
+   ~GrowableMemStream();
+
+   U8* getBuffer() { return m_buffer.data(); }
+   
+   /// Empties the stream, keeping the allocated buffer
+   void clear();
+
+   // Mandatory overrides from Stream
+  protected:
+   bool _read(const U32 in_numBytes,  void* out_pBuffer);
+   bool _write(const U32 in_numBytes, const void* in_pBuffer);
+  public:
+   bool hasCapability(const Capability) const;
+   U32  getPosition() const;
+   bool setPosition(const U32 in_newPosition);
+   U32  getStreamSize();
+};
+
 #endif //_MEMSTREAM_H_
@@ -6,153 +6,256 @@
 // SPDX-License-Identifier: MIT
 //-----------------------------------------------------------------------------
 
-#include <cctype>
 #include <cstdint>
-#include <deque>
-#include <mutex>
-#include <string>
+#include <cstdlib>
+#include <cstring>
 #include <string_view>
-#include <unordered_map>
-#include <vector>
-#include <cstdint>
-#include <deque>
-#include <string>
-#include <string_view>
-#include <unordered_map>
 #include <vector>
 
+/// Default string interner used by the VM when no InternStringInterface is supplied.
+///
+/// Entries live in an open addressing (linear probe) table keyed on a case folded
+/// hash which is computed once per call, 8 bytes at a time. Strings are packed into
+/// a bump arena and are never freed until the interner is destroyed.
+///
+/// Case insensitive lookups return the first case variant which was interned.
 class SimpleStringInterner
 {
 public:
-  using Entry = const char*;
+   using Entry = const char*;
 
-   SimpleStringInterner()
+   SimpleStringInterner() : mMask(0), mCount(0), mBlocks(nullptr), mBlockPos(0), mBlockEnd(0)
    {
-    EmptyString = internSV("", true);
-  }
+      mSlots.resize(InitialSlots);
+      mMask = InitialSlots - 1;
+      EmptyString = internSV("", true);
+   }
 
-  Entry internSV(std::string_view s, bool caseSens = true) 
-  {
-    if (s.data() == nullptr) return EmptyString;
+   ~SimpleStringInterner()
+   {
+      while (mBlocks)
+      {
+         Block* next = mBlocks->next;
+         free(mBlocks);
+         mBlocks = next;
+      }
+   }
 
-    // Find existing first (like your old code)
-    if (Entry e = find(s, caseSens)) return e;
+   SimpleStringInterner(const SimpleStringInterner&) = delete;
+   SimpleStringInterner& operator=(const SimpleStringInterner&) = delete;
 
-    // Store original-cased string (stable pointer)
-    mStorage.emplace_back(s);
-    const std::string& stored = mStorage.back();
-    Entry ptr = stored.c_str();
+   Entry internSV(std::string_view s, bool caseSens = true)
+   {
+      if (s.data() == nullptr) return EmptyString;
 
-    Node n;
-    n.ptr = ptr;
-    n.len = stored.size();
-    n.hashFold = hashFolded(stored);
+      const std::uint32_t len = (std::uint32_t)s.size();
+      const std::uint32_t hash = hashFolded(s.data(), len);
+      std::size_t idx = 0;
+      if (Entry e = find(s.data(), len, hash, caseSens, idx)) return e;
 
-    mBuckets[Key{n.hashFold, n.len}].push_back(n);
-    return ptr;
-  }
+      // Keep load under 3/4
+      if ((mCount + 1) * 4 > (mMask + 1) * 3)
+      {
+         grow();
+         idx = findEmpty(hash);
+      }
+
+      Slot& slot = mSlots[idx];
+      slot.ptr = store(s.data(), len);
+      slot.hash = hash;
+      slot.len = len;
+      mCount++;
+      return slot.ptr;
+   }
+
+   Entry lookupSV(std::string_view s, bool caseSens = true) const
+   {
+      if (s.data() == nullptr) return EmptyString;
 
-  Entry lookupSV(std::string_view s, bool caseSens = true) const 
-  {
-    if (s.data() == nullptr) return EmptyString;
-    return find(s, caseSens);
-  }
+      std::size_t idx = 0;
+      const std::uint32_t len = (std::uint32_t)s.size();
+      return find(s.data(), len, hashFolded(s.data(), len), caseSens, idx);
+   }
 
-  Entry empty() const { return EmptyString; }
+   Entry empty() const { return EmptyString; }
+
+   std::size_t size() const { return mCount; }
 
 private:
-   
-  static inline unsigned char toLower(unsigned char c) noexcept
-  {
-    return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c - 'A' + 'a') : c;
-  }
-
-  static std::uint64_t hashFolded(std::string_view s) noexcept 
-  {
-    std::uint64_t h = 1469598103934665603ull;
-    for (unsigned char c : s) {
-      h ^= toLower(c);
-      h *= 1099511628211ull;
-    }
-    return h;
-  }
-
-  struct Key 
-  {
-    std::uint64_t h;
-    std::size_t len;
-  };
-
-  struct KeyHash 
-  {
-    std::size_t operator()(const Key& k) const noexcept 
-    {
-      std::uint64_t x = k.h ^ (std::uint64_t(k.len) + 0x9e3779b97f4a7c15ull + (k.h << 6) + (k.h >> 2));
-      return static_cast<std::size_t>(x);
-    }
-  };
-
-  struct KeyEq 
-  {
-    bool operator()(const Key& a, const Key& b) const noexcept 
-    {
-      return a.h == b.h && a.len == b.len;
-    }
-  };
-
-  struct Node 
-  {
-    Entry ptr{};
-    std::size_t len{};
-    std::uint64_t hashFold{};
-  };
-
-  static bool equalsExact(std::string_view a, std::string_view b) noexcept
-  {
-    return a == b;
-  }
-
-  static bool equalsFolded(std::string_view a, std::string_view b) noexcept
-  {
-    if (a.size() != b.size()) return false;
-    for (std::size_t i = 0; i < a.size(); ++i) {
-      if (toLower(static_cast<unsigned char>(a[i])) != toLower(static_cast<unsigned char>(b[i])))
+
+   enum
+   {
+      InitialSlots = 1024,
+      BlockSize = 64 * 1024
+   };
+
+   struct Slot
+   {
+      Entry ptr = nullptr;
+      std::uint32_t hash = 0;
+      std::uint32_t len = 0;
+   };
+
+   struct Block
+   {
+      Block* next;
+      inline char* data() { return (char*)(this+1); }
+   };
+
+   static inline std::uint64_t loadWord(const char* p) noexcept
+   {
+      std::uint64_t v;
+      memcpy(&v, p, 8);
+      return v;
+   }
+
+   static inline std::uint64_t loadTail(const char* p, std::size_t n) noexcept
+   {
+      std::uint64_t v = 0;
+      memcpy(&v, p, n);
+      return v;
+   }
+
+   /// Lowercases 'A'-'Z' in each byte of x; other bytes (inc. >= 0x80) are left alone.
+   static inline std::uint64_t foldWord(std::uint64_t x) noexcept
+   {
+      const std::uint64_t heptets = x & 0x7f7f7f7f7f7f7f7full;
+      const std::uint64_t aboveZ = heptets + 0x2525252525252525ull; // bit 7 set if > 'Z'
+      const std::uint64_t atLeastA = heptets + 0x3f3f3f3f3f3f3f3full; // bit 7 set if >= 'A'
+      const std::uint64_t upper = ~x & (atLeastA ^ aboveZ) & 0x8080808080808080ull;
+      return x | (upper >> 2);
+   }
+
+   static inline std::uint64_t mixWord(std::uint64_t h, std::uint64_t w) noexcept
+   {
+      h = (h ^ w) * 0x9e3779b97f4a7c15ull;
+      return h ^ (h >> 32);
+   }
+
+   static std::uint32_t hashFolded(const char* s, std::uint32_t len) noexcept
+   {
+      std::uint64_t h = 0xcbf29ce484222325ull ^ len;
+      std::uint32_t i = 0;
+      for (; i + 8 <= len; i += 8)
       {
-        return false;
+         h = mixWord(h, foldWord(loadWord(s + i)));
       }
-    }
-    return true;
-  }
-
-  Entry find(std::string_view s, bool caseSens) const
-  {
-    const std::uint64_t hf = hashFolded(s);
-    auto it = mBuckets.find(Key{hf, s.size()});
-    if (it == mBuckets.end()) return nullptr;
-
-    for (const Node& n : it->second) 
-    {
-      std::string_view stored{n.ptr, n.len};
-      if (caseSens) 
+      if (i < len)
       {
-        if (equalsExact(stored, s)) 
-        {
-            return n.ptr;
-        }
-      } else 
+         h = mixWord(h, foldWord(loadTail(s + i, len - i)));
+      }
+      h *= 0xff51afd7ed558ccdull;
+      return (std::uint32_t)(h ^ (h >> 32));
+   }
+
+   static bool equalsFolded(const char* a, const char* b, std::uint32_t len) noexcept
+   {
+      std::uint32_t i = 0;
+      for (; i + 8 <= len; i += 8)
+      {
+         if (foldWord(loadWord(a + i)) != foldWord(loadWord(b + i)))
+         {
+            return false;
+         }
+      }
+      return i == len || foldWord(loadTail(a + i, len - i)) == foldWord(loadTail(b + i, len - i));
+   }
+
+   /// Returns the matching entry, or nullptr with outIdx set to the empty slot ending the probe.
+   Entry find(const char* s, std::uint32_t len, std::uint32_t hash, bool caseSens, std::size_t& outIdx) const
+   {
+      for (std::size_t i = hash & mMask;; i = (i + 1) & mMask)
       {
-        if (equalsFolded(stored, s)) 
-          {
-            return n.ptr;
-          }
+         const Slot& slot = mSlots[i];
+         if (slot.ptr == nullptr)
+         {
+            outIdx = i;
+            return nullptr;
+         }
+
+         if (slot.hash == hash && slot.len == len &&
+             (caseSens ? memcmp(slot.ptr, s, len) == 0 : equalsFolded(slot.ptr, s, len)))
+         {
+            return slot.ptr;
+         }
       }
-    }
-    return nullptr;
-  }
+   }
+
+   std::size_t findEmpty(std::uint32_t hash) const
+   {
+      std::size_t i = hash & mMask;
+      while (mSlots[i].ptr != nullptr)
+      {
+         i = (i + 1) & mMask;
+      }
+      return i;
+   }
+
+   void grow()
+   {
+      std::vector<Slot> oldSlots;
+      oldSlots.swap(mSlots);
+      const std::size_t oldSize = oldSlots.size();
+
+      mSlots.resize(oldSize * 2);
+      mMask = mSlots.size() - 1;
+
+      // Start after an empty slot so each probe run is reinserted in order,
+      // keeping the first interned case variant ahead of later ones.
+      std::size_t start = 0;
+      while (oldSlots[start].ptr != nullptr)
+      {
+         start++;
+      }
+
+      for (std::size_t n = 1; n <= oldSize; n++)
+      {
+         const Slot& slot = oldSlots[(start + n) & (oldSize - 1)];
+         if (slot.ptr != nullptr)
+         {
+            mSlots[findEmpty(slot.hash)] = slot;
+         }
+      }
+   }
+
+   Entry store(const char* s, std::uint32_t len)
+   {
+      const std::size_t needed = (std::size_t)len + 1;
+      if (mBlockEnd - mBlockPos < needed)
+      {
+         // Large strings get their own block so the current one isn't wasted
+         const bool own = needed > BlockSize / 4;
+         const std::size_t dataSize = own ? needed : BlockSize;
+         Block* block = (Block*)malloc(sizeof(Block) + dataSize);
+
+         if (own && mBlocks)
+         {
+            block->next = mBlocks->next;
+            mBlocks->next = block;
+            memcpy(block->data(), s, len);
+            block->data()[len] = '\0';
+            return block->data();
+         }
+
+         block->next = mBlocks;
+         mBlocks = block;
+         mBlockPos = 0;
+         mBlockEnd = dataSize;
+      }
+
+      char* ptr = mBlocks->data() + mBlockPos;
+      memcpy(ptr, s, len);
+      ptr[len] = '\0';
+      mBlockPos += needed;
+      return ptr;
+   }
 
 private:
-    std::deque<std::string> mStorage;
-    std::unordered_map<Key, std::vector<Node>, KeyHash, KeyEq> mBuckets;
-    Entry EmptyString;
+   std::vector<Slot> mSlots;
+   std::size_t mMask;
+   std::size_t mCount;
+   Block* mBlocks;         ///< Current block first
+   std::size_t mBlockPos;
+   std::size_t mBlockEnd;
+   Entry EmptyString;
 };
-
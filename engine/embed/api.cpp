@@ -10,12 +10,15 @@
 #include "console/consoleNamespace.h"
 
 #include "core/memStream.h"
+#include "core/chunkStream.h"
 #include "console/consoleInternal.h"
 #include "console/telnetDebugger.h"
 #include "console/telnetConsole.h"
+#include "console/scriptProfiler.h"
 
 #include "console/compiler.h"
 #include "console/codeBlock.h"
+#include "console/opcodeStats.h"
 
 #include "core/simpleIntern.h"
 
@@ -230,6 +233,21 @@ const char* Vm::tabCompleteVariable(const char *prevText, S32 baseLen, bool fFor
    return mInternal->mGlobalVars.tabComplete(prevText, baseLen, fForward);
 }
 
+static U32 getNumericStorageSize(U8 storage)
+{
+   switch (storage)
+   {
+      case NumericStorageS32:
+      case NumericStorageU32:
+      case NumericStorageF32:
+         return 4;
+      case NumericStorageF64:
+         return 8;
+      default:
+         return 0;
+   }
+}
+
 TypeId Vm::registerType(TypeInfo& info)
 {
    VmAllocTLS::Scope memScope(mInternal);
@@ -259,6 +277,14 @@ TypeId Vm::registerType(TypeInfo& info)
       };
    }
    
+   // Numeric storage must describe exactly one field element
+   if (chkFunc.numericStorage != NumericStorageNone &&
+       getNumericStorageSize(chkFunc.numericStorage) != chkFunc.fieldSize)
+   {
+      mInternal->printf(0, "registerType: numeric storage of type %s does not match its field size", chkFunc.name);
+      chkFunc.numericStorage = NumericStorageNone;
+   }
+   
    return mInternal->mTypes.size()-1;
 }
 
@@ -399,7 +425,7 @@ ClassId Vm::registerClass(ClassInfo& info)
 
    if (chkFunc.iSignals.TriggerSignal == nullptr)
    {
-      chkFunc.iSignals.TriggerSignal = [](void* userPtr, VMObject* object, StringTableEntry signalName, int argc, ConsoleValue* argv) {
+      chkFunc.iSignals.TriggerSignal = [](void* userPtr, VMObject* object, S32 signalSlot, StringTableEntry signalName, int argc, ConsoleValue* argv) {
       };
    }
    
@@ -435,7 +461,9 @@ ClassId Vm::registerClass(ClassInfo& info)
    }
       
    
-   return mInternal->mClassList.size()-1;
+   ClassId klassId = mInternal->mClassList.size()-1;
+   mInternal->buildClassFieldLookup(klassId);
+   return klassId;
 }
 
 ClassId Vm::getClassId(const char* name)
@@ -463,6 +491,25 @@ void Vm::releaseHeapRef(ConsoleHeapAllocRef value)
    mInternal->releaseHeapRef(value);
 }
 
+S32 VmInternal::getSignalSlot(StringTableEntry name, bool create)
+{
+   for (U32 i=0; i<mSignalSlots.size(); i++)
+   {
+      if (mSignalSlots[i] == name)
+      {
+         return (S32)i;
+      }
+   }
+   
+   if (!create)
+   {
+      return -1;
+   }
+   
+   mSignalSlots.push_back(name);
+   return (S32)mSignalSlots.size()-1;
+}
+
 S32 VmInternal::lookupTypeId(StringTableEntry typeName)
 {
    for (Vector<TypeInfo>::iterator itr = mTypes.begin(), itrEnd = mTypes.end(); itr != itrEnd; itr++)
@@ -529,6 +576,18 @@ ConsoleValue Vm::getTypeReturn(TypeId typeId, U32 heapSize)
     return mInternal->getTypeReturn(typeId, heapSize);
 }
 
+ConsoleValue Vm::getStringResultBuffer(U32 size)
+{
+   VmAllocTLS::Scope memScope(mInternal);
+   return mInternal->getStringResultBuffer(size);
+}
+
+ConsoleValue Vm::makeStringResult(ConsoleValue value, U32 len)
+{
+   VmAllocTLS::Scope memScope(mInternal);
+   return mInternal->makeStringResult(value, len);
+}
+
 ConsoleValue Vm::getTypeFunc(TypeId typeId, U32 heapSize)
 {
    VmAllocTLS::Scope memScope(mInternal);
@@ -604,6 +663,28 @@ ConsoleValue VmInternal::getStringReturnBuffer(U32 size)
    return ret;
 }
 
+ConsoleValue VmInternal::getStringResultBuffer(U32 size)
+{
+   ExprEvalState* state = mCurrentFiberState;
+   ConsoleValue ret;
+   if (state && state->mSTR.getFrameReturnBuffer(state->mNativeResultFrame, KorkApi::ConsoleValue::TypeInternalString, size, ret))
+   {
+      return ret;
+   }
+   
+   return getStringReturnBuffer(size);
+}
+
+ConsoleValue VmInternal::makeStringResult(ConsoleValue value, U32 len)
+{
+   value.len = len;
+   if (mCurrentFiberState)
+   {
+      mCurrentFiberState->mStringResultValue = value;
+   }
+   return value;
+}
+
 ConsoleValue VmInternal::getTypeFunc(U32 fiberIndex, TypeId typeId, U32 heapSize)
 {
    U32 size = mTypes[typeId].valueSize == UINT_MAX ? heapSize : mTypes[typeId].valueSize;
@@ -762,6 +843,17 @@ bool Vm::isNamespaceSignal(NamespaceId nsId, StringTableEntry name)
    return ent ? ent->isSignal() : false;
 }
 
+S32 Vm::getSignalSlot(StringTableEntry name)
+{
+   VmAllocTLS::Scope memScope(mInternal);
+   return mInternal->getSignalSlot(name, false);
+}
+
+U32 Vm::getNumSignalSlots()
+{
+   return (U32)mInternal->mSignalSlots.size();
+}
+
 StringTableEntry Vm::getMethodNamespaceName(NamespaceId nsId, StringTableEntry name)
 {
    VmAllocTLS::Scope memScope(mInternal);
@@ -799,6 +891,30 @@ bool Vm::compileCodeBlock(const char* code, const char* filename, CompiledBlock*
    return true;
 }
 
+bool Vm::compileCodeBlockFromStream(SourceReadFn readFn, void* userPtr, const char* filename, CompiledBlock* outBlock)
+{
+   VmAllocTLS::Scope memScope(mInternal);
+   CodeBlock* block = mInternal->New<CodeBlock>(mInternal, false);
+   
+   outBlock->data = nullptr;
+   outBlock->size = 0;
+   
+   // NOTE: only the compiled output is buffered in full
+   GrowableMemStream outS(64 * 1024);
+   bool ok = block->compileToStream(outS, mInternal->internString(filename ? filename : "", false), readFn, userPtr);
+   mInternal->Delete(block);
+   
+   if (!ok)
+   {
+      return false;
+   }
+   
+   outBlock->size = outS.getStreamSize();
+   outBlock->data = mInternal->NewArray<U8>(outBlock->size);
+   memcpy(outBlock->data, outS.getBuffer(), outBlock->size);
+   return true;
+}
+
 void Vm::freeCompiledBlock(CompiledBlock block)
 {
    if (block.data)
@@ -834,6 +950,15 @@ ConsoleValue Vm::evalCode(const char* code, const char* filename, const char* mo
                                     code, false, true, (!filename || setFrame < 0) ? -1 : setFrame);
 }
 
+ConsoleValue Vm::evalStream(SourceReadFn readFn, void* userPtr, const char* filename, const char* modPath, S32 setFrame)
+{
+   VmAllocTLS::Scope memScope(mInternal);
+   CodeBlock *newCodeBlock = mInternal->New<CodeBlock>(mInternal, (filename == nullptr || *filename == '\0') ? true : false);
+   return newCodeBlock->compileExec(mInternal->internString(filename, false),
+                                    mInternal->internString(modPath, false),
+                                    readFn, userPtr, false, true, (!filename || setFrame < 0) ? -1 : setFrame);
+}
+
 ConsoleValue Vm::call(int argc, ConsoleValue* argv, bool startSuspended)
 {
    ConsoleValue retValue = ConsoleValue();
@@ -848,6 +973,30 @@ ConsoleValue Vm::callObject(VMObject* h, int argc, ConsoleValue* argv, bool star
    return retValue;
 }
 
+static bool executeObjectEntry(VmInternal* vmInternal, VMObject* self, Namespace::Entry* ent, int argc, KorkApi::ConsoleValue* argv, ConsoleValue& retValue, bool startSuspended)
+{
+   // Twiddle %this argument
+   KorkApi::ConsoleValue oldArg1 = argv[1];
+   SimObjectId cv = self->klass->iCreate.GetIdFn(self);
+   argv[1] = KorkApi::ConsoleValue::makeUnsigned(cv);
+   
+   // NOTE: previously it was possible to destroy vm objects during execute, however VMObject itself is now
+   // refCounted. Any further checks regarding this should be done at a higher level.
+   
+   KorkApi::ConsoleValue ret = ent->execute(argc, argv, vmInternal->mCurrentFiberState, self, startSuspended);
+   
+   retValue = ret;
+
+   // Twiddle it back
+   argv[1] = oldArg1;
+
+   // Reset the function offset so the stack
+   // doesn't continue to grow unnecessarily
+   vmInternal->mCurrentFiberState->mSTR.clearFunctionOffset();
+
+   return true;
+}
+
 bool Vm::callObjectFunction(VMObject* self, StringTableEntry funcName, int argc, KorkApi::ConsoleValue* argv, ConsoleValue& retValue, bool startSuspended)
 {
    VmAllocTLS::Scope memScope(mInternal);
@@ -880,26 +1029,37 @@ bool Vm::callObjectFunction(VMObject* self, StringTableEntry funcName, int argc,
       return "";
    }
 
-   // Twiddle %this argument
-   KorkApi::ConsoleValue oldArg1 = argv[1];
-   SimObjectId cv = self->klass->iCreate.GetIdFn(self);
-   argv[1] = KorkApi::ConsoleValue::makeUnsigned(cv);
+   return executeObjectEntry(mInternal, self, ent, argc, argv, retValue, startSuspended);
+}
+
+bool Vm::callObjectFunctionCached(VMObject* self, StringTableEntry funcName, MethodCache& cache, int argc, KorkApi::ConsoleValue* argv, ConsoleValue& retValue)
+{
+   VmAllocTLS::Scope memScope(mInternal);
+   if (argc < 2 || !self || !self->ns)
+   {
+      return false;
+   }
    
-   // NOTE: previously it was possible to destroy vm objects during execute, however VMObject itself is now
-   // refCounted. Any further checks regarding this should be done at a higher level.
+   Namespace::Entry* ent = (Namespace::Entry*)cache.entry;
    
-   KorkApi::ConsoleValue ret = ent->execute(argc, argv, mInternal->mCurrentFiberState, self, startSuspended);
+   if (ent == nullptr ||
+       cache.ns != self->ns ||
+       cache.sequence != mInternal->mNSState.mCacheSequence)
+   {
+      ent = self->ns->lookup(funcName);
+      cache.entry = ent;
+      cache.ns = self->ns;
+      cache.sequence = mInternal->mNSState.mCacheSequence;
+   }
    
-   retValue = ret;
-
-   // Twiddle it back
-   argv[1] = oldArg1;
-
-   // Reset the function offset so the stack
-   // doesn't continue to grow unnecessarily
-   mInternal->mCurrentFiberState->mSTR.clearFunctionOffset();
-
-   return true;
+   if (ent == nullptr)
+   {
+      mInternal->printf(0, "%s: undefined for object id %d", funcName, self->klass->iCreate.GetIdFn(self));
+      mInternal->mCurrentFiberState->mSTR.clearFunctionOffset();
+      return false;
+   }
+   
+   return executeObjectEntry(mInternal, self, ent, argc, argv, retValue, false);
 }
 
 void Vm::triggerNamespaceSignal(VMObject* h, StringTableEntry name, int argc, ConsoleValue* argv)
@@ -919,7 +1079,7 @@ void Vm::triggerNamespaceSignal(VMObject* h, StringTableEntry name, int argc, Co
       return;
    }
 
-   h->klass->iSignals.TriggerSignal(ent->mUserPtr, h, name, argc, argv);
+   h->klass->iSignals.TriggerSignal(ent->mUserPtr, h, ent->mSignalSlot, name, argc, argv);
 }
 
 bool Vm::callNamespaceFunction(NamespaceId nsId, StringTableEntry name, int argc, KorkApi::ConsoleValue* argv, ConsoleValue& retValue, bool startSuspended)
@@ -1190,15 +1350,22 @@ VmInternal::VmInternal(Vm* vm, Config* cfg) : mGlobalVars(this)
    mCurrentCodeBlock = nullptr;
    mReturnBuffer.resize(2048);
    mNSState.init(this);
+   mGlobalVars.enableNameIndex();
    
    if (cfg->maxFibers == 0)
    {
       cfg->maxFibers = 1024;
    }
+   if (mConfig.warnRepeatLimit == 0)
+   {
+      mConfig.warnRepeatLimit = 10;
+   }
    mAllocBase.func = NewArray<void*>(cfg->maxFibers);
    mAllocBase.arg = &mReturnBuffer[0];
    memset(mAllocBase.func, 0, sizeof(void*)*cfg->maxFibers);
 
+   mPendingStepBreakDepth = 0;
+   
    if (mConfig.initTelnet)
    {
       mTelDebugger = New<TelnetDebugger>(this);
@@ -1209,6 +1376,10 @@ VmInternal::VmInternal(Vm* vm, Config* cfg) : mGlobalVars(this)
       mTelDebugger = nullptr;
       mTelConsole = nullptr;
    }
+
+   mProfiler = nullptr;
+   mCallStatsEnabled = false;
+   mOpcodeStats = nullptr;
    
    // Use inbuilt string interner
 
@@ -1253,6 +1424,8 @@ VmInternal::VmInternal(Vm* vm, Config* cfg) : mGlobalVars(this)
    mConvIndex = 0;
    mCVConvIndex = 0;
    mNSCounter = 0;
+   mSnapshotGeneration = 0;
+   mSnapshotIdCounter = 0;
 
    if (cfg->userResources)
    {
@@ -1268,6 +1441,7 @@ VmInternal::VmInternal(Vm* vm, Config* cfg) : mGlobalVars(this)
    }
 
    mCompilerResources->emptyString = internString("", false);
+   mCompilerResources->astArena.setLimit(cfg->maxCompileAstBytes);
 
    mCompilerResources->allowExceptions = cfg->enableExceptions;
    mCompilerResources->allowTuples = cfg->enableTuples;
@@ -1300,11 +1474,13 @@ VmInternal::VmInternal(Vm* vm, Config* cfg) : mGlobalVars(this)
      switch (requestedType)
      {
         case KorkApi::ConsoleValue::TypeInternalString: {
-           const char* strValue = vm->valueAsString(inputStorage->data.storageRegister ? *inputStorage->data.storageRegister : inputStorage->data.storageAddress);
-           U32 strLen = strlen(strValue)+1;
+           const ConsoleValue inputValue = inputStorage->data.storageRegister ? *inputStorage->data.storageRegister : inputStorage->data.storageAddress;
+           const char* strValue = vm->valueAsString(inputValue);
+           U32 strLen = (inputValue.hasLen() ? inputValue.len : (U32)strlen(strValue))+1;
            outputStorage->ResizeStorage(outputStorage, strLen);
            memcpy(outputStorage->data.storageAddress.evaluatePtr(vm->getAllocBase()), strValue, strLen);
            *(outputStorage->data.storageRegister) = outputStorage->data.storageAddress;
+           outputStorage->data.storageRegister->len = strLen-1;
         }
            break;
         case KorkApi::ConsoleValue::TypeInternalNumber:
@@ -1403,6 +1579,19 @@ VmInternal::~VmInternal()
    
    Delete(mTelDebugger);
    Delete(mTelConsole);
+   Delete(mProfiler);
+   
+   {
+      // Releases code blocks referenced for their hit counts
+      VmAllocTLS::Scope memScope(this);
+      Delete(mOpcodeStats);
+   }
+   
+   {
+      // AST blocks are retained between compiles
+      VmAllocTLS::Scope memScope(this);
+      mCompilerResources->astArena.releaseMemory();
+   }
    
    if (mOwnsResources)
    {
@@ -1613,6 +1802,94 @@ ClassInfo* VmInternal::getClassInfoByName(StringTableEntry name)
    }
 }
 
+static inline U32 hashFieldName(StringTableEntry name)
+{
+   return (U32)(((U64)(uintptr_t)name * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+void VmInternal::buildClassFieldLookup(ClassId klassId)
+{
+   if (mClassFieldLookup.size() <= (U32)klassId)
+   {
+      mClassFieldLookup.resize(klassId+1);
+   }
+   
+   ClassInfo& klass = mClassList[klassId];
+   Vector<U32>& table = mClassFieldLookup[klassId];
+   table.clear();
+   
+   if (klass.fields == nullptr || klass.numFields == 0)
+   {
+      return;
+   }
+   
+   // Keep the table at most half full
+   U32 size = 8;
+   while (size < klass.numFields * 2)
+   {
+      size <<= 1;
+   }
+   table.resize(size, 0);
+   
+   const U32 mask = size-1;
+   for (U32 i=0; i<klass.numFields; i++)
+   {
+      StringTableEntry name = klass.fields[i].pFieldname;
+      if (name == nullptr)
+      {
+         continue;
+      }
+      
+      // First field with a given name wins, as with a linear search
+      U32 h = hashFieldName(name) & mask;
+      for (; table[h] != 0; h = (h+1) & mask)
+      {
+         if (klass.fields[table[h]-1].pFieldname == name)
+            break;
+      }
+      
+      if (table[h] == 0)
+      {
+         table[h] = i+1;
+      }
+   }
+}
+
+S32 VmInternal::findClassField(ClassInfo* klass, StringTableEntry name)
+{
+   if (klass == nullptr || klass->fields == nullptr)
+   {
+      return -1;
+   }
+   
+   U32 klassId = (U32)(klass - mClassList.data());
+   if (klassId >= mClassFieldLookup.size())
+   {
+      // Not a registered class
+      for (U32 i=0; i<klass->numFields; i++)
+      {
+         if (klass->fields[i].pFieldname == name)
+            return i;
+      }
+      return -1;
+   }
+   
+   const Vector<U32>& table = mClassFieldLookup[klassId];
+   if (table.empty())
+   {
+      return -1;
+   }
+   
+   const U32 mask = (U32)table.size()-1;
+   for (U32 h = hashFieldName(name) & mask; table[h] != 0; h = (h+1) & mask)
+   {
+      if (klass->fields[table[h]-1].pFieldname == name)
+         return table[h]-1;
+   }
+   
+   return -1;
+}
+
 
 const char* VmInternal::tempFloatConv(F64 val)
 {
@@ -1656,24 +1933,23 @@ bool VmInternal::setObjectField(VMObject* obj, StringTableEntry name, KorkApi::C
 
 bool VmInternal::setObjectFieldTuple(VMObject* obj, StringTableEntry fieldName, KorkApi::ConsoleValue arrayIndex, U32 argc, ConsoleValue* argv)
 {
-   if ((obj->flags & KorkApi::ModStaticFields) != 0)
+   S32 fieldIndex = (obj->flags & KorkApi::ModStaticFields) != 0 ? findClassField(obj->klass, fieldName) : -1;
+   return setObjectFieldTupleByIndex(obj, fieldIndex, fieldName, arrayIndex, argc, argv);
+}
+
+bool VmInternal::setObjectFieldTupleByIndex(VMObject* obj, S32 fieldIndex, StringTableEntry fieldName, KorkApi::ConsoleValue arrayIndex, U32 argc, ConsoleValue* argv)
+{
+   if (fieldIndex >= 0 && (obj->flags & KorkApi::ModStaticFields) != 0)
    {
-      for (U32 i=0; i<obj->klass->numFields; i++)
+      FieldInfo& f = obj->klass->fields[fieldIndex];
+      
+      TypeId tid = f.type;
+      TypeInfo* tinfo = (tid >= 0 && (U32)tid < mTypes.size()) ? &mTypes[tid] : nullptr;
+      
+      if (tinfo && tinfo->iFuncs.CastValueFn && tinfo->fieldSize != 0)
       {
-         FieldInfo& f = obj->klass->fields[i];
-         
-         if (f.pFieldname != fieldName)
-            continue;
-         
-         TypeId tid = f.type;
-         if (tid < 0 || (U32)tid >= mTypes.size())
-            break;
-         
-         TypeInfo& tinfo = mTypes[tid];
-         if (!tinfo.iFuncs.CastValueFn || tinfo.fieldSize == 0)
-            break;
-
          TypeStorageInterface outputStorage;
+         bool hasStorage = true;
 
          if (f.allocStorageFn)
          {
@@ -1686,27 +1962,37 @@ bool VmInternal::setObjectFieldTuple(VMObject* obj, StringTableEntry fieldName,
          {
             U32 idx = valueAsInt(arrayIndex);
             U32 elemCount = f.elementCount > 0 ? (U32)f.elementCount : 1;
-            if (idx >= elemCount)
-               break;
-            
-            U8* base = static_cast<U8*>(obj->userPtr);
-            U8* dptr = base + f.offset + (idx * (U32)tinfo.fieldSize);
-            outputStorage = KorkApi::CreateFixedTypeStorage(this, dptr, tid, true);
+            if (idx < elemCount)
+            {
+               U8* base = static_cast<U8*>(obj->userPtr);
+               U8* dptr = base + f.offset + (idx * (U32)tinfo->fieldSize);
+               outputStorage = KorkApi::CreateFixedTypeStorage(this, dptr, tid, true);
+            }
+            else
+            {
+               hasStorage = false;
+            }
          }
          
-         CastValueFnType castFn = f.ovrCastValue ? f.ovrCastValue : tinfo.iFuncs.CastValueFn;
+         if (hasStorage)
+         {
+            CastValueFnType castFn = f.ovrCastValue ? f.ovrCastValue : tinfo->iFuncs.CastValueFn;
 
-         TypeStorageInterface inputStorage = KorkApi::CreateRegisterStorageFromArgs(this, argc, argv);
-         
-         outputStorage.fieldObject = obj->userPtr;
-         
-         castFn(tinfo.userPtr,
-               mVM,
-               &inputStorage,
-               &outputStorage,
-               f.fieldUserPtr,
-               f.flag,
-               tid);
+            TypeStorageInterface inputStorage = KorkApi::CreateRegisterStorageFromArgs(this, argc, argv);
+            
+            outputStorage.fieldObject = obj->userPtr;
+            
+            castFn(tinfo->userPtr,
+                  mVM,
+                  &inputStorage,
+                  &outputStorage,
+                  f.fieldUserPtr,
+                  f.flag,
+                  tid);
+            
+            // Static fields shadow dynamic ones
+            return true;
+         }
       }
    }
 
@@ -1720,85 +2006,123 @@ bool VmInternal::setObjectFieldTuple(VMObject* obj, StringTableEntry fieldName,
 }
 
 ConsoleValue VmInternal::getObjectField(VMObject* obj, StringTableEntry name, KorkApi::ConsoleValue array, U32 requestedType, U32 requestedZone)
+{
+   S32 fieldIndex = obj ? findClassField(obj->klass, name) : -1;
+   return getObjectFieldByIndex(obj, fieldIndex, name, array, requestedType, requestedZone);
+}
+
+ConsoleValue VmInternal::getObjectFieldByIndex(VMObject* obj, S32 fieldIndex, StringTableEntry name, KorkApi::ConsoleValue array, U32 requestedType, U32 requestedZone)
 {
    // Default result if nothing matches.
    ConsoleValue def;
    if (!obj || !obj->klass || !obj->klass->fields)
       return def;
    
-   for (U32 i = 0; i < obj->klass->numFields; ++i)
+   if (fieldIndex >= 0)
    {
-      FieldInfo& f = obj->klass->fields[i];
-
-      if (f.pFieldname != name)
-         continue;
+      FieldInfo& f = obj->klass->fields[fieldIndex];
 
       TypeId tid = (TypeId)f.type;
-      if (tid < 0 || (U32)tid >= mTypes.size())
-         break;
-
-      TypeInfo& tinfo = mTypes[tid];
+      if (tid >= 0 && (U32)tid < mTypes.size())
+      {
+         TypeInfo& tinfo = mTypes[tid];
 
-      if (!tinfo.iFuncs.CastValueFn || tinfo.fieldSize == 0)
-         return def;
+         if (!tinfo.iFuncs.CastValueFn || tinfo.fieldSize == 0)
+            return def;
 
-      TypeStorageInterface inputStorage;
+         TypeStorageInterface inputStorage;
 
-      if (f.allocStorageFn)
-      {
-         if (!f.allocStorageFn(this->mVM, obj, &f, array, &inputStorage, false))
+         if (f.allocStorageFn)
          {
-            return def;
+            if (!f.allocStorageFn(this->mVM, obj, &f, array, &inputStorage, false))
+            {
+               return def;
+            }
          }
-      }
-      else
-      {  
-         U32 idx = valueAsInt(array);
-         U32 elemCount = f.elementCount > 0 ? (U32)f.elementCount : 1;
-         if (idx >= elemCount)
+         else
+         {  
+            U32 idx = valueAsInt(array);
+            U32 elemCount = f.elementCount > 0 ? (U32)f.elementCount : 1;
+            if (idx >= elemCount)
+            {
+               return def;
+            }
+
+            U8* base = static_cast<U8*>(obj->userPtr);
+            U8* dptr = base + f.offset + (idx * (U32)tinfo.fieldSize);
+
+            inputStorage = KorkApi::CreateFixedTypeStorage(this, dptr, tid, true);
+         }
+         
+         // Add requested type
+         if ((requestedType & KorkApi::TypeDirectCopy) != 0)
          {
-            return def;
+            requestedType = f.type;
          }
 
-         U8* base = static_cast<U8*>(obj->userPtr);
-         U8* dptr = base + f.offset + (idx * (U32)tinfo.fieldSize);
+         TypeStorageInterface outputStorage = KorkApi::CreateExprEvalReturnTypeStorage(this, 0, 0);
+         
+         CastValueFnType castFn = f.ovrCastValue ? f.ovrCastValue : tinfo.iFuncs.CastValueFn;
+         
+         inputStorage.fieldObject = obj->userPtr;
 
-         inputStorage = KorkApi::CreateFixedTypeStorage(this, dptr, tid, true);
-      }
-      
-      // Add requested type
-      if ((requestedType & KorkApi::TypeDirectCopy) != 0)
-      {
-         requestedType = f.type;
+         // For fixed size types, ensure we are the correct size (avoids adding check in CastValueFn)
+         if (tinfo.valueSize != UINT_MAX && tinfo.valueSize > 0)
+         {
+            outputStorage.FinalizeStorage(&outputStorage, (U32)tinfo.valueSize);
+         }
+         
+         castFn(
+            tinfo.userPtr,
+            mVM,
+            &inputStorage,
+            &outputStorage,
+            f.fieldUserPtr,
+            f.flag,
+            requestedType
+         );
+         
+         return *outputStorage.data.storageRegister;
       }
+   }
 
-      TypeStorageInterface outputStorage = KorkApi::CreateExprEvalReturnTypeStorage(this, 0, 0);
-      
-      CastValueFnType castFn = f.ovrCastValue ? f.ovrCastValue : tinfo.iFuncs.CastValueFn;
-      
-      inputStorage.fieldObject = obj->userPtr;
+   // Try dynamic fields
+   return obj->klass->iCustomFields.GetFieldByName(mVM, obj, name, array);
+}
 
-      // For fixed size types, ensure we are the correct size (avoids adding check in CastValueFn)
-      if (tinfo.valueSize != UINT_MAX && tinfo.valueSize > 0)
+void* VmInternal::getNumericFieldPtr(VMObject* obj, S32 fieldIndex, const char* arrayIndex, bool forWrite, U8& outStorage)
+{
+   if (fieldIndex < 0 || obj->userPtr == nullptr ||
+       (forWrite && (obj->flags & KorkApi::ModStaticFields) == 0))
+   {
+      return nullptr;
+   }
+   
+   FieldInfo& f = obj->klass->fields[fieldIndex];
+   if (f.allocStorageFn || f.ovrCastValue || f.type >= mTypes.size())
+   {
+      return nullptr;
+   }
+   
+   TypeInfo& tinfo = mTypes[f.type];
+   if (tinfo.numericStorage == KorkApi::NumericStorageNone)
+   {
+      return nullptr;
+   }
+   
+   U32 idx = 0;
+   if (arrayIndex[0] != '\0')
+   {
+      idx = valueAsInt(ConsoleValue::makeString(arrayIndex));
+      U32 elemCount = f.elementCount > 0 ? (U32)f.elementCount : 1;
+      if (idx >= elemCount)
       {
-         outputStorage.FinalizeStorage(&outputStorage, (U32)tinfo.valueSize);
+         return nullptr;
       }
-      
-      castFn(
-         tinfo.userPtr,
-         mVM,
-         &inputStorage,
-         &outputStorage,
-         f.fieldUserPtr,
-         f.flag,
-         requestedType
-      );
-      
-      return *outputStorage.data.storageRegister;
    }
-
-   // Try dynamic fields
-   return obj->klass->iCustomFields.GetFieldByName(mVM, obj, name, array);
+   
+   outStorage = tinfo.numericStorage;
+   return static_cast<U8*>(obj->userPtr) + f.offset + (idx * (U32)tinfo.fieldSize);
 }
 
 U16 VmInternal::getObjectFieldType(VMObject* obj, StringTableEntry name, KorkApi::ConsoleValue array)
@@ -1807,21 +2131,15 @@ U16 VmInternal::getObjectFieldType(VMObject* obj, StringTableEntry name, KorkApi
    if (!obj || !obj->klass || !obj->klass->fields)
       return 0;
    
-   for (U32 i = 0; i < obj->klass->numFields; ++i)
-   {
-      FieldInfo& f = obj->klass->fields[i];
-
-      if (f.pFieldname != name)
-         continue;
-
-      TypeId tid = (TypeId)f.type;
-      if (tid < 0 || (U32)tid >= mTypes.size())
-         break;
-
-      return tid;
-   }
+   S32 fieldIndex = findClassField(obj->klass, name);
+   if (fieldIndex < 0)
+      return 0;
    
-   return 0;
+   TypeId tid = (TypeId)obj->klass->fields[fieldIndex].type;
+   if (tid < 0 || (U32)tid >= mTypes.size())
+      return 0;
+   
+   return tid;
 }
 
 void Vm::assignFieldsFromTo(VMObject* from, VMObject* to)
@@ -2037,7 +2355,7 @@ KorkApi::ConsoleValue VmInternal::valueAsCVString(ConsoleValue v)
       case KorkApi::ConsoleValue::TypeInternalString:
       {
          const char* r = (const char*)v.evaluatePtr(mAllocBase);
-         return  KorkApi::ConsoleValue::makeString(r ? r : "");
+         return r ? KorkApi::ConsoleValue::makeStringLen(r, v.len) : KorkApi::ConsoleValue::makeStringLen("", 0);
       }
          
       break;
@@ -2068,9 +2386,7 @@ KorkApi::ConsoleValue VmInternal::valueAsCVString(ConsoleValue v)
 
 void VmInternal::printf(int level, const char* fmt, ...)
 {
-   if (mConfig.logFn == nullptr && 
-       mConfig.extraConsumers[0].cbFunc == nullptr &&
-       mConfig.extraConsumers[1].cbFunc == nullptr)
+   if (!isLogEnabled())
       return;
 
    char buffer[4096];
@@ -2212,21 +2528,14 @@ FiberRunResult Vm::resumeCurrentFiber(ConsoleValue value)
    return mInternal->resumeCurrentFiber(value);
 }
 
-bool Vm::dumpFiberStateToBlob(U32 numFibers, KorkApi::FiberId* fibers, U32* outBlobSize, U8** outBlob)
+static bool writeFiberStates(VmInternal* vmInternal, U32 numFibers, KorkApi::FiberId* fibers, Stream* outS, bool delta)
 {
-   VmAllocTLS::Scope memScope(mInternal);
-   const U32 maxBlobSize = 1024*1024*16;
-   U8* buffer = mInternal->NewArray<U8>(maxBlobSize);
-   *outBlob = nullptr;
-   *outBlobSize = 0;
-   
-   MemStream outS(maxBlobSize, buffer, true, true);
-   ConsoleSerializer serializer(mInternal, nullptr, false, &outS);
+   ConsoleSerializer serializer(vmInternal, nullptr, false, outS);
    
    Vector<ExprEvalState*> fiberList;
    for (U32 i=0; i<numFibers; i++)
    {
-      ExprEvalState* state = mInternal->mFiberStates.getItem(fibers[i]);
+      ExprEvalState* state = vmInternal->mFiberStates.getItem(fibers[i]);
       if (state)
       {
          fiberList.push_back(state);
@@ -2235,49 +2544,115 @@ bool Vm::dumpFiberStateToBlob(U32 numFibers, KorkApi::FiberId* fibers, U32* outB
    
    if (fiberList.size() == 0)
    {
-      mInternal->DeleteArray(buffer);
       return false;
    }
    
-   if (serializer.write(fiberList))
+   return serializer.write(fiberList, delta);
+}
+
+static bool readFiberStates(VmInternal* vmInternal, U32 numStreams, Stream** streams, U32* outNumFibers, KorkApi::FiberId** outFibers)
+{
+   ConsoleSerializer serializer(vmInternal, nullptr, false, streams[0]);
+   
+   Vector<ExprEvalState*> fiberList;
+   if (!serializer.readChain(numStreams, streams, fiberList))
    {
-      *outBlob = buffer;
-      *outBlobSize = outS.getPosition();
-      return true;
+      return false;
    }
-   else
+   
+   *outFibers = fiberList.size() > 0 ? (KorkApi::FiberId*)vmInternal->NewArray<KorkApi::FiberId>(fiberList.size()) : 0;
+   *outNumFibers = fiberList.size();
+   
+   for (U32 i=0; i<fiberList.size(); i++)
    {
-      mInternal->DeleteArray(buffer);
+      (*outFibers)[i] = vmInternal->mFiberStates.getHandleValue(fiberList[i]);
    }
    
    serializer.reset(false);
-   return false;
+   return true;
+}
+
+bool Vm::dumpFiberStateToBlob(U32 numFibers, KorkApi::FiberId* fibers, U32* outBlobSize, U8** outBlob, bool delta)
+{
+   VmAllocTLS::Scope memScope(mInternal);
+   *outBlob = nullptr;
+   *outBlobSize = 0;
+   
+   GrowableMemStream outS(4096);
+   if (!writeFiberStates(mInternal, numFibers, fibers, &outS, delta))
+   {
+      return false;
+   }
+   
+   U32 blobSize = outS.getStreamSize();
+   *outBlob = mInternal->NewArray<U8>(blobSize);
+   *outBlobSize = blobSize;
+   memcpy(*outBlob, outS.getBuffer(), blobSize);
+   return true;
 }
 
 bool Vm::restoreFiberStateFromBlob(U32* outNumFibers, KorkApi::FiberId** outFibers, U32 blobSize, U8* blob)
+{
+   return restoreFiberStateFromBlobs(outNumFibers, outFibers, 1, &blobSize, &blob);
+}
+
+bool Vm::restoreFiberStateFromBlobs(U32* outNumFibers, KorkApi::FiberId** outFibers, U32 numBlobs, U32* blobSizes, U8** blobs)
 {
    VmAllocTLS::Scope memScope(mInternal);
-   MemStream inS(blobSize, blob, true, false);
-   ConsoleSerializer serializer(mInternal, nullptr, false, &inS);
    
-   Vector<ExprEvalState*> fiberList;
+   if (numBlobs == 0)
+   {
+      return false;
+   }
    
-   if (serializer.read(fiberList))
+   Vector<Stream*> streams;
+   for (U32 i=0; i<numBlobs; i++)
    {
-      *outFibers = fiberList.size() > 0 ? (KorkApi::FiberId*)mInternal->NewArray<KorkApi::FiberId>(fiberList.size()) : 0;
-      *outNumFibers = fiberList.size();
-      
-      for (U32 i=0; i<fiberList.size(); i++)
-      {
-         (*outFibers)[i] = mInternal->mFiberStates.getHandleValue(fiberList[i]);
-      }
-      
-      serializer.reset(false);
-      return true;
+      streams.push_back(mInternal->New<MemStream>(blobSizes[i], blobs[i], true, false));
    }
    
-   serializer.reset(true);
-   return false;
+   bool ok = readFiberStates(mInternal, numBlobs, streams.data(), outNumFibers, outFibers);
+   
+   for (Stream* stream : streams)
+   {
+      mInternal->Delete(static_cast<MemStream*>(stream));
+   }
+   
+   return ok;
+}
+
+bool Vm::dumpFiberStateToStream(U32 numFibers, KorkApi::FiberId* fibers, FiberStateWriteFn writeFn, void* userPtr, bool compress, bool delta)
+{
+   VmAllocTLS::Scope memScope(mInternal);
+   
+   ChunkWriteStream outS(writeFn, userPtr, compress);
+   return writeFiberStates(mInternal, numFibers, fibers, &outS, delta) &&
+          outS.finish();
+}
+
+bool Vm::restoreFiberStateFromStreams(U32* outNumFibers, KorkApi::FiberId** outFibers, U32 numStreams, FiberStateReadFn readFn, void** userPtrs)
+{
+   VmAllocTLS::Scope memScope(mInternal);
+   
+   if (numStreams == 0)
+   {
+      return false;
+   }
+   
+   Vector<Stream*> streams;
+   for (U32 i=0; i<numStreams; i++)
+   {
+      streams.push_back(mInternal->New<ChunkReadStream>(readFn, userPtrs[i]));
+   }
+   
+   bool ok = readFiberStates(mInternal, numStreams, streams.data(), outNumFibers, outFibers);
+   
+   for (Stream* stream : streams)
+   {
+      mInternal->Delete(static_cast<ChunkReadStream*>(stream));
+   }
+   
+   return ok;
 }
 
 void Vm::suspendCurrentFiber()
@@ -2320,6 +2695,230 @@ const char* Vm::getExceptionFileLine(ExceptionInfo* info)
    return info->cb->getFileLine(info->ip);
 }
 
+bool Vm::getExceptionFileLine(ExceptionInfo* info, StringTableEntry* outFile, U32* outLine)
+{
+   if (!info || !info->cb)
+   {
+      return false;
+   }
+
+   *outFile = info->cb->name;
+   *outLine = info->cb->getLineForIp(info->ip);
+   return true;
+}
+
+void Vm::profilerStart(U32 sampleInterval)
+{
+   VmAllocTLS::Scope memScope(mInternal);
+   if (mInternal->mProfiler == nullptr)
+   {
+      mInternal->mProfiler = mInternal->New<ScriptProfiler>(mInternal);
+   }
+   mInternal->mProfiler->start(sampleInterval);
+}
+
+void Vm::profilerStop()
+{
+   if (mInternal->mProfiler)
+   {
+      mInternal->mProfiler->stop();
+   }
+}
+
+void Vm::profilerReset()
+{
+   VmAllocTLS::Scope memScope(mInternal);
+   if (mInternal->mProfiler)
+   {
+      mInternal->mProfiler->reset();
+   }
+}
+
+bool Vm::isProfilerActive()
+{
+   return mInternal->mProfiler && mInternal->mProfiler->isActive();
+}
+
+void Vm::profilerRequestSample()
+{
+   if (mInternal->mProfiler)
+   {
+      mInternal->mProfiler->requestSample();
+   }
+}
+
+U32 Vm::profilerGetNumSamples()
+{
+   return mInternal->mProfiler ? mInternal->mProfiler->getNumSamples() : 0;
+}
+
+void Vm::setCallStatsEnabled(bool enabled)
+{
+   mInternal->mCallStatsEnabled = enabled;
+}
+
+bool Vm::isCallStatsEnabled()
+{
+   return mInternal->mCallStatsEnabled;
+}
+
+void Vm::resetCallStats()
+{
+   for (Namespace* ns = mInternal->mNSState.mNamespaceList; ns; ns = ns->mNext)
+   {
+      for (Namespace::Entry* ent = ns->mEntryList; ent; ent = ent->mNext)
+      {
+         ent->mCallStats.reset();
+      }
+   }
+}
+
+bool Vm::setOpcodeStatsEnabled(bool enabled)
+{
+#ifdef KS_OPCODE_STATS
+   VmAllocTLS::Scope memScope(mInternal);
+   if (mInternal->mOpcodeStats == nullptr)
+   {
+      if (!enabled)
+      {
+         return true;
+      }
+      mInternal->mOpcodeStats = mInternal->New<OpcodeStats>(mInternal);
+   }
+   mInternal->mOpcodeStats->setEnabled(enabled);
+   return true;
+#else
+   return false;
+#endif
+}
+
+bool Vm::isOpcodeStatsEnabled()
+{
+   return mInternal->mOpcodeStats && mInternal->mOpcodeStats->isEnabled();
+}
+
+void Vm::resetOpcodeStats()
+{
+   VmAllocTLS::Scope memScope(mInternal);
+   if (mInternal->mOpcodeStats)
+   {
+      mInternal->mOpcodeStats->reset();
+   }
+}
+
+U64 Vm::getOpcodeCount(U32 opcode)
+{
+   return mInternal->mOpcodeStats ? mInternal->mOpcodeStats->getOpcodeCount(opcode) : 0;
+}
+
+U64 Vm::getExecutedInstructionCount()
+{
+   return mInternal->mOpcodeStats ? mInternal->mOpcodeStats->getTotal() : 0;
+}
+
+void Vm::opcodeStatsDump(U32 maxRows, ProfilerOutputFn outputFn, void* userPtr)
+{
+   VmAllocTLS::Scope memScope(mInternal);
+   if (mInternal->mOpcodeStats && outputFn)
+   {
+      mInternal->mOpcodeStats->dump(maxRows, outputFn, userPtr);
+   }
+}
+
+bool Vm::dumpInstructionHits(const char* fileName)
+{
+   VmAllocTLS::Scope memScope(mInternal);
+   StringTableEntry name = mInternal->internString(fileName, false);
+   CodeBlock* code = mInternal->findCodeBlock(name);
+   for (CodeBlock* walk = mInternal->mCodeBlockList; walk && !code; walk = walk->nextFile)
+   {
+      if (walk->fullPath == name)
+      {
+         code = walk;
+      }
+   }
+   
+   if (!code || !code->ipHits)
+   {
+      return false;
+   }
+
+   code->dumpInstructions(0, false, false, true, true);
+   return true;
+}
+
+void Vm::setCompileAstLimit(U32 maxBytes)
+{
+   mInternal->mCompilerResources->astArena.setLimit(maxBytes);
+}
+
+void Vm::getCompileStats(CompileStats* outStats)
+{
+   Compiler::AstArena& arena = mInternal->mCompilerResources->astArena;
+   outStats->astPeakBytes = arena.getLastPeakBytes();
+   outStats->astReservedBytes = arena.getReservedBytes();
+   outStats->astLimit = arena.getLimit();
+   outStats->astLimitExceeded = arena.wasLastLimitExceeded();
+}
+
+static void fillCallStats(Namespace::Entry* ent, FunctionCallStats* outStats)
+{
+   outStats->nsId = ent->mNamespace;
+   outStats->nsName = ent->mNamespace ? ent->mNamespace->mName : nullptr;
+   outStats->package = ent->mPackage;
+   outStats->name = ent->mFunctionName;
+   outStats->isScript = ent->mType == Namespace::Entry::ScriptFunctionType;
+   outStats->calls = ent->mCallStats.calls;
+   outStats->inclusiveTime = ent->mCallStats.inclusiveTime;
+   outStats->exclusiveTime = ent->mCallStats.exclusiveTime;
+}
+
+bool Vm::getCallStats(NamespaceId nsId, StringTableEntry name, FunctionCallStats* outStats)
+{
+   VmAllocTLS::Scope memScope(mInternal);
+   Namespace* ns = nsId ? (Namespace*)nsId : mInternal->mNSState.mGlobalNamespace;
+   Namespace::Entry* ent = ns ? ns->lookup(name) : nullptr;
+   if (!ent || !outStats)
+   {
+      return false;
+   }
+   
+   fillCallStats(ent, outStats);
+   return true;
+}
+
+void Vm::enumerateCallStats(void* userPtr, CallStatsEnumerationCallback funcPtr)
+{
+   if (!funcPtr)
+   {
+      return;
+   }
+   
+   for (Namespace* ns = mInternal->mNSState.mNamespaceList; ns; ns = ns->mNext)
+   {
+      for (Namespace::Entry* ent = ns->mEntryList; ent; ent = ent->mNext)
+      {
+         if (ent->mCallStats.calls == 0)
+         {
+            continue;
+         }
+         
+         FunctionCallStats stats;
+         fillCallStats(ent, &stats);
+         funcPtr(userPtr, &stats);
+      }
+   }
+}
+
+void Vm::profilerDump(ProfilerOutputFormat format, ProfilerOutputFn outputFn, void* userPtr)
+{
+   VmAllocTLS::Scope memScope(mInternal);
+   if (mInternal->mProfiler && outputFn)
+   {
+      mInternal->mProfiler->dump(format, outputFn, userPtr);
+   }
+}
+
 StringTableEntry Vm::internString(const char* str, bool caseSens)
 {
    VmAllocTLS::Scope memScope(mInternal);
@@ -118,6 +118,18 @@ const char*(*PrepDataFn)(void* userPtr,
 KorkApi::ConsoleValue (*PerformOpFn)(void* userPtr, Vm* vm, U32 op, KorkApi::ConsoleValue lhs, KorkApi::ConsoleValue rhs); // result goes on STR
 };
 
+/// Native layout of a numeric type's field storage. Types which advertise 
+/// one have their fields read & written directly by numeric field opcodes
+/// instead of going through CastValueFn.
+enum NumericStorage : U8
+{
+   NumericStorageNone,
+   NumericStorageS32,
+   NumericStorageU32,
+   NumericStorageF32,
+   NumericStorageF64
+};
+
 struct TypeInfo
 {
     StringTableEntry name;
@@ -126,6 +138,7 @@ struct TypeInfo
     dsize_t fieldSize;
     dsize_t valueSize;
     bool valueIsString;
+    U8 numericStorage; ///< NumericStorage; must match fieldSize if set
     TypeInterface iFuncs;
 };
 
@@ -215,6 +228,24 @@ typedef S32 ClassId;
 
 typedef void (*ConsumerCallback)(U32 level, const char *consoleLine, void* userPtr);
 typedef U32 (*AddTaggedStringCallback)(const char* vmString, void* userPtr);
+
+/// Fiber state stream callbacks; write returns false on error, read returns 
+/// the number of bytes read (0 on error or end of data).
+typedef bool (*FiberStateWriteFn)(void* userPtr, const void* data, U32 size);
+typedef U32 (*FiberStateReadFn)(void* userPtr, void* data, U32 size);
+
+/// Script source callback for streaming compiles; returns the number of bytes
+/// read (0 at the end of the source).
+typedef U32 (*SourceReadFn)(void* userPtr, void* data, U32 size);
+
+/// Called once per line of profiler output (without a trailing newline).
+typedef void (*ProfilerOutputFn)(void* userPtr, const char* line);
+enum ProfilerOutputFormat
+{
+   ProfilerOutputFlat,      ///< Per function flat & cumulative sample counts
+   ProfilerOutputCollapsed  ///< One "frame;frame;frame count" line per stack (flamegraph input)
+};
+
 enum NamespaceEntryKind
 {
    NamespaceEntryInvalid,
@@ -248,8 +279,31 @@ struct NamespaceEntryInfo
    bool isScript;
 };
 
+/// Call counters for a namespace entry (see Vm::setCallStatsEnabled)
+struct FunctionCallStats
+{
+   NamespaceId nsId;
+   StringTableEntry nsName;
+   StringTableEntry package;
+   StringTableEntry name;
+   bool isScript;
+   U64 calls;
+   U64 inclusiveTime; ///< ns including callees (recursive calls are counted at each level)
+   U64 exclusiveTime; ///< ns excluding callees
+};
+
+/// Compiler memory stats (see Vm::getCompileStats)
+struct CompileStats
+{
+   U64 astPeakBytes;     ///< AST bytes used by the most recently compiled script
+   U64 astReservedBytes; ///< Bytes currently held by the AST arena
+   U64 astLimit;         ///< Per compile AST limit (0 = unlimited)
+   bool astLimitExceeded; ///< Set if the most recent compile hit the limit
+};
+
 typedef void(*NamespaceInfoEnumerationCallback)(void* userPtr, const NamespaceInfo* info);
 typedef void(*NamespaceEntryInfoEnumerationCallback)(void* userPtr, const NamespaceEntryInfo* info);
+typedef void(*CallStatsEnumerationCallback)(void* userPtr, const FunctionCallStats* stats);
 
 struct Vm;
 
@@ -277,6 +331,11 @@ struct CreateObjectInterface
     SimObjectId (*GetIdFn)(VMObject* object);
     // Get Name
     StringTableEntry (*GetNameFn)(VMObject* object);
+    // Optional. Sets a batch of constant fields on a new object in one call
+    // (i.e. OP_SET_OBJECT_FIELDS, between ProcessArgsFn and AddObjectFn).
+    // Large tables may be split over several calls. Returning false falls back
+    // to assigning each field in turn as a normal field assignment would.
+    bool (*SetFieldsFn)(Vm* vm, VMObject* object, U32 count, const StringTableEntry* names, const ConsoleValue* values);
 };
 
 // handles sub object enum
@@ -288,7 +347,21 @@ struct EnumerateObjectInterface
 
 struct ObjectSignalsInterface
 {
-   void (*TriggerSignal)(void* userPtr, VMObject* object, StringTableEntry signalName, int argc, ConsoleValue* argv);
+   /// signalSlot is a small VM-wide index for signalName (see Vm::getSignalSlot), 
+   /// suitable for indexing listener tables.
+   void (*TriggerSignal)(void* userPtr, VMObject* object, S32 signalSlot, StringTableEntry signalName, int argc, ConsoleValue* argv);
+};
+
+/// Resolved method for Vm::callObjectFunctionCached. Becomes invalid 
+/// automatically whenever namespaces or packages change.
+struct MethodCache
+{
+   void* entry;
+   void* ns;
+   U32 sequence;
+   
+   MethodCache() : entry(nullptr), ns(nullptr), sequence(0) {}
+   void reset() { entry = nullptr; ns = nullptr; sequence = 0; }
 };
 
 // handles field get & set
@@ -407,6 +480,10 @@ struct Config {
    bool initTelnet;
    
    U16 maxFibers;
+   
+   U32 maxCompileAstBytes; ///< Cap on AST memory for a single compile (0 = unlimited)
+   
+   U32 warnRepeatLimit; ///< Runtime warnings logged per script line before the rest are suppressed (0 = 10, U32_MAX = unlimited)
 };
 
 struct ConsoleHeapAlloc
@@ -465,9 +542,9 @@ struct FiberFrameInfo
 
 enum Constants
 {
-  DSOVersion = 78,
-  MinDSOVersion = 77,
-  MaxDSOVersion = 78,
+  DSOVersion = 80,
+  MinDSOVersion = 80, // 80 changed the array variable opcodes
+  MaxDSOVersion = 80,
   MaxLineLength = 512,
   MaxDataTypes = 256,
   MaxArgs = 20 // Should match StringStack
@@ -532,6 +609,13 @@ public:
    ConsoleValue getTypeFunc(TypeId typeId, U32 heapSize=0);
    ConsoleValue getTypeReturn(TypeId typeId, U32 heapSize=0);
    
+   // String results for native functions. Small results are placed where the
+   // interpreter keeps the result of the call, so passing the written buffer
+   // through makeStringResult lets it be used without measuring or copying it.
+   // NOTE: re-evaluate the pointer after calling back into the vm.
+   ConsoleValue getStringResultBuffer(U32 size);
+   ConsoleValue makeStringResult(ConsoleValue value, U32 len);
+   
    
    // Gets a string in a specific zone
    ConsoleValue getStringInZone(U16 zone, U32 size);
@@ -559,20 +643,32 @@ public:
    void addNamespaceSignal(NamespaceId nsId, StringTableEntry name, void* userPtr, const char *usage, S32 minArgs, S32 maxArgs);
    bool isNamespaceFunction(NamespaceId nsId, StringTableEntry name);
    bool isNamespaceSignal(NamespaceId nsId, StringTableEntry name);
+   /// Returns the slot assigned to a signal name when it was first declared, or -1.
+   S32 getSignalSlot(StringTableEntry name);
+   /// Returns the number of allocated signal slots.
+   U32 getNumSignalSlots();
    StringTableEntry getMethodNamespaceName(NamespaceId nsId, StringTableEntry name);
    void markNamespaceGroup(NamespaceId nsId, StringTableEntry groupName, StringTableEntry usage);
 
 
    bool compileCodeBlock(const char* code, const char* filename, CompiledBlock* outBlock);
+   /// Compiles source read in chunks from readFn. Each top level declaration
+   /// is compiled as soon as it is parsed, so the source and AST are never
+   /// held in memory in full.
+   bool compileCodeBlockFromStream(SourceReadFn readFn, void* userPtr, const char* filename, CompiledBlock* outBlock);
    ConsoleValue execCodeBlock(U32 codeSize, U8* code, const char* filename, const char* modPath, bool noCalls, int setFrame);
    void freeCompiledBlock(CompiledBlock block);
 
    ConsoleValue evalCode(const char* code, const char* filename, const char* modPath, S32 setFrame=-1);
+   /// Streaming variant of evalCode; see compileCodeBlockFromStream.
+   ConsoleValue evalStream(SourceReadFn readFn, void* userPtr, const char* filename, const char* modPath, S32 setFrame=-1);
    ConsoleValue call(int argc, ConsoleValue* argv, bool startSuspended=false);
    ConsoleValue callObject(VMObject* h, int argc, ConsoleValue* argv, bool startSuspended=false);
 
    bool callNamespaceFunction(NamespaceId nsId, StringTableEntry name, int argc, ConsoleValue* argv, ConsoleValue& retValue, bool startSuspended=false);
    bool callObjectFunction(VMObject* self, StringTableEntry name, int argc, ConsoleValue* argv, ConsoleValue& retValue, bool startSuspended=false);
+   /// As callObjectFunction, but reuses the method resolved by a previous call with the same cache.
+   bool callObjectFunctionCached(VMObject* self, StringTableEntry name, MethodCache& cache, int argc, ConsoleValue* argv, ConsoleValue& retValue);
    void triggerNamespaceSignal(VMObject* h, StringTableEntry name, int argc, ConsoleValue* argv);
 
    // Helpers (should call into user funcs)
@@ -641,9 +737,71 @@ public:
    FiberFrameInfo getCurrentFiberFrameInfo(S32 frame=-1);
 
    const char* getExceptionFileLine(ExceptionInfo* info);
+   /// Unformatted variant of getExceptionFileLine
+   bool getExceptionFileLine(ExceptionInfo* info, StringTableEntry* outFile, U32* outLine);
+
+   // Sampling profiler API
    
-   bool dumpFiberStateToBlob(U32 numFibers, FiberId* fibers, U32* outBlobSize, U8** outBlob);
+   /// Starts sampling script stacks every sampleInterval instructions. If sampleInterval 
+   /// is 0, samples are only taken when profilerRequestSample is called.
+   void profilerStart(U32 sampleInterval);
+   void profilerStop();
+   void profilerReset();
+   bool isProfilerActive();
+   /// Samples at the next executed instruction. Safe to call from other threads 
+   /// while the profiler is running (e.g. from a timer).
+   void profilerRequestSample();
+   U32 profilerGetNumSamples();
+   void profilerDump(ProfilerOutputFormat format, ProfilerOutputFn outputFn, void* userPtr);
+   
+   // Call stats API
+   
+   /// Enables counting & timing of every script and native function call. 
+   /// Time spent while a fiber is suspended is not counted.
+   void setCallStatsEnabled(bool enabled);
+   bool isCallStatsEnabled();
+   void resetCallStats();
+   /// Gets stats for a function in nsId (or the global namespace if nsId is nullptr).
+   bool getCallStats(NamespaceId nsId, StringTableEntry name, FunctionCallStats* outStats);
+   /// Enumerates all functions which have been called since the last reset.
+   void enumerateCallStats(void* userPtr, CallStatsEnumerationCallback funcPtr);
+   
+   // Opcode stats API
+   
+   /// Counts every executed opcode, opcode pair & triple and per instruction hits 
+   /// in each code block. Returns false if the VM was built without KS_OPCODE_STATS.
+   bool setOpcodeStatsEnabled(bool enabled);
+   bool isOpcodeStatsEnabled();
+   /// Clears all counts. Code blocks are kept alive for their hit counts until this is called.
+   void resetOpcodeStats();
+   U64 getOpcodeCount(U32 opcode);
+   U64 getExecutedInstructionCount();
+   /// Prints the total and the most executed opcodes, pairs and triples (up to maxRows of each, 0 = all).
+   void opcodeStatsDump(U32 maxRows, ProfilerOutputFn outputFn, void* userPtr);
+   /// Logs the instructions of a loaded file annotated with hit counts. Returns false 
+   /// if the file has not executed since stats were enabled.
+   bool dumpInstructionHits(const char* fileName);
+   
+   // Compiler stats API
+   
+   /// Caps the AST memory used while compiling a single script (0 = unlimited).
+   /// Scripts which exceed it fail to compile with a parse error.
+   void setCompileAstLimit(U32 maxBytes);
+   void getCompileStats(CompileStats* outStats);
+   
+   /// Serializes fibers to a blob. If delta is set, only dictionaries and code which 
+   /// changed since the previous dump made by this VM are written; the result can only 
+   /// be restored along with the previous blobs using restoreFiberStateFromBlobs.
+   bool dumpFiberStateToBlob(U32 numFibers, FiberId* fibers, U32* outBlobSize, U8** outBlob, bool delta=false);
    bool restoreFiberStateFromBlob(U32* outNumFibers, FiberId** outFibers, U32 blobSize, U8* blob);
+   /// Restores fibers from a full blob followed by any number of delta blobs (in dump order).
+   bool restoreFiberStateFromBlobs(U32* outNumFibers, FiberId** outFibers, U32 numBlobs, U32* blobSizes, U8** blobs);
+   
+   /// Serializes fibers to writeFn in bounded chunks, optionally lz compressed. 
+   /// The whole snapshot is never held in memory at once.
+   bool dumpFiberStateToStream(U32 numFibers, FiberId* fibers, FiberStateWriteFn writeFn, void* userPtr, bool compress, bool delta=false);
+   /// Restores fibers from streams written by dumpFiberStateToStream (full snapshot first, then any deltas).
+   bool restoreFiberStateFromStreams(U32* outNumFibers, FiberId** outFibers, U32 numStreams, FiberStateReadFn readFn, void** userPtrs);
 
    // String intern functions
    // These just redirect to iIntern interface; they are provided here for ease of use.
@@ -655,6 +813,8 @@ public:
 
   // Enum dict API
   void enumGlobals(const char* expr, void* userPtr, EnumFuncCallback callback);
+  /// Removes all globals matching the wildcard expression expr
+  void deleteGlobals(const char* expr);
   bool enumLocals(void* userPtr, EnumFuncCallback callback, S32 frame=-1);
    
    // Storage helpers
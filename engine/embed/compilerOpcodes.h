@@ -206,6 +206,28 @@ namespace Compiler
       // Signals
       OP_SIGNAL_DECL,
 
+      // Object declarations
+      OP_SET_OBJECT_FIELDS,        // sets a table of constant fields on the new object
+
+      // In place string append
+      OP_APPENDVAR_STR,            // i.e. %var = %var @ "str"; appends the string on the stack to var
+
+
       OP_INVALID   // 90
    };
+
+   /// Value encoding for each entry in an OP_SET_OBJECT_FIELDS table
+   enum ObjectFieldValueKind
+   {
+      OBJECT_FIELD_STR,    // string table offset
+      OBJECT_FIELD_IDENT,  // STE
+      OBJECT_FIELD_UINT,   // immediate
+      OBJECT_FIELD_FLT     // float table index
+   };
+
+   enum
+   {
+      /// Words per OP_SET_OBJECT_FIELDS entry: field STE + site, kind, value (padded to 2 words)
+      ObjectFieldEntrySize = 5
+   };
 }
@@ -10,6 +10,8 @@ class Namespace;
 class CodeBlock;
 class TelnetDebugger;
 class TelnetConsole;
+class ScriptProfiler;
+class OpcodeStats;
 
 #include "console/stlTypes.h"
 #include "console/stringStack.h"
@@ -64,7 +66,11 @@ struct VmInternal
    CodeBlock*    mExecCodeBlockList; // temp blocks (or loaded from file)
    CodeBlock*    mCurrentCodeBlock;
    TelnetDebugger* mTelDebugger;
+   U32 mPendingStepBreakDepth; ///< Step depth given to new fibers while the debugger steps in any fiber
    TelnetConsole* mTelConsole;
+   ScriptProfiler* mProfiler; ///< nullptr unless profiling has been started
+   bool mCallStatsEnabled;    ///< Time calls to each Namespace::Entry
+   OpcodeStats* mOpcodeStats; ///< nullptr unless opcode stats have been enabled (KS_OPCODE_STATS builds)
    ExceptionInfo  mLastExceptionInfo;
 
    Dictionary mGlobalVars;
@@ -78,6 +84,7 @@ struct VmInternal
 
    Vector<TypeInfo> mTypes;
    Vector<ClassInfo> mClassList;
+   Vector< Vector<U32> > mClassFieldLookup; ///< Per class open addressed field name hash (field index+1, 0 = empty)
 
    KorkApi::ConsoleHeapAlloc* mHeapAllocs;
    Config mConfig;
@@ -95,6 +102,9 @@ struct VmInternal
    bool mOwnsResources;
 
    U32 mNSCounter;
+   U32 mSnapshotGeneration; ///< Generation of the last fiber snapshot written (0 = none)
+   U32 mSnapshotIdCounter;   ///< Source of stable ids for snapshotted dictionaries & codeblocks
+   Vector<StringTableEntry> mSignalSlots; ///< Signal names indexed by slot
    char mExecReturnBuffer[ExecReturnBufferSize];
    char mFileLineBuffer[FileLineBufferSize];
 
@@ -169,12 +179,17 @@ struct VmInternal
    void releaseHeapRef(ConsoleHeapAllocRef value);
 
    S32 lookupTypeId(StringTableEntry typeName);
+   
+   /// Returns the slot for a signal name, optionally allocating one.
+   S32 getSignalSlot(StringTableEntry name, bool create);
 
    // Heap values (like strings)
    ConsoleValue getStringFuncBuffer(FiberId fiberId, U32 size);
    ConsoleValue getStringReturnBuffer(U32 size);
    ConsoleValue getTypeFunc(FiberId fiberId, TypeId typeId, U32 heapSize);
    ConsoleValue getTypeReturn(TypeId typeId, U32 heapSize);
+   ConsoleValue getStringResultBuffer(U32 size);
+   ConsoleValue makeStringResult(ConsoleValue value, U32 len);
 
    ConsoleValue getStringInZone(U16 zone, U32 size);
    ConsoleValue getTypeInZone(U16 zone, TypeId typeId, U32 heapSize);
@@ -185,6 +200,8 @@ struct VmInternal
    CodeBlock *findCodeBlock(StringTableEntry name);
 
    ClassInfo* getClassInfoByName(StringTableEntry name);
+   void buildClassFieldLookup(ClassId klassId);
+   S32 findClassField(ClassInfo* klass, StringTableEntry name);
 
    const char* tempFloatConv(F64 val);
    const char* tempIntConv(U64 val);
@@ -193,9 +210,25 @@ struct VmInternal
    bool setObjectField(VMObject* object, StringTableEntry name, ConsoleValue arrayIndex, ConsoleValue value);
    bool setObjectFieldTuple(VMObject* object, StringTableEntry fieldName, ConsoleValue arrayIndex, U32 argc, ConsoleValue* argv);
    ConsoleValue getObjectField(VMObject* object, StringTableEntry name, ConsoleValue  arrayIndex, U32 requestedType, U32 requestedZone);
+   
+   // Variants taking a pre-resolved static field index (see findClassField); 
+   // name is still used for dynamic fields when fieldIndex is -1.
+   bool setObjectFieldTupleByIndex(VMObject* object, S32 fieldIndex, StringTableEntry fieldName, ConsoleValue arrayIndex, U32 argc, ConsoleValue* argv);
+   ConsoleValue getObjectFieldByIndex(VMObject* object, S32 fieldIndex, StringTableEntry name, ConsoleValue  arrayIndex, U32 requestedType, U32 requestedZone);
+   
+   /// Returns the address of a static field value which can be accessed directly as
+   /// a number (see TypeInfo::numericStorage), or nullptr if it needs CastValueFn.
+   void* getNumericFieldPtr(VMObject* object, S32 fieldIndex, const char* arrayIndex, bool forWrite, U8& outStorage);
    U16 getObjectFieldType(VMObject* object, StringTableEntry name, ConsoleValue arrayIndex);
    void assignFieldsFromTo(VMObject* from, VMObject* to);
 
+   /// Returns false if printf output would be discarded
+   inline bool isLogEnabled() const
+   {
+      return mConfig.logFn != nullptr ||
+             mConfig.extraConsumers[0].cbFunc != nullptr ||
+             mConfig.extraConsumers[1].cbFunc != nullptr;
+   }
    void printf(int level, const char* fmt, ...);
    void print(int level, const char* buf);
 
@@ -1,7 +1,12 @@
 #include "platform/platform.h"
 #include <stdio.h>
+#include <chrono>
+#include <string>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 #include "embed/api.h"
+#include "core/stringTable.h"
 
 /*
  Example for new API
@@ -429,6 +434,163 @@ int testScript(char* script, const char* filename)
 }
 
 
+// Times the VMs inbuilt string interner via the embed API.
+// Usage: csapitest -benchIntern [count]
+static int benchIntern(U32 count)
+{
+   Config cfg{};
+   cfg.mallocFn = [](size_t sz, void* user) {
+      return (void*)malloc(sz);
+   };
+   cfg.freeFn = [](void* ptr, void* user){
+      free(ptr);
+   };
+   cfg.logFn = MyLogger;
+   Vm* vm = createVM(&cfg);
+   if (!vm)
+   {
+      return 1;
+   }
+
+   std::vector<std::string> names(count);
+   std::vector<std::string> upperNames(count);
+   std::vector<std::string> missNames(count);
+   for (U32 i=0; i<count; i++)
+   {
+      names[i] = "$Pref::Server::Variable" + std::to_string(i);
+      upperNames[i] = names[i];
+      for (char& c : upperNames[i]) c = toupper(c);
+      missNames[i] = "missing_name_" + std::to_string(i);
+   }
+
+   uintptr_t check = 0;
+   auto timePass = [&](const char* label, auto fn) {
+      auto start = std::chrono::steady_clock::now();
+      for (U32 i=0; i<count; i++)
+      {
+         check += (uintptr_t)fn(i);
+      }
+      auto end = std::chrono::steady_clock::now();
+      F64 ns = (F64)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+      printf("%-24s %8.1f ns/op\n", label, ns / count);
+   };
+
+   timePass("intern new", [&](U32 i) { return vm->internString(names[i].c_str()); });
+   timePass("intern existing", [&](U32 i) { return vm->internString(names[i].c_str()); });
+   timePass("intern other case", [&](U32 i) { return vm->internString(upperNames[i].c_str()); });
+   timePass("intern case sensitive", [&](U32 i) { return vm->internString(names[i].c_str(), true); });
+   timePass("internN existing", [&](U32 i) { return vm->internStringN(names[i].c_str(), (U32)names[i].size()); });
+   timePass("lookup hit", [&](U32 i) { return vm->lookupString(upperNames[i].c_str()); });
+   timePass("lookup miss", [&](U32 i) { return vm->lookupString(missNames[i].c_str()); });
+
+   bool ok = vm->internString(upperNames[0].c_str()) == vm->internString(names[0].c_str()) &&
+             vm->lookupString(missNames[0].c_str()) == nullptr;
+   printf("check %llx %s\n", (unsigned long long)check, ok ? "ok" : "FAILED");
+
+   destroyVM(vm);
+   return ok ? 0 : 1;
+}
+
+// Inserts and looks up strings in the StringTable from several threads at
+// once. New names force shard resizes while the seeded names are checked,
+// so case insensitive hits must still return the first variant inserted.
+// Usage: csapitest -testStringTable
+static bool testStringTableThreads()
+{
+   const U32 numThreads = 8;
+   const U32 numNames = 20000;
+   const U32 numSeeds = 512;
+   
+   std::vector<std::string> names(numNames);
+   std::vector<std::string> upperNames(numNames);
+   for (U32 i=0; i<numNames; i++)
+   {
+      names[i] = "threadName_" + std::to_string(i);
+      upperNames[i] = names[i];
+      for (char& c : upperNames[i]) c = toupper(c);
+   }
+   
+   std::vector<std::string> seeds(numSeeds);
+   std::vector<std::string> upperSeeds(numSeeds);
+   std::vector<StringTableEntry> seedEntries(numSeeds);
+   for (U32 i=0; i<numSeeds; i++)
+   {
+      seeds[i] = "threadseed_" + std::to_string(i);
+      upperSeeds[i] = seeds[i];
+      for (char& c : upperSeeds[i]) c = toupper(c);
+      seedEntries[i] = StringTable->insert(seeds[i].c_str());
+   }
+   
+   std::vector<std::vector<StringTableEntry>> results(numThreads, std::vector<StringTableEntry>(numNames));
+   std::vector<U32> failures(numThreads, 0);
+   std::vector<std::thread> threads;
+   
+   for (U32 t=0; t<numThreads; t++)
+   {
+      threads.emplace_back([&, t]() {
+         for (U32 i=0; i<numNames; i++)
+         {
+            // Each thread walks the names in a different order and case
+            U32 idx = (i * 7919 + t * 2503) % numNames;
+            const std::string& name = ((i + t) & 1) ? upperNames[idx] : names[idx];
+            StringTableEntry ste = StringTable->insert(name.c_str());
+            if (StringTable->lookup(name.c_str()) != ste ||
+                StringTable->insertn(name.c_str(), (S32)name.size()) != ste)
+            {
+               failures[t]++;
+            }
+            results[t][idx] = ste;
+            
+            // Adds a later variant of each seed, then checks the first is kept
+            U32 seed = (i + t) % numSeeds;
+            StringTableEntry upperSeed = StringTable->insert(upperSeeds[seed].c_str(), true);
+            if (upperSeed == seedEntries[seed] ||
+                StringTable->insert(upperSeeds[seed].c_str()) != seedEntries[seed] ||
+                StringTable->lookupn(upperSeeds[seed].c_str(), (S32)upperSeeds[seed].size()) != seedEntries[seed] ||
+                StringTable->lookup(upperSeeds[seed].c_str(), true) != upperSeed)
+            {
+               failures[t]++;
+            }
+         }
+      });
+   }
+   
+   for (std::thread& thread : threads)
+   {
+      thread.join();
+   }
+   
+   bool ok = true;
+   for (U32 t=0; t<numThreads; t++)
+   {
+      if (failures[t] != 0)
+      {
+         printf("testStringTableThreads: thread %u had %u mismatched lookups\n", t, failures[t]);
+         ok = false;
+      }
+   }
+   
+   for (U32 i=0; i<numNames && ok; i++)
+   {
+      StringTableEntry ste = StringTable->lookup(names[i].c_str());
+      if (ste == nullptr || strcasecmp(ste, names[i].c_str()) != 0)
+      {
+         printf("testStringTableThreads: %s missing\n", names[i].c_str());
+         ok = false;
+      }
+      for (U32 t=0; t<numThreads && ok; t++)
+      {
+         if (results[t][i] != ste)
+         {
+            printf("testStringTableThreads: %s has more than one entry\n", names[i].c_str());
+            ok = false;
+         }
+      }
+   }
+   
+   return ok;
+}
+
 int procMain(int argc, char **argv)
 {
    if (argc < 2)
@@ -437,6 +599,18 @@ int procMain(int argc, char **argv)
       return 1;
    }
    
+   if (strcmp(argv[1], "-benchIntern") == 0)
+   {
+      return benchIntern(argc > 2 ? (U32)atoi(argv[2]) : 200000);
+   }
+   
+   if (strcmp(argv[1], "-testStringTable") == 0)
+   {
+      bool ok = testStringTableThreads();
+      printf("testStringTableThreads %s\n", ok ? "ok" : "FAILED");
+      return ok ? 0 : 1;
+   }
+   
    for (int i=2; i<argc; i++)
    {
    }
@@ -12,6 +12,7 @@
 #include "console/compiler.h"
 #include "console/simpleParser.h"
 #include <stdio.h>
+#include <chrono>
 
 /*
  
@@ -23,6 +24,9 @@ bool gPrintBytecode = false;
 bool gEnableExtensions = false;
 bool gDumpLines = false;
 bool gPrintLexer = false;
+U32 gLexBenchMB = 0;
+bool gRunOpcodeStats = false;
+U32 gOpcodeStatsRows = 20;
 
 void MyLogger(U32 level, const char *consoleLine, void* userPtr)
 {
@@ -488,7 +492,8 @@ void dumpToInstructionsPrint(Compiler::Resources& res, StmtNode* rootNode)
       U32 lastIP = Compiler::compileBlock(rootNode, codeStream, 0) + 1;
       
       codeStream.emit(Compiler::OP_RETURN);
-      codeStream.emitCodeStream(&cb->codeSize, &cb->code, &cb->lineBreakPairs, &cb->numFunctionCalls, &cb->functionCalls);
+      codeStream.emitCodeStream(&cb->codeSize, &cb->code, &cb->lineBreakPairs, &cb->numFunctionCalls, &cb->functionCalls, &cb->numFieldSites);
+      cb->allocFieldSites();
       
       
       cb->lineBreakPairCount = codeStream.getNumLineBreaks();
@@ -586,6 +591,117 @@ bool printAST(const char* buf, const char* filename)
    return true;
 }
 
+// Measures raw tokenizer throughput. The source is lexed repeatedly until
+// at least gLexBenchMB megabytes have been processed.
+bool benchLexer(const char* buf, size_t size, const char* filename)
+{
+   if (size == 0)
+   {
+      printf("Nothing to lex\n");
+      return false;
+   }
+   
+   KorkApi::Config cfg{};
+   cfg.mallocFn = [](size_t sz, void* user) {
+      return (void*)malloc(sz);
+   };
+   cfg.freeFn = [](void* ptr, void* user){
+      free(ptr);
+   };
+   cfg.logFn = MyLogger;
+   
+   KorkApi::Vm* vm = KorkApi::createVM(&cfg);
+   bool ok = true;
+   {
+      KorkApi::VmAllocTLS::Scope memScope(vm->mInternal);
+      
+      std::string_view src(buf, size);
+      const U64 target = (U64)gLexBenchMB * 1024 * 1024;
+      U64 totalBytes = 0;
+      U64 totalTokens = 0;
+      U32 passes = 0;
+      
+      auto start = std::chrono::steady_clock::now();
+      while (totalBytes < target || passes == 0)
+      {
+         SimpleLexer::Tokenizer<KorkApi::VMStringTable> lex(KorkApi::VMStringTable(vm->mInternal), src, filename, gEnableExtensions);
+         SimpleLexer::Token t;
+         for (t = lex.next(); !(t.isNone() || t.isIllegal() || t.isEnd()); t = lex.next())
+         {
+            totalTokens++;
+         }
+         
+         if (!t.isEnd())
+         {
+            printf("Invalid token (%s) at %i:%i\n", lex.toString(t).c_str(), t.pos.line, t.pos.col);
+            ok = false;
+            break;
+         }
+         
+         totalBytes += size;
+         passes++;
+      }
+      auto end = std::chrono::steady_clock::now();
+      
+      if (ok)
+      {
+         F64 secs = std::chrono::duration<F64>(end - start).count();
+         F64 mb = (F64)totalBytes / (1024.0 * 1024.0);
+         printf("Lexed %.2f MB (%u passes, %" PRIu64 " tokens) in %.3f s: %.2f MB/s, %.2f Mtok/s\n",
+                mb, passes, totalTokens, secs,
+                secs > 0 ? mb / secs : 0.0,
+                secs > 0 ? ((F64)totalTokens / 1000000.0) / secs : 0.0);
+      }
+   }
+   
+   KorkApi::destroyVM(vm);
+   return ok;
+}
+
+// Runs the script then prints its bytecode annotated with instruction hit 
+// counts, followed by the most executed opcodes, pairs and triples.
+bool runOpcodeStats(const char* buf, const char* filename)
+{
+   KorkApi::Config cfg{};
+   cfg.mallocFn = [](size_t sz, void* user) {
+      return (void*)malloc(sz);
+   };
+   cfg.freeFn = [](void* ptr, void* user){
+      free(ptr);
+   };
+   cfg.logFn = MyLogger;
+   cfg.enableExceptions = gEnableExtensions;
+   cfg.enableTuples = gEnableExtensions;
+   cfg.enableTypes = gEnableExtensions;
+   cfg.enableSignals = gEnableExtensions;
+   cfg.enableStringInterpolation = gEnableExtensions;
+   
+   KorkApi::Vm* vm = KorkApi::createVM(&cfg);
+   bool ok = vm->setOpcodeStatsEnabled(true);
+   if (!ok)
+   {
+      printf("Opcode stats not available (build with KS_OPCODE_STATS)\n");
+   }
+   else
+   {
+      vm->evalCode(buf, filename, "", -1);
+      vm->setOpcodeStatsEnabled(false);
+      
+      printf("== Instruction Hits ==\n");
+      if (!vm->dumpInstructionHits(filename))
+      {
+         printf("No instructions executed\n");
+      }
+      
+      printf("== Opcode Stats ==\n");
+      vm->opcodeStatsDump(gOpcodeStatsRows, [](void* userPtr, const char* line) {
+         printf("%s\n", line);
+      }, nullptr);
+   }
+   
+   KorkApi::destroyVM(vm);
+   return ok;
+}
 
 int procMain(int argc, char **argv)
 {
@@ -613,6 +729,24 @@ int procMain(int argc, char **argv)
       {
          gPrintLexer = true;
       }
+      if (strcmp(argv[i], "-r") == 0)
+      {
+         // -r [rows] : run with opcode stats
+         gRunOpcodeStats = true;
+         if (i+1 < argc && argv[i+1][0] != '-')
+         {
+            gOpcodeStatsRows = (U32)atoi(argv[++i]);
+         }
+      }
+      if (strcmp(argv[i], "-t") == 0)
+      {
+         // -t [MB] : lexer throughput benchmark
+         gLexBenchMB = 256;
+         if (i+1 < argc && argv[i+1][0] != '-')
+         {
+            gLexBenchMB = (U32)atoi(argv[++i]);
+         }
+      }
    }
    
    FILE* fp = fopen(argv[1], "r");
@@ -631,7 +765,19 @@ int procMain(int argc, char **argv)
    data[fend] = '\0';
    fclose(fp);
    
-   int ret = printAST(data, argv[1]) ? 0 : 1;
+   int ret = 0;
+   if (gLexBenchMB > 0)
+   {
+      ret = benchLexer(data, fend, argv[1]) ? 0 : 1;
+   }
+   else if (gRunOpcodeStats)
+   {
+      ret = runOpcodeStats(data, argv[1]) ? 0 : 1;
+   }
+   else
+   {
+      ret = printAST(data, argv[1]) ? 0 : 1;
+   }
    delete[] data;
    return ret;
 }
@@ -172,9 +172,210 @@ function test_controlFlow()
    testInt("switch.string", %x, 2);
 }
 
+function test_arrays()
+{
+   // Elements are the same variables as their composite names
+   %arr[0] = "zero";
+   %arr[5] = "five";
+   testString("arrays.index", %arr[5], "five");
+   testString("arrays.alias", %arr5, "five");
+   %arr0 = "ZERO";
+   testString("arrays.aliasWrite", %arr[0], "ZERO");
+   %old3 = "legacy";
+   testString("arrays.legacy", %old[3], "legacy");
+   %old[3] = "updated";
+   testString("arrays.legacyWrite", %old3, "updated");
+
+   // String, sparse and multi dimensional keys
+   %arr["Key"] = "k";
+   testString("arrays.key", %arr["KEY"], "k");
+   testString("arrays.keyAlias", %arrkey, "k");
+   %arr[1000000] = "sparse";
+   testString("arrays.sparse", %arr1000000, "sparse");
+   %arr["007"] = "octal";
+   testString("arrays.leadingZero", %arr007, "octal");
+   testString("arrays.leadingZeroDense", %arr[7], "");
+   %grid[1, 2] = "g";
+   testString("arrays.multi", %grid1_2, "g");
+   %arr[""] = "base";
+   testString("arrays.emptyKey", %arr, "base");
+
+   // Arrays whose names prefix each other
+   %ab[1] = "ab1";
+   testString("arrays.crossAlias", %a["b1"], "ab1");
+   %a["b1"] = "a_b1";
+   testString("arrays.crossAliasWrite", %ab[1], "a_b1");
+
+   // Operators
+   %arr[2] = 10;
+   %arr[2] += 5;
+   %arr[2]++;
+   testInt("arrays.assignOp", %arr[2], 16);
+
+   %sum = 0;
+   for (%i = 0; %i < 2000; %i++)
+      %big[%i] = %i;
+   for (%i = 0; %i < 2000; %i++)
+      %sum += %big[%i];
+   testInt("arrays.loop", %sum, 1999000);
+   testString("arrays.loopAlias", %big1999, "1999");
+
+   // Aliases resolve through whichever array name prefixes the variable
+   $tstAlias[1] = "short";
+   $tstAliasLonger["k"] = "longer";
+   $tstAliasWithAVeryLongNameWhichIsWellPastTheUsualLengthOfAGlobalName[7] = "long";
+   testString("arrays.aliasShort", $tstAlias1, "short");
+   testString("arrays.aliasLonger", $TSTALIASLONGERk, "longer");
+   testString("arrays.aliasLong", $tstAliasWithAVeryLongNameWhichIsWellPastTheUsualLengthOfAGlobalName7, "long");
+   testString("arrays.aliasMiss", $tstAliasLongerx, "");
+   deleteVariables("$tstAlias*");
+
+   // Enumeration sees composite names
+   $tstArr[1] = "one";
+   $tstArr["x"] = "ex";
+   $tstArr2 = "two";
+   testString("arrays.enumGlobals", listGlobals("$tstArr*"), "$tstArr1=one $tstArr2=two $tstArrx=ex");
+   %locals = listLocals();
+   testInt("arrays.enumLocals", strstr(%locals, "%grid1_2=g") >= 0 && strstr(%locals, "%big42=42") >= 0, 1);
+   deleteVariables("$tstArr1");
+   testString("arrays.delete", listGlobals("$tstArr*"), "$tstArr2=two $tstArrx=ex");
+   testString("arrays.deleteValue", $tstArr[1], "");
+}
+
+function test_globalPatterns()
+{
+   $PatB::z = 3;
+   $PatA::y = 2;
+   $PatA::x::deep = 1;
+   $PatAlpha = 4;
+   $PatA::list[1] = "l1";
+   $PatA::list[10] = "l10";
+   $PatA::list["w"] = "lw";
+
+   testString("globalPatterns.segment", listGlobals("$PatA::*"), "$PatA::list1=l1 $PatA::list10=l10 $PatA::listw=lw $PatA::x::deep=1 $PatA::y=2");
+   testString("globalPatterns.partial", listGlobals("$PatA*"), "$PatA::list1=l1 $PatA::list10=l10 $PatA::listw=lw $PatA::x::deep=1 $PatA::y=2 $PatAlpha=4");
+   testString("globalPatterns.intoKey", listGlobals("$PatA::list1*"), "$PatA::list1=l1 $PatA::list10=l10");
+   testString("globalPatterns.inner", listGlobals("$Pat?::y"), "$PatA::y=2");
+   testString("globalPatterns.case", listGlobals("$pata::X::*"), "$PatA::x::deep=1");
+   testString("globalPatterns.leadingWild", listGlobals("?PatA::list1*"), "$PatA::list1=l1 $PatA::list10=l10");
+   export("*");
+   testString("globalPatterns.exportAll", $PatA::list[1], "l1");
+
+   deleteVariables("$PatA::*");
+   testString("globalPatterns.delete", listGlobals("$Pat*"), "$PatAlpha=4 $PatB::z=3");
+   testString("globalPatterns.deletedElement", $PatA::list[10], "");
+
+   $PatA::y = 5;
+   testString("globalPatterns.readd", listGlobals("$PatA::*"), "$PatA::y=5");
+   deleteVariables("$Pat*");
+   testString("globalPatterns.deleteAll", listGlobals("$Pat*"), "");
+}
+
+function test_stringAppend()
+{
+   // %var = %var @ ... is appended in place
+   for (%i = 0; %i < 5; %i++)
+      %s = %s @ %i;
+   testString("append.loop", %s, "01234");
+
+   %t = 3;
+   %t = %t SPC "x" @ "y" TAB 4;
+   testString("append.chain", %t, "3 xy\t4");
+
+   $tstAppend = "g";
+   $tstAppend = $tstAppend NL "h";
+   testString("append.global", $tstAppend, "g\nh");
+
+   %w = "a";
+   %w = %w @ (%w @ "b");
+   testString("append.self", %w, "aab");
+
+   // Calls may change the variable so keep the normal order
+   %x = "k";
+   %x = %x @ appendSuffix(%x);
+   testString("append.call", %x, "kk!");
+
+   %v = "q";
+   %r = (%v = %v @ "r");
+   testString("append.value", %r, "qr");
+
+   %big = "";
+   for (%i = 0; %i < 10000; %i++)
+      %big = %big @ "0123456789";
+   testInt("append.bigLen", strlen(%big), 100000);
+   testString("append.bigEnd", getSubStr(%big, 99990, 10), "0123456789");
+}
+
+function appendSuffix(%a)
+{
+   return %a @ "!";
+}
+
+function test_nativeStringResults()
+{
+   // Native string results are written in place on the stack
+   testString("nativeResult.concat", "<" @ getSubStr("abcdef", 1, 3) @ ">", "<bcd>");
+   testString("nativeResult.nested", strupr(getSubStr("hello world", 6, 5)), "WORLD");
+   testString("nativeResult.args", firstWord(strreplace("a b c", " ", "_") SPC "z"), "a_b_c");
+   testString("nativeResult.trim", trim("  pad  ") @ restWords("x y"), "pady");
+   testInt("nativeResult.int", getSubStr("12345", 1, 2) + 1, 24);
+
+   for (%i = 0; %i < 3; %i++)
+      %list = %list @ strlwr(getSubStr("ABC", %i, 1));
+   testString("nativeResult.loop", %list, "abc");
+
+   // Results too large for the frame fall back to the return buffer
+   for (%i = 0; %i < 100; %i++)
+      %big = %big @ "xxxxxxxxxx";
+   %big = strreplace(%big, "x", "yy");
+   testInt("nativeResult.bigLen", strlen(%big), 2000);
+   testString("nativeResult.bigEnd", getSubStr(%big, 1996, 4), "yyyy");
+
+   // Natives called from natives get their own result space
+   testString("nativeResult.nestedNative", wrapResult("strupr", "abc"), "[ABC]");
+   testString("nativeResult.nestedNativeConcat", "<" @ wrapResult("trim", "  xyz ") @ ">", "<[xyz]>");
+}
+
+function lengthArgs(%a, %b)
+{
+   return strlen(%a) SPC strlen(%b) SPC strlen(%a @ %b);
+}
+
+function test_stringLengths()
+{
+   // Lengths are carried through concatenation, variables and calls
+   %a = "abc";
+   %b = %a @ "de" SPC 12 TAB 1.5;
+   testInt("strLen.concat", strlen(%b), 12);
+   testInt("strLen.nested", strlen("x" @ ("yy" @ %a) @ ""), 6);
+   testString("strLen.args", lengthArgs(%a, %b), "3 12 15");
+   testInt("strLen.empty", strlen(""), 0);
+
+   %c = %b;
+   %c = %c @ "!";
+   testInt("strLen.copyAppend", strlen(%c), 13);
+   testInt("strLen.copyOrig", strlen(%b), 12);
+
+   $tstLen = %a NL %a;
+   testInt("strLen.global", strlen($tstLen), 7);
+   testInt("strLen.number", strlen(1234), 4);
+
+   // Compares check lengths before contents
+   testInt("strLen.eq", %a $= "ABC", 1);
+   testInt("strLen.neLonger", %a $= "abcd", 0);
+   testInt("strLen.neShorter", %a $= "ab", 0);
+   testInt("strLen.neSame", %a $= "abd", 0);
+   testInt("strLen.eqConcat", ("ab" @ "c") $= %a, 1);
+}
+
 
 test_coreIntExpr();
 test_coreFloatExpr();
 test_precedence();
 test_coreStringExpr();
 test_controlFlow();
+test_arrays();
+test_globalPatterns();
+test_stringAppend();
+test_nativeStringResults();
+test_stringLengths();
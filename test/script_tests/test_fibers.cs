@@ -85,9 +85,111 @@ function test_fiberSaveLoad()
    testString("fiberSaveLoad.step3", %yield3, "FUDGERET");
 }
 
+function test_fiberDeltaSaveLoad()
+{
+   $FIBFIN = 0;
+   %fiberId = createFiber();
+   %code = "fiber_entry(" @ %fiberId @ "); $FIBFIN=1;";
+   %yield1 = evalInFiber(%fiberId, %code);
+
+   // Full snapshot, then a delta containing only the changes after resuming
+   %didSave = saveFibers(%fiberId, "test.dat");
+   %yield2 = resumeFiber(%fiberId, 26);
+   %didSaveDelta = saveFibers(%fiberId, "test_delta.dat", true);
+   testInt("fiberDeltaSaveLoad.saved", %didSave && %didSaveDelta, 1);
+
+   echo("STOPPING SERIALIZED FIBER Y2");
+   stopFiber(%fiberId);
+
+   // A delta on its own is not enough to restore
+   testString("fiberDeltaSaveLoad.deltaOnly", restoreFibers("test_delta.dat"), "");
+
+   %restoredId = restoreFibers("test.dat", "test_delta.dat");
+   testInt("fiberDeltaSaveLoad.chk2", $FIBFIN, 0);
+   testString("fiberDeltaSaveLoad.chk2LocalVar", readFiberLocalVariable(%restoredId, "%vc"), "26");
+
+   %yield3 = resumeFiber(%restoredId, "FUDGE");
+   testInt("fiberDeltaSaveLoad.chk3", $FIBFIN, 1);
+   testString("fiberDeltaSaveLoad.chk3L", $fiberLog[%fiberId], "ABC");
+
+   testInt("fiberDeltaSaveLoad.step1", %yield1, 123);
+   testString("fiberDeltaSaveLoad.step2", %yield2, 30);
+   testString("fiberDeltaSaveLoad.step3", %yield3, "FUDGERET");
+}
+
+function test_fiberStreamSaveLoad()
+{
+   $FIBFIN = 0;
+   %fiberId = createFiber();
+   %code = "fiber_entry(" @ %fiberId @ "); $FIBFIN=1;";
+   %yield1 = evalInFiber(%fiberId, %code);
+
+   // Compressed full snapshot followed by an uncompressed delta
+   %didSave = saveFibersStream(%fiberId, "test.dat", true);
+   %yield2 = resumeFiber(%fiberId, 26);
+   %didSaveDelta = saveFibersStream(%fiberId, "test_delta.dat", false, true);
+   testInt("fiberStreamSaveLoad.saved", %didSave && %didSaveDelta, 1);
+
+   echo("STOPPING SERIALIZED FIBER Y2");
+   stopFiber(%fiberId);
+
+   // Blob and stream formats are not interchangeable
+   testString("fiberStreamSaveLoad.notBlob", restoreFibers("test.dat"), "");
+
+   %restoredId = restoreFibersStream("test.dat", "test_delta.dat");
+   testInt("fiberStreamSaveLoad.chk2", $FIBFIN, 0);
+   testString("fiberStreamSaveLoad.chk2LocalVar", readFiberLocalVariable(%restoredId, "%vc"), "26");
+
+   %yield3 = resumeFiber(%restoredId, "FUDGE");
+   testInt("fiberStreamSaveLoad.chk3", $FIBFIN, 1);
+   testString("fiberStreamSaveLoad.chk3L", $fiberLog[%fiberId], "ABC");
+
+   testInt("fiberStreamSaveLoad.step1", %yield1, 123);
+   testString("fiberStreamSaveLoad.step2", %yield2, 30);
+   testString("fiberStreamSaveLoad.step3", %yield3, "FUDGERET");
+}
+
+function fiber_arrays()
+{
+   for (%i = 0; %i < 100; %i++)
+      %arr[%i] = %i * 2;
+   %arr["name"] = "N";
+   %arr[%i] = yieldFiber(1);
+   %arr["late"] = "L";
+   %arr[%i + 1] = yieldFiber(2);
+   return %arr[0] @ %arr[99] @ %arr["name"] @ %arr[100] @ %arr["late"] @ %arr101;
+}
+
+function test_fiberArraySaveLoad()
+{
+   %fiberId = createFiber();
+   %yield1 = evalInFiber(%fiberId, "fiber_arrays();");
+
+   %didSave = saveFibers(%fiberId, "test.dat");
+   %yield2 = resumeFiber(%fiberId, "X");
+   %didSaveDelta = saveFibers(%fiberId, "test_delta.dat", true);
+   testInt("fiberArraySaveLoad.saved", %didSave && %didSaveDelta, 1);
+   stopFiber(%fiberId);
+
+   %restoredId = restoreFibers("test.dat", "test_delta.dat");
+   testString("fiberArraySaveLoad.element", readFiberLocalVariable(%restoredId, "%arr42"), "84");
+   testString("fiberArraySaveLoad.key", readFiberLocalVariable(%restoredId, "%arrname"), "N");
+   testString("fiberArraySaveLoad.deltaElement", readFiberLocalVariable(%restoredId, "%arr100"), "X");
+   testString("fiberArraySaveLoad.deltaKey", readFiberLocalVariable(%restoredId, "%arrlate"), "L");
+
+   %result = resumeFiber(%restoredId, "Y");
+   testString("fiberArraySaveLoad.result", %result, "0198NXLY");
+}
+
 
 test_fiberBasic();
 echo("--");
 test_fiberSaveLoad();
+echo("--");
+test_fiberDeltaSaveLoad();
+echo("--");
+test_fiberStreamSaveLoad();
+echo("--");
+test_fiberArraySaveLoad();
 
 echo("Fiber tests finished");
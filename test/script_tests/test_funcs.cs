@@ -41,6 +41,99 @@ function test_functions()
    return %ok;
 }
 
+function test_profiler()
+{
+   profilerReset();
+   profilerStart(1);
+   fn_fact(6);
+   profilerStop();
+
+   %samples = profilerNumSamples();
+   testAssert("fn.profiler.samples", %samples > 0);
+   testAssert("fn.profiler.outer", profilerStackSamples("test_profiler (") == %samples);
+   testAssert("fn.profiler.recursive", profilerStackSamples(":25);fn_fact (") > 0);
+
+   // Nothing is sampled once stopped
+   fn_fact(6);
+   testInt("fn.profiler.stopped", profilerNumSamples(), %samples);
+   profilerReset();
+}
+
+function test_call_stats()
+{
+   resetCallStats();
+   setCallStatsEnabled(true);
+   for (%i = 0; %i < 3; %i++)
+      fn_fact(4);
+   %word = getWord("a b c", 1);
+   setCallStatsEnabled(false);
+   fn_fact(2);
+
+   %stats = getCallStats("fn_fact");
+   testInt("fn.callStats.script", getWord(%stats, 0), 12);
+   testAssert("fn.callStats.exclusive", getWord(%stats, 2) <= getWord(%stats, 1));
+   testInt("fn.callStats.native", getWord(getCallStats("getWord"), 0), 1);
+
+   resetCallStats();
+   testInt("fn.callStats.reset", getWord(getCallStats("fn_fact"), 0), 0);
+}
+
+function test_compile_stats()
+{
+   eval("$compileStatsVal = 1 + 2;");
+   %stats = getCompileStats();
+   testAssert("fn.compileStats.peak", getWord(%stats, 0) > 0);
+   testAssert("fn.compileStats.reserved", getWord(%stats, 1) >= getWord(%stats, 0));
+   testInt("fn.compileStats.notExceeded", getWord(%stats, 2), 0);
+
+   // Scripts over the limit fail to compile
+   setCompileAstLimit(256);
+   $compileStatsVal = 0;
+   eval("$compileStatsVal = 1 + 2 + 3 + 4 + 5 + 6 + 7 + 8 + 9 + 10 + 11 + 12;");
+   %stats = getCompileStats();
+   setCompileAstLimit(0);
+   testInt("fn.compileStats.limited", $compileStatsVal, 0);
+   testInt("fn.compileStats.exceeded", getWord(%stats, 2), 1);
+
+   eval("$compileStatsVal = 1 + 2;");
+   testInt("fn.compileStats.unlimited", $compileStatsVal, 3);
+}
+
+function test_stream_compile()
+{
+   // Comments, docblocks and strings split across chunks of varying size
+   %code = "/* block\n * comment */ function streamFnA(%a) { return %a @ \"-streamed\"; }\n" @
+           "/// Doc line\n/// Second\nfunction streamFnB() { return \"b\" SPC $\"{1+2}\"; }\n" @
+           "$streamVal = streamFnA(\"x\") @ streamFnB();\n" @
+           "new ScriptObject(StreamObj) { field = \"v\" @ \"w\"; };\n";
+   for (%size = 1; %size < 8; %size += 3)
+   {
+      $streamVal = "";
+      evalStream(%code, %size);
+      testString("fn.stream.decls" @ %size, $streamVal, "x-streamedb 3");
+      testString("fn.stream.object" @ %size, StreamObj.field, "vw");
+      StreamObj.delete();
+   }
+
+   // AST memory is only held for one declaration at a time
+   %big = "";
+   for (%i = 0; %i < 200; %i++)
+      %big = %big @ "$streamSum = $streamSum + " @ %i @ " + 1 + 2 + 3;\n";
+   $streamSum = 0;
+   eval(%big);
+   %fullPeak = getWord(getCompileStats(), 0);
+   $streamSum = 0;
+   evalStream(%big, 64);
+   %streamPeak = getWord(getCompileStats(), 0);
+   testInt("fn.stream.result", $streamSum, 21100);
+   testAssert("fn.stream.boundedAst", %streamPeak * 10 < %fullPeak);
+
+   // Nothing runs if a later declaration fails to parse
+   $streamErr = 0;
+   evalStream("$streamErr = 1;\nfunction streamBad( {", 5);
+   testInt("fn.stream.parseError", $streamErr, 0);
+}
+
 function test_object_functions()
 {
    echo("ADDING ScriptObject");
@@ -57,6 +150,77 @@ function test_object_functions()
    %obj.delete();
 }
 
+function fn_readClassField(%obj)
+{
+   return %obj.class;
+}
+
+function test_object_fields()
+{
+   %obj = new ScriptObject() {
+      class = TestScriptClass;
+      internalName = "fieldTest";
+   };
+   %grp = new SimGroup();
+   %grp.class = "DynamicClass";
+
+   // Same field site alternating between a static and a dynamic field
+   testString("fn.field.static", fn_readClassField(%obj), "TestScriptClass");
+   testString("fn.field.dynamic", fn_readClassField(%grp), "DynamicClass");
+   testString("fn.field.static2", fn_readClassField(%obj), "TestScriptClass");
+   testString("fn.field.internalName", %obj.internalName, "fieldTest");
+
+   %obj.delete();
+   %grp.delete();
+
+   // TypeS32 field accessed directly by numeric loads & stores
+   %mgr = new SimFiberManager();
+   %mgr.flags = 123456;
+   testInt("fn.field.numeric", %mgr.flags + 1, 123457);
+   testString("fn.field.numericStr", %mgr.flags, "123456");
+   %mgr.flags = 2.7 * 2;
+   testInt("fn.field.numericFlt", %mgr.flags, 5);
+   %mgr.flags++;
+   testNumber("fn.field.numericInc", %mgr.flags * 0.5, 3);
+   %mgr.delete();
+}
+
+function test_object_const_fields()
+{
+   // All constant fields are set from a single field table
+   %obj = new ScriptObject() {
+      internalName = "constTest";
+      strField = "hello world";
+      identField = someIdent;
+      intField = 42;
+      floatField = 1.5;
+   };
+   testString("fn.constFields.static", %obj.internalName, "constTest");
+   testString("fn.constFields.str", %obj.strField, "hello world");
+   testString("fn.constFields.ident", %obj.identField, "someIdent");
+   testInt("fn.constFields.int", %obj.intField, 42);
+   testNumber("fn.constFields.float", %obj.floatField, 1.5);
+   %obj.delete();
+
+   // A non constant field keeps the per field path
+   %value = "dynamic";
+   %obj = new ScriptObject() {
+      constField = "a";
+      varField = %value;
+   };
+   testString("fn.constFields.mixedConst", %obj.constField, "a");
+   testString("fn.constFields.mixedVar", %obj.varField, "dynamic");
+   %obj.delete();
+
+   // Tables larger than a single batch
+   %code = "$constFieldObj = new ScriptObject() {";
+   for (%i = 0; %i < 40; %i++)
+      %code = %code @ "f" @ %i @ " = " @ (%i * 3) @ ";";
+   eval(%code @ "};");
+   testInt("fn.constFields.batchFirst", $constFieldObj.f0, 0);
+   testInt("fn.constFields.batchLast", $constFieldObj.f39, 117);
+   $constFieldObj.delete();
+}
 
 function TestScriptClass::onAdd(%this)
 {
@@ -83,4 +247,10 @@ function TestNamespace::func(%a, %b, %c)
 
 test_functions();
 test_object_functions();
+test_object_fields();
+test_object_const_fields();
+test_profiler();
+test_call_stats();
+test_compile_stats();
+test_stream_compile();
 echo("Function tests finished");
@@ -32,6 +32,18 @@ function SignalListener::onRemove(%this)
 {
 }
 
+function SignalListener::onPingRemove(%this, %amount)
+{
+   $signalTrace = $signalTrace @ "remove-" @ %this.getName() @ ":" @ %amount @ ";";
+   $signalEmitter.removeListener("ping", $signalVictim);
+}
+
+function SignalListener::onPingDeleteEmitter(%this, %amount)
+{
+   $signalTrace = $signalTrace @ "delete-" @ %this.getName() @ ":" @ %amount @ ";";
+   $signalEmitter.delete();
+}
+
 function testSignals()
 {
    $signalSum = 0;
@@ -83,4 +95,79 @@ function testSignals()
    %emitter.delete();
 }
 
+function testSignalDispatch()
+{
+   $signalTrace = "";
+
+   %emitter = new ScriptObject(emitter2)
+   {
+      class = SignalEmitter;
+   };
+
+   %remover = new ScriptObject(remover)
+   {
+      class = SignalListener;
+   };
+
+   %victim = new ScriptObject(victim)
+   {
+      class = SignalListener;
+   };
+
+   $signalEmitter = %emitter;
+   $signalVictim = %victim;
+
+   // Listener removed by an earlier listener in the same dispatch is skipped
+   %emitter.addListener("ping", %remover, "onPingRemove");
+   %emitter.addListener("ping", %victim, "onPing");
+   %emitter.ping(1);
+   testString("signal.dispatchRemove", $signalTrace, "remove-remover:1;");
+
+   // Redefined listener methods are picked up by existing bindings
+   %emitter.removeListener("ping", %remover);
+   %emitter.addListener("ping", %victim, "onPing");
+   %emitter.ping(2);
+   eval("function SignalListener::onPing(%this, %amount) { $signalTrace = $signalTrace @ \"redef:\" @ %amount @ \";\"; }");
+   %emitter.ping(3);
+   testString("signal.redefine", $signalTrace, "remove-remover:1;alias-victim:2;redef:3;");
+
+   %victim.delete();
+   %remover.delete();
+   %emitter.delete();
+}
+
+function testSignalDeleteEmitter()
+{
+   $signalTrace = "";
+
+   %emitter = new ScriptObject(emitter3)
+   {
+      class = SignalEmitter;
+   };
+
+   %deleter = new ScriptObject(deleter)
+   {
+      class = SignalListener;
+   };
+
+   %after = new ScriptObject(after)
+   {
+      class = SignalListener;
+   };
+
+   $signalEmitter = %emitter;
+
+   // Dispatch stops once a listener deletes the emitter
+   %emitter.addListener("ping", %deleter, "onPingDeleteEmitter");
+   %emitter.addListener("ping", %after, "onPing");
+   %emitter.ping(7);
+   testString("signal.deleteEmitter", $signalTrace, "delete-deleter:7;");
+   testInt("signal.deleteEmitterGone", isObject(emitter3), 0);
+
+   %after.delete();
+   %deleter.delete();
+}
+
 testSignals();
+testSignalDispatch();
+testSignalDeleteEmitter();
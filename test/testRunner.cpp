@@ -13,6 +13,7 @@
 #include "sim/dynamicTypes.h"
 #include "core/fileStream.h"
 #include "core/stringUnit.h"
+#include <string>
 
 S32 gReturnCode = 0;
 U32 gNumPasses = 0;
@@ -274,7 +275,28 @@ ConsoleFunction(throwFiber, void, 3, 3, "value, soft")
    vmPtr->throwFiber(((U32)dAtoi(argv[1])) | (dAtob(argv[2]) ? BIT(31) : 0));
 }
 
-ConsoleFunction(saveFibers, bool, 3, 3, "fiberIdList, fileName")
+static const char* fiberListToString(KorkApi::Vm* vmPtr, U32 numFibers, KorkApi::FiberId* fibers)
+{
+   KorkApi::ConsoleValue cbuf = Con::getReturnBuffer(numFibers * 32);
+   char* buf = (char*)cbuf.evaluatePtr(vmPtr->getAllocBase());
+   buf[0] = 0;
+
+   for (U32 i = 0; i < numFibers; i++)
+   {
+      char tmp[32];
+      dSprintf(tmp, sizeof(tmp), "%u", fibers[i]);
+
+      if (i > 0)
+         dStrcat(buf, " ");
+
+      dStrcat(buf, tmp);
+   }
+   
+   KorkApi::ConsoleValue cv = KorkApi::ConsoleValue::makeString(buf);
+   return vmPtr->valueAsString(cv);
+}
+
+ConsoleFunction(saveFibers, bool, 3, 4, "fiberIdList, fileName, [delta]")
 {
    const char* list = argv[1];
    
@@ -295,7 +317,8 @@ ConsoleFunction(saveFibers, bool, 3, 3, "fiberIdList, fileName")
       fibers[i] = (KorkApi::FiberId)dAtoi(unit);
    }
 
-   bool ok = vmPtr->dumpFiberStateToBlob((U32)count, fibers, &blobSize, &blob);
+   bool delta = argc > 3 && dAtob(argv[3]);
+   bool ok = vmPtr->dumpFiberStateToBlob((U32)count, fibers, &blobSize, &blob, delta);
    free(fibers);
 
    if (!ok)
@@ -313,53 +336,190 @@ ConsoleFunction(saveFibers, bool, 3, 3, "fiberIdList, fileName")
    return didWrite;
 }
 
-ConsoleFunction(restoreFibers, const char*, 2, 2, "fileName")
+ConsoleFunction(restoreFibers, const char*, 2, 10, "fileName, [deltaFileName...]")
 {
-   FileStream fs;
+   U32 numBlobs = 0;
+   U32 blobSizes[9];
+   U8* blobs[9];
+   const char* result = "";
    
-   if (fs.open(argv[1], FileStream::Read))
+   for (S32 i = 1; i < argc; i++)
    {
-      U32 blobSize = fs.getStreamSize();
-      U8* blob = (U8*)malloc(blobSize);
-      fs.read(blobSize, blob);
-      
-      KorkApi::FiberId* outFibers = nullptr;
-      U32 outNumFibers = 0;
+      FileStream fs;
+      if (!fs.open(argv[i], FileStream::Read))
+      {
+         break;
+      }
       
-      const char* result = "";
+      blobSizes[numBlobs] = fs.getStreamSize();
+      blobs[numBlobs] = (U8*)malloc(blobSizes[numBlobs]);
+      fs.read(blobSizes[numBlobs], blobs[numBlobs]);
+      numBlobs++;
+   }
+   
+   KorkApi::FiberId* outFibers = nullptr;
+   U32 outNumFibers = 0;
 
-      if (vmPtr->restoreFiberStateFromBlob(&outNumFibers, &outFibers, blobSize, blob))
-      {
-         KorkApi::ConsoleValue cbuf = Con::getReturnBuffer(outNumFibers * 32);
-         char* buf = (char*)cbuf.evaluatePtr(vmPtr->getAllocBase());
-         buf[0] = 0;
+   if (numBlobs == (U32)(argc - 1) &&
+       vmPtr->restoreFiberStateFromBlobs(&outNumFibers, &outFibers, numBlobs, blobSizes, blobs))
+   {
+      result = fiberListToString(vmPtr, outNumFibers, outFibers);
+      free(outFibers);
+   }
+   
+   for (U32 i = 0; i < numBlobs; i++)
+   {
+      free(blobs[i]);
+   }
+   
+   return result;
+}
 
-         for (U32 i = 0; i < outNumFibers; i++)
-         {
-            char tmp[32];
-            dSprintf(tmp, sizeof(tmp), "%u", outFibers[i]);
+static bool writeFiberFile(void* userPtr, const void* data, U32 size)
+{
+   return fwrite(data, 1, size, (FILE*)userPtr) == size;
+}
 
-            if (i > 0)
-               dStrcat(buf, " ");
+static U32 readFiberFile(void* userPtr, void* data, U32 size)
+{
+   return (U32)fread(data, 1, size, (FILE*)userPtr);
+}
 
-            dStrcat(buf, tmp);
-         }
-         
-         KorkApi::ConsoleValue cv = KorkApi::ConsoleValue::makeString(buf);
-         result = vmPtr->valueAsString(cv);
+ConsoleFunction(saveFibersStream, bool, 3, 5, "fiberIdList, fileName, [compress], [delta]")
+{
+   const char* list = argv[1];
+   
+   const S32 count = StringUnit::getUnitCount(list, " \t\n");
+   if (count <= 0)
+      return false;
+   
+   FILE* fp = fopen(argv[2], "wb");
+   if (!fp)
+      return false;
+
+   KorkApi::FiberId* fibers = (KorkApi::FiberId*)malloc(sizeof(KorkApi::FiberId) * count);
+
+   for (S32 i = 0; i < count; ++i)
+   {
+      const char* unit = StringUnit::getUnit(list, i, " \t\n");
+      fibers[i] = (KorkApi::FiberId)dAtoi(unit);
+   }
 
-         free(outFibers);
-         free(blob);
-         return result;
+   bool compress = argc > 3 && dAtob(argv[3]);
+   bool delta = argc > 4 && dAtob(argv[4]);
+   bool ok = vmPtr->dumpFiberStateToStream((U32)count, fibers, writeFiberFile, fp, compress, delta);
+   
+   free(fibers);
+   fclose(fp);
+   return ok;
+}
+
+ConsoleFunction(restoreFibersStream, const char*, 2, 10, "fileName, [deltaFileName...]")
+{
+   U32 numFiles = 0;
+   void* files[9];
+   const char* result = "";
+   
+   for (S32 i = 1; i < argc; i++)
+   {
+      FILE* fp = fopen(argv[i], "rb");
+      if (!fp)
+      {
+         break;
       }
+      
+      files[numFiles++] = fp;
+   }
+   
+   KorkApi::FiberId* outFibers = nullptr;
+   U32 outNumFibers = 0;
 
-      free(blob);
+   if (numFiles == (U32)(argc - 1) &&
+       vmPtr->restoreFiberStateFromStreams(&outNumFibers, &outFibers, numFiles, readFiberFile, files))
+   {
+      result = fiberListToString(vmPtr, outNumFibers, outFibers);
+      free(outFibers);
    }
    
-   return "";
+   for (U32 i = 0; i < numFiles; i++)
+   {
+      fclose((FILE*)files[i]);
+   }
+   
+   return result;
 }
 
 
+ConsoleFunction(profilerNumSamples, S32, 1, 1, "")
+{
+   return vmPtr->profilerGetNumSamples();
+}
+
+struct ProfilerStackMatch
+{
+   const char* pattern;
+   S32 samples;
+};
+
+ConsoleFunction(profilerStackSamples, S32, 2, 2, "pattern")
+{
+   ProfilerStackMatch match = { argv[1], 0 };
+   vmPtr->profilerDump(KorkApi::ProfilerOutputCollapsed, [](void* userPtr, const char* line) {
+      ProfilerStackMatch* match = (ProfilerStackMatch*)userPtr;
+      const char* count = dStrrchr(line, ' ');
+      if (count && dStrstr(line, match->pattern))
+         match->samples += dAtoi(count + 1);
+   }, &match);
+   return match.samples;
+}
+
+static void appendVariable(KorkApi::Vm* vmPtr, void* userPtr, const char* name, KorkApi::ConsoleValue value)
+{
+   std::string* list = (std::string*)userPtr;
+   if (!list->empty())
+      *list += " ";
+   *list += name;
+   *list += "=";
+   *list += vmPtr->valueAsString(value);
+}
+
+ConsoleFunction(listGlobals, const char*, 2, 2, "pattern - Returns matching globals as name=value pairs")
+{
+   std::string list;
+   vmPtr->enumGlobals(argv[1], &list, appendVariable);
+   char* ret = Con::getBufferPtr(Con::getReturnBuffer((U32)list.size() + 1));
+   dStrcpy(ret, list.c_str());
+   return ret;
+}
+
+ConsoleFunction(wrapResult, const char*, 3, 3, "fn, value - Returns [fn(value)], building the result around a nested native call")
+{
+   KorkApi::ConsoleValue retV = Con::getResultBuffer(256);
+   char* ret = (char*)retV.evaluatePtr(vmPtr->getAllocBase());
+   ret[0] = '[';
+   
+   KorkApi::ConsoleValue innerV = Con::executef(argv[1], KorkApi::ConsoleValue::makeString(argv[2]));
+   const char* inner = vmPtr->valueAsString(innerV);
+   U32 innerLen = (U32)dStrlen(inner);
+   if (innerLen > 253)
+      innerLen = 253;
+   
+   // The stack may have moved during the call
+   ret = (char*)retV.evaluatePtr(vmPtr->getAllocBase());
+   memmove(ret + 1, inner, innerLen);
+   ret[innerLen + 1] = ']';
+   return Con::returnResult(retV, innerLen + 2);
+}
+
+ConsoleFunction(listLocals, const char*, 1, 1, "Returns the callers locals as name=value pairs")
+{
+   std::string list;
+   vmPtr->enumLocals(&list, appendVariable);
+   char* ret = Con::getBufferPtr(Con::getReturnBuffer((U32)list.size() + 1));
+   dStrcpy(ret, list.c_str());
+   return ret;
+}
+
 ConsoleFunction(createFiber, const char*, 1, 1, "")
 {
    KorkApi::FiberId fiberId = vmPtr->createFiber();
@@ -983,6 +983,29 @@ KorkApi::ConsoleValue getReturnBuffer( const char *stringToCopy )
    return retV;
 }
 
+KorkApi::ConsoleValue getResultBuffer(U32 bufferSize)
+{
+   return sVM->getStringResultBuffer(bufferSize);
+}
+
+const char* returnResult(KorkApi::ConsoleValue buffer, U32 len)
+{
+   sVM->makeStringResult(buffer, len);
+   char* ret = getBufferPtr(buffer);
+   ret[len] = '\0';
+   return ret;
+}
+
+char* getBufferPtr(KorkApi::ConsoleValue buffer)
+{
+   // Console buffers always live in the return or function zones, so unlike
+   // evaluatePtr this never points into the value itself
+   AssertFatal(buffer.getZone() >= KorkApi::ConsoleValue::ZoneReturn, "Con::getBufferPtr: not a console buffer");
+   KorkApi::ConsoleValue::AllocBase base = sVM->getAllocBase();
+   void* zoneBase = buffer.getZone() == KorkApi::ConsoleValue::ZoneReturn ? base.arg : base.func[buffer.zoneId - KorkApi::ConsoleValue::ZoneFiberStart];
+   return (char*)KorkApi::ConsoleValue::addOffset(zoneBase, buffer.cvalue);
+}
+
 KorkApi::ConsoleValue getArgBuffer(U32 bufferSize)
 {
    return sVM->getStringFuncBuffer(bufferSize);
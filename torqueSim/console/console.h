@@ -618,6 +618,15 @@ namespace Con
    ///
    KorkApi::ConsoleValue getReturnBuffer(U32 bufferSize);
    KorkApi::ConsoleValue getReturnBuffer(const char *stringToCopy);
+   
+   /// getResultBuffer is like getReturnBuffer, but small results are written where the
+   /// console keeps the result of the function being called. Return the buffer through
+   /// returnResult with its final length so the result isn't measured or copied again.
+   KorkApi::ConsoleValue getResultBuffer(U32 bufferSize);
+   const char* returnResult(KorkApi::ConsoleValue buffer, U32 len);
+   
+   /// Returns the address of a buffer from getReturnBuffer, getResultBuffer or getArgBuffer.
+   char* getBufferPtr(KorkApi::ConsoleValue buffer);
 
    KorkApi::ConsoleValue getArgBuffer(U32 bufferSize);
    KorkApi::ConsoleValue getFloatArg(F64 arg);
@@ -6,6 +6,7 @@
 #include "core/fileStream.h"
 
 #include <vector>
+#include <algorithm>
 
 // This is a temporary hack to get tools using the library to
 // link in this module which contains no other references.
@@ -43,11 +44,14 @@ ConsoleFunction(stricmp, S32, 3, 3, "(string one, string two)"
    return dStricmp(argv[1], argv[2]);
 }
 
-ConsoleFunction(strlen, S32, 2, 2, "(string str)"
+ConsoleFunctionValue(strlen, 2, 2, "(string str)"
                "Calculate the length of a string in characters.")
 {
    argc;
-   return dStrlen(argv[1]);
+   // Strings from the stack and variables usually know their length
+   if (argv[1].hasLen())
+      return KorkApi::ConsoleValue::makeUnsigned(argv[1].len);
+   return KorkApi::ConsoleValue::makeUnsigned(dStrlen(vmPtr->valueAsString(argv[1])));
 }
 
 ConsoleFunction(strstr, S32 , 3, 3, "(string one, string two) "
@@ -104,11 +108,10 @@ ConsoleFunction(rtrim, const char *,2,2,"(string value)")
          firstWhitespace = pos + 1;
       pos++;
    }
-   KorkApi::ConsoleValue retV = Con::getReturnBuffer(firstWhitespace + 1);
+   KorkApi::ConsoleValue retV = Con::getResultBuffer(firstWhitespace + 1);
    char *ret = (char*)retV.evaluatePtr(vmPtr->getAllocBase());
    dStrncpy(ret, argv[1], firstWhitespace);
-   ret[firstWhitespace] = 0;
-   return ret;
+   return Con::returnResult(retV, firstWhitespace);
 }
 
 ConsoleFunction(trim, const char *,2,2,"(string)")
@@ -126,11 +129,10 @@ ConsoleFunction(trim, const char *,2,2,"(string)")
          firstWhitespace = pos + 1;
       pos++;
    }
-   KorkApi::ConsoleValue retV = Con::getReturnBuffer(firstWhitespace + 1);
+   KorkApi::ConsoleValue retV = Con::getResultBuffer(firstWhitespace + 1);
    char *ret = (char*)retV.evaluatePtr(vmPtr->getAllocBase());
    dStrncpy(ret, ptr, firstWhitespace);
-   ret[firstWhitespace] = 0;
-   return ret;
+   return Con::returnResult(retV, firstWhitespace);
 }
 
 ConsoleFunction(stripChars, const char*, 3, 3, "(string value, string chars) "
@@ -163,20 +165,26 @@ ConsoleFunction(strlwr,const char *,2,2,"(string) "
                 "Convert string to lower case.")
 {
    argc;
-   KorkApi::ConsoleValue retV = Con::getReturnBuffer(dStrlen(argv[1]) + 1);
+   U32 len = dStrlen(argv[1]);
+   KorkApi::ConsoleValue retV = Con::getResultBuffer(len + 1);
    char *ret = (char*)retV.evaluatePtr(vmPtr->getAllocBase());
-   dStrcpy(ret, argv[1]);
-   return dStrlwr(ret);
+   memcpy(ret, argv[1], len);
+   ret[len] = 0;
+   dStrlwr(ret);
+   return Con::returnResult(retV, len);
 }
 
 ConsoleFunction(strupr,const char *,2,2,"(string) "
                 "Convert string to upper case.")
 {
    argc;
-   KorkApi::ConsoleValue retV = Con::getReturnBuffer(dStrlen(argv[1]) + 1);
+   U32 len = dStrlen(argv[1]);
+   KorkApi::ConsoleValue retV = Con::getResultBuffer(len + 1);
    char *ret = (char*)retV.evaluatePtr(vmPtr->getAllocBase());
-   dStrcpy(ret, argv[1]);
-   return dStrupr(ret);
+   memcpy(ret, argv[1], len);
+   ret[len] = 0;
+   dStrupr(ret);
+   return Con::returnResult(retV, len);
 }
 
 ConsoleFunction(strchr,const char *,3,3,"(string,char)")
@@ -206,7 +214,8 @@ ConsoleFunction(strreplace, const char *, 4, 4, "(string source, string from, st
       }
    }
 
-   KorkApi::ConsoleValue retV = Con::getReturnBuffer(dStrlen(argv[1]) + 1 + (toLen - fromLen) * count);
+   const U32 retLen = dStrlen(argv[1]) + (toLen - fromLen) * count;
+   KorkApi::ConsoleValue retV = Con::getResultBuffer(retLen + 1);
    char *ret = (char*)retV.evaluatePtr(vmPtr->getAllocBase());
 
    U32 scanp = 0;
@@ -217,7 +226,7 @@ ConsoleFunction(strreplace, const char *, 4, 4, "(string source, string from, st
       if(!scan)
       {
          dStrcpy(ret + dstp, argv[1] + scanp);
-         return ret;
+         return Con::returnResult(retV, retLen);
       }
       U32 len = scan - (argv[1] + scanp);
       dStrncpy(ret + dstp, argv[1] + scanp, len);
@@ -255,12 +264,11 @@ ConsoleFunction(getSubStr, const char *, 4, 4, "getSubStr(string str, int start,
    if (startPos + desiredLen > baseLen)
       actualLen = baseLen - startPos;
 
-   KorkApi::ConsoleValue retV = Con::getReturnBuffer(actualLen + 1);
+   KorkApi::ConsoleValue retV = Con::getResultBuffer(actualLen + 1);
    char *ret = (char*)retV.evaluatePtr(vmPtr->getAllocBase());
    dStrncpy(ret, argv[1] + startPos, actualLen);
-   ret[actualLen] = '\0';
 
-   return ret;
+   return Con::returnResult(retV, actualLen);
 }
 
 // Used?
@@ -565,11 +573,10 @@ ConsoleFunction(firstWord, const char *, 2, 2, "firstWord(text)")
       len = dStrlen(argv[1]);
    else
       len = word - argv[1];
-   KorkApi::ConsoleValue retV = Con::getReturnBuffer(len + 1);
+   KorkApi::ConsoleValue retV = Con::getResultBuffer(len + 1);
    char *ret = (char*)retV.evaluatePtr(vmPtr->getAllocBase());
    dStrncpy(ret, argv[1], len);
-   ret[len] = 0;
-   return ret;
+   return Con::returnResult(retV, len);
 }
 
 ConsoleFunction(restWords, const char *, 2, 2, "restWords(text)")
@@ -578,10 +585,11 @@ ConsoleFunction(restWords, const char *, 2, 2, "restWords(text)")
    const char *word = dStrchr(argv[1], ' ');
    if(word == nullptr)
       return "";
-   KorkApi::ConsoleValue retV = Con::getReturnBuffer(dStrlen(word + 1) + 1);
+   U32 len = dStrlen(word + 1);
+   KorkApi::ConsoleValue retV = Con::getResultBuffer(len + 1);
    char *ret = (char*)retV.evaluatePtr(vmPtr->getAllocBase());
-   dStrcpy(ret, word + 1);
-   return ret;
+   memcpy(ret, word + 1, len);
+   return Con::returnResult(retV, len);
 }
 
 static bool isInSet(char c, const char *set)
@@ -839,7 +847,7 @@ ConsoleFunction(export, void, 2, 4, "export(searchString [, fileName [,append]])
 ConsoleFunction(deleteVariables, void, 2, 2, "deleteVariables(wildCard)")
 {
    argc;
-   vmPtr->removeGlobalVariable(vmPtr->internString((const char*)argv[1]));
+   vmPtr->deleteGlobals(argv[1]);
 }
 
 //----------------------------------------------------------------
@@ -851,6 +859,157 @@ ConsoleFunction(trace, void, 2, 2, "trace(bool)")
    Con::printf("Console trace is %s", vmPtr->isTracing() ? "on." : "off.");
 }
 
+ConsoleFunction(profilerStart, void, 1, 2, "profilerStart([sampleInterval]) - Sample script stacks every sampleInterval instructions (default 1000).")
+{
+   U32 interval = argc > 1 ? dAtoi(argv[1]) : 1000;
+   vmPtr->profilerStart(interval);
+}
+
+ConsoleFunction(profilerStop, void, 1, 1, "profilerStop()")
+{
+   argc; argv;
+   vmPtr->profilerStop();
+}
+
+ConsoleFunction(profilerReset, void, 1, 1, "profilerReset() - Discards all collected samples.")
+{
+   argc; argv;
+   vmPtr->profilerReset();
+}
+
+ConsoleFunction(setCallStatsEnabled, void, 2, 2, "setCallStatsEnabled(bool) - Counts and times every function call.")
+{
+   argc;
+   vmPtr->setCallStatsEnabled(dAtob(argv[1]));
+}
+
+ConsoleFunction(resetCallStats, void, 1, 1, "resetCallStats()")
+{
+   argc; argv;
+   vmPtr->resetCallStats();
+}
+
+ConsoleFunction(getCallStats, const char*, 2, 3, "getCallStats(function [, namespace]) - Returns \"calls inclusiveMs exclusiveMs\".")
+{
+   KorkApi::NamespaceId nsId = nullptr;
+   if (argc > 2)
+   {
+      nsId = vmPtr->findNamespace(vmPtr->internString(argv[2]));
+      if (!nsId)
+         return "0 0 0";
+   }
+
+   KorkApi::FunctionCallStats stats;
+   if (!vmPtr->getCallStats(nsId, vmPtr->internString(argv[1]), &stats))
+      return "0 0 0";
+
+   char* ret = Con::getBufferPtr(Con::getReturnBuffer(64));
+   dSprintf(ret, 64, "%llu %.3f %.3f", (unsigned long long)stats.calls, stats.inclusiveTime / 1000000.0, stats.exclusiveTime / 1000000.0);
+   return ret;
+}
+
+ConsoleFunction(dumpCallStats, void, 1, 2, "dumpCallStats([maxEntries]) - Prints functions with the most exclusive time.")
+{
+   std::vector<KorkApi::FunctionCallStats> list;
+   vmPtr->enumerateCallStats(&list, [](void* userPtr, const KorkApi::FunctionCallStats* stats) {
+      ((std::vector<KorkApi::FunctionCallStats>*)userPtr)->push_back(*stats);
+   });
+
+   std::sort(list.begin(), list.end(), [](const KorkApi::FunctionCallStats& a, const KorkApi::FunctionCallStats& b) {
+      return a.exclusiveTime > b.exclusiveTime;
+   });
+
+   U32 maxEntries = argc > 1 ? dAtoi(argv[1]) : 50;
+   Con::printf("%12s %12s %12s  function", "calls", "incl(ms)", "excl(ms)");
+   for (U32 i = 0; i < list.size() && i < maxEntries; i++)
+   {
+      const KorkApi::FunctionCallStats& stats = list[i];
+      Con::printf("%12llu %12.3f %12.3f  %s%s%s%s",
+                  (unsigned long long)stats.calls,
+                  stats.inclusiveTime / 1000000.0,
+                  stats.exclusiveTime / 1000000.0,
+                  stats.nsName ? stats.nsName : "",
+                  stats.nsName ? "::" : "",
+                  stats.name,
+                  stats.isScript ? "" : " [native]");
+   }
+}
+
+ConsoleFunction(setCompileAstLimit, void, 2, 2, "setCompileAstLimit(bytes) - Caps AST memory used to compile a script (0 = unlimited).")
+{
+   argc;
+   vmPtr->setCompileAstLimit((U32)dAtoi(argv[1]));
+}
+
+ConsoleFunction(getCompileStats, const char*, 1, 1, "getCompileStats() - Returns \"astPeakBytes astReservedBytes limitExceeded\" for the last compiled script.")
+{
+   argc; argv;
+   KorkApi::CompileStats stats;
+   vmPtr->getCompileStats(&stats);
+
+   char* ret = Con::getBufferPtr(Con::getReturnBuffer(64));
+   dSprintf(ret, 64, "%llu %llu %d", (unsigned long long)stats.astPeakBytes, (unsigned long long)stats.astReservedBytes, stats.astLimitExceeded ? 1 : 0);
+   return ret;
+}
+
+struct EvalStreamSource
+{
+   const char* ptr;
+   U32 remaining;
+   U32 chunkSize;
+};
+
+static U32 evalStreamRead(void* userPtr, void* data, U32 size)
+{
+   EvalStreamSource* src = (EvalStreamSource*)userPtr;
+   U32 count = getMin(getMin(size, src->chunkSize), src->remaining);
+   memcpy(data, src->ptr, count);
+   src->ptr += count;
+   src->remaining -= count;
+   return count;
+}
+
+ConsoleFunction(evalStream, const char*, 2, 3, "evalStream(consoleString [, chunkSize]) - Evaluates a string with the streaming compiler, reading chunkSize bytes at a time.")
+{
+   EvalStreamSource src;
+   src.ptr = argv[1];
+   src.remaining = dStrlen(argv[1]);
+   src.chunkSize = argc > 2 ? getMax((U32)dAtoi(argv[2]), 1U) : 4096;
+
+   KorkApi::ConsoleValue retValue = vmPtr->evalStream(evalStreamRead, &src, nullptr, "");
+   vmPtr->clearCurrentFiberError();
+   return vmPtr->valueAsString(retValue);
+}
+
+ConsoleFunction(profilerDump, void, 1, 3, "profilerDump([format [, fileName]]) - Dumps samples as \"flat\" (default) or \"collapsed\" stacks.")
+{
+   KorkApi::ProfilerOutputFormat format = KorkApi::ProfilerOutputFlat;
+   if (argc > 1 && dStricmp(argv[1], "collapsed") == 0)
+      format = KorkApi::ProfilerOutputCollapsed;
+
+   if (argc > 2)
+   {
+      FileStream fs;
+      if (!Con::expandScriptFilename(scriptFilenameBuffer, sizeof(scriptFilenameBuffer), (const char*)argv[2]) ||
+          !fs.open(scriptFilenameBuffer, FileStream::Write))
+      {
+         Con::errorf("profilerDump: couldn't write to %s", (const char*)argv[2]);
+         return;
+      }
+
+      vmPtr->profilerDump(format, [](void* userPtr, const char* line) {
+         FileStream* stream = (FileStream*)userPtr;
+         stream->writeStringBuffer(line);
+         stream->writeStringBuffer("\n");
+      }, &fs);
+      return;
+   }
+
+   vmPtr->profilerDump(format, [](void* userPtr, const char* line) {
+      Con::printf("%s", line);
+   }, nullptr);
+}
+
 //----------------------------------------------------------------
 
 #if defined(TORQUE_DEBUG) || defined(INTERNAL_RELEASE)
@@ -912,11 +1071,10 @@ ConsoleFunction(filePath, const char *, 2, 2, "filePath(fileName)")
    if(!path)
       return "";
    U32 len = path - argv[1];
-   KorkApi::ConsoleValue retV = Con::getReturnBuffer(len + 1);
+   KorkApi::ConsoleValue retV = Con::getResultBuffer(len + 1);
    char *ret = (char*)retV.evaluatePtr(vmPtr->getAllocBase());
    dStrncpy(ret, argv[1], len);
-   ret[len] = 0;
-   return ret;
+   return Con::returnResult(retV, len);
 }
 
 ConsoleFunction(pathCopy, bool, 3, 4, "pathCopy(fromFile, toFile [, nooverwrite = true])")
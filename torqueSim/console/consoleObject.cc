@@ -46,13 +46,28 @@ U32                                AbstractClassRep::classCRC[NetClassGroupsCoun
 bool                               AbstractClassRep::initialized = false;
 
 //--------------------------------------
-const AbstractClassRep::Field *AbstractClassRep::findField(StringTableEntry name) const
+void AbstractClassRep::buildFieldLookup() const
 {
+   mFieldLookup.clear();
+   mFieldLookup.reserve(mFieldList.size());
+
+   // First field with a given name wins
    for(U32 i = 0; i < (U32)mFieldList.size(); i++)
-      if(mFieldList[i].pFieldname == name)
-         return &mFieldList[i];
+      mFieldLookup.emplace(mFieldList[i].pFieldname, i);
 
-   return nullptr;
+   mFieldLookupSize = (U32)mFieldList.size();
+}
+
+const AbstractClassRep::Field *AbstractClassRep::findField(StringTableEntry name) const
+{
+   if (mFieldList.empty())
+      return nullptr;
+
+   if (mFieldLookupSize != (U32)mFieldList.size())
+      buildFieldLookup();
+
+   auto itr = mFieldLookup.find(name);
+   return itr != mFieldLookup.end() ? &mFieldList[itr->second] : nullptr;
 }
 
 //-----------------------------------------------------------------------------
@@ -399,11 +414,11 @@ void AbstractClassRep::registerClassWithVm(KorkApi::Vm* vm)
          return object ? object->at(index)->getVMObject() : (KorkApi::VMObject*)nullptr;
       };
       mClassInfo.iSignals = {};
-      mClassInfo.iSignals.TriggerSignal = [](void* userPtr, KorkApi::VMObject* vmObject, StringTableEntry signalName, int argc, KorkApi::ConsoleValue* argv) {
+      mClassInfo.iSignals.TriggerSignal = [](void* userPtr, KorkApi::VMObject* vmObject, S32 signalSlot, StringTableEntry signalName, int argc, KorkApi::ConsoleValue* argv) {
          ConsoleObject* consoleObject = static_cast<ConsoleObject*>(vmObject->userPtr);
          SimObject* object = dynamic_cast<SimObject*>(consoleObject);
          if (object)
-            object->triggerSignal(userPtr, signalName, argc, argv);
+            object->triggerSignal(userPtr, signalSlot, signalName, argc, argv);
       };
    }
    
@@ -28,6 +28,7 @@
 #include "platform/platform.h"
 #endif
 #include <vector>
+#include <unordered_map>
 #ifndef _STRINGTABLE_H_
 #include "core/stringTable.h"
 #endif
@@ -219,6 +220,15 @@ public:
    KorkApi::ClassInfo mClassInfo;
    FieldList mFieldList;
 
+protected:
+   /// Field name -> index in mFieldList; rebuilt by findField when the list size changes
+   mutable std::unordered_map<StringTableEntry, U32> mFieldLookup;
+   mutable U32 mFieldLookupSize;
+
+   void buildFieldLookup() const;
+
+public:
+
    bool mDynamicGroupExpand;
 
    static U32  NetClassCount [NetClassGroupsCount][NetClassTypesCount];
@@ -232,6 +242,7 @@ public:
    AbstractClassRep() 
    {
       parentClass  = nullptr;
+      mFieldLookupSize = 0;
    }
    virtual ~AbstractClassRep() { }
 
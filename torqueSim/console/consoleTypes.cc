@@ -17,8 +17,8 @@ ConsoleType( stringList, TypeStringTableEntryVector, sizeof(std::vector<StringTa
 ConsoleType( caseString, TypeCaseString, sizeof(const char*), UINT_MAX, "" )
 
 ConsoleType( char, TypeS8, sizeof(U8), sizeof(U8), "" )
-ConsoleType( int, TypeS32, sizeof(S32), sizeof(S32), "" )
-ConsoleType( float, TypeF32, sizeof(F32), sizeof(F32), "" )
+ConsoleNumericType( int, TypeS32, sizeof(S32), sizeof(S32), KorkApi::NumericStorageS32, "" )
+ConsoleNumericType( float, TypeF32, sizeof(F32), sizeof(F32), KorkApi::NumericStorageF32, "" )
 ConsoleType( bool, TypeBool, sizeof(bool), sizeof(bool), "" )
 ConsoleType( enumval, TypeEnum, sizeof(S32), sizeof(S32), "" )
 
@@ -420,8 +420,8 @@ ConsoleGetType( TypeS32 )
    
    if (requestedType == KorkApi::ConsoleValue::TypeInternalString)
    {
-      outputStorage->FinalizeStorage(outputStorage, 6);
-      dSprintf((char*)ConsoleGetOutputStoragePtr(), 6, "%i", value);
+      outputStorage->FinalizeStorage(outputStorage, 16);
+      dSprintf((char*)ConsoleGetOutputStoragePtr(), 16, "%i", value);
       
       if (outputStorage->data.storageRegister)
       {
@@ -461,7 +461,7 @@ ConsoleTypeOpDefaultNumeric( TypeS32 )
 
 ConsoleGetType( TypeF32 )
 {
-   S32 value = 0;
+   F32 value = 0;
    
    if (inputStorage->isField)
    {
@@ -481,8 +481,8 @@ ConsoleGetType( TypeF32 )
    
    if (requestedType == KorkApi::ConsoleValue::TypeInternalString)
    {
-      outputStorage->FinalizeStorage(outputStorage, 6);
-      dSprintf((char*)ConsoleGetOutputStoragePtr(), 6, "%.9g", value);
+      outputStorage->FinalizeStorage(outputStorage, 32);
+      dSprintf((char*)ConsoleGetOutputStoragePtr(), 32, "%.9g", value);
       
       if (outputStorage->data.storageRegister)
       {
@@ -501,8 +501,6 @@ ConsoleGetType( TypeF32 )
          *dst = value;
       }
       
-      if (requestedType == KorkApi::ConsoleValue::TypeInternalUnsigned)
-      
       if (outputStorage->data.storageRegister)
       {
          *outputStorage->data.storageRegister = (requestedType == KorkApi::ConsoleValue::TypeInternalUnsigned) ? KorkApi::ConsoleValue::makeUnsigned(value) : KorkApi::ConsoleValue::makeNumber(value);
@@ -33,60 +33,71 @@ StringTableEntry _StringTable::EmptyString;
 //
 //---------------------------------------------------------------
 
-namespace {
-   bool sgInitTable = true;
-   U8   sgHashTable[256];
-   
-   void initTolowerTable()
-   {
-      for (U32 i = 0; i < 256; i++) {
-         U8 c = dTolower(i);
-         sgHashTable[i] = c * c;
-      }
-      
-      sgInitTable = false;
-   }
-   
-} // namespace {}
+// 32-bit FNV-1a over lowercased characters
 
 U32 _StringTable::hashString(const char* str)
 {
-   if (sgInitTable)
-      initTolowerTable();
-   
-   U32 ret = 0;
+   U32 len = 0;
+   return hashStringLen(str, len);
+}
+
+U32 _StringTable::hashStringn(const char* str, S32 len)
+{
+   U32 ret = 2166136261U;
    char c;
-   while((c = *str++) != 0) {
-      ret <<= 1;
-      ret ^= sgHashTable[c];
+   while(len-- > 0 && (c = *str++) != 0) {
+      ret = (ret ^ (U8)dTolower(c)) * 16777619U;
    }
    return ret;
 }
 
-U32 _StringTable::hashStringn(const char* str, S32 len)
+U32 _StringTable::hashStringLen(const char* str, U32& outLen)
 {
-   if (sgInitTable)
-      initTolowerTable();
-   
-   U32 ret = 0;
+   const char* start = str;
+   U32 ret = 2166136261U;
    char c;
-   while((c = *str++) != 0 && len--) {
-      ret <<= 1;
-      ret ^= sgHashTable[c];
+   while((c = *str++) != 0) {
+      ret = (ret ^ (U8)dTolower(c)) * 16777619U;
    }
+   outLen = (U32)(str - start - 1);
    return ret;
 }
 
+//--------------------------------------
+_StringTable::Table* _StringTable::newTable(U32 size, Table* retired)
+{
+   Table* table = new Table;
+   table->size = size;
+   table->retired = retired;
+   table->buckets = new std::atomic<Node*>[size];
+   for(U32 i = 0; i < size; i++) {
+      table->buckets[i].store(nullptr, std::memory_order_relaxed);
+   }
+   return table;
+}
+
+void _StringTable::deleteTables(Table* table)
+{
+   while(table) {
+      Table* retired = table->retired;
+      delete[] table->buckets;
+      delete table;
+      table = retired;
+   }
+}
+
 //--------------------------------------
 _StringTable::_StringTable()
 {
-   buckets.resize(csm_stInitSize);
-   for(U32 i = 0; i < csm_stInitSize; i++) {
-      buckets[i] = 0;
+   for(U32 i = 0; i < NumShards; i++) {
+      Shard& shard = mShards[i];
+      shard.table.store(newTable(csm_stInitSize, nullptr), std::memory_order_relaxed);
+      shard.firstInserted = nullptr;
+      shard.lastInserted = nullptr;
+      shard.itemCount = 0;
+      shard.resizeSeq.store(0, std::memory_order_relaxed);
    }
    
-   itemCount = 0;
-   
    // Insert empty string.
    EmptyString = insert("");
 }
@@ -94,6 +105,9 @@ _StringTable::_StringTable()
 //--------------------------------------
 _StringTable::~_StringTable()
 {
+   for(U32 i = 0; i < NumShards; i++) {
+      deleteTables(mShards[i].table.load(std::memory_order_relaxed));
+   }
 }
 
 
@@ -116,41 +130,104 @@ void _StringTable::destroy()
 }
 
 //--------------------------------------
-StringTableEntry _StringTable::insert(const char* val, const bool  caseSens)
+StringTableEntry _StringTable::find(Shard& shard, const char* val, U32 len, U32 hash, bool caseSens)
 {
-   if ( val == nullptr )
-      return StringTable->EmptyString;
-   
-   MutexHandle mutex;
-   mutex.lock(&mMutex, true);
+   // Buckets are in insertion order, so case insensitive matches
+   // find the first variant inserted.
+   Table* table = shard.table.load(std::memory_order_acquire);
+   Node* walk = table->buckets[hash % table->size].load(std::memory_order_acquire);
+   for(; walk; walk = walk->next.load(std::memory_order_acquire)) {
+      if(walk->hash != hash || walk->len != len)
+         continue;
+      if(caseSens ? !memcmp(walk->val(), val, len) : !strncasecmp(walk->val(), val, len))
+         return walk->val();
+   }
+   return nullptr;
+}
+
+StringTableEntry _StringTable::findUnlocked(Shard& shard, const char* val, U32 len, U32 hash, bool caseSens)
+{
+   U32 seq = shard.resizeSeq.load(std::memory_order_acquire);
+   StringTableEntry ret = find(shard, val, len, hash, caseSens);
    
-   Node **walk, *temp;
-   U32 key = hashString(val);
-   walk = &buckets[key % (U32)buckets.size()];
-   while((temp = *walk) != nullptr)   {
-      if(caseSens && !strcmp(temp->val, val))
-         return temp->val;
-      else if(!caseSens && !strcasecmp(temp->val, val))
-         return temp->val;
-      walk = &(temp->next);
+   // An exact match is the only entry for that string. A case insensitive
+   // hit made while nodes were being relinked may not be the first variant.
+   if(ret && !caseSens) {
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if((seq & 1) || shard.resizeSeq.load(std::memory_order_relaxed) != seq)
+         return nullptr;
    }
-   char *ret = 0;
-   if(!*walk) {
-      *walk = (Node *) mempool.alloc(sizeof(Node));
-      (*walk)->next = 0;
-      U32 sz = strlen(val)+1;
-      sz = (sz + 7) & ~((U32)7);
-      (*walk)->val = (char *) mempool.alloc(sz); // align to 8 bytes
-      strcpy((*walk)->val, val);
-      ret = (*walk)->val;
-      itemCount ++;
+   return ret;
+}
+
+StringTableEntry _StringTable::add(Shard& shard, const char* val, U32 len, U32 hash)
+{
+   U32 sz = (U32)sizeof(Node) + len + 1;
+   sz = (sz + 7) & ~((U32)7);
+   Node* node = new (shard.mempool.alloc(sz)) Node; // align to 8 bytes
+   node->next.store(nullptr, std::memory_order_relaxed);
+   node->nextInserted = nullptr;
+   node->hash = hash;
+   node->len = len;
+   memcpy(node->val(), val, len);
+   node->val()[len] = '\0';
+   
+   // Append so earlier case variants stay first
+   Table* table = shard.table.load(std::memory_order_relaxed);
+   std::atomic<Node*>* walk = &table->buckets[hash % table->size];
+   Node* temp;
+   while((temp = walk->load(std::memory_order_relaxed)) != nullptr) {
+      walk = &temp->next;
    }
+   walk->store(node, std::memory_order_release);
+   
+   if(shard.lastInserted)
+      shard.lastInserted->nextInserted = node;
+   else
+      shard.firstInserted = node;
+   shard.lastInserted = node;
+   shard.itemCount++;
    
-   U32 numBuckets = (U32)buckets.size();
-   if(itemCount > 2 * numBuckets) {
-      resize(4 * numBuckets - 1);
+   if(shard.itemCount > 2 * table->size) {
+      resize(shard, 4 * table->size - 1);
    }
-   return ret;
+   return node->val();
+}
+
+//--------------------------------------
+StringTableEntry _StringTable::insertHashed(const char* val, U32 len, U32 hash, bool caseSens)
+{
+   Shard& shard = getShard(hash);
+   StringTableEntry ret = findUnlocked(shard, val, len, hash, caseSens);
+   if(ret)
+      return ret;
+   
+   std::lock_guard<std::mutex> lock(shard.mutex);
+   ret = find(shard, val, len, hash, caseSens);
+   return ret ? ret : add(shard, val, len, hash);
+}
+
+StringTableEntry _StringTable::lookupHashed(const char* val, U32 len, U32 hash, bool caseSens)
+{
+   Shard& shard = getShard(hash);
+   StringTableEntry ret = findUnlocked(shard, val, len, hash, caseSens);
+   if(ret)
+      return ret;
+   
+   // May have missed due to a concurrent resize
+   std::lock_guard<std::mutex> lock(shard.mutex);
+   return find(shard, val, len, hash, caseSens);
+}
+
+//--------------------------------------
+StringTableEntry _StringTable::insert(const char* val, const bool  caseSens)
+{
+   if ( val == nullptr )
+      return StringTable->EmptyString;
+   
+   U32 len = 0;
+   U32 hash = hashStringLen(val, len);
+   return insertHashed(val, len, hash, caseSens);
 }
 
 //--------------------------------------
@@ -159,14 +236,8 @@ StringTableEntry _StringTable::insertn(const char* src, S32 len, const bool  cas
    if ( src == nullptr )
       return StringTable->EmptyString;
    
-   MutexHandle mutex;
-   mutex.lock(&mMutex, true);
-   
-   char val[1024];
-   AssertFatal(len < sizeof(val), "Invalid string to insertn");
-   strncpy(val, src, len);
-   val[len] = 0;
-   return insert(val, caseSens);
+   U32 realLen = (U32)strnlen(src, len > 0 ? len : 0);
+   return insertHashed(src, realLen, hashStringn(src, realLen), caseSens);
 }
 
 //--------------------------------------
@@ -175,20 +246,9 @@ StringTableEntry _StringTable::lookup(const char* val, const bool  caseSens)
    if ( val == nullptr )
       return StringTable->EmptyString;
    
-   MutexHandle mutex;
-   mutex.lock(&mMutex, true);
-   
-   Node **walk, *temp;
-   U32 key = hashString(val);
-   walk = &buckets[key % (U32)buckets.size()];
-   while((temp = *walk) != nullptr)   {
-      if(caseSens && !strcmp(temp->val, val))
-         return temp->val;
-      else if(!caseSens && !strcasecmp(temp->val, val))
-         return temp->val;
-      walk = &(temp->next);
-   }
-   return nullptr;
+   U32 len = 0;
+   U32 hash = hashStringLen(val, len);
+   return lookupHashed(val, len, hash, caseSens);
 }
 
 //--------------------------------------
@@ -197,55 +257,46 @@ StringTableEntry _StringTable::lookupn(const char* val, S32 len, const bool  cas
    if ( val == nullptr )
       return StringTable->EmptyString;
    
-   MutexHandle mutex;
-   mutex.lock(&mMutex, true);
-   
-   Node **walk, *temp;
-   U32 key = hashStringn(val, len);
-   walk = &buckets[key % (U32)buckets.size()];
-   while((temp = *walk) != nullptr) {
-      if(caseSens && !strncasecmp(temp->val, val, len) && temp->val[len] == 0)
-         return temp->val;
-      else if(!caseSens && !strncasecmp(temp->val, val, len) && temp->val[len] == 0)
-         return temp->val;
-      walk = &(temp->next);
+   U32 realLen = (U32)strnlen(val, len > 0 ? len : 0);
+   return lookupHashed(val, realLen, hashStringn(val, realLen), caseSens);
+}
+
+//--------------------------------------
+U32 _StringTable::getCount()
+{
+   U32 count = 0;
+   for(U32 i = 0; i < NumShards; i++) {
+      std::lock_guard<std::mutex> lock(mShards[i].mutex);
+      count += mShards[i].itemCount;
    }
-   return nullptr;
+   return count;
 }
 
 //--------------------------------------
-void _StringTable::resize(const U32 newSize)
-{
-   Node *head = nullptr, *walk, *temp;
-   U32 i;
-   // reverse individual bucket lists
-   // we do this because new strings are added at the end of bucket
-   // lists so that case sens strings are always after their
-   // corresponding case insens strings
+void _StringTable::resize(Shard& shard, const U32 newSize)
+{
+   // Nodes are relinked in insertion order, so every next pointer (old or
+   // new) leads to a later node. Readers walking the old table can't loop;
+   // at worst they miss and retry with the shard locked. resizeSeq is odd
+   // while relinking so case insensitive hits can tell to recheck.
+   U32 seq = shard.resizeSeq.load(std::memory_order_relaxed);
+   shard.resizeSeq.store(seq + 1, std::memory_order_relaxed);
+   std::atomic_thread_fence(std::memory_order_release);
    
-   for(i = 0; i < buckets.size(); i++) {
-      walk = buckets[i];
-      while(walk)
-      {
-         temp = walk->next;
-         walk->next = head;
-         head = walk;
-         walk = temp;
-      }
-   }
-   buckets.resize(newSize);
-   for(i = 0; i < newSize; i++) {
-      buckets[i] = 0;
-   }
-   walk = head;
-   while(walk) {
-      U32 key;
-      Node *temp = walk;
-      
-      walk = walk->next;
-      key = hashString(temp->val);
-      temp->next = buckets[key % newSize];
-      buckets[key % newSize] = temp;
+   Table* oldTable = shard.table.load(std::memory_order_relaxed);
+   Table* table = newTable(newSize, oldTable);
+   std::vector<Node*> tails(newSize, nullptr);
+   
+   for(Node* walk = shard.firstInserted; walk; walk = walk->nextInserted) {
+      U32 idx = walk->hash % newSize;
+      walk->next.store(nullptr, std::memory_order_release);
+      if(tails[idx])
+         tails[idx]->next.store(walk, std::memory_order_release);
+      else
+         table->buckets[idx].store(walk, std::memory_order_relaxed);
+      tails[idx] = walk;
    }
+   
+   shard.table.store(table, std::memory_order_release);
+   shard.resizeSeq.store(seq + 2, std::memory_order_release);
 }
-
@@ -26,13 +26,12 @@
 #ifndef _PLATFORM_H_
 #include "platform/platform.h"
 #endif
-#ifndef _PLATFORM_THREADS_MUTEX_H_
-#include "platform/threads/mutex.h"
-#endif
 #ifndef _DATACHUNKER_H_
 #include "core/dataChunker.h"
 #endif
 
+#include <atomic>
+#include <mutex>
 #include <vector>
 
 //--------------------------------------
@@ -77,24 +76,70 @@
 /// @note Be aware that the StringTable NEVER DEALLOCATES memory, so be careful when you
 ///       add strings to it. If you carelessly add many strings, you will end up wasting
 ///       space.
+///
+/// @note The table may be used from any thread. Entries are split across shards
+///       by hash, each with its own lock. Lookups of strings already in the table
+///       do not lock; only inserts (and lookups which miss) lock their shard.
+///       Case insensitive hits made while the shard was resizing are rechecked
+///       with it locked, so they always return the first variant inserted.
 class _StringTable
 {
 private:
    /// @name Implementation details
    /// @{
    
-   /// This is internal to the _StringTable class.
+   enum
+   {
+      NumShards = 16
+   };
+   
+   /// This is internal to the _StringTable class. The string follows the node.
    struct Node
    {
-      char *val;
-      Node *next;
+      std::atomic<Node*> next; ///< Next node in the bucket, in insertion order
+      Node* nextInserted;      ///< Next node inserted into the shard
+      U32 hash;                ///< Case insensitive hash
+      U32 len;
+      
+      inline char* val() { return (char*)(this+1); }
+   };
+   
+   struct Table
+   {
+      U32 size;
+      Table* retired; ///< Previous table; kept since lock free readers may still use it
+      std::atomic<Node*>* buckets;
    };
    
-   std::vector<Node*> buckets;
-   U32         itemCount;
-   DataChunker<> mempool;
+   struct Shard
+   {
+      std::mutex mutex;
+      std::atomic<Table*> table;
+      Node* firstInserted;
+      Node* lastInserted;
+      U32 itemCount;
+      std::atomic<U32> resizeSeq; ///< Odd while resize() is relinking nodes
+      DataChunker<> mempool;
+   };
+   
+   Shard mShards[NumShards];
+   
+   static Table* newTable(U32 size, Table* retired);
+   static void deleteTables(Table* table);
    
-   Mutex mMutex;
+   inline Shard& getShard(U32 hash) { return mShards[(hash >> 24) % NumShards]; }
+   
+   /// Finds string in shard. Must be called with the shard locked unless
+   /// called through findUnlocked().
+   static StringTableEntry find(Shard& shard, const char* val, U32 len, U32 hash, bool caseSens);
+   /// Lock free find. Returns nullptr if the result must be rechecked with
+   /// the shard locked.
+   static StringTableEntry findUnlocked(Shard& shard, const char* val, U32 len, U32 hash, bool caseSens);
+   StringTableEntry add(Shard& shard, const char* val, U32 len, U32 hash);
+   void resize(Shard& shard, const U32 newSize);
+   
+   StringTableEntry insertHashed(const char* val, U32 len, U32 hash, bool caseSens);
+   StringTableEntry lookupHashed(const char* val, U32 len, U32 hash, bool caseSens);
    
 protected:
    static const U32 csm_stInitSize;
@@ -146,19 +191,18 @@ public:
    StringTableEntry lookupn(const char *string, S32 len, bool caseSens = false);
    
    
-   /// Resize the StringTable to be able to hold newSize items. This
-   /// is called automatically by the StringTable when the table is
-   /// full past a certain threshhold.
-   ///
-   /// @param newSize   Number of new items to allocate space for.
-   void             resize(const U32 newSize);
+   /// Returns the number of strings in the table.
+   U32 getCount();
    
-   /// Hash a string into a U32.
+   /// Hash a string into a U32 (case insensitive).
    static U32 hashString(const char* in_pString);
    
-   /// Hash a string of given length into a U32.
+   /// Hash a string of given length into a U32 (case insensitive).
    static U32 hashStringn(const char* in_pString, S32 len);
    
+   /// Hash a string, also returning its length.
+   static U32 hashStringLen(const char* in_pString, U32& outLen);
+   
    /// Empty string.
    static StringTableEntry EmptyString;
 };
@@ -71,9 +71,10 @@ void ConsoleBaseType::registerWithVM(KorkApi::Vm* vm)
 void ConsoleBaseType::registerTypeWithVm(KorkApi::Vm* vm)
 {
    //
-   KorkApi::TypeInfo info;
+   KorkApi::TypeInfo info{};
    info.fieldSize = mTypeSize;
    info.valueSize = mValueSize;
+   info.numericStorage = mNumericStorage;
    info.name = vm->internString(mTypeName);
    info.inspectorFieldType = vm->internString(mInspectorFieldType);
    info.userPtr = this;
@@ -117,7 +118,7 @@ ConsoleBaseType  *ConsoleBaseType::getType(const S32 typeID)
 }
 //-------------------------------------------------------------------------
 
-ConsoleBaseType::ConsoleBaseType(const U32 size, const U32 vsize, S32 *idPtr, const char *aTypeName)
+ConsoleBaseType::ConsoleBaseType(const U32 size, const U32 vsize, S32 *idPtr, const char *aTypeName, U8 numericStorage)
 {
    // General initialization.
    mInspectorFieldType = nullptr;
@@ -125,6 +126,7 @@ ConsoleBaseType::ConsoleBaseType(const U32 size, const U32 vsize, S32 *idPtr, co
    // Store general info.
    mTypeSize = size;
    mValueSize = vsize;
+   mNumericStorage = numericStorage;
    mTypeName = aTypeName;
 
    // Get our type ID and store it.
@@ -47,6 +47,7 @@ protected:
    S32      mTypeID;
    dsize_t  mTypeSize;
    dsize_t  mValueSize;
+   U8       mNumericStorage; ///< KorkApi::NumericStorage of field values
    
 public:
    const char *mTypeName;
@@ -81,11 +82,12 @@ public:
 
    /// The constructor is responsible for linking an element into the
    /// master list, registering the type ID, etc.
-   ConsoleBaseType(const U32 size, const U32 vsize, S32 *idPtr, const char *aTypeName);
+   ConsoleBaseType(const U32 size, const U32 vsize, S32 *idPtr, const char *aTypeName, U8 numericStorage = KorkApi::NumericStorageNone);
 
    const S32 getTypeID() const { return mTypeID; }
    const dsize_t getFieldSize() const { return mTypeSize; }
    const dsize_t getValueSize() const { return mValueSize; }
+   const U8 getNumericStorage() const { return mNumericStorage; }
    const char *getTypeName() const { return mTypeName; }
 
    void setInspectorFieldType(const char *type) { mInspectorFieldType = type; }
@@ -106,10 +108,14 @@ public:
 #define DefineConsoleType( type ) extern S32 type;
 
 #define ConsoleType( typeName, type, size, vsize, typePrefix ) \
+   ConsoleNumericType( typeName, type, size, vsize, KorkApi::NumericStorageNone, typePrefix )
+
+/// Type whose field values are plain numbers (see KorkApi::NumericStorage)
+#define ConsoleNumericType( typeName, type, size, vsize, numericStorage, typePrefix ) \
    class ConsoleType##type : public ConsoleBaseType \
    { \
    public: \
-      ConsoleType##type (const U32 aSize, const U32 vSize, S32 *idPtr, const char *aTypeName) : ConsoleBaseType(aSize, vSize, idPtr, aTypeName) { } \
+      ConsoleType##type (const U32 aSize, const U32 vSize, S32 *idPtr, const char *aTypeName, U8 aNumericStorage) : ConsoleBaseType(aSize, vSize, idPtr, aTypeName, aNumericStorage) { } \
       virtual bool getData(KorkApi::Vm* vmPtr, KorkApi::TypeStorageInterface *inputStorage, KorkApi::TypeStorageInterface *outputStorage, void* fieldUserPtr, BitSet32 flag, U32 requestedType); \
       virtual const char *getTypeClassName() { return #typeName ; } \
       virtual StringTableEntry getTypePrefix( void ) const { return StringTable->insert( typePrefix ); }\
@@ -117,7 +123,7 @@ public:
       virtual KorkApi::ConsoleValue performOp(KorkApi::Vm* vm, U32 op, KorkApi::ConsoleValue lhs, KorkApi::ConsoleValue rhs); \
    }; \
    S32 type = -1; \
-   ConsoleType##type gConsoleType##type##Instance(size,vsize,&type,#type); \
+   ConsoleType##type gConsoleType##type##Instance(size,vsize,&type,#type,numericStorage); \
 
 #define ConsolePrepType( typeName, type, size, vsize, typePrefix ) \
    class ConsoleType##type : public ConsoleBaseType \
@@ -190,18 +190,46 @@ SimObject::SimObject( const U8 namespaceLinkMask ) : mNSLinkMask( namespaceLinkM
 
 SimObject::SignalListenerList* SimObject::findSignalListenerList(StringTableEntry signalName)
 {
-   auto itr = std::find_if(mSignalListeners.begin(), mSignalListeners.end(), [signalName](const SignalListenerList& list) {
-      return list.signalName == signalName;
-   });
-   return itr != mSignalListeners.end() ? &(*itr) : nullptr;
+   S32 slot = vm ? vm->getSignalSlot(signalName) : -1;
+   if (slot < 0 || slot >= (S32)mSignalListeners.size() || mSignalListeners[slot].signalName == nullptr)
+      return nullptr;
+   return &mSignalListeners[slot];
 }
 
 const SimObject::SignalListenerList* SimObject::findSignalListenerList(StringTableEntry signalName) const
 {
-   auto itr = std::find_if(mSignalListeners.begin(), mSignalListeners.end(), [signalName](const SignalListenerList& list) {
-      return list.signalName == signalName;
-   });
-   return itr != mSignalListeners.end() ? &(*itr) : nullptr;
+   S32 slot = vm ? vm->getSignalSlot(signalName) : -1;
+   if (slot < 0 || slot >= (S32)mSignalListeners.size() || mSignalListeners[slot].signalName == nullptr)
+      return nullptr;
+   return &mSignalListeners[slot];
+}
+
+bool SimObject::removeSignalBindings(SignalListenerList& list, SimObject* listener, StringTableEntry methodName)
+{
+   auto matches = [listener, methodName](const SignalListenerList::ListenerBinding& binding) {
+      if (binding.listener != listener)
+         return false;
+      return methodName == nullptr || binding.methodName == methodName;
+   };
+
+   if (list.dispatchDepth > 0)
+   {
+      // triggerSignal is indexing into the list, so just clear the entry
+      bool removed = false;
+      for (SignalListenerList::ListenerBinding& binding : list.listeners)
+      {
+         if (!matches(binding))
+            continue;
+         binding.listener = nullptr;
+         list.needsCompact = true;
+         removed = true;
+      }
+      return removed;
+   }
+
+   U32 oldSize = list.listeners.size();
+   list.listeners.erase(std::remove_if(list.listeners.begin(), list.listeners.end(), matches), list.listeners.end());
+   return oldSize != list.listeners.size();
 }
 
 bool SimObject::hasAnySignalListenerRef(SimObject* listener) const
@@ -1830,46 +1858,57 @@ void SimObject::onGroupRemove()
 
 void SimObject::onDeleteNotify(SimObject* object)
 {
-   for (auto listItr = mSignalListeners.begin(); listItr != mSignalListeners.end(); )
-   {
-      auto& listeners = listItr->listeners;
-      listeners.erase(std::remove_if(listeners.begin(), listeners.end(), [object](const SignalListenerList::ListenerBinding& binding) {
-         return binding.listener == object;
-      }), listeners.end());
-      if (listeners.empty())
-         listItr = mSignalListeners.erase(listItr);
-      else
-         ++listItr;
-   }
+   for (SignalListenerList& list : mSignalListeners)
+      removeSignalBindings(list, object, nullptr);
 }
 
-void SimObject::triggerSignal(void* userPtr, StringTableEntry signalName, int argc, KorkApi::ConsoleValue* argv)
+void SimObject::triggerSignal(void* userPtr, S32 signalSlot, StringTableEntry signalName, int argc, KorkApi::ConsoleValue* argv)
 {
-   SignalListenerList* list = findSignalListenerList(signalName);
-   if (!list || !vm)
+   if (!vm || signalSlot < 0 || signalSlot >= (S32)mSignalListeners.size())
+      return;
+
+   const int callArgc = argc + 2;
+   if (callArgc > KorkApi::MaxArgs)
       return;
 
-   std::vector<SignalListenerList::ListenerBinding> listeners = list->listeners;
-   for (const SignalListenerList::ListenerBinding& binding : listeners)
+   KorkApi::ConsoleValue callArgv[KorkApi::MaxArgs];
+   callArgv[0] = KorkApi::ConsoleValue::makeString(signalName);
+   for (int i = 0; i < argc; i++)
+      callArgv[i + 2] = argv[i];
+
+   // NOTE: listeners added during dispatch are not called until the next trigger
+   const U32 numListeners = mSignalListeners[signalSlot].listeners.size();
+   mSignalListeners[signalSlot].dispatchDepth++;
+   
+   // Listeners may delete this object, in which case dispatch stops
+   SimObjectPtr<SimObject> self(this);
+
+   for (U32 i = 0; i < numListeners; i++)
    {
+      // Listener callbacks may add bindings, so always re-index the list
+      SignalListenerList::ListenerBinding& binding = mSignalListeners[signalSlot].listeners[i];
       SimObject* listener = binding.listener;
       if (!listener || listener->isDeleted() || !listener->getVMObject())
          continue;
 
-      const int callArgc = argc + 2;
-      if (callArgc > KorkApi::MaxArgs)
-         continue;
-
-      KorkApi::ConsoleValue callArgv[KorkApi::MaxArgs];
-      callArgv[0] = KorkApi::ConsoleValue::makeString(signalName);
       callArgv[1] = KorkApi::ConsoleValue::makeUnsigned(listener->getId());
-      for (int i = 0; i < argc; i++)
-         callArgv[i + 2] = argv[i];
 
       KorkApi::ConsoleValue retValue;
       listener->pushScriptCallbackGuard();
-      vm->callObjectFunction(listener->getVMObject(), binding.methodName ? binding.methodName : signalName, callArgc, callArgv, retValue);
+      vm->callObjectFunctionCached(listener->getVMObject(), binding.methodName, binding.method, callArgc, callArgv, retValue);
       listener->popScriptCallbackGuard();
+      
+      if (self.isNull())
+         return;
+   }
+
+   SignalListenerList& list = mSignalListeners[signalSlot];
+   if (--list.dispatchDepth == 0 && list.needsCompact)
+   {
+      list.listeners.erase(std::remove_if(list.listeners.begin(), list.listeners.end(), [](const SignalListenerList::ListenerBinding& binding) {
+         return binding.listener == nullptr;
+      }), list.listeners.end());
+      list.needsCompact = false;
    }
 }
 
@@ -1904,13 +1943,16 @@ bool SimObject::addSignalListener(StringTableEntry signalName, SimObject* listen
    if (!listener || !hasSignal(signalName))
       return false;
 
+   S32 slot = vm->getSignalSlot(signalName);
+   if (slot < 0)
+      return false;
+
+   if (slot >= (S32)mSignalListeners.size())
+      mSignalListeners.resize(slot + 1, {nullptr, {}, 0, false});
+
    StringTableEntry resolvedMethodName = methodName ? methodName : signalName;
-   SignalListenerList* list = findSignalListenerList(signalName);
-   if (!list)
-   {
-      mSignalListeners.push_back({signalName, {}});
-      list = &mSignalListeners.back();
-   }
+   SignalListenerList* list = &mSignalListeners[slot];
+   list->signalName = signalName;
 
    auto itr = std::find_if(list->listeners.begin(), list->listeners.end(), [listener, resolvedMethodName](const SignalListenerList::ListenerBinding& binding) {
       return binding.listener == listener && binding.methodName == resolvedMethodName;
@@ -1919,7 +1961,7 @@ bool SimObject::addSignalListener(StringTableEntry signalName, SimObject* listen
       return true;
 
    const bool needsDeleteNotify = !hasAnySignalListenerRef(listener);
-   list->listeners.push_back({listener, resolvedMethodName});
+   list->listeners.push_back({listener, resolvedMethodName, KorkApi::MethodCache()});
    if (needsDeleteNotify)
       deleteNotify(listener);
    return true;
@@ -1934,23 +1976,8 @@ bool SimObject::removeSignalListener(StringTableEntry signalName, SimObject* lis
    if (!list)
       return false;
 
-   U32 oldSize = list->listeners.size();
-   list->listeners.erase(std::remove_if(list->listeners.begin(), list->listeners.end(), [listener, methodName](const SignalListenerList::ListenerBinding& binding) {
-      if (binding.listener != listener)
-         return false;
-      return methodName == nullptr || binding.methodName == methodName;
-   }), list->listeners.end());
-   if (oldSize == list->listeners.size())
+   if (!removeSignalBindings(*list, listener, methodName))
       return false;
-   
-   if (list->listeners.empty())
-   {
-      auto listItr = std::find_if(mSignalListeners.begin(), mSignalListeners.end(), [signalName](const SignalListenerList& entry) {
-         return entry.signalName == signalName;
-      });
-      if (listItr != mSignalListeners.end())
-         mSignalListeners.erase(listItr);
-   }
 
    if (!hasAnySignalListenerRef(listener))
       clearNotify(listener);
@@ -543,12 +543,15 @@ public:
     {
         struct ListenerBinding
         {
-            SimObject* listener;
+            SimObject* listener;           ///< nullptr if removed during dispatch
             StringTableEntry methodName;
+            KorkApi::MethodCache method;   ///< Resolved methodName on listener
         };
 
-        StringTableEntry signalName;
+        StringTableEntry signalName;       ///< nullptr if slot is unused
         std::vector<ListenerBinding> listeners;
+        U32 dispatchDepth;                 ///< Non-zero while listeners are being called
+        bool needsCompact;                 ///< Bindings were removed during dispatch
     };
 
     /// @}
@@ -599,7 +602,7 @@ private:
     /// @}
 
     std::vector<StringTableEntry> mFieldFilter;
-    std::vector<SignalListenerList> mSignalListeners;
+    std::vector<SignalListenerList> mSignalListeners; ///< Indexed by vm signal slot
 
 protected:
     SimObjectId mId;         ///< Id number for this object.
@@ -662,6 +665,7 @@ private:
     SignalListenerList* findSignalListenerList(StringTableEntry signalName);
     const SignalListenerList* findSignalListenerList(StringTableEntry signalName) const;
     bool hasAnySignalListenerRef(SimObject* listener) const;
+    bool removeSignalBindings(SignalListenerList& list, SimObject* listener, StringTableEntry methodName);
 
 protected:
     // By setting the value of mNSLinkMask in the constructor of a class that 
@@ -796,7 +800,7 @@ public:
     /// When you are on the notification list for another object
     /// and it is deleted, this method is called.
     virtual void onDeleteNotify(SimObject *object);
-    virtual void triggerSignal(void* userPtr, StringTableEntry signalName, int argc, KorkApi::ConsoleValue* argv);
+    virtual void triggerSignal(void* userPtr, S32 signalSlot, StringTableEntry signalName, int argc, KorkApi::ConsoleValue* argv);
 
     /// Called when the editor is activated.
     virtual void onEditorEnable(){};